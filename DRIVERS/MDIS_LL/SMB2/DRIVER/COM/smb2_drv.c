@@ -146,6 +146,7 @@ static int32 Smb2SetStat(LL_HANDLE *llHdl, int32 code, INT32_OR_64 value32_or_64
 static int32 Smb2GetStat(LL_HANDLE *llHdl, int32 code, INT32_OR_64 *value32_or_64P);
 static void Smb2AlertCb( void *cbArg );
 static int32 IsDevExcluded( LL_HANDLE *llHdl, u_int16 addr );
+static int32 Smb2XferGroup( LL_HANDLE *llHdl, M_SG_BLOCK *blk );
 
 
 /****************************** SMB2_GetEntry ********************************/
@@ -1035,6 +1036,12 @@ static int32 Smb2GetStat(
 		break;
 	}
 
+	case SMB2_BLK_XFER_GROUP:
+		DBGWRT_2((DBH, " XferGroup\n"));
+		if( (error = Smb2XferGroup( llHdl, blk )) )
+			goto ERR_EXIT;
+		break;
+
 	default:
 		return ERR_LL_UNK_CODE;
 	}
@@ -1100,5 +1107,82 @@ static int32 IsDevExcluded(
 	}
 }
 
+/********************************* Smb2XferGroup *****************************/
+/** Execute all transfers of a transaction group
+ *
+ *  The transfers are executed in order within one driver call, so no other
+ *  path can access the bus between them (LL_LOCK_CALL). Only simple and
+ *  block transfers are allowed, alert and I2C codes are rejected.
+ *
+ *  The result of each transfer is stored in its \a error field, the number
+ *  of executed transfers in \a done. Execution stops at the first failed
+ *  transfer, unless #SMB2_XFER_GROUP_CONT is set. A failed transfer is
+ *  only reported in the group: the function succeeds, because the block
+ *  (with \a done and the results of the successful transfers) is passed
+ *  back to the caller only on success. An error is returned for an invalid
+ *  group only. An empty group (\a num == 0) is valid, it is used by the
+ *  API to check that the driver supports transaction groups.
+ *
+ *  \param llHdl      \IN  Low-level handle
+ *  \param blk        \IN  Block data structure containing SMB2_XFER_GROUP
+ *
+ *  \return           \c 0 On success or error code
+ */
+static int32 Smb2XferGroup(
+	LL_HANDLE	*llHdl,
+	M_SG_BLOCK	*blk )
+{
+	SMB2_XFER_GROUP			*grp = (SMB2_XFER_GROUP*)blk->data;
+	SMB2_XFER_GROUP_ENTRY	*entry;
+	M_SG_BLOCK				entryBlk;
+	int32					error;
+	u_int32					n;
+
+	if( (blk->size < (int32)SMB2_XFER_GROUP_SIZE(1)) ||
+		(grp->num > SMB2_XFER_GROUP_MAX) ||
+		(blk->size < (int32)SMB2_XFER_GROUP_SIZE(grp->num)) )
+		return SMB_ERR_PARAM;
+
+	DBGWRT_2((DBH, " XferGroup: num=%d, flags=0x%x\n", grp->num, grp->flags));
+
+	grp->done = 0;
+	for( n=0; n<grp->num; n++ ){
+		entry = &grp->entry[n];
+
+		entryBlk.size = sizeof(entry->u);
+		entryBlk.data = (void*)&entry->u;
+
+		switch( entry->code ){
+		case SMB2_BLK_QUICK_COMM:
+		case SMB2_BLK_WRITE_BYTE:
+		case SMB2_BLK_WRITE_BYTE_DATA:
+		case SMB2_BLK_WRITE_WORD_DATA:
+		case SMB2_BLK_WRITE_BLOCK_DATA:
+			error = Smb2SetStat( llHdl, entry->code, (INT32_OR_64)&entryBlk );
+			break;
+		case SMB2_BLK_READ_BYTE:
+		case SMB2_BLK_READ_BYTE_DATA:
+		case SMB2_BLK_READ_WORD_DATA:
+		case SMB2_BLK_READ_BLOCK_DATA:
+		case SMB2_BLK_PROCESS_CALL:
+		case SMB2_BLK_BLOCK_PROCESS_CALL:
+			error = Smb2GetStat( llHdl, entry->code, (INT32_OR_64*)&entryBlk );
+			break;
+		default:
+			error = SMB_ERR_PARAM;
+		}
+
+		entry->error = error;
+		grp->done++;
 
+		if( error ){
+			DBGWRT_ERR((DBH, " *** LL - Smb2XferGroup: transfer %d failed, "
+				"error=0x%x\n", n, error));
+			if( !(grp->flags & SMB2_XFER_GROUP_CONT) )
+				break;
+		}
+	}
+
+	return 0;
+}
 
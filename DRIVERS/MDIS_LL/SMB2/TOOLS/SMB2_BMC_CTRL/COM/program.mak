@@ -27,11 +27,13 @@ STAMPED_REVISION="13Y004-06_01_42-24-ge5f4d78-dirty_2019-05-30"
 DEF_REVISION=MAK_REVISION=$(STAMPED_REVISION)
 MAK_SWITCH=$(SW_PREFIX)$(DEF_REVISION)
 
+# SMB2_BMC_API background service threads (smb2_os) use POSIX threads
 MAK_LIBS=$(LIB_PREFIX)$(MEN_LIB_DIR)/usr_utl$(LIB_SUFFIX)   \
          $(LIB_PREFIX)$(MEN_LIB_DIR)/usr_oss$(LIB_SUFFIX)   \
          $(LIB_PREFIX)$(MEN_LIB_DIR)/smb2_bmc_api$(LIB_SUFFIX)  \
          $(LIB_PREFIX)$(MEN_LIB_DIR)/smb2_api$(LIB_SUFFIX)  \
-         $(LIB_PREFIX)$(MEN_LIB_DIR)/mdis_api$(LIB_SUFFIX)
+         $(LIB_PREFIX)$(MEN_LIB_DIR)/mdis_api$(LIB_SUFFIX)  \
+         -lpthread
 
 MAK_INCL=$(MEN_INC_DIR)/men_typs.h  \
          $(MEN_INC_DIR)/usr_utl.h   \
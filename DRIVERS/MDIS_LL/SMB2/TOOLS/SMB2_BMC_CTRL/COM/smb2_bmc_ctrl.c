@@ -93,11 +93,14 @@ static const char IdentString[]=MENT_XSTR(MAK_REVISION);
 #define EVLOG_STAT			0x01
 #define EVLOG_WRITE			0x02
 #define EVLOG_READ			0x03
+#define EVLOG_SYNC			0x04
 
 /* Error Counters Commands */
 #define ERR_CNT_MAX_NUM		0x01
 #define ERR_CNT_CLR			0x02
 #define ERR_CNT_GET			0x03
+#define ERR_CNT_GET_ALL		0x04
+#define ERR_CNT_WATCH		0x05
 
 /* Status Outputs Commands */
 #define STATUS_OUT_SET		0x01
@@ -117,12 +120,14 @@ static const char IdentString[]=MENT_XSTR(MAK_REVISION);
 #define GPO_GET				0x03
 #define GPI_CAPS			0x04
 #define GPI_GET				0x05
+#define GPO_SET_MASK		0x06
 
 /* CB30C Specific Commands */
 #define PWR_LOG_MODE_SET	0x01
 #define PWR_LOG_MODE_GET	0x02
 #define STAT_FRM_TRIG		0x03
 #define STAT_FRM_GET		0x04
+#define STAT_FRM_MONITOR	0x05
 
 #define WDOG_ON				0x01
 #define WDOG_OFF			0x00
@@ -210,15 +215,22 @@ static void print_voltage_report(void);
 
 static void print_life_time_report(void);
 
+static void print_health(void);
+
 static void event_log_command(int event_log_cmd, int argc, char* argv[]);
 static void print_evlog_status(void);
 static void evlog_write(int argc, char* argv[]);
+static void evlog_sync(int argc, char* argv[]);
+static int32 evlog_sync_cb(void *cb_arg, u_int16 evlog_idx,
+						   struct bmc_event_report *event_report);
 static void print_event_report(int argc, char* argv[]);
 
 static void error_cnt_command(int error_cnt_cmd, int argc, char* argv[]);
 static void print_errcnt_max(void);
 static void clear_errcnt(void);
 static void print_errcnt(int argc, char* argv[]);
+static void print_errcnt_all(void);
+static void watch_errcnt(int argc, char* argv[]);
 
 static void status_outputs_command(int status_out_cmd, int argc, char* argv[]);
 static void set_status_output(int argc, char* argv[]);
@@ -263,6 +275,7 @@ static void usage(void)
 		"    -p=[cmd]   Send Power Reset command\n"
 		"    -v         Get Voltage Report\n"
 		"    -l         Get Life Time Report\n"
+		"    -a         Get Health Snapshot (all reports in one request)\n"
 		"    -e=[cmd]   Send Event Log command\n"
 		"    -x=[cmd]   Send Error Counter command\n"
 		"    -s=[cmd]   Send Status Output command\n"
@@ -311,7 +324,8 @@ static void print_wd_options(void)
 		"     1                  Enable WDOG\n"
 		"     2                  Disable WDOG\n"
 		"     3 [<trigger_time>] Trigger WDOG\n"
-		"                          <trigger_time> in ms, default=30000 (=30s)\n"
+		"                          <trigger_time> in ms, default: keep-alive\n"
+		"                          service triggers in the middle of the window\n"
 		"     4  <upper_limit>   Set upper limit of trigger time window (unit: 100 ms)\n"
 		"     5                  Get upper limit of trigger time window (unit: 100 ms)\n"
 		"     6                  Get WDOG State\n"
@@ -367,6 +381,8 @@ static void print_evlog_options(void)
 		"          <code>=0x1000..0x7fff\n"
 		"          <info*>=0x0..0xff\n"
 		"     3  <idx>                                   Read event from Event LOG\n"
+		"     4  <file>                                  Print new events since last sync\n"
+		"          <file>=cursor file, updated after printing\n"
 		);
 }
 
@@ -382,6 +398,8 @@ static void print_errcnt_options(void)
 		"     1       Get number of error counters supported\n"
 		"     2       Clear all Error Counters\n"
 		"     3 <idx> Get Error Counter by Index\n"
+		"     4       Get all Error Counters\n"
+		"     5 [<s>] Print changed Error Counters every <s>=1.. seconds (default 1)\n"
 		);
 }
 
@@ -441,6 +459,7 @@ static void print_gpio_options(void)
 		"     3               Get GPO 0..6 states\n"
 		"     4               Report which GPIs are supported\n"
 		"     5               Get GPI 0..6 states\n"
+		"     6 <mask> <val>  Set GPOs selected by <mask> to <val> (hex, bit n = GPO n)\n"
 		);	
 }
 
@@ -457,6 +476,7 @@ static void print_cb30c_specific_options(void)
 		"     2       Get current setting of power on/off event logging\n"
 		"     3       Trigger a new SUPV Status Frame Transfer\n"
 		"     4       Get last from SUPV received status frame\n"
+		"     5 [<period>] Monitor status frames, <period> in ms, default=50\n"
 		);
 }
 
@@ -494,7 +514,7 @@ int main(int argc, char** argv)
 	/*--------------------+
 	|  check arguments    |
 	+--------------------*/
-	errstr = UTL_ILLIOPT("?ib=w=p=vle=x=s=r=c=g=z=", argbuf);
+	errstr = UTL_ILLIOPT("?ib=w=p=vlae=x=s=r=c=g=z=", argbuf);
 	if (errstr) {
 		printf("*** %s\n", errstr);
 		usage();
@@ -564,6 +584,11 @@ int main(int argc, char** argv)
 		print_life_time_report();
 	}
 	
+	/* get health snapshot */
+	if (UTL_TSTOPT("a")) {
+		print_health();
+	}
+	
 	/* send Event Log command */
 	if ((optP = UTL_TSTOPT("e="))) {
 		sscanf(optP, "%x", &evlog_cmd);
@@ -818,24 +843,50 @@ static void wdog_off(void)
 	}
 }
 
+/****************************************************************************/
+/** Print statistics of the WDOG keep-alive service
+*
+*  \param kaHdl    \IN  keep-alive handle
+*/
+static void wdog_print_stats(void *kaHdl)
+{
+	int err;
+	struct bmc_wdog_keepalive_stats stats;
+
+	err = SMB2BMC_WDOG_KeepAliveGetStats(kaHdl, &stats);
+	if (err) {
+		PrintError("***ERROR: SMB2BMC_WDOG_KeepAliveGetStats:", err);
+		return;
+	}
+
+	printf(" triggers=%u errors=%u near misses=%u "
+		   "jitter min/avg/max=%d/%d/%d ms\n",
+		   (unsigned int)stats.trig_cnt, (unsigned int)stats.err_cnt,
+		   (unsigned int)stats.near_miss_cnt, (int)stats.jitter_min,
+		   (int)stats.jitter_avg, (int)stats.jitter_max);
+}
+
 /****************************************************************************/
 /** WDOG trigger
 *
+*  Without <trigger_time> the keep-alive service of the library triggers
+*  the WDOG in the middle of the trigger time window.
+*
 *  \param argc    \IN  argument counter
 *  \param argv    \IN  argument vector
 */
 static void wdog_trigger(int argc, char* argv[])
 {
 	int err;
-	unsigned int trigTime;
+	unsigned int trigTime = 0;
 	u_int8 wdog_state;
+	void *kaHdl;
+	struct bmc_wdog_keepalive_stats stats;
+	u_int32 seconds = 0;
 	
 	if( argc > 3 ) {
 		sscanf( argv[3], "%d", &trigTime );
 	}
-	else {
-		trigTime = 30000;	/* 30sec */
-	}
 
 	/* check WDog state */
 	err = SMB2BMC_WDOG_GetState(&wdog_state);
@@ -843,7 +894,7 @@ static void wdog_trigger(int argc, char* argv[])
 		PrintError("***ERROR: SMB2BMC_WDOG_GetState:", err);
 	}
 	
-	if( wdog_state == WDOG_ON ) {		/* WDOG enabled */
+	if( wdog_state == WDOG_ON && trigTime ) {		/* WDOG enabled */
 
 		printf( " Watchdog state: enabled -> trigger all %dmsec\n", trigTime );
 
@@ -859,6 +910,30 @@ static void wdog_trigger(int argc, char* argv[])
 			}
 		} while( UOS_KeyPressed() == -1 );
 	}
+	else if( wdog_state == WDOG_ON ) {
+
+		err = SMB2BMC_WDOG_KeepAliveStart(&kaHdl);
+		if (err) {
+			PrintError("***ERROR: SMB2BMC_WDOG_KeepAliveStart:", err);
+			return;
+		}
+
+		SMB2BMC_WDOG_KeepAliveGetStats(kaHdl, &stats);
+		printf( " Watchdog state: enabled -> window %u..%umsec, "
+				"trigger all %umsec\n", (unsigned int)stats.win_min,
+				(unsigned int)stats.win_max, (unsigned int)stats.period );
+		printf( " Press any key to abort\n" );
+
+		/* print statistics every 10s */
+		do {
+			UOS_Delay( 1000 );
+			if( ++seconds % 10 == 0 )
+				wdog_print_stats(kaHdl);
+		} while( UOS_KeyPressed() == -1 );
+
+		wdog_print_stats(kaHdl);
+		SMB2BMC_WDOG_KeepAliveStop(&kaHdl);
+	}
 	else {
 		printf( " Watchdog state: disabled -> no trigger" );
 	}
@@ -1399,32 +1474,25 @@ static void pwr_rst_ctrl(int prc_cmd, int argc, char* argv[])
 static void print_voltage_report(void)
 {
 	int err;
-	u_int8 volt_max_num;
+	u_int8 volt_max_num = SMB2_BMC_VOLT_MAX;
 	u_int8 volt_idx;
-	struct bmc_voltage_report volt_report;
+	struct bmc_voltage_report volt_report[SMB2_BMC_VOLT_MAX];
 	
-	err = SMB2BMC_Volt_Max_Num(&volt_max_num);
+	err = SMB2BMC_Volt_GetAll(volt_report, &volt_max_num);
 	if (err) {
-		PrintError("***ERROR: SMB2BMC_Volt_Max_Num:", err);
+		PrintError("***ERROR: SMB2BMC_Volt_GetAll:", err);
 	}
 	else {
 		printf("Number of voltages: %d\n", volt_max_num);
 		for (volt_idx=0; volt_idx < volt_max_num; volt_idx++){
 			printf("\nVoltage %d\n", volt_idx + 1);
-			err = SMB2BMC_Volt_Get(volt_idx, &volt_report);
-			if (err) {
-				PrintError("***ERROR: SMB2BMC_Volt_Get:", err);
-			}
-			else {
-				printf("-----------------------------------------------------\n");
-				printf("Actual voltage  : %5d\n", volt_report.actual_volt);
-				printf("Nominal voltage : %5d\n", volt_report.nominal_volt);
-				printf("Lowest measured : %5d (since BMC powered on)\n", 
-						volt_report.low_lim_volt);
-				printf("Highest measured: %5d (since BMC powered on)\n",
-						volt_report.up_lim_volt);
-			}
-			
+			printf("-----------------------------------------------------\n");
+			printf("Actual voltage  : %5d\n", volt_report[volt_idx].actual_volt);
+			printf("Nominal voltage : %5d\n", volt_report[volt_idx].nominal_volt);
+			printf("Lowest measured : %5d (since BMC powered on)\n", 
+					volt_report[volt_idx].low_lim_volt);
+			printf("Highest measured: %5d (since BMC powered on)\n",
+					volt_report[volt_idx].up_lim_volt);
 		}
 	}
 }
@@ -1456,6 +1524,63 @@ static void print_life_time_report(void)
 	}
 }
 
+/****************************************************************************/
+/** Get and print a health snapshot.
+*
+*/
+static void print_health(void)
+{
+	int err, i;
+	struct bmc_health health;
+
+	err = SMB2BMC_GetHealthSnapshot(&health);
+	if (err) {
+		PrintError("***ERROR: SMB2BMC_GetHealthSnapshot:", err);
+		return;
+	}
+
+	printf("Health Snapshot (%u ms, %u requests)\n",
+		   (unsigned int)health.duration, (unsigned int)health.requests);
+	printf("------------------------------------------------\n");
+	printf("Sections valid: 0x%04x  failed: 0x%04x\n",
+		   (unsigned int)health.valid, (unsigned int)health.failed);
+
+	if (health.valid & SMB2_BMC_HEALTH_FW)
+		printf("Firmware      : %d.%d.%d build %d\n",
+			   health.fw_version.maj_revision,
+			   health.fw_version.min_revision,
+			   health.fw_version.mtnce_revision,
+			   health.fw_version.build_nbr);
+	if (health.valid & SMB2_BMC_HEALTH_WDOG)
+		printf("Watchdog      : %s, %s, window %d..%d ms\n",
+			   health.wd_state ? "enabled" : "disabled",
+			   health.wd_arm_state ? "armed" : "not armed",
+			   health.wd_min_tout * 10, health.wd_max_tout * 100);
+	if (health.valid & SMB2_BMC_HEALTH_RSTR)
+		printf("Reset reason  : event code 0x%04x\n",
+			   health.rst_reason.ev_code);
+	if (health.valid & SMB2_BMC_HEALTH_LIFE)
+		printf("Life time     : %u power cycles, %u hours\n",
+			   (unsigned int)health.pwr_cycles,
+			   (unsigned int)health.op_time);
+	if (health.valid & SMB2_BMC_HEALTH_RTC)
+		printf("RTC           : %04d-%02d-%02d %02d:%02d:%02d%s\n",
+			   health.rtc.year, health.rtc.month, health.rtc.mday,
+			   health.rtc.hours, health.rtc.minutes, health.rtc.seconds,
+			   health.rtc.battery ? " (battery low)" : "");
+	if (health.valid & SMB2_BMC_HEALTH_EVLOG)
+		printf("Event log     : %d of %d entries\n",
+			   health.evlog_status.act_entries,
+			   health.evlog_status.max_entries);
+	if (health.valid & SMB2_BMC_HEALTH_VOLT)
+		for (i = 0; i < health.volt_num; i++)
+			printf("Voltage %3d   : %5d (nominal %5d)\n", i,
+				   health.volt[i].actual_volt, health.volt[i].nominal_volt);
+	if (health.valid & SMB2_BMC_HEALTH_ERRCNT)
+		for (i = 0; i < health.errcnt_num; i++)
+			printf("Error cnt %3d : %d\n", i, health.errcnt[i]);
+}
+
 /****************************************************************************/
 /** Print event log status.
 *
@@ -1560,6 +1685,54 @@ static void print_event_report(int argc, char* argv[])
 	}
 }
 
+/****************************************************************************/
+/** Print one event of the event log synchronization.
+*
+ *  \param cb_arg          \IN  number of printed events
+ *  \param evlog_idx       \IN  event log index
+ *  \param event_report    \IN  event report
+ *  \return 0 to continue synchronization
+*/
+static int32 evlog_sync_cb(void *cb_arg, u_int16 evlog_idx,
+						   struct bmc_event_report *event_report)
+{
+	(*(int*)cb_arg)++;
+
+	printf("%5d: %12llu s  proc %d  code 0x%04x  info 0x%02x 0x%02x 0x%02x 0x%02x%s\n",
+			evlog_idx, event_report->tstamp, event_report->procID,
+			event_report->ev_code, event_report->ev_info1,
+			event_report->ev_info2, event_report->ev_info3,
+			event_report->ev_info4, event_report->rtcv ? "" : "  (RTC invalid)");
+
+	return 0;
+}
+
+/****************************************************************************/
+/** Print new events since the last synchronization.
+*
+ *  \param argc    \IN  argument counter
+ *  \param argv    \IN  argument vector
+*/
+static void evlog_sync(int argc, char* argv[])
+{
+	int err;
+	int num = 0;
+
+	if (argc > 3){
+		err = SMB2BMC_EventLog_Sync(argv[3], evlog_sync_cb, &num);
+		if (err) {
+			PrintError("***ERROR: SMB2BMC_EventLog_Sync:", err);
+		}
+		else {
+			printf("%d new event(s)\n", num);
+		}
+	}
+
+	else {
+		printf("***ERROR: Not enough arguments\n");
+	}
+}
+
 /****************************************************************************/
 /** Send Event Log command.
 *
@@ -1583,6 +1756,9 @@ static void event_log_command(int event_log_cmd, int argc, char* argv[])
 		case EVLOG_READ: 
 			print_event_report(argc, argv);
 			break;
+		case EVLOG_SYNC: 
+			evlog_sync(argc, argv);
+			break;
 		default: printf("***ERROR: Event Log command not available\n");
 	}
 }
@@ -1659,6 +1835,64 @@ static void print_errcnt(int argc, char* argv[])
 	
 }
 
+/****************************************************************************/
+/** Get all Error Counters.
+*
+*/
+static void print_errcnt_all(void)
+{
+	int err, i;
+	u_int8 n = SMB2_BMC_ERRCNT_MAX;
+	u_int16 counts[SMB2_BMC_ERRCNT_MAX];
+
+	err = SMB2BMC_ErrCnt_GetAll(counts, &n);
+	if (err) {
+		PrintError("***ERROR: SMB2BMC_ErrCnt_GetAll:", err);
+		return;
+	}
+
+	printf("Error Counter Report\n");
+	printf("------------------------------------------------\n");
+	for (i = 0; i < n; i++)
+		printf("Error Counter %3d: %d\n", i, counts[i]);
+}
+
+/****************************************************************************/
+/** Print changed Error Counters periodically.
+*
+ *  \param argc    \IN  argument counter
+ *  \param argv    \IN  argument vector
+*/
+static void watch_errcnt(int argc, char* argv[])
+{
+	int err, i;
+	unsigned int interval = 1;
+	u_int8 n;
+	struct bmc_errcnt_change change[SMB2_BMC_ERRCNT_MAX];
+
+	if (argc > 3)
+		sscanf(argv[3], "%d", &interval);
+	if (interval == 0)
+		interval = 1;
+
+	printf("Press any key to abort\n");
+
+	do {
+		n = SMB2_BMC_ERRCNT_MAX;
+		err = SMB2BMC_ErrCnt_GetChanged(change, &n);
+		if (err) {
+			PrintError("***ERROR: SMB2BMC_ErrCnt_GetChanged:", err);
+			return;
+		}
+
+		for (i = 0; i < n; i++)
+			printf("Error Counter %3d: %5d -> %5d\n", change[i].idx,
+				   change[i].prev, change[i].count);
+
+		UOS_Delay(interval * 1000);
+	} while (UOS_KeyPressed() == -1);
+}
+
 /****************************************************************************/
 /** Send Error Counter command.
 *
@@ -1682,6 +1916,12 @@ static void error_cnt_command(int error_cnt_cmd, int argc, char* argv[])
 		case ERR_CNT_GET: 
 			print_errcnt(argc, argv);
 			break;
+		case ERR_CNT_GET_ALL:
+			print_errcnt_all();
+			break;
+		case ERR_CNT_WATCH:
+			watch_errcnt(argc, argv);
+			break;
 		default: printf("***ERROR: Error Counter command not available\n");
 	}
 }
@@ -1989,17 +2229,46 @@ static void gpo_set(int argc, char* argv[])
 static void gpo_get(void)
 {
 	int err, i;
-	u_int8 status;
+	u_int8 levels;
+
+	err = SMB2BMC_GPO_GetAll(&levels, NULL);
+	if (err) {
+		PrintError("***ERROR: SMB2BMC_GPO_GetAll:", err);
+		return;
+	}
 
 	for (i=GPO_0; i<=GPO_6; i++){
-		err = SMB2BMC_GPO_Get(i, &status);
+		printf("GPO_%d is %s\n", i, (levels & (1 << i)) ? "HIGH" : "LOW");
+	}
+}
+
+/****************************************************************************/
+/** Set several general purpose outputs.
+*
+ *  \param argc    \IN  argument counter
+ *  \param argv    \IN  argument vector
+*/
+static void gpo_set_mask(int argc, char* argv[])
+{
+	int err;
+	unsigned int mask;
+	unsigned int value;
+	
+	if (argc > 4) {
+		sscanf(argv[3], "%x", &mask);
+		sscanf(argv[4], "%x", &value);
+		
+		err = SMB2BMC_GPO_SetMask((u_int8)mask, (u_int8)value);
 		if (err) {
-			PrintError("***ERROR: SMB2BMC_GPO_Get:", err);
+			PrintError("***ERROR: SMB2BMC_GPO_SetMask:", err);
 		}
 		else {
-			printf("GPO_%d is %s\n", i, status ? "HIGH" : "LOW");
+			printf("GPOs 0x%02x set to 0x%02x\n", mask, value & mask);
 		}
 	}
+	else {
+		printf("***ERROR: Not enough arguments\n");
+	}
 }
 
 /****************************************************************************/
@@ -2029,16 +2298,16 @@ static void print_gpi_caps(void)
 static void gpi_get(void)
 {
 	int err, i;
-	u_int8 status;
+	u_int8 levels;
+
+	err = SMB2BMC_GPI_GetAll(&levels, NULL);
+	if (err) {
+		PrintError("***ERROR: SMB2BMC_GPI_GetAll:", err);
+		return;
+	}
 
 	for (i=GPI_0; i<=GPI_6; i++){
-		err = SMB2BMC_GPI_Get(i, &status);
-		if (err) {
-			PrintError("***ERROR: SMB2BMC_GPI_Get:", err);
-		}
-		else {
-			printf("GPI_%d is %s\n", i, status ? "HIGH" : "LOW");
-		}
+		printf("GPI_%d is %s\n", i, (levels & (1 << i)) ? "HIGH" : "LOW");
 	}
 }
 
@@ -2071,6 +2340,9 @@ static void gpio_command(int gpio_cmd, int argc, char* argv[])
 		case GPI_GET:
 			gpi_get();
 			break;
+		case GPO_SET_MASK:
+			gpo_set_mask(argc, argv);
+			break;
 		default: printf("***ERROR: Backplane CPCI command not available\n");
 	}
 }
@@ -2310,6 +2582,71 @@ static void print_stat_frm(void)
 	}
 }
 
+/****************************************************************************/
+/** Status frame sampler callback: print events.
+*
+ *  \param cb_arg    \IN  unused
+ *  \param events    \IN  SMB2_BMC_SMPL_EV_xxx events
+ *  \param sample    \IN  sample that caused the events
+*/
+static void stat_frm_monitor_cb(void *cb_arg, u_int32 events,
+								struct bmc_status_sample *sample)
+{
+	printf("%10u ms:", (unsigned int)sample->tstamp);
+	if (events & SMB2_BMC_SMPL_EV_ERR)
+		printf(" read error 0x%x", (unsigned int)sample->err);
+	if (events & SMB2_BMC_SMPL_EV_STALL)
+		printf(" life sign stalled");
+	if (events & SMB2_BMC_SMPL_EV_ALIVE)
+		printf(" life sign ok");
+	if (events & SMB2_BMC_SMPL_EV_FAULT)
+		printf(" fault_cause=0x%x", sample->frame.fault_cause);
+	if (events & SMB2_BMC_SMPL_EV_STATE)
+		printf(" state=0x%x", sample->frame.state);
+	printf("\n");
+}
+
+/****************************************************************************/
+/** Monitor status frames until a key is pressed.
+*
+ *  \param argc    \IN  argument counter
+ *  \param argv    \IN  argument vector
+*/
+static void stat_frm_monitor(int argc, char* argv[])
+{
+	int err;
+	unsigned int period = 50;
+	void *smplHdl;
+	struct bmc_status_sample sample[64];
+	u_int32 count, total = 0;
+
+	if (argc > 3)
+		sscanf(argv[3], "%d", &period);
+
+	err = SMB2BMC_Sampler_Start(period, 256, 0, stat_frm_monitor_cb, NULL,
+								&smplHdl);
+	if (err) {
+		PrintError("***ERROR: SMB2BMC_Sampler_Start:", err);
+		return;
+	}
+
+	printf("Sampling status frames every %d ms - Press any key to abort\n",
+		   period);
+
+	do {
+		UOS_Delay(500);
+		do {
+			count = 64;
+			SMB2BMC_Sampler_Read(smplHdl, sample, &count);
+			total += count;
+		} while (count == 64);
+	} while (UOS_KeyPressed() == -1);
+
+	SMB2BMC_Sampler_Stop(&smplHdl);
+
+	printf("%u samples\n", (unsigned int)total);
+}
+
 /****************************************************************************/
 /** Send CB30C specific command.
 *
@@ -2336,6 +2673,9 @@ static void cb30c_command(int cb30c_cmd, int argc, char* argv[])
 		case STAT_FRM_GET:
 			print_stat_frm();
 			break;
+		case STAT_FRM_MONITOR:
+			stat_frm_monitor(argc, argv);
+			break;
 		default: printf("***ERROR: CB30C Specific command not available\n");
 	}
 }
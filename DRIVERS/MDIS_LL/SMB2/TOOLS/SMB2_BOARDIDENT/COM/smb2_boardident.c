@@ -10,7 +10,9 @@
  *        \brief Tool to dump board informations from SMBus devices via the SMB2_API
  *
  *               - init SMB2_API library (SMB2API_Init)
- *               - read data from SMB device (SMB2API_ReadByteData)
+ *               - read data from SMB device (SMB2API_I2CXfer or
+ *                 SMB2API_ReadByteData), or only the header if a valid
+ *                 cache file exists
  *               - show data from SMB device
  *               - exit SMB2_API library (SMB2API_Exit)
  *
@@ -43,6 +45,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stddef.h>			/* for offsetof() */
 #include <MEN/men_typs.h>
 #include <MEN/mdis_api.h>
 #include <MEN/usr_oss.h>
@@ -63,6 +66,12 @@ static const char IdentString[]=MENT_XSTR(MAK_REVISION);
 #define DEFAULT_ID_PROM_ADDR    0xAE
 #define SMB_FLAGS    0x0
 #define ZZ           0xEE
+#define READ_CHUNK   32			/* bytes per sequential read */
+
+#define CACHE_MAGIC    0x42494331	/* "BIC1" */
+#define CACHE_DEV_LEN  64
+/* header compared against the cache: pd_id (incl. parity), revision, serial */
+#define CACHE_HDR_LEN  offsetof(EEPROD2, pd_model)
 
 /*-------------------------------------+
 |   MAKROS                             |
@@ -82,16 +91,33 @@ static const char IdentString[]=MENT_XSTR(MAK_REVISION);
 # error "Don't define _BIG/_LITTLE_ENDIAN_ together"
 #endif
 
+/*-------------------------------------+
+|   TYPEDEFS                           |
++-------------------------------------*/
+/* cache file content */
+typedef struct {
+	u_int32 magic;					/* CACHE_MAGIC */
+	char    device[CACHE_DEV_LEN];	/* SMB device name */
+	u_int8  smbAddr;				/* address of EEPROM */
+	u_int8  data[sizeof(EEPROD2)];	/* EEPROM content */
+	u_int32 crc;					/* CRC-32 of the fields above */
+} BI_CACHE;
+
 /*-------------------------------------+
 |   GLOBALS                            |
 +-------------------------------------*/
 void    *SMB2EEPROD2_smbHdl;
 EEPROD2 G_eeprd2;
+/* I2C transfers supported: -1=unknown, 0=no, 1=yes */
+static int G_i2cOk = -1;
 
 /*-------------------------------------+
 |   PROTOTYPES                         |
 +-------------------------------------*/
-static int32   SmbIdPromRead( u_int8 );
+static int32   SmbIdPromRead( u_int8, u_int8, u_int8*, u_int32 );
+static int32   CacheLoad( char*, char*, u_int8, u_int8* );
+static void    CacheSave( char*, char*, u_int8, u_int8* );
+static u_int32 CacheCrc( u_int8*, u_int32 );
 static void    SmbIdPromDump( void );
 static int32   CheckParity( void );
 static u_int8  CalcParity( u_int8*, u_int32 );
@@ -120,11 +146,15 @@ static void usage(void)
 		"   devName    SMB device name e.g. smb2_1\n"
 		"   [smbAddr]  SMB address of the board information EEPROM - default: 0xae\n"
 		"   [-r]       dump raw board information EEPROM data \n"
+		"   [-c=str]   cache file: if it matches the EEPROM header, only the\n"
+		"              header is read, otherwise the cache is updated\n"
 		"\nCalling examples:\n"
 		"\n- dump board information EEPROM (with raw data): \n"
 		"    smb2_boardident smb2_1 -r \n"
 		"\n- dump data from specified SMB address: \n"
-		"    smb2_boardident smb2_1 0xac  \n");
+		"    smb2_boardident smb2_1 0xac  \n"
+		"\n- dump board information EEPROM at boot time: \n"
+		"    smb2_boardident smb2_1 -c=/var/cache/boardident \n");
     printf("\nCopyright 2009-2019, MEN Mikro Elektronik GmbH\n%s\n\n", IdentString);
 }
 
@@ -141,15 +171,16 @@ int main(int argc, char *argv[])
 	int     err, ret=0, i=0;
 	char    *errstr=NULL, ebuf[100];
 
-	int     raw;
-	char    *deviceP=NULL, *addrP=NULL;
+	int     raw, cached=0;
+	char    *deviceP=NULL, *addrP=NULL, *cacheP=NULL;
 	u_int32 smbAddr=0x0;
-	u_int8  byte;
+	u_int8  data[sizeof(EEPROD2)];
+	u_int8  hdr[CACHE_HDR_LEN];
 
 	/*--------------------+
 	|  check arguments    |
 	+--------------------*/
-	errstr = UTL_ILLIOPT("?r", ebuf);  /* check args */
+	errstr = UTL_ILLIOPT("?rc=", ebuf);  /* check args */
 	if(errstr) {
 		printf("*** %s\n", errstr);
 		usage();
@@ -191,6 +222,9 @@ int main(int argc, char *argv[])
 	/* show raw data ? */
 	raw = ( UTL_TSTOPT("r") ? 1 : 0 );
 
+	/* cache file */
+	cacheP = UTL_TSTOPT("c=");
+
 	/*--------------------+
 	|  Init SMB2 library  |
 	+--------------------*/
@@ -205,12 +239,25 @@ int main(int argc, char *argv[])
 	header();
 	printf("Accessing %s: smbAddr 0x%2x\n", deviceP, (unsigned int)smbAddr);
 
+	/* cached content still valid? */
+	if( cacheP && (CacheLoad( cacheP, deviceP, (u_int8)smbAddr, data ) == 0) ) {
+		ret = SmbIdPromRead( (u_int8)smbAddr, 0, hdr, sizeof(hdr) );
+		if( ret == 1 ) {
+			printf("***ERROR getting EEPROM access\n");
+			goto CLEANUP;
+		}
+		cached = !memcmp( hdr, data, sizeof(hdr) );
+	}
+
 	/* read content of EEPROM */
-	ret = SmbIdPromRead( (u_int8)smbAddr );
-	if( ret == 1 ) {
-		printf("***ERROR getting EEPROM access\n");
-		goto CLEANUP;
+	if( !cached ) {
+		ret = SmbIdPromRead( (u_int8)smbAddr, 0, data, sizeof(data) );
+		if( ret == 1 ) {
+			printf("***ERROR getting EEPROM access\n");
+			goto CLEANUP;
+		}
 	}
+	memcpy( &G_eeprd2, data, sizeof(EEPROD2) );
 
 	/* check EEPROD2 ID and parity */
 	if( (G_eeprd2.pd_id == 0xFF) || ( ((G_eeprd2.pd_id >> 4) != EEID_PD2) &&
@@ -231,28 +278,27 @@ int main(int argc, char *argv[])
 				ret = 1;
 			}
 			else {
-				printf("\nDUMP EEPROM:\n");
+				printf("\nDUMP EEPROM%s:\n", cached ? " (cached)" : "");
 				ret = 0;
 			}
 		}
 		else {  /* EEID_PD */
-			printf("\nDUMP EEPROM:\n");
+			printf("\nDUMP EEPROM%s:\n", cached ? " (cached)" : "");
 			ret = 0;
 		}
 
+		/* cache only valid content */
+		if( cacheP && !cached && !ret ) {
+			CacheSave( cacheP, deviceP, (u_int8)smbAddr, data );
+		}
+
 		SmbIdPromDump();
 
 		/* display RAW data */
 		if( raw ) {
 			printf("\nRAW EEPROM DATA: \n\n");
 			for( i=0; i<sizeof(EEPROD2); i++ ) {
-				err = SMB2API_ReadByteData( SMB2EEPROD2_smbHdl, SMB_FLAGS, (u_int8)smbAddr, (u_int8)i, &byte );
-				UOS_Delay(10); /* wait 10ms */
-				if( err ) {
-					PrintError( "SMB2API_ReadByteData", err );
-					ret=1;
-				}
-				printf(" %02X", byte );
+				printf(" %02X", data[i] );
 				if( !((i+1)%8) ) {
 					printf("\n");
 				}
@@ -275,33 +321,153 @@ EXIT:
 }
 
 /******************************* SmbIdPromRead ********************************/
-/** Routine to read data from SMB2 ID-EEPROM to the EEPROD2 struct.
+/** Routine to read data from SMB2 ID-EEPROM sequentially
  *
- *  \param smbAddr	\IN address of SMB device
+ *  Sets the offset and reads READ_CHUNK bytes per I2C transfer. Falls
+ *  back to SMBus byte reads if the controller doesn't support I2C
+ *  transfers. Reads don't start a write cycle, so no delays are needed.
+ *
+ *  \param smbAddr	\IN  address of SMB device
+ *  \param offs		\IN  EEPROM offset
+ *  \param buf		\OUT read data
+ *  \param len		\IN  number of bytes
  *
  *  \return			success (0) or error (1)
  */
-static int32 SmbIdPromRead( u_int8 smbAddr )
+static int32 SmbIdPromRead( u_int8 smbAddr, u_int8 offs, u_int8 *buf, u_int32 len )
 {
-	int    err=0;
-	u_int8 i=0;
-	u_int8 *arr;
-	
-	arr = (u_int8*)&G_eeprd2;
+	int32   err=0;
+	u_int32 n, i;
+	SMB_I2CMESSAGE msg[2];
+
+	while( len && G_i2cOk ) {
+		n = (len > READ_CHUNK) ? READ_CHUNK : len;
+
+		msg[0].addr  = smbAddr;
+		msg[0].flags = I2C_M_WR;
+		msg[0].len   = 1;
+		msg[0].buf   = &offs;
+		msg[1].addr  = smbAddr;
+		msg[1].flags = I2C_M_RD;
+		msg[1].len   = (u_int16)n;
+		msg[1].buf   = buf;
+
+		err = SMB2API_I2CXfer( SMB2EEPROD2_smbHdl, msg, 2 );
+		if( err ) {
+			/* first transfer failed: try SMBus byte reads */
+			if( G_i2cOk == -1 ) {
+				G_i2cOk = 0;
+				break;
+			}
+			PrintError( "SMB2API_I2CXfer", err );
+			return 1;
+		}
+		G_i2cOk = 1;
+
+		offs = (u_int8)(offs + n);
+		buf += n;
+		len -= n;
+	}
 
-	for( i=0; i<sizeof(EEPROD2); i++ ) {
-		err = SMB2API_ReadByteData( SMB2EEPROD2_smbHdl, SMB_FLAGS, smbAddr, i, &arr[i] );
-		UOS_Delay(10); /* wait 10ms */
+	for( i=0; i<len; i++ ) {
+		err = SMB2API_ReadByteData( SMB2EEPROD2_smbHdl, SMB_FLAGS, smbAddr,
+									(u_int8)(offs + i), &buf[i] );
 		if( err ) {
 			PrintError( "SMB2API_ReadByteData", err );
 			return 1;
 		}
 	}
-	UOS_Delay(50); /* wait 50ms */
 
 	return 0;
 }
 
+/********************************* CacheLoad **********************************/
+/** Routine to read the EEPROM content from the cache file
+ *
+ *  \param fileName	\IN  cache file name
+ *  \param deviceP	\IN  SMB device name
+ *  \param smbAddr	\IN  address of SMB device
+ *  \param data		\OUT cached EEPROM content (sizeof(EEPROD2))
+ *
+ *  \return			success (0) or error (1) if no valid cache for
+ *					this device exists
+ */
+static int32 CacheLoad( char *fileName, char *deviceP, u_int8 smbAddr, u_int8 *data )
+{
+	FILE     *fp;
+	BI_CACHE cache;
+	size_t   n;
+
+	fp = fopen( fileName, "rb" );
+	if( fp == NULL )
+		return 1;
+	n = fread( &cache, 1, sizeof(cache), fp );
+	fclose( fp );
+
+	if( (n != sizeof(cache)) || (cache.magic != CACHE_MAGIC) ||
+		(cache.crc != CacheCrc( (u_int8*)&cache, offsetof(BI_CACHE, crc) )) )
+		return 1;
+
+	cache.device[CACHE_DEV_LEN-1] = '\0';
+	if( strcmp( cache.device, deviceP ) || (cache.smbAddr != smbAddr) )
+		return 1;
+
+	memcpy( data, cache.data, sizeof(cache.data) );
+	return 0;
+}
+
+/********************************* CacheSave **********************************/
+/** Routine to write the EEPROM content to the cache file
+ *
+ *  Errors are only reported, the next call reads the EEPROM again.
+ *
+ *  \param fileName	\IN cache file name
+ *  \param deviceP	\IN SMB device name
+ *  \param smbAddr	\IN address of SMB device
+ *  \param data		\IN EEPROM content (sizeof(EEPROD2))
+ */
+static void CacheSave( char *fileName, char *deviceP, u_int8 smbAddr, u_int8 *data )
+{
+	FILE     *fp;
+	BI_CACHE cache;
+
+	/* clear padding, it is part of the CRC */
+	memset( &cache, 0, sizeof(cache) );
+	cache.magic = CACHE_MAGIC;
+	strncpy( cache.device, deviceP, CACHE_DEV_LEN-1 );
+	cache.smbAddr = smbAddr;
+	memcpy( cache.data, data, sizeof(cache.data) );
+	cache.crc = CacheCrc( (u_int8*)&cache, offsetof(BI_CACHE, crc) );
+
+	fp = fopen( fileName, "wb" );
+	if( (fp == NULL) || (fwrite( &cache, 1, sizeof(cache), fp ) != sizeof(cache)) )
+		printf( "*** can't write cache file %s\n", fileName );
+	if( fp )
+		fclose( fp );
+}
+
+/********************************** CacheCrc **********************************/
+/** Routine to compute the CRC-32 (IEEE 802.3) of the cache file content
+ *
+ *  \param ptr	\IN data
+ *  \param len	\IN number of bytes
+ *
+ *  \return		CRC-32
+ */
+static u_int32 CacheCrc( u_int8 *ptr, u_int32 len )
+{
+	u_int32 crc = 0xFFFFFFFF;
+	int     bit;
+
+	while( len-- ) {
+		crc ^= *ptr++;
+		for( bit=0; bit<8; bit++ )
+			crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
+	}
+
+	return ~crc;
+}
+
 /******************************* SmbIdPromDump ********************************/
 /** Routine to print data of the SMB2 ID-EEPROM (EEPROD/EEPROD2)
  */
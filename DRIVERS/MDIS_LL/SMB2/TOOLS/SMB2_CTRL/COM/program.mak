@@ -27,16 +27,21 @@ STAMPED_REVISION="13Y004-06_01_42-24-ge5f4d78-dirty_2019-05-30"
 DEF_REVISION=MAK_REVISION=$(STAMPED_REVISION)
 MAK_SWITCH=$(SW_PREFIX)$(DEF_REVISION)
 
+# scan threads (smb2_os) use POSIX threads
 MAK_LIBS=$(LIB_PREFIX)$(MEN_LIB_DIR)/smb2_api$(LIB_SUFFIX)	\
          $(LIB_PREFIX)$(MEN_LIB_DIR)/mdis_api$(LIB_SUFFIX)	\
          $(LIB_PREFIX)$(MEN_LIB_DIR)/usr_oss$(LIB_SUFFIX)	\
          $(LIB_PREFIX)$(MEN_LIB_DIR)/usr_utl$(LIB_SUFFIX)	\
+         -lpthread											\
 
 MAK_INCL=$(MEN_INC_DIR)/men_typs.h	\
          $(MEN_INC_DIR)/usr_utl.h	\
          $(MEN_INC_DIR)/usr_oss.h	\
          $(MEN_INC_DIR)/smb2_api.h	\
          $(MEN_INC_DIR)/smb2.h	\
+         $(MEN_INC_DIR)/smb2_drv.h	\
+         $(MEN_INC_DIR)/eeprod.h	\
+         $(MEN_INC_DIR)/smb2_os.h	\
          $(MEN_MOD_DIR)/cmd_tbl.h	\
          $(MEN_MOD_DIR)/ident.h		\
          $(MEN_MOD_DIR)/smb2_ctrl.h	\
@@ -44,5 +49,7 @@ MAK_INCL=$(MEN_INC_DIR)/men_typs.h	\
 
 MAK_INP1=smb2_ctrl$(INP_SUFFIX)
 MAK_INP2=smb2api$(INP_SUFFIX)
+MAK_INP3=smb2_scan$(INP_SUFFIX)
+MAK_INP4=smb2_batch$(INP_SUFFIX)
 
-MAK_INP=$(MAK_INP1) $(MAK_INP2)
+MAK_INP=$(MAK_INP1) $(MAK_INP2) $(MAK_INP3) $(MAK_INP4)
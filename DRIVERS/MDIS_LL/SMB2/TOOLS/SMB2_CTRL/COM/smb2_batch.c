@@ -0,0 +1,762 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************/
+/*!
+ *        \file  smb2_batch.c
+ *
+ *      \author  dieter.pfeuffer@men.de
+ *
+ *        \brief Batch interpreter for SMBus command scripts
+ *
+ *               Executes a command file (or stdin) on the open SMB2
+ *               handle of smb2_ctrl. With grouping enabled, consecutive
+ *               SMBus transfers are passed to the driver in transaction
+ *               groups.
+ *
+ *               Script syntax, one command per line, '#' starts a comment.
+ *               Numbers are C style (0x.. for hex), \<val\> is a number
+ *               or a variable ($name):
+ *
+ *               q    \<addr\> [r]                 QuickComm (write/read)
+ *               wb   \<addr\> \<val\>               WriteByte
+ *               rb   \<addr\> [$var]              ReadByte
+ *               wbd  \<addr\> \<cmd\> \<val\>         WriteByteData
+ *               rbd  \<addr\> \<cmd\> [$var]        ReadByteData
+ *               wwd  \<addr\> \<cmd\> \<val\>         WriteWordData
+ *               rwd  \<addr\> \<cmd\> [$var]        ReadWordData
+ *               wbk  \<addr\> \<cmd\> \<val\> ..      WriteBlockData
+ *               rbk  \<addr\> \<cmd\>               ReadBlockData
+ *               i2c  \<addr\> \<rdlen\> [\<val\> ..]   I2C write and/or read
+ *               poll \<addr\> \<cmd\> \<mask\> \<val\> \<ms\>
+ *                                               ReadByteData until
+ *                                               (data & mask) == val
+ *               sleep \<ms\>
+ *               set  $var \<val\> [\<op\> \<val\>]    op: + - & | ^ << >>
+ *               loop \<count\> [$var] .. end       $var counts 0..count-1
+ *               echo \<text|$var\> ..
+ *
+ *     Switches: -
+ */
+/*
+ *---------------------------------------------------------------------------
+ * Copyright 2019, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "smb2_ctrl.h"
+#include <ctype.h>
+#include <MEN/smb2_drv.h>
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+#define BAT_LINE_LEN		256		/* max. line length */
+#define BAT_ARGS_MAX		(SMB_BLOCK_MAX_BYTES + 8)	/* max. words/line */
+#define BAT_VARS_MAX		32		/* max. number of variables */
+#define BAT_VAR_LEN			16		/* max. variable name length */
+#define BAT_LOOP_DEPTH		8		/* max. nested loops */
+#define BAT_GRP_MAX			64		/* max. transfers per group */
+
+/*--------------------------------------+
+|   TYPEDEFS                            |
++--------------------------------------*/
+/* variable */
+typedef struct {
+	char    name[BAT_VAR_LEN];
+	u_int32 val;
+} BAT_VAR;
+
+/* active loop */
+typedef struct {
+	u_int32 line;			/* first line of loop body */
+	u_int32 count;			/* number of iterations */
+	u_int32 iter;			/* current iteration */
+	int     var;			/* counter variable or -1 */
+} BAT_LOOP;
+
+/* queued read transfer (grouped mode) */
+typedef struct {
+	u_int32 line;			/* script line */
+	u_int32 idx;			/* index of the transfer in the group */
+	int     size;			/* 1=byte, 2=word, 0=block */
+	int     var;			/* result variable or -1 */
+	u_int8  byte;
+	u_int16 word;
+	u_int8  len;
+	u_int8  blk[SMB_BLOCK_MAX_BYTES];
+} BAT_PEND;
+
+/* interpreter state */
+typedef struct {
+	char     **line;		/* script lines */
+	u_int32  lineNum;		/* number of lines */
+	u_int32  pc;			/* current line */
+	u_int32  flags;			/* SMB flags */
+	int      timing;		/* print time of each command */
+	BAT_VAR  var[BAT_VARS_MAX];
+	u_int32  varNum;
+	BAT_LOOP loop[BAT_LOOP_DEPTH];
+	u_int32  loopNum;
+	void     *grpHdl;		/* transaction group or NULL */
+	u_int32  grpNum;		/* queued transfers */
+	u_int32  grpLine[BAT_GRP_MAX];	/* script line of queued transfers */
+	BAT_PEND pend[BAT_GRP_MAX];
+	u_int32  pendNum;		/* queued reads */
+	u_int32  cmdCnt;		/* executed commands */
+	u_int32  xferCnt;		/* driver requests */
+} BAT_CTX;
+
+/*-----------------------------------------+
+|  PROTOTYPES                              |
++-----------------------------------------*/
+static int32 BatLoad( BAT_CTX *ctx, char *fileName );
+static int32 BatValue( BAT_CTX *ctx, char *str, u_int32 *valP );
+static int   BatVar( BAT_CTX *ctx, char *name, int create );
+static int   BatSplit( char *line, char *buf, char **argv );
+static int32 BatFlush( BAT_CTX *ctx );
+static int32 BatReplay( BAT_CTX *ctx );
+static int32 BatExec( BAT_CTX *ctx, int argc, char **argv );
+static void  BatPrintRead( BAT_CTX *ctx, BAT_PEND *p );
+
+/**********************************************************************/
+/** Read the script
+ *
+ *  \param ctx		interpreter state
+ *  \param fileName	script file, NULL or "-" for stdin
+ *
+ *  \return 0=ok, or 1 on error
+ */
+static int32 BatLoad( BAT_CTX *ctx, char *fileName )
+{
+	FILE    *fp = stdin;
+	char    buf[BAT_LINE_LEN], **newLine;
+	char    *p, *start;
+	u_int32 max = 0;
+
+	if( fileName && strcmp( fileName, "-" ) ) {
+		if( (fp = fopen( fileName, "r" )) == NULL ) {
+			printf( "*** can't open %s\n", fileName );
+			return 1;
+		}
+	}
+
+	while( fgets( buf, sizeof(buf), fp ) ) {
+		/* strip comment, indentation and line end */
+		if( (p = strchr( buf, '#' )) != NULL )
+			*p = '\0';
+		for( start = buf; isspace((int)*start); start++ )
+			;
+		for( p = start + strlen(start); (p > start) && isspace((int)p[-1]); p-- )
+			;
+		*p = '\0';
+
+		if( ctx->lineNum == max ) {
+			max = max ? max * 2 : 64;
+			newLine = (char**)realloc( ctx->line, max * sizeof(char*) );
+			if( !newLine )
+				goto NO_MEM;
+			ctx->line = newLine;
+		}
+		if( (ctx->line[ctx->lineNum] = (char*)malloc( strlen(start) + 1 )) == NULL )
+			goto NO_MEM;
+		strcpy( ctx->line[ctx->lineNum++], start );
+	}
+
+	if( fp != stdin )
+		fclose( fp );
+	return 0;
+
+NO_MEM:
+	printf( "*** can't alloc script buffer\n" );
+	if( fp != stdin )
+		fclose( fp );
+	return 1;
+}
+
+/**********************************************************************/
+/** Find (or create) a variable
+ *
+ *  \param ctx		interpreter state
+ *  \param name		variable name with '$'
+ *  \param create	create the variable if it doesn't exist
+ *
+ *  \return index of variable or -1
+ */
+static int BatVar( BAT_CTX *ctx, char *name, int create )
+{
+	u_int32 i;
+
+	if( (name[0] != '$') || (strlen(name) >= BAT_VAR_LEN) )
+		return -1;
+
+	for( i=0; i<ctx->varNum; i++ ) {
+		if( !strcmp( ctx->var[i].name, name ) )
+			return (int)i;
+	}
+	if( !create || (ctx->varNum == BAT_VARS_MAX) )
+		return -1;
+
+	strcpy( ctx->var[ctx->varNum].name, name );
+	ctx->var[ctx->varNum].val = 0;
+	return (int)ctx->varNum++;
+}
+
+/**********************************************************************/
+/** Evaluate a number or variable
+ *
+ *  \param ctx		interpreter state
+ *  \param str		number or $var
+ *  \param valP		value
+ *
+ *  \return 0=ok, or 1 on error
+ */
+static int32 BatValue( BAT_CTX *ctx, char *str, u_int32 *valP )
+{
+	char *end;
+	int  v;
+
+	if( str[0] == '$' ) {
+		if( (v = BatVar( ctx, str, 0 )) < 0 ) {
+			printf( "*** line %u: unknown variable %s\n", ctx->pc + 1, str );
+			return 1;
+		}
+		*valP = ctx->var[v].val;
+		return 0;
+	}
+
+	*valP = (u_int32)strtoul( str, &end, 0 );
+	if( (end == str) || *end ) {
+		printf( "*** line %u: invalid number %s\n", ctx->pc + 1, str );
+		return 1;
+	}
+	return 0;
+}
+
+/**********************************************************************/
+/** Split a script line into words
+ *
+ *  \param line		script line
+ *  \param buf		buffer for the words (BAT_LINE_LEN)
+ *  \param argv		words of the line (BAT_ARGS_MAX)
+ *
+ *  \return number of words
+ */
+static int BatSplit( char *line, char *buf, char **argv )
+{
+	char *tok;
+	int  argc = 0;
+
+	strcpy( buf, line );
+	for( tok = strtok( buf, " \t" ); tok && (argc < BAT_ARGS_MAX);
+		 tok = strtok( NULL, " \t" ) )
+		argv[argc++] = tok;
+
+	return argc;
+}
+
+/**********************************************************************/
+/** Print the result of a read transfer
+ *
+ *  \param ctx		interpreter state
+ *  \param p		read transfer
+ */
+static void BatPrintRead( BAT_CTX *ctx, BAT_PEND *p )
+{
+	int i;
+
+	switch( p->size ) {
+	case 1:
+		if( p->var >= 0 )
+			ctx->var[p->var].val = p->byte;
+		printf( "%s = 0x%02x\n", ctx->line[p->line], p->byte );
+		break;
+	case 2:
+		if( p->var >= 0 )
+			ctx->var[p->var].val = p->word;
+		printf( "%s = 0x%04x\n", ctx->line[p->line], p->word );
+		break;
+	default:
+		printf( "%s =", ctx->line[p->line] );
+		for( i=0; i<p->len; i++ )
+			printf( " %02x", p->blk[i] );
+		printf( "\n" );
+	}
+}
+
+/**********************************************************************/
+/** Execute the queued transfers (grouped mode)
+ *
+ *  The group stops at the first failed transfer. The reads executed
+ *  before it are printed, then the line of the failed transfer. If the
+ *  driver doesn't know transaction groups, the queued lines are executed
+ *  again with single transfers (see BatReplay).
+ *
+ *  \param ctx		interpreter state
+ *
+ *  \return 0=ok, or error number
+ */
+static int32 BatFlush( BAT_CTX *ctx )
+{
+	u_int32 i, start;
+	int32   err;
+
+	if( !ctx->grpHdl || !ctx->grpNum )
+		return 0;
+
+	start = UOS_MsecTimerGet();
+	err = SMB2API_XferGroupCommit( ctx->grpHdl );
+	ctx->xferCnt++;
+
+	if( err == ERR_LL_UNK_CODE )
+		return BatReplay( ctx );
+
+	for( i=0; i<ctx->pendNum; i++ ) {
+		if( !SMB2API_XferGroupError( ctx->grpHdl, ctx->pend[i].idx ) )
+			BatPrintRead( ctx, &ctx->pend[i] );
+	}
+
+	if( err ) {
+		/* the failed transfer reports the error of the group */
+		for( i=0; i<ctx->grpNum; i++ ) {
+			if( SMB2API_XferGroupError( ctx->grpHdl, i ) == err ) {
+				printf( "*** line %u: %s\n", ctx->grpLine[i] + 1,
+						ctx->line[ctx->grpLine[i]] );
+				break;
+			}
+		}
+	}
+	else if( ctx->timing ) {
+		printf( "  [group of %u transfer(s): %u ms]\n", ctx->grpNum,
+				UOS_MsecTimerGet() - start );
+	}
+
+	SMB2API_XferGroupReset( ctx->grpHdl );
+	ctx->grpNum = 0;
+	ctx->pendNum = 0;
+
+	return err;
+}
+
+/**********************************************************************/
+/** Execute the queued lines with single transfers
+ *
+ *  Used if the driver rejects the transaction group. The group is
+ *  released, so all following commands use single transfers, too.
+ *  Queued lines don't use variables except their result variable,
+ *  so they can be executed again.
+ *
+ *  \param ctx		interpreter state
+ *
+ *  \return 0=ok, or error number
+ */
+static int32 BatReplay( BAT_CTX *ctx )
+{
+	char    buf[BAT_LINE_LEN], *argv[BAT_ARGS_MAX];
+	u_int32 i, num = ctx->grpNum, pc = ctx->pc;
+	int32   err = 0;
+
+	printf( "*** transaction groups not supported, "
+			"executing single transfers\n" );
+
+	SMB2API_XferGroupEnd( &ctx->grpHdl );
+	ctx->grpNum = 0;
+	ctx->pendNum = 0;
+
+	for( i=0; !err && (i<num); i++ ) {
+		ctx->pc = ctx->grpLine[i];
+		err = BatExec( ctx, BatSplit( ctx->line[ctx->pc], buf, argv ), argv );
+	}
+	ctx->pc = pc;
+
+	return err;
+}
+
+/**********************************************************************/
+/** Execute one command
+ *
+ *  SMBus transfers are queued in grouped mode. Commands that use a
+ *  variable, echo and the non-groupable transfers execute the queued
+ *  transfers first.
+ *
+ *  \param ctx		interpreter state
+ *  \param argc		number of words
+ *  \param argv		words of the line
+ *
+ *  \return 0=ok, -1 on syntax error, -2 on reported error, or error number
+ */
+static int32 BatExec( BAT_CTX *ctx, int argc, char **argv )
+{
+	char     *cmd = argv[0];
+	u_int32  v[BAT_ARGS_MAX];
+	u_int8   wbuf[I2C_BLOCK_MAX_BYTES], rbuf[I2C_BLOCK_MAX_BYTES];
+	u_int32  start;
+	int      i, n, dst = -1, group, rd = 0, qRead = 0;
+	int32    err = 0;
+	BAT_PEND *p, single;
+	BAT_LOOP *l;
+	SMB_I2CMESSAGE msg[2];
+
+	/*--- commands without SMBus access ---*/
+	if( !strcmp( cmd, "end" ) ) {
+		if( !ctx->loopNum ) {
+			printf( "*** line %u: end without loop\n", ctx->pc + 1 );
+			return -1;
+		}
+		l = &ctx->loop[ctx->loopNum - 1];
+		if( ++l->iter < l->count ) {
+			if( l->var >= 0 )
+				ctx->var[l->var].val = l->iter;
+			ctx->pc = l->line - 1;
+		}
+		else {
+			ctx->loopNum--;
+		}
+		return 0;
+	}
+
+	/* variables are up to date only after the queued transfers,
+	   except the result variable of a queued read */
+	n = -1;
+	if( (!strcmp( cmd, "rb" ) && (argc == 3)) ||
+		((!strcmp( cmd, "rbd" ) || !strcmp( cmd, "rwd" )) && (argc == 4)) )
+		n = argc - 1;
+	for( i=1; i<argc; i++ ) {
+		if( (i != n) && (argv[i][0] == '$') ) {
+			if( (err = BatFlush( ctx )) )
+				return err;
+			break;
+		}
+	}
+
+	if( !strcmp( cmd, "loop" ) ) {
+		if( (argc < 2) || (argc > 3) || BatValue( ctx, argv[1], &v[0] ) )
+			return -1;
+		if( ctx->loopNum == BAT_LOOP_DEPTH ) {
+			printf( "*** line %u: loops nested too deep\n", ctx->pc + 1 );
+			return -1;
+		}
+		l = &ctx->loop[ctx->loopNum];
+		l->var = -1;
+		if( (argc == 3) && ((l->var = BatVar( ctx, argv[2], 1 )) < 0) )
+			return -1;
+		if( v[0] == 0 ) {
+			/* skip loop body */
+			for( n=1; n && (++ctx->pc < ctx->lineNum); ) {
+				if( !strncmp( ctx->line[ctx->pc], "loop", 4 ) )
+					n++;
+				else if( !strcmp( ctx->line[ctx->pc], "end" ) )
+					n--;
+			}
+			return 0;
+		}
+		l->line  = ctx->pc + 1;
+		l->count = v[0];
+		l->iter  = 0;
+		if( l->var >= 0 )
+			ctx->var[l->var].val = 0;
+		ctx->loopNum++;
+		return 0;
+	}
+	if( !strcmp( cmd, "set" ) ) {
+		if( ((argc != 3) && (argc != 5)) ||
+			((dst = BatVar( ctx, argv[1], 1 )) < 0) ||
+			BatValue( ctx, argv[2], &v[0] ) ||
+			((argc == 5) && BatValue( ctx, argv[4], &v[1] )) )
+			return -1;
+		if( argc == 5 ) {
+			if( !strcmp( argv[3], "+" ) )       v[0] += v[1];
+			else if( !strcmp( argv[3], "-" ) )  v[0] -= v[1];
+			else if( !strcmp( argv[3], "&" ) )  v[0] &= v[1];
+			else if( !strcmp( argv[3], "|" ) )  v[0] |= v[1];
+			else if( !strcmp( argv[3], "^" ) )  v[0] ^= v[1];
+			else if( !strcmp( argv[3], "<<" ) ) v[0] <<= v[1];
+			else if( !strcmp( argv[3], ">>" ) ) v[0] >>= v[1];
+			else return -1;
+		}
+		ctx->var[dst].val = v[0];
+		return 0;
+	}
+	if( !strcmp( cmd, "echo" ) ) {
+		/* keep the output in script order with the queued reads */
+		if( (err = BatFlush( ctx )) )
+			return err;
+		for( i=1; i<argc; i++ ) {
+			if( argv[i][0] == '$' ) {
+				if( BatValue( ctx, argv[i], &v[0] ) )
+					return -1;
+				printf( "%s0x%x", i > 1 ? " " : "", v[0] );
+			}
+			else {
+				printf( "%s%s", i > 1 ? " " : "", argv[i] );
+			}
+		}
+		printf( "\n" );
+		return 0;
+	}
+
+	/*--- SMBus commands: evaluate arguments ---*/
+	if( argc < 2 )
+		return -1;
+
+	/* destination variable of read commands */
+	if( (!strcmp( cmd, "rb" ) && (argc == 3)) ||
+		((!strcmp( cmd, "rbd" ) || !strcmp( cmd, "rwd" )) && (argc == 4)) ) {
+		if( (dst = BatVar( ctx, argv[argc-1], 1 )) < 0 )
+			return -1;
+		argc--;
+	}
+	if( !strcmp( cmd, "q" ) && (argc == 3) && !strcmp( argv[2], "r" ) ) {
+		qRead = 1;
+		argc--;
+	}
+	for( i=1; i<argc; i++ ) {
+		if( BatValue( ctx, argv[i], &v[i-1] ) )
+			return -1;
+	}
+	n = argc - 1;
+
+	group = (ctx->grpHdl != NULL) && strcmp( cmd, "i2c" ) &&
+		strcmp( cmd, "poll" ) && strcmp( cmd, "sleep" );
+	if( !group && (err = BatFlush( ctx )) )
+		return err;
+	if( group && ((ctx->grpNum == BAT_GRP_MAX) ||
+				  (ctx->pendNum == BAT_GRP_MAX)) ) {
+		if( (err = BatFlush( ctx )) )
+			return err;
+	}
+
+	/* result of read transfers */
+	p = group ? &ctx->pend[ctx->pendNum] : &single;
+	p->line = ctx->pc;
+	p->idx  = ctx->grpNum;
+	p->var  = dst;
+	p->size = 0;
+
+	start = UOS_MsecTimerGet();
+
+	if( !strcmp( cmd, "sleep" ) && (n == 1) ) {
+		UOS_Delay( v[0] );
+	}
+	else if( !strcmp( cmd, "q" ) && (n == 1) ) {
+		err = group ?
+			SMB2API_XferGroupAddQuickComm( ctx->grpHdl, ctx->flags,
+				(u_int16)v[0], qRead ? SMB_READ : SMB_WRITE ) :
+			SMB2API_QuickComm( SMB2CTRL_smbHdl, ctx->flags,
+				(u_int16)v[0], qRead ? SMB_READ : SMB_WRITE );
+	}
+	else if( !strcmp( cmd, "wb" ) && (n == 2) ) {
+		err = group ?
+			SMB2API_XferGroupAddWriteByte( ctx->grpHdl, ctx->flags,
+				(u_int16)v[0], (u_int8)v[1] ) :
+			SMB2API_WriteByte( SMB2CTRL_smbHdl, ctx->flags,
+				(u_int16)v[0], (u_int8)v[1] );
+	}
+	else if( !strcmp( cmd, "rb" ) && (n == 1) ) {
+		p->size = 1;
+		err = group ?
+			SMB2API_XferGroupAddReadByte( ctx->grpHdl, ctx->flags,
+				(u_int16)v[0], &p->byte ) :
+			SMB2API_ReadByte( SMB2CTRL_smbHdl, ctx->flags,
+				(u_int16)v[0], &p->byte );
+	}
+	else if( !strcmp( cmd, "wbd" ) && (n == 3) ) {
+		err = group ?
+			SMB2API_XferGroupAddWriteByteData( ctx->grpHdl, ctx->flags,
+				(u_int16)v[0], (u_int8)v[1], (u_int8)v[2] ) :
+			SMB2API_WriteByteData( SMB2CTRL_smbHdl, ctx->flags,
+				(u_int16)v[0], (u_int8)v[1], (u_int8)v[2] );
+	}
+	else if( !strcmp( cmd, "rbd" ) && (n == 2) ) {
+		p->size = 1;
+		err = group ?
+			SMB2API_XferGroupAddReadByteData( ctx->grpHdl, ctx->flags,
+				(u_int16)v[0], (u_int8)v[1], &p->byte ) :
+			SMB2API_ReadByteData( SMB2CTRL_smbHdl, ctx->flags,
+				(u_int16)v[0], (u_int8)v[1], &p->byte );
+	}
+	else if( !strcmp( cmd, "wwd" ) && (n == 3) ) {
+		err = group ?
+			SMB2API_XferGroupAddWriteWordData( ctx->grpHdl, ctx->flags,
+				(u_int16)v[0], (u_int8)v[1], (u_int16)v[2] ) :
+			SMB2API_WriteWordData( SMB2CTRL_smbHdl, ctx->flags,
+				(u_int16)v[0], (u_int8)v[1], (u_int16)v[2] );
+	}
+	else if( !strcmp( cmd, "rwd" ) && (n == 2) ) {
+		p->size = 2;
+		err = group ?
+			SMB2API_XferGroupAddReadWordData( ctx->grpHdl, ctx->flags,
+				(u_int16)v[0], (u_int8)v[1], &p->word ) :
+			SMB2API_ReadWordData( SMB2CTRL_smbHdl, ctx->flags,
+				(u_int16)v[0], (u_int8)v[1], &p->word );
+	}
+	else if( !strcmp( cmd, "wbk" ) && (n >= 3) &&
+			 (n - 2 <= SMB_BLOCK_MAX_BYTES) ) {
+		for( i=2; i<n; i++ )
+			wbuf[i-2] = (u_int8)v[i];
+		err = group ?
+			SMB2API_XferGroupAddWriteBlockData( ctx->grpHdl, ctx->flags,
+				(u_int16)v[0], (u_int8)v[1], (u_int8)(n - 2), wbuf ) :
+			SMB2API_WriteBlockData( SMB2CTRL_smbHdl, ctx->flags,
+				(u_int16)v[0], (u_int8)v[1], (u_int8)(n - 2), wbuf );
+	}
+	else if( !strcmp( cmd, "rbk" ) && (n == 2) ) {
+		p->size = 0;
+		p->len  = SMB_BLOCK_MAX_BYTES;
+		err = group ?
+			SMB2API_XferGroupAddReadBlockData( ctx->grpHdl, ctx->flags,
+				(u_int16)v[0], (u_int8)v[1], &p->len, p->blk ) :
+			SMB2API_ReadBlockData( SMB2CTRL_smbHdl, ctx->flags,
+				(u_int16)v[0], (u_int8)v[1], &p->len, p->blk );
+		rd = 1;
+	}
+	else if( !strcmp( cmd, "i2c" ) && (n >= 2) && (v[1] <= I2C_BLOCK_MAX_BYTES) &&
+			 (n - 2 <= I2C_BLOCK_MAX_BYTES) && (v[1] || (n > 2)) ) {
+		for( i=2; i<n; i++ )
+			wbuf[i-2] = (u_int8)v[i];
+		i = 0;
+		if( n > 2 ) {
+			msg[i].addr  = (u_int16)v[0];
+			msg[i].flags = I2C_M_WR;
+			msg[i].len   = (u_int16)(n - 2);
+			msg[i].buf   = wbuf;
+			i++;
+		}
+		if( v[1] ) {
+			msg[i].addr  = (u_int16)v[0];
+			msg[i].flags = I2C_M_RD;
+			msg[i].len   = (u_int16)v[1];
+			msg[i].buf   = rbuf;
+			i++;
+		}
+		err = SMB2API_I2CXfer( SMB2CTRL_smbHdl, msg, i );
+		if( !err && v[1] ) {
+			printf( "%s =", ctx->line[ctx->pc] );
+			for( i=0; i<(int)v[1]; i++ )
+				printf( " %02x", rbuf[i] );
+			printf( "\n" );
+		}
+	}
+	else if( !strcmp( cmd, "poll" ) && (n == 5) ) {
+		for(;;) {
+			err = SMB2API_ReadByteData( SMB2CTRL_smbHdl, ctx->flags,
+				(u_int16)v[0], (u_int8)v[1], &p->byte );
+			if( err || ((p->byte & v[2]) == v[3]) )
+				break;
+			if( UOS_MsecTimerGet() - start >= v[4] ) {
+				printf( "*** line %u: poll timeout, last value 0x%02x\n",
+						ctx->pc + 1, p->byte );
+				return -2;
+			}
+			UOS_Delay( 1 );
+		}
+	}
+	else {
+		return -1;
+	}
+
+	if( err ) {
+		if( !group )
+			printf( "*** line %u: %s\n", ctx->pc + 1, ctx->line[ctx->pc] );
+		return err;
+	}
+
+	if( group ) {
+		ctx->grpLine[ctx->grpNum++] = ctx->pc;
+		if( p->size || rd )
+			ctx->pendNum++;
+		return 0;
+	}
+
+	if( strcmp( cmd, "sleep" ) )
+		ctx->xferCnt++;
+	if( p->size || rd )
+		BatPrintRead( ctx, p );
+	if( ctx->timing )
+		printf( "  [%s: %u ms]\n", cmd, UOS_MsecTimerGet() - start );
+
+	return 0;
+}
+
+/**********************************************************************/
+/** Execute a command script on the open SMB2 handle
+ *
+ *  \param fileName	script file, NULL or "-" for stdin
+ *  \param flags	SMB flags for all transfers
+ *  \param grouped	pass consecutive SMBus transfers in transaction groups
+ *  \param timing	print the time of each command (resp. group)
+ *
+ *  \return 0=ok, or 1 on error
+ */
+extern int32 SMB2CTRL_Batch( char *fileName, u_int32 flags, int grouped,
+							 int timing )
+{
+	BAT_CTX ctx;
+	char    buf[BAT_LINE_LEN], *argv[BAT_ARGS_MAX];
+	int     argc;
+	int32   err = 0;
+	u_int32 i, start;
+
+	memset( &ctx, 0, sizeof(ctx) );
+	ctx.flags  = flags;
+	ctx.timing = timing;
+
+	if( BatLoad( &ctx, fileName ) ) {
+		err = 1;
+		goto CLEANUP;
+	}
+
+	if( grouped && SMB2API_XferGroupBegin( SMB2CTRL_smbHdl, 0, BAT_GRP_MAX,
+										   &ctx.grpHdl ) ) {
+		printf( "*** transaction groups not supported, "
+				"executing single transfers\n" );
+		ctx.grpHdl = NULL;
+	}
+
+	start = UOS_MsecTimerGet();
+	for( ctx.pc = 0; ctx.pc < ctx.lineNum; ctx.pc++ ) {
+		if( !(argc = BatSplit( ctx.line[ctx.pc], buf, argv )) )
+			continue;
+
+		err = BatExec( &ctx, argc, argv );
+		if( err == -1 ) {
+			printf( "*** line %u: syntax error: %s\n", ctx.pc + 1,
+					ctx.line[ctx.pc] );
+			break;
+		}
+		if( err )
+			break;
+		ctx.cmdCnt++;
+	}
+	if( !err && ctx.loopNum ) {
+		printf( "*** loop without end\n" );
+		err = -1;
+	}
+	if( !err )
+		err = BatFlush( &ctx );
+
+	if( err > 0 )
+		SMB2CTRL_PrintStatus( err );
+
+	printf( "%u command(s), %u driver request(s) in %u ms\n",
+			ctx.cmdCnt, ctx.xferCnt, UOS_MsecTimerGet() - start );
+
+CLEANUP:
+	if( ctx.grpHdl )
+		SMB2API_XferGroupEnd( &ctx.grpHdl );
+	for( i=0; i<ctx.lineNum; i++ )
+		free( ctx.line[i] );
+	free( ctx.line );
+
+	return err ? 1 : 0;
+}
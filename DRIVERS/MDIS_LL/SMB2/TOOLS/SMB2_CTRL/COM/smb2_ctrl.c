@@ -76,6 +76,13 @@ static void usage(void)
 		"    list : List SMB devices that accepts ReadByte commands.   \n"
 		"           A few SMB devices accepts ReadByte commands only   \n"
 		"           after other commands or not at all.                \n"
+		"    batch [<file>] : Execute a command script from file or    \n"
+		"           stdin on one open handle (see smb2_batch.c).       \n"
+		"           Commands: q wb rb wbd rbd wwd rwd wbk rbk i2c poll \n"
+		"           sleep set loop..end echo, $var for variables       \n"
+		"    scan : Scan all addresses and identify known devices. The \n"
+		"           inventory is printed as key=value lines. Further   \n"
+		"           devNames are scanned in parallel.                  \n"
 				"                  wb  : WriteByte       rb  : ReadByte     \n"
 				"                  wbd : WriteByteData   rbd : ReadByteData \n"
 				"                  wwd : WriteWordData   rwd : ReadWordData \n"
@@ -89,12 +96,18 @@ static void usage(void)
 		"    [-d=hex]  : data to write (non-block access - wbd/wwd)    \n"
 		"    [hex ..]  : data to write (block access - wbk)            \n"
 		"    [-n=hex]  : number of bytes for memory dump               \n"
+		"    [-g]      : batch: pass SMBus transfers in groups         \n"
+		"    [-t]      : batch: print time of each command/group       \n"
 		"CLI Mode Options:\n"
 		"    <-f>      : ask for flags                                 \n"
 				"Calling examples:\n"
 		"  _____Command Mode_____                                      \n"
 		"  - write byte:\n"
 				"    smb2_ctrl smb2_1 wbd -a=0xac -o=5 -d=0x12 \n"
+		"  - inventory of two SMB devices:\n"
+		"    smb2_ctrl smb2_1 scan smb2_2\n"
+		"  - run bring-up script with grouped transfers:\n"
+		"    smb2_ctrl smb2_1 batch init.txt -g\n"
 		"  - read 128 bytes:\n"
 		"    smb2_ctrl smb2_1 rbd -a=0xae -n=0x80\n"
 		"  - block write 3 bytes to offset 0x5:\n"
@@ -135,6 +148,9 @@ int main(int argc, char* argv[])
 	u_int8  blkData[SMB_BLOCK_MAX_BYTES]={0};
 	char    *errstr=NULL, ebuf[100];
 	char    *optP=NULL;
+	char    *scanDevs[SCAN_BUS_MAX];
+	u_int32 scanNum=0;
+	char    *batchFile=NULL;
 
 	/* init globals */
 	SMB2CTRL_flag = 0;
@@ -146,7 +162,7 @@ int main(int argc, char* argv[])
 	/*------------------+
 	|  Check arguments  |
 	+------------------*/
-	errstr = UTL_ILLIOPT( "?fra=o=d=n=F=", ebuf );
+	errstr = UTL_ILLIOPT( "?fra=o=d=n=F=gt", ebuf );
 	if( errstr ) {
 		printf( "*** %s\n", errstr );
 		usage();
@@ -176,6 +192,23 @@ int main(int argc, char* argv[])
 		return 0;
 	}
 
+	/*--------------------------+
+	| Scan (opens the devices)  |
+	+--------------------------*/
+	if( G_cmd && !strcmp(G_cmd, "scan") ) {
+		scanDevs[scanNum++] = G_dev;
+		for( i++; i<argc; i++ ) {
+			if( *argv[i] == '-' )
+				continue;
+			if( scanNum < SCAN_BUS_MAX )
+				scanDevs[scanNum++] = argv[i];
+			else
+				printf( "*** scan: max. %d devices, %s ignored\n",
+						SCAN_BUS_MAX, argv[i] );
+		}
+		return SMB2CTRL_Scan( scanDevs, scanNum );
+	}
+
 	/*--------------------+
 	|  init library       |
 	+--------------------*/
@@ -213,7 +246,7 @@ int main(int argc, char* argv[])
 		if( (optP = UTL_TSTOPT("a=")) ) {
 			sscanf( optP, "%x", &smbAddr );
 		}
-		if( ((!smbAddr) && (strncmp(G_cmd, "list", 4))) ) {
+		if( (!smbAddr) && strncmp(G_cmd, "list", 4) && strcmp(G_cmd, "batch") ) {
 			printf( "***ERROR: missing SMB address!\n" );
 			goto CLEANUP;
 		}
@@ -231,6 +264,17 @@ int main(int argc, char* argv[])
 		if( !(strncmp(G_cmd, "list", 4)) ) {
 			SMB2CTRL_List();
 		}
+		/* Batch */
+		else if( !strcmp(G_cmd, "batch") ) {
+			for( i++; i<argc; i++ ) {
+				if( *argv[i] != '-' || !strcmp(argv[i], "-") ) {
+					batchFile = argv[i];
+					break;
+				}
+			}
+			ret = SMB2CTRL_Batch( batchFile, flags, UTL_TSTOPT("g") ? 1 : 0,
+								  UTL_TSTOPT("t") ? 1 : 0 );
+		}
 		/* Write Byte */
 		else if( !(strncmp(G_cmd, "wb", 3)) ) {
 			if( (optP = UTL_TSTOPT("d=")) ) {
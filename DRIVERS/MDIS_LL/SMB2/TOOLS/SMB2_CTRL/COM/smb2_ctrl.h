@@ -49,6 +49,7 @@
 |   DEFINES                             |
 +--------------------------------------*/
 #define DATABUF_SIZE		0x10000		/* 64kB buffer */
+#define SCAN_BUS_MAX		16			/* max. SMB devices per scan */
 
 /*--------------------------------------+
 |   GLOBALS                             |
@@ -88,6 +89,9 @@ extern int32 SMB2CTRL_Ident(void);
 /* Tools */
 extern int32 SMB2CTRL_List(void);
 extern int32 SMB2CTRL_Mtest(void);
+extern int32 SMB2CTRL_Scan(char **devs, u_int32 num);
+extern int32 SMB2CTRL_Batch(char *fileName, u_int32 flags, int grouped,
+							int timing);
 
 #ifdef __cplusplus
    }
@@ -0,0 +1,416 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************/
+/*!
+ *        \file  smb2_scan.c
+ *
+ *      \author  dieter.pfeuffer@men.de
+ *
+ *        \brief SMBus scan and device inventory
+ *
+ *               All 7-bit addresses except the reserved ranges are probed
+ *               with ReadByte transfers in one transaction group, known
+ *               devices are identified with a second group. Several SMB
+ *               devices are scanned in parallel, one thread per device.
+ *               The inventory is printed as one "key=value" line per
+ *               device.
+ *
+ *     Switches: -
+ */
+/*
+ *---------------------------------------------------------------------------
+ * Copyright 2019, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "smb2_ctrl.h"
+#include <stddef.h>
+#include <MEN/smb2_drv.h>
+#include <MEN/eeprod.h>
+#include <MEN/smb2_os.h>
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+/* probed addresses (8-bit format): 7-bit 0x08..0x77, without
+   the reserved ranges 0x00..0x07 and 0x78..0x7f */
+#define SCAN_ADDR_FIRST		0x10
+#define SCAN_ADDR_LAST		0xee
+#define SCAN_ADDR_NUM		((SCAN_ADDR_LAST - SCAN_ADDR_FIRST) / 2 + 1)
+
+/* identification of known devices */
+#define SCAN_ID_NONE		0		/* probe only */
+#define SCAN_ID_FWREV		1		/* firmware revision block read */
+#define SCAN_ID_PROM		2		/* EEPROD2 board information */
+
+#define SCAN_FWREV_CMD		0x80	/* BMC/SHC: get firmware revision */
+#define SCAN_FWREV_LEN		0x07
+
+/*--------------------------------------+
+|   TYPEDEFS                            |
++--------------------------------------*/
+/* known device */
+typedef struct {
+	u_int8  addr;			/* SMB address */
+	char    *type;			/* device type */
+	int     ident;			/* SCAN_ID_xxx */
+} SCAN_KNOWN;
+
+/* found device */
+typedef struct {
+	u_int8  addr;			/* SMB address */
+	int32   err;			/* probe result */
+	u_int8  byte;			/* probe data */
+	const SCAN_KNOWN *known;	/* known device or NULL */
+	int32   identErr;		/* identification result */
+	u_int8  len;			/* SCAN_ID_FWREV: block length */
+	u_int8  data[SMB_BLOCK_MAX_BYTES];	/* identification data
+										   (>= sizeof(EEPROD2)) */
+} SCAN_DEV;
+
+/* scanned SMB device */
+typedef struct {
+	char           *name;		/* SMB device name */
+	int32          err;			/* SMB2API_Init error */
+	u_int32        time;		/* scan time [ms] */
+	u_int32        num;			/* number of found devices */
+	SCAN_DEV       dev[SCAN_ADDR_NUM];
+	SMB2_OS_THREAD thread;		/* scan thread */
+	int            started;		/* thread started */
+} SCAN_BUS;
+
+/*--------------------------------------+
+|   GLOBALS                             |
++--------------------------------------*/
+static const SCAN_KNOWN G_known[] = {
+	{ 0x9c, "bmc",    SCAN_ID_FWREV },	/* board management controller */
+	{ 0xea, "shc",    SCAN_ID_FWREV },	/* shelf controller */
+	{ 0x44, "f601",   SCAN_ID_NONE  },	/* F601 I/O */
+	{ 0xae, "idprom", SCAN_ID_PROM  },	/* board information EEPROM */
+};
+#define SCAN_KNOWN_NUM	(sizeof(G_known)/sizeof(SCAN_KNOWN))
+
+/*-----------------------------------------+
+|  PROTOTYPES                              |
++-----------------------------------------*/
+static void ScanProbe( void *smbHdl, SCAN_BUS *bus );
+static void ScanIdent( void *smbHdl, SCAN_BUS *bus );
+static void ScanBus( SCAN_BUS *bus );
+static void ScanPrint( SCAN_BUS *bus );
+
+/**********************************************************************/
+/** Probe all addresses of an SMB device
+ *
+ *  All ReadByte transfers are passed to the driver with one transaction
+ *  group. If the group can't be set up or executed (e.g. the driver
+ *  doesn't support transaction groups), the addresses are probed one by
+ *  one.
+ *
+ *  \param smbHdl	SMB2API handle
+ *  \param bus		scanned SMB device
+ */
+static void ScanProbe( void *smbHdl, SCAN_BUS *bus )
+{
+	SCAN_DEV dev[SCAN_ADDR_NUM];
+	void     *grpHdl = NULL;
+	u_int32  i;
+	int32    err;
+
+	for( i=0; i<SCAN_ADDR_NUM; i++ )
+		dev[i].addr = (u_int8)(SCAN_ADDR_FIRST + i*2);
+
+	err = SMB2API_XferGroupBegin( smbHdl, SMB2_XFER_GROUP_CONT,
+								  SCAN_ADDR_NUM, &grpHdl );
+	for( i=0; !err && i<SCAN_ADDR_NUM; i++ )
+		err = SMB2API_XferGroupAddReadByte( grpHdl, 0, dev[i].addr,
+											&dev[i].byte );
+	if( !err )
+		err = SMB2API_XferGroupCommit( grpHdl );
+	for( i=0; !err && i<SCAN_ADDR_NUM; i++ )
+		dev[i].err = SMB2API_XferGroupError( grpHdl, i );
+	SMB2API_XferGroupEnd( &grpHdl );
+
+	/* transaction group failed: single transfers */
+	for( i=0; err && i<SCAN_ADDR_NUM; i++ )
+		dev[i].err = SMB2API_ReadByte( smbHdl, 0, dev[i].addr, &dev[i].byte );
+
+	/* keep present devices */
+	bus->num = 0;
+	for( i=0; i<SCAN_ADDR_NUM; i++ ) {
+		if( (dev[i].err == SMB_ERR_ADDR) || (dev[i].err == SMB_ERR_NO_DEVICE) )
+			continue;
+		bus->dev[bus->num] = dev[i];
+		bus->dev[bus->num].known = NULL;
+		bus->dev[bus->num].identErr = 0;
+		bus->dev[bus->num].len = 0;
+		bus->num++;
+	}
+}
+
+/**********************************************************************/
+/** Identify the known devices of an SMB device
+ *
+ *  The identification transfers of all found known devices are passed
+ *  to the driver with one transaction group. If the group can't be set
+ *  up or executed, single transfers are used.
+ *
+ *  \param smbHdl	SMB2API handle
+ *  \param bus		scanned SMB device
+ */
+static void ScanIdent( void *smbHdl, SCAN_BUS *bus )
+{
+	SCAN_DEV *d;
+	void     *grpHdl = NULL;
+	u_int32  i, k, n, idx[SCAN_ADDR_NUM], xfers = 0;
+	int32    err;
+
+	/* find known devices */
+	for( i=0; i<bus->num; i++ ) {
+		d = &bus->dev[i];
+		if( d->err )
+			continue;
+		for( k=0; k<SCAN_KNOWN_NUM; k++ ) {
+			if( G_known[k].addr == d->addr ) {
+				d->known = &G_known[k];
+				if( d->known->ident == SCAN_ID_FWREV )
+					xfers++;
+				else if( d->known->ident == SCAN_ID_PROM ) {
+					xfers += sizeof(EEPROD2);
+					d->len = sizeof(EEPROD2);
+				}
+			}
+		}
+	}
+	if( !xfers )
+		return;
+
+	err = SMB2API_XferGroupBegin( smbHdl, SMB2_XFER_GROUP_CONT, xfers,
+								  &grpHdl );
+
+	for( xfers=0, i=0; !err && i<bus->num; i++ ) {
+		d = &bus->dev[i];
+		idx[i] = xfers;
+		if( !d->known )
+			continue;
+
+		switch( d->known->ident ) {
+		case SCAN_ID_FWREV:
+			err = SMB2API_XferGroupAddReadBlockData( grpHdl, 0, d->addr,
+				SCAN_FWREV_CMD, &d->len, d->data );
+			xfers++;
+			break;
+		case SCAN_ID_PROM:
+			for( n=0; !err && n<sizeof(EEPROD2); n++ )
+				err = SMB2API_XferGroupAddReadByteData( grpHdl, 0, d->addr,
+					(u_int8)n, &d->data[n] );
+			xfers += sizeof(EEPROD2);
+			break;
+		}
+	}
+
+	if( !err )
+		err = SMB2API_XferGroupCommit( grpHdl );
+
+	for( i=0; !err && i<bus->num; i++ ) {
+		d = &bus->dev[i];
+		if( !d->known || (d->known->ident == SCAN_ID_NONE) )
+			continue;
+		n = (d->known->ident == SCAN_ID_PROM) ? sizeof(EEPROD2) : 1;
+		for( k=0; (k<n) && !d->identErr; k++ )
+			d->identErr = SMB2API_XferGroupError( grpHdl, idx[i] + k );
+	}
+	SMB2API_XferGroupEnd( &grpHdl );
+
+	/* transaction group failed: single transfers */
+	for( i=0; err && i<bus->num; i++ ) {
+		d = &bus->dev[i];
+		if( !d->known )
+			continue;
+
+		switch( d->known->ident ) {
+		case SCAN_ID_FWREV:
+			d->identErr = SMB2API_ReadBlockData( smbHdl, 0, d->addr,
+				SCAN_FWREV_CMD, &d->len, d->data );
+			break;
+		case SCAN_ID_PROM:
+			for( n=0; !d->identErr && n<sizeof(EEPROD2); n++ )
+				d->identErr = SMB2API_ReadByteData( smbHdl, 0, d->addr,
+					(u_int8)n, &d->data[n] );
+			break;
+		}
+	}
+}
+
+/**********************************************************************/
+/** Scan one SMB device (thread function)
+ *
+ *  \param bus		scanned SMB device
+ */
+static void ScanBus( SCAN_BUS *bus )
+{
+	void    *smbHdl = NULL;
+	u_int32 start = UOS_MsecTimerGet();
+
+	bus->err = SMB2API_Init( bus->name, &smbHdl );
+	if( bus->err )
+		return;
+
+	ScanProbe( smbHdl, bus );
+	ScanIdent( smbHdl, bus );
+
+	SMB2API_Exit( &smbHdl );
+	bus->time = UOS_MsecTimerGet() - start;
+}
+
+/**********************************************************************/
+/** Thread entry of a scan
+ *
+ *  \param arg		scanned SMB device
+ */
+static void ScanThread( void *arg )
+{
+	ScanBus( (SCAN_BUS*)arg );
+}
+
+/**********************************************************************/
+/** Print the inventory of one SMB device
+ *
+ *  \param bus		scanned SMB device
+ */
+static void ScanPrint( SCAN_BUS *bus )
+{
+	char     errMsg[512];
+	SCAN_DEV *d;
+	EEPROD2  *ee;
+	u_int8   par, *serP;
+	u_int32  i, n;
+
+	if( bus->err ) {
+		printf( "bus=%s status=error error=\"%s\"\n", bus->name,
+				SMB2API_Errstring( bus->err, errMsg ) );
+		return;
+	}
+
+	for( i=0; i<bus->num; i++ ) {
+		d = &bus->dev[i];
+		printf( "bus=%s addr=0x%02x", bus->name, d->addr );
+
+		if( d->err == SMB_ERR_ADDR_EXCLUDED ) {
+			printf( " status=excluded\n" );
+			continue;
+		}
+		if( d->err ) {
+			printf( " status=error error=\"%s\"\n",
+					SMB2API_Errstring( d->err, errMsg ) );
+			continue;
+		}
+		printf( " status=ok data=0x%02x", d->byte );
+
+		if( !d->known ) {
+			printf( " type=unknown\n" );
+			continue;
+		}
+		printf( " type=%s", d->known->type );
+
+		if( d->identErr ) {
+			printf( " ident=error\n" );
+			continue;
+		}
+
+		switch( d->known->ident ) {
+		case SCAN_ID_FWREV:
+			if( (d->len == SCAN_FWREV_LEN) && !d->data[0] )
+				printf( " fw=%d.%d.%d.%d", d->data[1], d->data[2],
+						d->data[3], (d->data[4] << 8) | d->data[5] );
+			else
+				printf( " ident=invalid" );
+			break;
+		case SCAN_ID_PROM:
+			ee = (EEPROD2*)d->data;
+			for( par=0xf, n=1; n<sizeof(EEPROD2); n++ )
+				par ^= (d->data[n] >> 4) ^ (d->data[n] & 0xf);
+			if( ((ee->pd_id >> 4) != EEID_PD2) || ((ee->pd_id & 0xf) != par) ) {
+				printf( " ident=invalid" );
+				break;
+			}
+			/* serial number is big endian */
+			serP = &d->data[offsetof(EEPROD2, pd_serial)];
+			ee->pd_hwName[sizeof(ee->pd_hwName)-1] = '\0';
+			printf( " board=%s%02u serial=%u rev=%02u.%02u.%02u",
+					ee->pd_hwName, ee->pd_model,
+					(u_int32)serP[0] << 24 | (u_int32)serP[1] << 16 |
+					(u_int32)serP[2] << 8 | serP[3],
+					ee->pd_revision[0], ee->pd_revision[1],
+					ee->pd_revision[2] );
+			break;
+		}
+		printf( "\n" );
+	}
+
+	printf( "bus=%s status=done devices=%u time_ms=%u\n",
+			bus->name, bus->num, bus->time );
+}
+
+/**********************************************************************/
+/** Scan SMB devices and print the inventory
+ *
+ *  Each SMB device is scanned by its own thread. The output is printed
+ *  after all scans are finished, so lines of different devices are
+ *  not mixed.
+ *
+ *  \param devs		SMB device names
+ *  \param num		number of SMB devices
+ *
+ *  \return 0=ok, or 1 if a device couldn't be scanned
+ */
+extern int32 SMB2CTRL_Scan( char **devs, u_int32 num )
+{
+	SCAN_BUS *bus;
+	u_int32  i, start;
+	int32    ret = 0;
+
+	if( num > SCAN_BUS_MAX )
+		num = SCAN_BUS_MAX;
+
+	bus = (SCAN_BUS*)calloc( num, sizeof(SCAN_BUS) );
+	if( !bus ) {
+		printf( "*** can't alloc scan buffer\n" );
+		return 1;
+	}
+
+	start = UOS_MsecTimerGet();
+	for( i=0; i<num; i++ ) {
+		bus[i].name = devs[i];
+		bus[i].started = !SMB2_OsThreadCreate( &bus[i].thread, ScanThread,
+											   &bus[i], 0 );
+		/* no thread: scan this device sequentially */
+		if( !bus[i].started )
+			ScanBus( &bus[i] );
+	}
+	for( i=0; i<num; i++ ) {
+		if( !bus[i].started )
+			continue;
+		SMB2_OsThreadJoin( &bus[i].thread );
+	}
+
+	for( i=0; i<num; i++ ) {
+		ScanPrint( &bus[i] );
+		if( bus[i].err )
+			ret = 1;
+	}
+	printf( "total buses=%u time_ms=%u\n", num, UOS_MsecTimerGet() - start );
+
+	free( bus );
+	return ret;
+}
@@ -27,10 +27,12 @@ STAMPED_REVISION="13Y004-06_01_42-24-ge5f4d78-dirty_2019-05-30"
 DEF_REVISION=MAK_REVISION=$(STAMPED_REVISION)
 MAK_SWITCH=$(SW_PREFIX)$(DEF_REVISION)
 
+# batch mode threads (smb2_os) use POSIX threads
 MAK_LIBS=$(LIB_PREFIX)$(MEN_LIB_DIR)/smb2_api$(LIB_SUFFIX)	\
 		 $(LIB_PREFIX)$(MEN_LIB_DIR)/usr_oss$(LIB_SUFFIX)	\
 		 $(LIB_PREFIX)$(MEN_LIB_DIR)/usr_utl$(LIB_SUFFIX)   \
 		 $(LIB_PREFIX)$(MEN_LIB_DIR)/mdis_api$(LIB_SUFFIX)	\
+		 -lpthread											\
 
 MAK_INCL=$(MEN_INC_DIR)/men_typs.h \
          $(MEN_INC_DIR)/usr_utl.h  \
@@ -38,6 +40,7 @@ MAK_INCL=$(MEN_INC_DIR)/men_typs.h \
          $(MEN_INC_DIR)/usr_oss.h  \
          $(MEN_INC_DIR)/smb2_api.h \
          $(MEN_INC_DIR)/eeprod.h   \
+         $(MEN_INC_DIR)/smb2_os.h  \
 
 MAK_INP1=smb2_eeprod2$(INP_SUFFIX)
 
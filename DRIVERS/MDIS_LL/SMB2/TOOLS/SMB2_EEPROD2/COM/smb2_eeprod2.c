@@ -46,6 +46,7 @@
 #include <MEN/usr_utl.h>
 #include <MEN/smb2_api.h>
 #include <MEN/eeprod.h>		/* for EEPROD2 struct/constants */
+#include <MEN/smb2_os.h>
 
 static const char IdentString[]=MENT_XSTR(MAK_REVISION);
 
@@ -66,6 +67,15 @@ static const char IdentString[]=MENT_XSTR(MAK_REVISION);
 #define ZZ						0xEE
 #define LINE_BUF				80
 
+#define EE_SIZE_MAX				256		/* max. EEPROM size (8-bit offset) */
+#define EE_PAGE_SIZE			8		/* default page size (24C02) */
+#define EE_PAGE_MAX				64		/* max. page size */
+#define EE_READ_CHUNK			32		/* bytes per sequential read */
+#define EE_WRITE_TIMEOUT		50		/* max. write cycle time [ms] */
+
+#define BATCH_TARGET_MAX		256		/* max. targets in a batch manifest */
+#define BATCH_BUS_MAX			16		/* max. SMB devices in a batch */
+
 /*--------------------------------------+
 |   MAKROS                              |
 +--------------------------------------*/
@@ -87,7 +97,49 @@ static const char IdentString[]=MENT_XSTR(MAK_REVISION);
 /*--------------------------------------+
 |   TYPEDEFS                            |
 +--------------------------------------*/
-/* none */
+/* SMB bus used for EEPROM access */
+typedef struct {
+	void    *smbHdl;	/* SMB2API handle */
+	int     i2cOk;		/* I2C transfers supported: -1=unknown, 0=no, 1=yes */
+	int     quiet;		/* no progress output */
+} EE_BUS;
+
+/* batch target: one EEPROM */
+typedef struct {
+	char    device[LINE_BUF];	/* SMB device name */
+	u_int8  smbAddr;			/* address of EEPROM */
+	u_int32 serial;				/* serial number (ID EEPROM) */
+	char    board[LINE_BUF];	/* board name or binary file name */
+	u_int8  data[EE_SIZE_MAX];	/* file data */
+	u_int32 size;				/* size of file data, 0 = ID EEPROM */
+	u_int32 worker;				/* index of worker */
+	int32   result;				/* success (0) or error (1) */
+	u_int32 time;				/* programming time [ms] */
+	u_int32 written;			/* number of written bytes */
+} BATCH_TARGET;
+
+/* batch worker: one SMB device */
+typedef struct {
+	char           *device;		/* SMB device name */
+	EE_BUS         bus;			/* SMB bus */
+	SMB2_OS_THREAD thread;		/* worker thread */
+	int            started;		/* thread started */
+} BATCH_WORKER;
+
+/* batch job */
+typedef struct {
+	int          revision;		/* set revision */
+	u_int8       rev[3];		/* revision */
+	u_int8       model;			/* model number */
+	int          proddate;		/* set production date */
+	u_int16      prodat;		/* production date (EEPROD2 format) */
+	int          repdate;		/* set repair date */
+	u_int16      repdat;		/* repair date (EEPROD2 format) */
+	u_int32      targetNum;		/* number of targets */
+	BATCH_TARGET target[BATCH_TARGET_MAX];
+	u_int32      workerNum;		/* number of workers */
+	BATCH_WORKER worker[BATCH_BUS_MAX];
+} BATCH;
 
 /*--------------------------------------+
 |   GLOBALS                             |
@@ -95,6 +147,13 @@ static const char IdentString[]=MENT_XSTR(MAK_REVISION);
 void    *SMB2EEPROD2_smbHdl;
 EEPROD2 G_eeprd2;
 
+/* EEPROM page size for page writes */
+static u_int32 G_pageSize = EE_PAGE_SIZE;
+/* bus of the single device mode */
+static EE_BUS  G_bus = { NULL, -1, 0 };
+/* batch mode job */
+static BATCH   G_batch;
+
 /*--------------------------------------+
 |   PROTOTYPES                          |
 +--------------------------------------*/
@@ -104,6 +163,14 @@ static int32   SmbIdPromWrite( u_int8 );
 static void    SmbIdPromDump( void );
 static int32   SmbSPDWriteProtect( u_int8 );
 static int32   SmbProgramFile( u_int8, char* );
+static int32   EeRead( EE_BUS*, u_int8, u_int32, u_int8*, u_int32 );
+static int32   EeWrite( EE_BUS*, u_int8, u_int32, u_int8*, u_int32 );
+static int32   EeAckPoll( EE_BUS*, u_int8 );
+static int32   EeProgram( EE_BUS*, u_int8, u_int32, u_int8*, u_int32, u_int32* );
+static int32   BatchLoad( char*, u_int32 );
+static int32   BatchIdProm( EE_BUS*, BATCH_TARGET* );
+static void    BatchWorker( BATCH_WORKER* );
+static int32   BatchRun( char*, u_int32 );
 static u_int16 GetDateFormat( u_int16, u_int8, u_int8 );
 static void    GetSystemDate( u_int16*, u_int8*, u_int8* );
 static int32   CheckParity( void );
@@ -118,6 +185,7 @@ static void usage( void )
 {
 	printf(
 		"\nUsage:     smb2_eeprod2  devName  [board]  [<opts>] \n"
+		"           smb2_eeprod2  -b=manifest  [<opts>] \n"
 		"\nFunction:  - write/read data to/from board information EEPROMs"
 		"\n           - program SMB devices from file (e.g. SPD EEPROMs)"
 		"\n           - lock (write protect) SPD EEPROMs"
@@ -137,6 +205,13 @@ static void usage( void )
 		"   [-l]      last repair date (current system date)\n"
 		"   [-f=str]  program file data into SMB devices e.g. SPD EEPROMs\n"
 		"             - file must be binary formatted\n"
+		"   [-w=dec]  EEPROM page size for writes - default: 8\n"
+		"             (1 = byte writes)\n"
+		"   [-b=str]  batch mode: program all targets of the manifest file,\n"
+		"             one thread per SMB device. One target per line:\n"
+		"               <devName> <hex address> <serial|+> <board|@binfile>\n"
+		"             '+' = next serial number, starting at -n\n"
+		"             -r, -m, -p, -l and -w apply to all targets\n"
 		"\nCalling examples:\n"
 		"\n- dump board information EEPROM: \n"
 		"    smb2_eeprod2 smb2_1 -d \n"
@@ -150,6 +225,8 @@ static void usage( void )
 		"    smb2_eeprod2 smb2_1 -f=08SC25-00IC200_300.bin -a=0xa0 \n"
 		"\n- write-protect SPD EEPROM: \n"
 		"    smb2_eeprod2 smb2_1 -a=0x60 -s \n"
+		"\n- program all EEPROMs of a manifest, serial numbers from 1200:\n"
+		"    smb2_eeprod2 -b=lot42.txt -n=1200 -r=01.00.00 \n"
 	);
     printf("\nCopyright 2009-2019, MEN Mikro Elektronik GmbH\n%s\n\n", IdentString);
 }
@@ -176,12 +253,13 @@ int main(int argc, char *argv[])
 	u_int32 rev[3]={0};
 	u_int8  byte, par=0;
 	u_int8  *arr;
-	char    *boardnameP=NULL, *deviceP=NULL, *filenameP=NULL;
+	u_int8  raw[sizeof(EEPROD2)];
+	char    *boardnameP=NULL, *deviceP=NULL, *filenameP=NULL, *batchP=NULL;
 
 	/*------------------+
 	|  Check arguments  |
 	+------------------*/
-	errstr = UTL_ILLIOPT( "?desn=a=r=m=p=lf=", ebuf );
+	errstr = UTL_ILLIOPT( "?desn=a=r=m=p=lf=w=b=", ebuf );
 	if( errstr ) {
 		printf( "*** %s\n", errstr );
 		usage();
@@ -208,7 +286,10 @@ int main(int argc, char *argv[])
 		}
 	}
 
-	if( !deviceP ) {
+	/* batch manifest */
+	batchP = UTL_TSTOPT("b=");
+
+	if( !deviceP && !batchP ) {
 		usage();
 		return 0;
 	}
@@ -247,6 +328,17 @@ int main(int argc, char *argv[])
 	/* file name */
 	filenameP = UTL_TSTOPT("f=");
 
+	/* EEPROM page size */
+	optp = UTL_TSTOPT("w=");
+	if( optp ) {
+		sscanf( optp, "%d", &G_pageSize );
+		if( (G_pageSize == 0) || (G_pageSize > EE_PAGE_MAX) ) {
+			printf( "\n***ERROR: page size %s (1..%d)\n", optp, EE_PAGE_MAX );
+			ret=1;
+			goto EXIT;
+		}
+	}
+
 	/* revision of board */
 	optp = UTL_TSTOPT("r=");
 	if( optp ) {
@@ -287,6 +379,37 @@ int main(int argc, char *argv[])
 		goto EXIT;
 	}
 
+	/*--------------+
+	|  Batch mode   |
+	+--------------*/
+	if( batchP ) {
+		if( (rev[0] > 0xFF) || (rev[1] > 0xFF) || (rev[2] > 0xFF) ) {
+			printf( "\n***ERROR: revision number %u.%u.%u wrong!\n",
+											rev[0], rev[1], rev[2] );
+			ret=1;
+			goto EXIT;
+		}
+		G_batch.revision = revision;
+		G_batch.rev[0]   = (u_int8)rev[0];
+		G_batch.rev[1]   = (u_int8)rev[1];
+		G_batch.rev[2]   = (u_int8)rev[2];
+		G_batch.model    = (u_int8)modelno;
+		G_batch.proddate = proddate;
+		G_batch.prodat   = GetDateFormat( (u_int16)prodYYYY, (u_int8)prodMM,
+										  (u_int8)prodDD );
+		G_batch.repdate  = repdate;
+		if( repdate )
+			G_batch.repdat = GetDateFormat( (u_int16)repYYYY, (u_int8)repMM,
+											(u_int8)repDD );
+		if( (G_batch.prodat == 1) || (repdate && (G_batch.repdat == 1)) ) {
+			ret=1;
+			goto EXIT;
+		}
+
+		ret = BatchRun( batchP, serial );
+		goto EXIT;
+	}
+
 	/*--------------------+
 	|  Init SMB2 library  |
 	+--------------------*/
@@ -296,6 +419,7 @@ int main(int argc, char *argv[])
 		ret=1;
 		goto EXIT;
 	}
+	G_bus.smbHdl = SMB2EEPROD2_smbHdl;
 	
 	/* some output at the beginning */
 	printf( "\nSMB device %s at address 0x%02x\n", deviceP, smbAddr );
@@ -376,14 +500,12 @@ int main(int argc, char *argv[])
 		SmbIdPromDump();
 		/* display RAW data */
 		printf("\nRAW EEPROM DATA: \n\n");
+		if( EeRead( &G_bus, (u_int8)smbAddr, 0, raw, sizeof(EEPROD2) ) ) {
+			ret=1;
+			goto CLEANUP;
+		}
 		for( i=0; i<sizeof(EEPROD2); i++ ) {
-			err = SMB2API_ReadByteData( SMB2EEPROD2_smbHdl, SMB_FLAGS, (u_int8)smbAddr, (u_int8)i, &byte );
-			UOS_Delay(10); /* wait 10ms */
-			if( err ) {
-				PrintError( "SMB2API_ReadByteData", err );
-				ret=1;
-			}
-			printf(" %02X", byte );
+			printf(" %02X", raw[i] );
 			if( !((i+1)%8) ) {
 				printf("\n");
 			}
@@ -612,27 +734,13 @@ static int32 GetSerial( u_int32 *serial )
  */
 static int32 SmbIdPromRead( u_int8 smbAddr )
 {
-	int    err=0;
-	u_int8 i=0;
-	u_int8 *arr;
-	
-	arr = (u_int8*)&G_eeprd2;
-
-	for( i=0; i<sizeof(EEPROD2); i++ ) {
-		err = SMB2API_ReadByteData( SMB2EEPROD2_smbHdl, SMB_FLAGS, smbAddr, i, &arr[i] );
-		UOS_Delay(10); /* wait 10ms */
-		if( err ) {
-			PrintError( "SMB2API_ReadByteData", err );
-			return 1;
-		}
-	}
-	UOS_Delay(50); /* wait 50ms */
-
-	return 0;
+	return EeRead( &G_bus, smbAddr, 0, (u_int8*)&G_eeprd2, sizeof(EEPROD2) );
 }
 
 /******************************* SmbIdPromWrite *******************************/
 /** Routine to write data from EEPROD2 struct to a SMB ID-EEPROM.
+ *
+ *  Only bytes that differ from the EEPROM content are written.
  *
  *  \param smbAddr	\IN address of SMB device
  *
@@ -640,27 +748,13 @@ static int32 SmbIdPromRead( u_int8 smbAddr )
  */
 static int32 SmbIdPromWrite( u_int8 smbAddr )
 {
-	int err, ret=0;
-	u_int8 i=0;
-	u_int8 *arr;
+	int32   ret;
+	u_int32 written=0;
 
-	arr = (u_int8*)&G_eeprd2;
+	ret = EeProgram( &G_bus, smbAddr, 0, (u_int8*)&G_eeprd2, sizeof(EEPROD2),
+					 &written );
 
-	for( i=0; i<sizeof(EEPROD2); i++ ) {
-		err = SMB2API_WriteByteData( SMB2EEPROD2_smbHdl, SMB_FLAGS, smbAddr, i, arr[i] );
-		UOS_Delay(20); /* wait 20ms */
-		if( err ) {
-			PrintError( "SMB2API_WriteByteData", err );
-			ret = 1;
-		}
-		else {
-			printf( "." );
-		}
-		UOS_Delay(20); /* wait 20ms */
-	}
-	UOS_Delay(50); /* wait 50ms */
-
-	printf( "\n" );
+	printf( "\n%d byte(s) changed\n", written );
 
 	return ret;
 }
@@ -796,6 +890,9 @@ static int32 SmbSPDWriteProtect( u_int8 smbAddr )
 
 /******************************* SmbProgramFile ******************************/
 /** Routine to program SMB devices e.g. SPD EEPROMs from binary file 
+ *
+ *  Only bytes that differ from the device content are written, with
+ *  page writes if possible. All bytes are verified afterwards.
  *
  *  \param smbAddr		\IN address of SMB device
  *  \param filenameP	\IN name of binary file
@@ -807,6 +904,7 @@ static int32 SmbProgramFile( u_int8 smbAddr, char *filenameP )
 	int    err=0, ret=0;
 	char   input=0;
 	int    filesize, offs;
+	u_int32 written=0;
 	FILE   *fileP = NULL;
 	u_int8 *buf=NULL;
 
@@ -825,43 +923,37 @@ static int32 SmbProgramFile( u_int8 smbAddr, char *filenameP )
 			fseek( fileP, 0, SEEK_END );
 			filesize = ftell( fileP );
 			fseek( fileP, 0, SEEK_SET );
-			
+
+			if( (filesize <= 0) || (filesize > EE_SIZE_MAX) ) {
+				printf( "*** file size %d not supported (1..%d)\n",
+						filesize, EE_SIZE_MAX );
+				ret = 1;
+				goto CLEANUP;
+			}
+
 			buf = malloc(filesize*sizeof(char));
 			if( buf == NULL ) {
 				PrintError( "malloc", err );
-				return 1;
+				ret = 1;
+				goto CLEANUP;
 			}
 			if( fread( buf, 1, filesize, fileP ) != (size_t)filesize ){
 				PrintError( "fread", err );
-				return 1;
-			}
-			
-			for( offs=0; offs<=(filesize-1); offs++ ) {
-				err = SMB2API_WriteByteData( SMB2EEPROD2_smbHdl, SMB_FLAGS,
-										smbAddr, (u_int8)offs, buf[offs] );
-				if( err ) {
-					PrintError( "SMB2API_WriteByteData", err );
-					ret = 1;
-				}
-				else {
-					printf( "." );
-				}
-				UOS_Delay(20); /* wait 20ms */
+				ret = 1;
+				goto CLEANUP;
 			}
-			printf( "\n" );
+
+			ret = EeProgram( &G_bus, smbAddr, 0, buf, filesize, &written );
+			printf( "%d of %d byte(s) changed\n", written, filesize );
+			if( ret )
+				goto CLEANUP;
+
+			/* show verified content */
 			for( offs=0; offs<=(filesize-1); offs++ ) {
-				err = SMB2API_ReadByteData( SMB2EEPROD2_smbHdl, SMB_FLAGS,
-										smbAddr, (u_int8)offs, &buf[offs] );
-				if( err ) {
-					PrintError( "SMB2API_ReadByteData", err );
-					ret = 1;
+				printf(" %02X", buf[offs] );
+				if( !((offs+1)%16) ) {
+					printf("\n");
 				}
-				else {
-					printf(" %02X", buf[offs] );
-					if( !((offs+1)%16) ) {
-						printf("\n");
-					}
-				} 
 			} /* for */
 		} /* if */
 		else{
@@ -872,6 +964,7 @@ static int32 SmbProgramFile( u_int8 smbAddr, char *filenameP )
 		ret=1;
 	}
 
+CLEANUP:
 	/* close file handle */
 	if( fileP ) {
 		fclose(fileP);
@@ -884,6 +977,536 @@ static int32 SmbProgramFile( u_int8 smbAddr, char *filenameP )
 	return ret;
 }
 
+/*********************************** EeRead ***********************************/
+/** Routine to read EEPROM data sequentially
+ *
+ *  Sets the offset and reads EE_READ_CHUNK bytes per I2C transfer. Falls
+ *  back to SMBus byte reads if the controller doesn't support I2C
+ *  transfers.
+ *
+ *  \param bus		\IN  SMB bus
+ *  \param smbAddr	\IN  address of SMB device
+ *  \param offs		\IN  EEPROM offset
+ *  \param buf		\OUT read data
+ *  \param len		\IN  number of bytes
+ *
+ *  \return			success (0) or error (1)
+ */
+static int32 EeRead( EE_BUS *bus, u_int8 smbAddr, u_int32 offs, u_int8 *buf, u_int32 len )
+{
+	int32   err=0;
+	u_int32 n, i;
+	u_int8  offsByte;
+	SMB_I2CMESSAGE msg[2];
+
+	while( len && bus->i2cOk ) {
+		n = (len > EE_READ_CHUNK) ? EE_READ_CHUNK : len;
+
+		offsByte = (u_int8)offs;
+		msg[0].addr  = smbAddr;
+		msg[0].flags = I2C_M_WR;
+		msg[0].len   = 1;
+		msg[0].buf   = &offsByte;
+		msg[1].addr  = smbAddr;
+		msg[1].flags = I2C_M_RD;
+		msg[1].len   = (u_int16)n;
+		msg[1].buf   = buf;
+
+		err = SMB2API_I2CXfer( bus->smbHdl, msg, 2 );
+		if( err ) {
+			/* first transfer failed: try SMBus byte reads */
+			if( bus->i2cOk == -1 ) {
+				bus->i2cOk = 0;
+				break;
+			}
+			PrintError( "SMB2API_I2CXfer", err );
+			return 1;
+		}
+		bus->i2cOk = 1;
+
+		offs += n;
+		buf  += n;
+		len  -= n;
+	}
+
+	for( i=0; i<len; i++ ) {
+		err = SMB2API_ReadByteData( bus->smbHdl, SMB_FLAGS, smbAddr,
+									(u_int8)(offs + i), &buf[i] );
+		if( err ) {
+			PrintError( "SMB2API_ReadByteData", err );
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/********************************** EeAckPoll *********************************/
+/** Routine to wait for the end of an EEPROM write cycle
+ *
+ *  The EEPROM doesn't acknowledge its address until the write cycle is
+ *  complete.
+ *
+ *  \param bus		\IN SMB bus
+ *  \param smbAddr	\IN address of SMB device
+ *
+ *  \return			success (0) or error (1)
+ */
+static int32 EeAckPoll( EE_BUS *bus, u_int8 smbAddr )
+{
+	int32   err;
+	u_int8  dummy;
+	u_int32 start = UOS_MsecTimerGet();
+
+	for(;;) {
+		err = SMB2API_ReadByte( bus->smbHdl, SMB_FLAGS, smbAddr, &dummy );
+		if( !err )
+			return 0;
+
+		if( UOS_MsecTimerGet() - start > EE_WRITE_TIMEOUT ) {
+			PrintError( "finish EEPROM write cycle", err );
+			return 1;
+		}
+		UOS_Delay(1);
+	}
+}
+
+/*********************************** EeWrite **********************************/
+/** Routine to write EEPROM data
+ *
+ *  The data is split at page boundaries and every page is written with
+ *  one I2C transfer, followed by ACK polling. Falls back to SMBus byte
+ *  writes if the page size is 1 or the controller doesn't support I2C
+ *  transfers.
+ *
+ *  \param bus		\IN SMB bus
+ *  \param smbAddr	\IN address of SMB device
+ *  \param offs		\IN EEPROM offset
+ *  \param buf		\IN data
+ *  \param len		\IN number of bytes
+ *
+ *  \return			success (0) or error (1)
+ */
+static int32 EeWrite( EE_BUS *bus, u_int8 smbAddr, u_int32 offs, u_int8 *buf, u_int32 len )
+{
+	int32   err=0;
+	u_int32 n;
+	u_int8  page[EE_PAGE_MAX + 1];
+	SMB_I2CMESSAGE msg;
+
+	while( len ) {
+		/* don't cross a page boundary */
+		n = G_pageSize - (offs % G_pageSize);
+		if( n > len )
+			n = len;
+
+		if( (n > 1) && bus->i2cOk ) {
+			page[0] = (u_int8)offs;
+			memcpy( &page[1], buf, n );
+			msg.addr  = smbAddr;
+			msg.flags = I2C_M_WR;
+			msg.len   = (u_int16)(n + 1);
+			msg.buf   = page;
+
+			err = SMB2API_I2CXfer( bus->smbHdl, &msg, 1 );
+			if( err && (bus->i2cOk == -1) ) {
+				/* first transfer failed: use SMBus byte writes */
+				bus->i2cOk = 0;
+				continue;
+			}
+			if( err ) {
+				PrintError( "SMB2API_I2CXfer", err );
+				return 1;
+			}
+			bus->i2cOk = 1;
+		}
+		else {
+			n = 1;
+			err = SMB2API_WriteByteData( bus->smbHdl, SMB_FLAGS, smbAddr,
+										 (u_int8)offs, *buf );
+			if( err ) {
+				PrintError( "SMB2API_WriteByteData", err );
+				return 1;
+			}
+		}
+
+		if( EeAckPoll( bus, smbAddr ) )
+			return 1;
+
+		offs += n;
+		buf  += n;
+		len  -= n;
+	}
+
+	return 0;
+}
+
+/********************************** EeProgram *********************************/
+/** Routine to program EEPROM data and verify it
+ *
+ *  Reads the EEPROM content first and writes only the bytes that differ,
+ *  from the first to the last changed byte of every page. The whole
+ *  range is read back and compared afterwards.
+ *
+ *  \param bus		\IN  SMB bus
+ *  \param smbAddr	\IN  address of SMB device
+ *  \param offs		\IN  EEPROM offset
+ *  \param data		\IN  data
+ *  \param len		\IN  number of bytes (offs + len <= EE_SIZE_MAX)
+ *  \param writtenP	\OUT number of written bytes
+ *
+ *  \return			success (0) or error (1)
+ */
+static int32 EeProgram( EE_BUS *bus, u_int8 smbAddr, u_int32 offs, u_int8 *data,
+						u_int32 len, u_int32 *writtenP )
+{
+	u_int8  cur[EE_SIZE_MAX];
+	u_int32 pos, end, first, last, i;
+	u_int32 start = UOS_MsecTimerGet();
+
+	*writtenP = 0;
+
+	if( offs + len > EE_SIZE_MAX )
+		return 1;
+
+	if( EeRead( bus, smbAddr, offs, cur, len ) )
+		return 1;
+
+	/* write changed bytes page by page */
+	for( pos=0; pos<len; pos=end ) {
+		end = pos + G_pageSize - ((offs + pos) % G_pageSize);
+		if( end > len )
+			end = len;
+
+		for( first=pos; (first < end) && (cur[first] == data[first]); first++ )
+			;
+		if( first == end )
+			continue;
+		for( last=end-1; cur[last] == data[last]; last-- )
+			;
+
+		if( EeWrite( bus, smbAddr, offs + first, &data[first], last - first + 1 ) )
+			return 1;
+		*writtenP += last - first + 1;
+		if( !bus->quiet ) {
+			printf( "." );
+			fflush( stdout );
+		}
+	}
+
+	/* verify */
+	if( EeRead( bus, smbAddr, offs, cur, len ) )
+		return 1;
+
+	for( i=0; i<len; i++ ) {
+		if( cur[i] != data[i] ) {
+			printf( "\n*** verify error at 0x%02x/0x%02x: read 0x%02x, "
+					"expected 0x%02x\n", smbAddr, offs + i, cur[i], data[i] );
+			return 1;
+		}
+	}
+
+	if( !bus->quiet )
+		printf( "\nwritten and verified in %d ms\n",
+				UOS_MsecTimerGet() - start );
+
+	return 0;
+}
+
+/********************************* BatchLoad **********************************/
+/** Routine to read the batch manifest
+ *
+ *  Every line describes one target: SMB device, EEPROM address, serial
+ *  number and board name, or '@' and the name of a binary file to program.
+ *  Empty lines and lines starting with '#' are ignored. Binary files are
+ *  read here, so the workers don't touch the file system.
+ *
+ *  \param fileName	\IN manifest file name
+ *  \param serial	\IN first serial number for '+' entries (0 = none)
+ *
+ *  \return			success (0) or error (1)
+ */
+static int32 BatchLoad( char *fileName, u_int32 serial )
+{
+	FILE    *fp, *binP;
+	char    line[4*LINE_BUF], serStr[LINE_BUF];
+	u_int32 addr, lineNo=0, i;
+	long    size;
+	BATCH_TARGET *t;
+
+	fp = fopen( fileName, "r" );
+	if( fp == NULL ) {
+		printf( "*** can't open manifest %s\n", fileName );
+		return 1;
+	}
+
+	while( fgets( line, sizeof(line), fp ) ) {
+		lineNo++;
+		if( (sscanf( line, "%1s", serStr ) != 1) || (serStr[0] == '#') )
+			continue;
+
+		if( G_batch.targetNum == BATCH_TARGET_MAX ) {
+			printf( "*** %s:%d: more than %d targets\n",
+					fileName, lineNo, BATCH_TARGET_MAX );
+			goto ERR;
+		}
+		t = &G_batch.target[G_batch.targetNum];
+
+		if( sscanf( line, "%79s %x %79s %79s", t->device, &addr, serStr,
+					t->board ) != 4 || (addr > 0xFF) ) {
+			printf( "*** %s:%d: syntax error\n", fileName, lineNo );
+			goto ERR;
+		}
+		t->smbAddr = (u_int8)addr;
+
+		/* no two targets at the same EEPROM */
+		for( i=0; i<G_batch.targetNum; i++ ) {
+			if( (G_batch.target[i].smbAddr == t->smbAddr) &&
+				!strcmp( G_batch.target[i].device, t->device ) ) {
+				printf( "*** %s:%d: %s 0x%02x used twice\n",
+						fileName, lineNo, t->device, t->smbAddr );
+				goto ERR;
+			}
+		}
+
+		/* binary file */
+		if( t->board[0] == '@' ) {
+			binP = fopen( &t->board[1], "rb" );
+			if( binP == NULL ) {
+				printf( "*** %s:%d: can't open %s\n",
+						fileName, lineNo, &t->board[1] );
+				goto ERR;
+			}
+			size = (long)fread( t->data, 1, EE_SIZE_MAX, binP );
+			if( (size <= 0) || (fgetc( binP ) != EOF) ) {
+				printf( "*** %s:%d: file size of %s not supported (1..%d)\n",
+						fileName, lineNo, &t->board[1], EE_SIZE_MAX );
+				fclose( binP );
+				goto ERR;
+			}
+			fclose( binP );
+			t->size = (u_int32)size;
+		}
+		/* board information EEPROM */
+		else {
+			if( strlen( t->board ) > (sizeof(G_eeprd2.pd_hwName)-1) ) {
+				printf( "*** %s:%d: boardname too long\n", fileName, lineNo );
+				goto ERR;
+			}
+			for( i=0; t->board[i]; i++ )
+				t->board[i] = (char)toupper( t->board[i] );
+
+			if( !strcmp( serStr, "+" ) ) {
+				if( !serial ) {
+					printf( "*** %s:%d: '+' needs a first serial number (-n)\n",
+							fileName, lineNo );
+					goto ERR;
+				}
+				t->serial = serial++;
+			}
+			else if( sscanf( serStr, "%u", &t->serial ) != 1 ) {
+				t->serial = 0;
+			}
+			if( (t->serial <= MIN_SERIAL_NO) || (t->serial >= MAX_SERIAL_NO) ) {
+				printf( "*** %s:%d: %s is not a valid serial number "
+						"between 1 and 65534\n", fileName, lineNo, serStr );
+				goto ERR;
+			}
+		}
+
+		/* one worker per SMB device */
+		for( i=0; i<G_batch.workerNum; i++ ) {
+			if( !strcmp( G_batch.worker[i].device, t->device ) )
+				break;
+		}
+		if( i == G_batch.workerNum ) {
+			if( G_batch.workerNum == BATCH_BUS_MAX ) {
+				printf( "*** %s:%d: more than %d SMB devices\n",
+						fileName, lineNo, BATCH_BUS_MAX );
+				goto ERR;
+			}
+			G_batch.worker[i].device    = t->device;
+			G_batch.worker[i].bus.i2cOk = -1;
+			G_batch.worker[i].bus.quiet = 1;
+			G_batch.workerNum++;
+		}
+		t->worker = i;
+		G_batch.targetNum++;
+	}
+
+	fclose( fp );
+
+	if( !G_batch.targetNum ) {
+		printf( "*** %s: no targets\n", fileName );
+		return 1;
+	}
+	return 0;
+
+ERR:
+	fclose( fp );
+	return 1;
+}
+
+/******************************** BatchIdProm *********************************/
+/** Routine to program a board information EEPROM of a batch
+ *
+ *  Builds the EEPROD2 data from the current EEPROM content and the batch
+ *  parameters in the same way as the single device mode, computes the
+ *  parity and programs the EEPROM.
+ *
+ *  \param bus		\IN    SMB bus
+ *  \param t		\INOUT batch target
+ *
+ *  \return			success (0) or error (1)
+ */
+static int32 BatchIdProm( EE_BUS *bus, BATCH_TARGET *t )
+{
+	EEPROD2 ee;
+	u_int8  *arr = (u_int8*)&ee;
+
+	if( EeRead( bus, t->smbAddr, 0, arr, sizeof(EEPROD2) ) )
+		return 1;
+
+	/* keep revision in EEPROM if not specified */
+	if( G_batch.revision || (ee.pd_revision[0] == 0xFF) )
+		memcpy( ee.pd_revision, G_batch.rev, sizeof(ee.pd_revision) );
+
+	if( G_batch.repdate )
+		ee.pd_repdat = SWAPWORD(G_batch.repdat);
+
+	/* keep production date in EEPROM if not specified */
+	if( G_batch.proddate || (ee.pd_prodat == 0xFFFF) )
+		ee.pd_prodat = SWAPWORD(G_batch.prodat);
+
+	strncpy( ee.pd_hwName, t->board, sizeof(ee.pd_hwName)-1 );
+	ee.pd_hwName[sizeof(ee.pd_hwName)-1] = '\0';
+	ee.pd_serial = SWAPLONG(t->serial);
+	ee.pd_model  = G_batch.model;
+
+	ee.pd_id = (u_int8)( CalcParity( &arr[1], (sizeof(EEPROD2)-1) ) |
+						 (EEID_PD2 << 4) );
+
+	return EeProgram( bus, t->smbAddr, 0, arr, sizeof(EEPROD2), &t->written );
+}
+
+/******************************** BatchWorker *********************************/
+/** Routine to program all batch targets of one SMB device
+ *
+ *  \param w	\IN batch worker
+ */
+static void BatchWorker( BATCH_WORKER *w )
+{
+	int32   err;
+	u_int32 i, start;
+	BATCH_TARGET *t;
+
+	err = SMB2API_Init( w->device, &w->bus.smbHdl );
+
+	for( i=0; i<G_batch.targetNum; i++ ) {
+		t = &G_batch.target[i];
+		if( &G_batch.worker[t->worker] != w )
+			continue;
+
+		if( err ) {
+			t->result = 1;
+			continue;
+		}
+
+		start = UOS_MsecTimerGet();
+		if( t->size )
+			t->result = EeProgram( &w->bus, t->smbAddr, 0, t->data, t->size,
+								   &t->written );
+		else
+			t->result = BatchIdProm( &w->bus, t );
+		t->time = UOS_MsecTimerGet() - start;
+	}
+
+	if( err ) {
+		printf( "*** %s: ", w->device );
+		PrintError( "SMB2API_Init", err );
+		return;
+	}
+
+	err = SMB2API_Exit( &w->bus.smbHdl );
+	if( err ) {
+		printf( "*** %s: ", w->device );
+		PrintError( "SMB2API_Exit", err );
+	}
+}
+
+/******************************** BatchThread *********************************/
+/** Thread entry of a batch worker
+ *
+ *  \param arg	\IN batch worker
+ */
+static void BatchThread( void *arg )
+{
+	BatchWorker( (BATCH_WORKER*)arg );
+}
+
+/********************************** BatchRun **********************************/
+/** Routine to program all targets of a batch manifest
+ *
+ *  The SMB devices are programmed concurrently, the targets of one SMB
+ *  device one after another. Prints the result and time of every target.
+ *
+ *  \param fileName	\IN manifest file name
+ *  \param serial	\IN first serial number for '+' entries (0 = none)
+ *
+ *  \return			success (0) or error (1)
+ */
+static int32 BatchRun( char *fileName, u_int32 serial )
+{
+	u_int32 i, start, wall, sum=0, failed=0;
+	BATCH_WORKER *w;
+	BATCH_TARGET *t;
+
+	if( BatchLoad( fileName, serial ) )
+		return 1;
+
+	printf( "\nPROGRAMMING %d EEPROM(S) ON %d SMB DEVICE(S)\n",
+			G_batch.targetNum, G_batch.workerNum );
+
+	start = UOS_MsecTimerGet();
+	for( i=0; i<G_batch.workerNum; i++ ) {
+		w = &G_batch.worker[i];
+		w->started = !SMB2_OsThreadCreate( &w->thread, BatchThread, w, 0 );
+		/* no thread: program this device sequentially */
+		if( !w->started )
+			BatchWorker( w );
+	}
+	for( i=0; i<G_batch.workerNum; i++ ) {
+		w = &G_batch.worker[i];
+		if( !w->started )
+			continue;
+		SMB2_OsThreadJoin( &w->thread );
+	}
+	wall = UOS_MsecTimerGet() - start;
+
+	/* report */
+	printf( "\n%-12s %-4s %-6s %-24s %-6s %7s %5s\n",
+			"device", "addr", "serial", "target", "result", "time", "bytes" );
+	for( i=0; i<G_batch.targetNum; i++ ) {
+		t = &G_batch.target[i];
+		if( t->size )
+			printf( "%-12s 0x%02x %-6s %-24s", t->device, t->smbAddr, "-",
+					&t->board[1] );
+		else
+			printf( "%-12s 0x%02x %-6u %-24s", t->device, t->smbAddr,
+					t->serial, t->board );
+		printf( " %-6s %4d ms %5d\n", t->result ? "FAILED" : "ok",
+				t->time, t->written );
+		sum += t->time;
+		if( t->result )
+			failed++;
+	}
+	printf( "\n%d of %d EEPROM(s) programmed in %d ms "
+			"(%d ms sequential)\n",
+			G_batch.targetNum - failed, G_batch.targetNum, wall, sum );
+
+	return failed ? 1 : 0;
+}
+
 /******************************* GetDateFormat ********************************/
 /** Routine to get the right date format for EEPROD2 structure
  *
@@ -1008,7 +1631,7 @@ static u_int8 CalcParity( u_int8 *ptr, u_int32 len )
  */
 static void PrintError( char *info, int32 errCode )
 {
-	static char errMsg[512];
+	char errMsg[512];
 
 	if( !errCode )
 		errCode = UOS_ErrnoGet();
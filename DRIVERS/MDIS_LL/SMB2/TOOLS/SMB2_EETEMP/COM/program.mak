@@ -37,6 +37,7 @@ MAK_INCL=$(MEN_INC_DIR)/men_typs.h \
          $(MEN_INC_DIR)/mdis_api.h \
          $(MEN_INC_DIR)/usr_oss.h  \
          $(MEN_INC_DIR)/smb2_api.h \
+         $(MEN_INC_DIR)/smb2_drv.h \
 
 
 MAK_INP1=smb2_eetemp$(INP_SUFFIX)
@@ -10,7 +10,9 @@
  *        \brief Tool to read the temperature from EEPROMS via the SMB2_API
  *
  *                - init SMB2_API library (SMB2API_Init)
- *                - read data from SMB device (SMB2API_ReadWordData)
+ *                - read data from SMB devices (SMB2API_ReadWordData, one
+ *                  transaction group for all sensors)
+ *                - optionally log the temperatures at a fixed rate
  *                - exit SMB2_API library (SMB2API_Exit)
  *
  *     Required: libraries: mdis_api, usr_oss, usr_utl, smb2_api
@@ -39,11 +41,13 @@
 +-------------------------------------*/
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <MEN/men_typs.h>
 #include <MEN/mdis_api.h>
 #include <MEN/usr_oss.h>
 #include <MEN/usr_utl.h>
 #include <MEN/smb2_api.h>
+#include <MEN/smb2_drv.h>
 
 static const char IdentString[]=MENT_XSTR(MAK_REVISION);
 
@@ -75,11 +79,34 @@ static const char IdentString[]=MENT_XSTR(MAK_REVISION);
 #define DEFAULT_TEMP_SENSE_ADDR  0x3E
 #define SMB_FLAGS                0x0
 #define TEMP_OFFS                0x5 
+#define SENSOR_MAX               16		/* max. number of sensors */
+#define WINDOW_MAX               1024	/* max. samples for min/max/avg */
+#define WINDOW_DEFAULT           60
+
+/*-------------------------------------+
+|    TYPEDEFS                          |
++-------------------------------------*/
+/* temperature sensor */
+typedef struct {
+	u_int8  addr;				/* SMB address */
+	u_int16 raw;				/* raw register value */
+	int32   err;				/* read error */
+	int32   cur;				/* temperature [m degC] */
+	int32   ring[WINDOW_MAX];	/* last temperatures [m degC] */
+	u_int32 ringIdx;			/* next ring entry */
+	u_int32 ringNum;			/* valid ring entries */
+	int32   sum;				/* sum of ring entries */
+	int32   min, max, avg;		/* rolling statistics [m degC] */
+	u_int32 errCnt;				/* number of read errors */
+} SENSOR;
 
 /*-------------------------------------+
 |    PROTOTYPES                        |
 +-------------------------------------*/
-static void CalcTemp(int32 temp, double *eetemp);
+static int32 CalcTemp(u_int16 temp);
+static char *FmtTemp(int32 mdeg, char *buf);
+static int32 ReadSensors(void *smbHdl, void *grpHdl, SENSOR *sens, u_int32 num);
+static void UpdateStats(SENSOR *s, u_int32 window);
 static void PrintError(char*, int32);
 
 /********************************* header **********************************/
@@ -105,21 +132,30 @@ static void usage(void)
 		"\nFunction:  read board temperatures from EEPROMs of "
 		"\nOptions:\n"
 		"    devName         device name e.g. smb2_1                           \n"
-		"    [-a=hex]        address of temp. sensor (EEPROM)...........[0x3E] \n"
+		"    [-a=hex[,hex]]  address(es) of temp. sensors (EEPROM), max. 16[0x3E]\n"
 		"    [-t=deg]        max. temperature (in %cC) - 0 means not used...[0]\n"
-		"    [-l <opts>]     read temperature in a loop                        \n"
-		"       [-d=<time>]    delay between loop (in ms)................[500] \n"
+		"    [-l <opts>]     read temperature in a loop at a fixed rate        \n"
+		"       [-d=<time>]    sample period (in ms).....................[500] \n"
+		"       [-n=<num>]     number of samples - 0 means endless........[0] \n"
+		"       [-w=<num>]     samples for rolling min/max/avg...........[60]  \n"
+		"       [-f=<file>]    write CSV log file instead of console output    \n"
 		"\nCalling examples:                          \n"
 		"\n - show current board temperature:         \n"
 		"     smb2_eetemp smb2_1                      \n"
 		"\n - set max. temperature for tests and show temperature in a loop:   \n"
-		"     smb2_eetemp smb2_1 -t=80 -l             \n", 248
+		"     smb2_eetemp smb2_1 -t=80 -l             \n"
+		"\n - log three sensors every 100ms:            \n"
+		"     smb2_eetemp smb2_1 -a=0x30,0x32,0x3e -l -d=100 -f=temp.csv \n", 248
 	);
     printf("\nCopyright 2011-2019, MEN Mikro Elektronik GmbH\n%s\n\n", IdentString);
 }
 
 /***************************************************************************/
 /** Program main function
+ *
+ *  In loop mode, the sensors are sampled at absolute deadlines
+ *  (start + n * period), so the read time doesn't add up. The deviation of
+ *  the sample time from the deadline is reported as jitter.
  *
  *  \param argc    \IN argument counter
  *  \param argv    \IN argument vector
@@ -130,17 +166,21 @@ int main(int argc, char *argv[])
 {
 	int     err, ret=0, i=0;
 	char    *errstr=NULL, ebuf[100];
-	char    *optp=NULL;
+	char    *optp=NULL, *logName=NULL;
 	u_int32 delay=0, maxtemp=0, smbAddr=0x0, loop;
-	int32   temp=0;
-	double  eetemp;
+	u_int32 count=0, window=WINDOW_DEFAULT, num=0, n=0, k;
+	u_int32 start, next, now, missed=0, allFail=0;
+	int32   rem, jit, jitMin=0, jitMax=0, jitSum=0;
 	char    *deviceP=NULL;
-	void    *smbHdl=NULL;
+	char    t1[16], t2[16], t3[16], t4[16];
+	void    *smbHdl=NULL, *grpHdl=NULL;
+	FILE    *logP=NULL;
+	SENSOR  *sens=NULL;
 
 	/*------------------+
 	|  Check arguments  |
 	+------------------*/
-	errstr = UTL_ILLIOPT("?a=ld=t=", ebuf);
+	errstr = UTL_ILLIOPT("?a=ld=t=n=w=f=", ebuf);
 	if (errstr) {
 		printf("*** %s\n", errstr);
 		usage();
@@ -170,12 +210,33 @@ int main(int argc, char *argv[])
 		goto EXIT;
 	}
 
-	/* SMB device(EEPROM) address */
+	sens = (SENSOR*)calloc(SENSOR_MAX, sizeof(SENSOR));
+	if (!sens) {
+		printf("\n***ERROR: can't alloc sensor buffer!\n");
+		ret=1;
+		goto EXIT;
+	}
+
+	/* SMB device(EEPROM) addresses */
 	optp = UTL_TSTOPT("a=");
-	if (optp)
-		sscanf(optp, "%x", &smbAddr);
-	else
-		smbAddr = DEFAULT_TEMP_SENSE_ADDR; /* 0x3E */
+	if (optp) {
+		while (*optp && (num < SENSOR_MAX)) {
+			if (sscanf(optp, "%x", &smbAddr) != 1)
+				break;
+			sens[num++].addr = (u_int8)smbAddr;
+			if ((optp = strchr(optp, ',')) == NULL)
+				break;
+			optp++;
+		}
+	}
+	else {
+		sens[num++].addr = DEFAULT_TEMP_SENSE_ADDR; /* 0x3E */
+	}
+	if (!num) {
+		printf("\n***ERROR: invalid sensor address!\n");
+		ret=1;
+		goto EXIT;
+	}
 
 	/* max. temperature */
 	optp = UTL_TSTOPT("t=");
@@ -192,6 +253,37 @@ int main(int argc, char *argv[])
 		sscanf(optp, "%d", &delay);
 	else
 		delay = 500;
+	if (!delay)
+		delay = 1;
+
+	/* number of samples */
+	optp = UTL_TSTOPT("n=");
+	if (optp)
+		sscanf(optp, "%d", &count);
+
+	/* window for min/max/avg */
+	optp = UTL_TSTOPT("w=");
+	if (optp)
+		sscanf(optp, "%d", &window);
+	if (!window || (window > WINDOW_MAX)) {
+		printf("\n***ERROR: window must be 1..%d samples!\n", WINDOW_MAX);
+		ret=1;
+		goto EXIT;
+	}
+
+	/* log file */
+	logName = UTL_TSTOPT("f=");
+	if (logName) {
+		if ((logP = fopen(logName, "w")) == NULL) {
+			printf("\n***ERROR: can't open %s!\n", logName);
+			ret=1;
+			goto EXIT;
+		}
+		fprintf(logP, "time_ms");
+		for (k = 0; k < num; k++)
+			fprintf(logP, ",0x%02x,min,max,avg", sens[k].addr);
+		fprintf(logP, "\n");
+	}
 
 	/*--------------------+
 	|  Init SMB2 library  |
@@ -203,61 +295,226 @@ int main(int argc, char *argv[])
 		goto EXIT;
 	}
 
+	/* read all sensors with one driver call if supported,
+	   a failed sensor doesn't stop the others */
+	if (SMB2API_XferGroupBegin(smbHdl, SMB2_XFER_GROUP_CONT, num, &grpHdl))
+		grpHdl = NULL;
+
 	/* some output at the beginning */
 	header();
-	printf("Accessing %s: smbAddr 0x%02x; max.temp.: %d %cC\n", deviceP, smbAddr, maxtemp, 248);
+	printf("Accessing %s: %d sensor(s); max.temp.: %d %cC\n", deviceP, num, maxtemp, 248);
 
 	/*-----------------------------+
 	|  Read temperature in a loop  |
 	+-----------------------------*/
-	do {
-		/* read current temperature of EEPROM */
-		err = SMB2API_ReadWordData( smbHdl, SMB_FLAGS, (u_int8)smbAddr, TEMP_OFFS, (u_int16*)&temp );
-		if (err) {
-			PrintError( "SMB2API_ReadWordData", err );
-			goto ERR_EXIT;
+	start = next = UOS_MsecTimerGet();
+
+	while (!count || (n < count)) {
+		/* wait for the deadline */
+		rem = (int32)(next - UOS_MsecTimerGet());
+		if (rem > 0)
+			UOS_Delay(rem);
+
+		jit = (int32)(UOS_MsecTimerGet() - next);
+		if (!n || (jit < jitMin))
+			jitMin = jit;
+		if (!n || (jit > jitMax))
+			jitMax = jit;
+		jitSum += jit;
+		n++;
+
+		/* read current temperature of EEPROMs,
+		   in loop mode a failed sample is logged as empty row */
+		if (ReadSensors(smbHdl, grpHdl, sens, num) == (int32)num) {
+			allFail++;
+			if (!loop) {
+				PrintError("SMB2API_ReadWordData", sens[0].err);
+				ret=1;
+				break;
+			}
 		}
 
-		CalcTemp(temp, &eetemp);
+		for (k = 0; k < num; k++) {
+			if (sens[k].err)
+				continue;
+			UpdateStats(&sens[k], window);
 
-		if (maxtemp && (eetemp > (double)maxtemp)) {
-			printf( "\n *** WARNING: Current board temperature(%.2lf %cC)"
-					"\n              is higher than %d %cC!\n", eetemp, 248, maxtemp, 248 );
+			if (maxtemp && (sens[k].cur > (int32)maxtemp * 1000)) {
+				printf( "\n *** WARNING: Current temperature of 0x%02x (%s %cC)"
+						"\n              is higher than %d %cC!\n", sens[k].addr,
+						FmtTemp(sens[k].cur, t1), 248, maxtemp, 248 );
+			}
+		}
+
+		if (logP) {
+			fprintf(logP, "%u", next - start);
+			for (k = 0; k < num; k++) {
+				if (sens[k].err)
+					fprintf(logP, ",,,,");
+				else
+					fprintf(logP, ",%s,%s,%s,%s", FmtTemp(sens[k].cur, t1),
+							FmtTemp(sens[k].min, t2), FmtTemp(sens[k].max, t3),
+							FmtTemp(sens[k].avg, t4));
+			}
+			fprintf(logP, "\n");
+		}
+		else if (!loop) {
+			for (k = 0; k < num; k++) {
+				if (sens[k].err)
+					printf("\n*** Sensor 0x%02x: read error\n", sens[k].addr);
+				else
+					printf("\nCurrent Board temperature (0x%02x): %s %cC\n",
+						   sens[k].addr, FmtTemp(sens[k].cur, t1), 248);
+			}
 		}
 		else {
-			printf("\nCurrent Board temperature: %.2lf %cC\n", eetemp, 248);
+			printf("%8u ms", next - start);
+			for (k = 0; k < num; k++) {
+				if (sens[k].err)
+					printf("  0x%02x: ----", sens[k].addr);
+				else
+					printf("  0x%02x: %s (%s..%s avg %s)", sens[k].addr,
+						   FmtTemp(sens[k].cur, t1), FmtTemp(sens[k].min, t2),
+						   FmtTemp(sens[k].max, t3), FmtTemp(sens[k].avg, t4));
+			}
+			printf("\n");
 		}
 
-		if (!loop)
+		if (!loop || (UOS_KeyPressed() != -1))
 			break;
 
-		UOS_Delay(delay);
-
-	} while (UOS_KeyPressed() == -1);
+		/* next deadline, skip missed periods */
+		next += delay;
+		now = UOS_MsecTimerGet();
+		while ((int32)(now - next) > 0) {
+			next += delay;
+			missed++;
+		}
+	}
 
+	/*--------------+
+	|  Statistics   |
+	+--------------*/
+	if (loop && n) {
+		printf("\n%u sample(s), period %u ms, jitter min %d / max %d / avg %d ms, "
+			   "%u missed period(s), %u sample(s) without any sensor\n",
+			   n, delay, jitMin, jitMax, jitSum / (int32)n, missed, allFail);
+		for (k = 0; k < num; k++) {
+			printf("  sensor 0x%02x: %u read error(s)\n", sens[k].addr,
+				   sens[k].errCnt);
+		}
+	}
 
-ERR_EXIT:
 	/*--------------------+
 	|  Exit SMB2 library  |
 	+--------------------*/
+	if (grpHdl)
+		SMB2API_XferGroupEnd(&grpHdl);
 	err = SMB2API_Exit(&smbHdl);
-	if (err)
+	if (err) {
 		PrintError("SMB2API_Exit", err);
-
-	ret = 1;
+		ret = 1;
+	}
 
 EXIT:
+	if (logP)
+		fclose(logP);
+	if (sens)
+		free(sens);
 	return ret;
 }
 
+/******************************* ReadSensors ********************************/
+/** Routine to read the temperature of all sensors
+ *
+ *  With a transaction group, all sensors are read with one driver call.
+ *  If the group can't be executed, the sensors are read one by one.
+ *  A failed sensor doesn't stop the others, its error is stored in the
+ *  sensor.
+ *
+ *  \param smbHdl     \IN    SMB2API handle
+ *  \param grpHdl     \IN    transaction group or NULL
+ *  \param sens       \INOUT sensors
+ *  \param num        \IN    number of sensors
+ *
+ *  \return           number of failed sensors
+ */
+static int32 ReadSensors(void *smbHdl, void *grpHdl, SENSOR *sens, u_int32 num)
+{
+	u_int32 k;
+	int32   err, failed = 0;
+	int     grouped = 0;
+
+	if (grpHdl) {
+		err = SMB2API_XferGroupReset(grpHdl);
+		for (k = 0; !err && k < num; k++)
+			err = SMB2API_XferGroupAddReadWordData(grpHdl, SMB_FLAGS,
+									sens[k].addr, TEMP_OFFS, &sens[k].raw);
+		if (!err)
+			err = SMB2API_XferGroupCommit(grpHdl);
+		for (k = 0; !err && k < num; k++)
+			sens[k].err = SMB2API_XferGroupError(grpHdl, k);
+		grouped = !err;
+	}
+
+	/* no transaction group or group failed: single transfers */
+	for (k = 0; !grouped && k < num; k++)
+		sens[k].err = SMB2API_ReadWordData(smbHdl, SMB_FLAGS,
+									sens[k].addr, TEMP_OFFS, &sens[k].raw);
+
+	for (k = 0; k < num; k++) {
+		if (sens[k].err) {
+			sens[k].errCnt++;
+			failed++;
+		}
+		else {
+			sens[k].cur = CalcTemp(sens[k].raw);
+		}
+	}
+
+	return failed;
+}
+
+/******************************* UpdateStats ********************************/
+/** Routine to add the current temperature to the rolling statistics
+ *
+ *  \param s          \INOUT sensor
+ *  \param window     \IN    number of samples for min/max/avg
+ */
+static void UpdateStats(SENSOR *s, u_int32 window)
+{
+	u_int32 i;
+
+	if (s->ringNum == window)
+		s->sum -= s->ring[s->ringIdx];
+	else
+		s->ringNum++;
+
+	s->ring[s->ringIdx] = s->cur;
+	s->sum += s->cur;
+	s->ringIdx = (s->ringIdx + 1) % window;
+
+	s->min = s->max = s->cur;
+	for (i = 0; i < s->ringNum; i++) {
+		if (s->ring[i] < s->min)
+			s->min = s->ring[i];
+		if (s->ring[i] > s->max)
+			s->max = s->ring[i];
+	}
+	s->avg = s->sum / (int32)s->ringNum;
+}
+
 /********************************* CalcTemp *********************************/
 /** Routine to calculate the actual EEPROM temperature 
  *
  *  \param temp       \IN  raw temperature value
- *  \param eetemp     \OUT formatted temperature sensor value
+ *
+ *  \return           temperature in mC
  */
-static void CalcTemp(int32 temp, double *eetemp)
+static int32 CalcTemp(u_int16 temp)
 {
+	int32 t16;
+
 	/*------------------------+
 	|  Calculate temperature  |
 	+------------------------*/
@@ -269,11 +526,29 @@ static void CalcTemp(int32 temp, double *eetemp)
 	 * 15 14 13 |  12 11 10 9 8 7 6 5 4 3 2  | 1 0
 	 * -------------------------------------------
 	 */
+	/* 13 bit 2nd complement in 1/16C (0.25C resolution) */
+	t16 = SWAPWORD(temp) & 0xFFC;
 	if (SWAPWORD(temp) & 0x1000)
-		*eetemp = (~SWAPWORD(temp) & 0xFFC) * (-0.0625);
+		t16 -= 0x1000;
 
-	else
-		*eetemp = (SWAPWORD(temp) & 0xFFC) * 0.0625;
+	/* 1/16C = 62.5 mC, t16 is a multiple of 4 */
+	return t16 * 125 / 2;
+}
+
+/********************************* FmtTemp **********************************/
+/** Routine to format a temperature without floating point
+ *
+ *  \param mdeg       \IN  temperature in mC
+ *  \param buf        \OUT buffer for string (min. 16 bytes)
+ *
+ *  \return           buf, e.g. "-24.750"
+ */
+static char *FmtTemp(int32 mdeg, char *buf)
+{
+	u_int32 abs = (mdeg < 0) ? -mdeg : mdeg;
+
+	sprintf(buf, "%s%u.%03u", (mdeg < 0) ? "-" : "", abs / 1000, abs % 1000);
+	return buf;
 }
 
 /******************************* PrintError *********************************/
@@ -66,10 +66,10 @@ void *SMB2CTRL_smbHdl;
 +-------------------------------------*/
 static void header(void);
 static void usage(void);
-static void print_psu(int32 psu_id);
-static void print_fan(int32 fan_id);
+static void print_psu(int32 psu_id, struct shc_psu *shc_psu_state);
+static void print_fan(int32 fan_id, struct shc_fan *shc_fan_state);
 static void print_voltlevel(void);
-static void print_ups(int32 ups_id);
+static void print_ups(int32 ups_id, struct shc_ups *shc_ups_state);
 static void set_persistent_pwrbtn_status(u_int32 status);
 static void set_power_cycle_duration(u_int32 duration);
 static void print_persistent_pwrbtn_status();
@@ -78,10 +78,17 @@ static void power_off(void);
 static void print_configdata(void);
 static void get_temperature(void);
 static void set_temperature(int32 tempC);
+static void refresh_temperature(int32 tempC);
+static int32 refresh_temperature_cb(void *cb_arg, u_int16 *tempK);
+static void monitor(u_int32 period);
+static void monitor_cb(void *cb_arg, u_int32 events,
+					   struct shc_mon_state *state,
+					   struct shc_mon_state *prev);
 static void get_psu_state(u_int32 psu_nbr);
 static void get_ups_state(u_int32 ups_nbr);
 static void get_fan_state(u_int32 fan_nbr);
 static void print_firm_version(void);
+static void print_snapshot(void);
 static void PrintError(char *info, int32 errCode);
 
 /********************************* header ***********************************/
@@ -108,6 +115,8 @@ static void usage(void)
 		"    -?            Usage                                     \n"
 		"    -t            Get system/ambient temperature                    \n"
 		"    -T=[dec]      Set ambient temperature (Celsius) for FAN control \n"
+		"    -R=[dec]      Keep ambient temperature (Celsius) set until a    \n"
+		"                  key is pressed                                    \n"
 		"    -i            Get shelf controller API identifier       \n"
 		"    -p=[psu_id]   Get status of one or all PSU              \n"
 		"                  (psu_id: 0 to 3, 0: to get all psu status)\n"
@@ -125,6 +134,10 @@ static void usage(void)
 		"                  status can be 0 (off) or 1 (on)           \n"
 		"    -c            Get Configuration Data                    \n"
 		"    -r            Get Firmware Version                      \n"
+		"    -a            Get status snapshot (temperature, PSU,    \n"
+		"                  FAN, voltage and UPS with one request)    \n"
+		"    -M=[ms]       Monitor PSU, FAN and UPS transitions until\n"
+		"                  a key is pressed (fastest poll period)    \n"
 		"Calling examples:                                           \n"
 		"    Get FAN status:  smb2_shc_ctrl smb2_1 -f=0              \n"
 		);
@@ -153,7 +166,7 @@ int main(int argc, char** argv)
 	/*--------------------+
 	|  check arguments    |
 	+--------------------*/
-	errstr = UTL_ILLIOPT("?cf=op=PB=d=irstT=u=v", argbuf);
+	errstr = UTL_ILLIOPT("?acf=op=PB=d=irstT=R=u=vM=", argbuf);
 	if (errstr) {
 		printf("*** %s\n", errstr);
 		usage();
@@ -210,6 +223,12 @@ int main(int argc, char** argv)
 		set_temperature(tempC);
 	}
 
+	/* keep ambient temperature set */
+	if ((optP = UTL_TSTOPT("R="))) {
+		sscanf(optP, "%d", &tempC);
+		refresh_temperature(tempC);
+	}
+
 	/* get voltage levels */
 	if ((optP = UTL_TSTOPT("v")))
 		print_voltlevel();
@@ -259,6 +278,16 @@ int main(int argc, char** argv)
 	if ((optP = UTL_TSTOPT("r")))
 		print_firm_version();
 
+	/* get status snapshot */
+	if ((optP = UTL_TSTOPT("a")))
+		print_snapshot();
+
+	/* monitor power-fail transitions */
+	if ((optP = UTL_TSTOPT("M="))) {
+		sscanf(optP, "%d", &id_nbr);
+		monitor(id_nbr);
+	}
+
 EXIT:
 	/*--------------------+
 	|  Exit SHC library   |
@@ -270,53 +299,37 @@ EXIT:
 
 
 /****************************************************************************/
-/** Get and print the state of PSU
+/** Print the state of PSU
  *
- *  \param psu_id    \IN  ID number of the PSU
+ *  \param psu_id           \IN  ID number of the PSU
+ *  \param shc_psu_state    \IN  state of the PSU
  */
-static void print_psu(int32 psu_id)
+static void print_psu(int32 psu_id, struct shc_psu *shc_psu_state)
 {
-	int err;
-	struct shc_psu shc_psu_state;
-
-	err = SMB2SHC_GetPSU_State(psu_id, &shc_psu_state);
-	if (err) {
-		PrintError("***ERROR: SMB2SHC_GET_PSU:", err);
-	}
-	else {
-		printf("-----------------------------------------\n");
-		printf("PSU %d Present:\t\t%s\n", psu_id + 1,
-				shc_psu_state.isPresent ? "TRUE" : "FALSE");
-		printf("PSU %d Failure:\t\t%s\n", psu_id + 1,
-				shc_psu_state.intFailure ? "TRUE" : "FALSE");
-		printf("PSU %d External PWR:\t%s\n", psu_id +1,
-				shc_psu_state.isEPwrPresent ? "TRUE" : "FALSE");
-	}
+	printf("-----------------------------------------\n");
+	printf("PSU %d Present:\t\t%s\n", psu_id + 1,
+			shc_psu_state->isPresent ? "TRUE" : "FALSE");
+	printf("PSU %d Failure:\t\t%s\n", psu_id + 1,
+			shc_psu_state->intFailure ? "TRUE" : "FALSE");
+	printf("PSU %d External PWR:\t%s\n", psu_id +1,
+			shc_psu_state->isEPwrPresent ? "TRUE" : "FALSE");
 }
 
 /****************************************************************************/
-/** Get and print the state of FAN
+/** Print the state of FAN
  *
- *  \param fan_id    \IN  ID number of the FAN
+ *  \param fan_id           \IN  ID number of the FAN
+ *  \param shc_fan_state    \IN  state of the FAN
  */
-static void print_fan(int32 fan_id)
+static void print_fan(int32 fan_id, struct shc_fan *shc_fan_state)
 {
-	int err;
-	struct shc_fan shc_fan_state;
-
-	err = SMB2SHC_GetFAN_State(fan_id, &shc_fan_state);
-	if (err) {
-		PrintError("***ERROR: SMB2SHC_GET_FAN:", err);
-	}
-	else {
-		printf("-----------------------------------------\n");
-		printf("FAN %d Present:\t\t%s\n", fan_id + 1,
-				shc_fan_state.isPresent ? "TRUE" : "FALSE");
-		printf("FAN %d Status:\t\t%s\n", fan_id + 1,
-				shc_fan_state.state == SHC_FAN_OK ? "OK" : "FAIL");
-		printf("FAN %d Speed (rpm):\t%d\n", fan_id + 1,
-				shc_fan_state.speedRpm);
-	}
+	printf("-----------------------------------------\n");
+	printf("FAN %d Present:\t\t%s\n", fan_id + 1,
+			shc_fan_state->isPresent ? "TRUE" : "FALSE");
+	printf("FAN %d Status:\t\t%s\n", fan_id + 1,
+			shc_fan_state->state == SHC_FAN_OK ? "OK" : "FAIL");
+	printf("FAN %d Speed (rpm):\t%d\n", fan_id + 1,
+			shc_fan_state->speedRpm);
 }
 
 /****************************************************************************/
@@ -325,46 +338,39 @@ static void print_fan(int32 fan_id)
 static void print_voltlevel()
 {
 	int i, err, pwr_mon_nr;
-	u_int16 voltlevel;
+	u_int16 voltlevel[SMB2_SHC_PWR_MON_NUM];
 
 	printf("Voltage Level Reporting:\n");
 	printf("-----------------------------------------\n");
 
+	err = SMB2SHC_GetAllVoltLevels(voltlevel);
+	if (err) {
+		PrintError("***ERROR: SMB2SHC_GET_VOLT_LEVEL:", err);
+		return;
+	}
+
 	for (i=SHC_PWR_MON_1; i<=SHC_PWR_MON_4; i++) {
-		err = SMB2SHC_GetVoltLevel(i, &voltlevel);
-		if (err) {
-			PrintError("***ERROR: SMB2SHC_GET_VOLT_LEVEL:", err);
-			continue;
-		}
 		pwr_mon_nr = i + 1;
-		printf("PWR_MON %d Voltage Level in mV:\t\t%d\n", pwr_mon_nr, voltlevel);
+		printf("PWR_MON %d Voltage Level in mV:\t\t%d\n", pwr_mon_nr, voltlevel[i]);
 	}
 }
 
 /****************************************************************************/
-/** Get and print the state of UPS
+/** Print the state of UPS
 *
-*  \param ups_id    \IN  ID number of the UPS
+*  \param ups_id           \IN  ID number of the UPS
+*  \param shc_ups_state    \IN  state of the UPS
 */
-static void print_ups(int32 ups_id)
+static void print_ups(int32 ups_id, struct shc_ups *shc_ups_state)
 {
-	int err;
-	struct shc_ups shc_ups_state;
-
-	err = SMB2SHC_GetUPS_State(ups_id, &shc_ups_state);
-	if (err) {
-		PrintError("***ERROR: SMB2SHC_GET_UPS:", err);
-	}
-	else {
-		printf("-----------------------------------------\n");
-		printf("UPS %d Present:\t\t%s\n", ups_id + 1,
-			shc_ups_state.isPresent ? "TRUE" : "FALSE");
-		printf("UPS %d Failure:\t\t%s\n", ups_id + 1,
-			shc_ups_state.intFailure ? "TRUE" : "FALSE");
-		printf("UPS %d provides PWR:\t%s\n", ups_id + 1,
-			shc_ups_state.provPWR ? "TRUE" : "FALSE");
-		printf("UPS %d charging level in %%: %d\n", ups_id + 1, shc_ups_state.chrg_lvl);
-	}
+	printf("-----------------------------------------\n");
+	printf("UPS %d Present:\t\t%s\n", ups_id + 1,
+		shc_ups_state->isPresent ? "TRUE" : "FALSE");
+	printf("UPS %d Failure:\t\t%s\n", ups_id + 1,
+		shc_ups_state->intFailure ? "TRUE" : "FALSE");
+	printf("UPS %d provides PWR:\t%s\n", ups_id + 1,
+		shc_ups_state->provPWR ? "TRUE" : "FALSE");
+	printf("UPS %d charging level in %%: %d\n", ups_id + 1, shc_ups_state->chrg_lvl);
 }
 
 /****************************************************************************/
@@ -395,6 +401,122 @@ static void get_temperature()
 	}
 }
 
+/****************************************************************************/
+/** Temperature callback for the refresher
+*
+*  \param cb_arg    \IN   pointer to the temperature (Kelvin)
+*  \param tempK     \OUT  temperature (Kelvin)
+*  \return          0
+*/
+static int32 refresh_temperature_cb(void *cb_arg, u_int16 *tempK)
+{
+	*tempK = *(u_int16*)cb_arg;
+	return 0;
+}
+
+/****************************************************************************/
+/** Keep ambient temperature set with the refresher
+*
+*  \param tempC    \IN  temperature in Celsius
+*/
+static void refresh_temperature(int32 tempC)
+{
+	int err, i = 0;
+	u_int16 tempK;
+	void *trefHdl;
+	struct shc_temp_refresh_stats stats;
+
+	/* get Kelvin */
+	tempK = (u_int16)(tempC + ABS_ZERO);
+
+	err = SMB2SHC_TempRefresh_Start(1000, 10000, refresh_temperature_cb,
+									&tempK, &trefHdl);
+	if (err) {
+		PrintError("***ERROR: SMB2SHC_TEMP_REFRESH_START", err);
+		return;
+	}
+
+	printf("Keep ambient temperature at %dC - Press any key to abort\n", tempC);
+
+	do {
+		UOS_Delay(1000);
+		if (++i % 10 == 0) {
+			SMB2SHC_TempRefresh_GetStats(trefHdl, &stats);
+			printf("writes %u, skipped %u, errors %u, missed %u, "
+				   "latency %d/%d/%d ms (min/avg/max)\n",
+				   (unsigned int)stats.writeCnt, (unsigned int)stats.skipCnt,
+				   (unsigned int)stats.errCnt, (unsigned int)stats.missCnt,
+				   (int)stats.latMin, (int)stats.latAvg, (int)stats.latMax);
+		}
+	} while (UOS_KeyPressed() == -1);
+
+	SMB2SHC_TempRefresh_Stop(&trefHdl);
+}
+
+/****************************************************************************/
+/** Transition callback for the power-fail monitor
+*
+*  \param cb_arg    \IN  unused
+*  \param events    \IN  SMB2_SHC_MON_EV_xxx events
+*  \param state     \IN  new state
+*  \param prev      \IN  previous state
+*/
+static void monitor_cb(void *cb_arg, u_int32 events,
+					   struct shc_mon_state *state,
+					   struct shc_mon_state *prev)
+{
+	int i;
+
+	printf("%u ms: events 0x%03x\n", (unsigned int)state->tstamp,
+		   (unsigned int)events);
+
+	if (state->err) {
+		PrintError("  status read", state->err);
+		return;
+	}
+
+	for (i = 0; i < SMB2_SHC_PSU_NUM; i++)
+		print_psu(i, &state->psu[i]);
+	for (i = 0; i < SMB2_SHC_FAN_NUM; i++)
+		print_fan(i, &state->fan[i]);
+	for (i = 0; i < SMB2_SHC_UPS_NUM; i++)
+		print_ups(i, &state->ups[i]);
+}
+
+/****************************************************************************/
+/** Monitor PSU, FAN and UPS transitions
+*
+*  \param period    \IN  fastest poll period [ms]
+*/
+static void monitor(u_int32 period)
+{
+	int err;
+	void *monHdl;
+	struct shc_mon_stats stats;
+
+	err = SMB2SHC_Monitor_Start(period, period * 16, SMB2_SHC_MON_EV_ALL,
+								monitor_cb, NULL, &monHdl);
+	if (err) {
+		PrintError("***ERROR: SMB2SHC_MONITOR_START", err);
+		return;
+	}
+
+	printf("Monitor PSU, FAN and UPS - Press any key to abort\n");
+
+	do {
+		UOS_Delay(100);
+	} while (UOS_KeyPressed() == -1);
+
+	SMB2SHC_Monitor_GetStats(monHdl, &stats);
+	SMB2SHC_Monitor_Stop(&monHdl);
+
+	printf("polls %u, errors %u, transitions %u, period %u ms, "
+		   "latency %d/%d/%d ms (min/avg/max)\n",
+		   (unsigned int)stats.pollCnt, (unsigned int)stats.errCnt,
+		   (unsigned int)stats.evCnt, (unsigned int)stats.period,
+		   (int)stats.latMin, (int)stats.latAvg, (int)stats.latMax);
+}
+
 /****************************************************************************/
 /** Set ambient temperature
 *
@@ -567,17 +689,29 @@ static void print_configdata()
 */
 static void get_psu_state(u_int32 psu_nbr)
 {
-	int i;
+	int i, err;
+	struct shc_psu shc_psu_state[SMB2_SHC_PSU_NUM];
 
 	printf("Power Supply Reporting:\n");
 
+	if (psu_nbr > SMB2_SHC_PSU_NUM) {
+		PrintError("***ERROR: SMB2SHC_GET_PSU:", SMB2_SHC_ID_NA);
+		return;
+	}
+
+	err = SMB2SHC_GetAllPSU(shc_psu_state);
+	if (err) {
+		PrintError("***ERROR: SMB2SHC_GET_PSU:", err);
+		return;
+	}
+
 	if (psu_nbr == 0) {
 		for (i = SHC_PSU1; i <= SHC_PSU3; i++) {
-			print_psu(i);
+			print_psu(i, &shc_psu_state[i]);
 		}
 	}
 	else
-		print_psu(psu_nbr - 1);
+		print_psu(psu_nbr - 1, &shc_psu_state[psu_nbr - 1]);
 }
 
 /****************************************************************************/
@@ -587,17 +721,29 @@ static void get_psu_state(u_int32 psu_nbr)
 */
 static void get_ups_state(u_int32 ups_nbr)
 {
-	int i;
+	int i, err;
+	struct shc_ups shc_ups_state[SMB2_SHC_UPS_NUM];
 
 	printf("Uninterruptible Power Supply Reporting:\n");
 
+	if (ups_nbr > SMB2_SHC_UPS_NUM) {
+		PrintError("***ERROR: SMB2SHC_GET_UPS:", SMB2_SHC_ID_NA);
+		return;
+	}
+
+	err = SMB2SHC_GetAllUPS(shc_ups_state);
+	if (err) {
+		PrintError("***ERROR: SMB2SHC_GET_UPS:", err);
+		return;
+	}
+
 	if (ups_nbr == 0) {
 		for (i=SHC_UPS1; i<=SHC_UPS2; i++) {
-			print_ups(i);
+			print_ups(i, &shc_ups_state[i]);
 		}
 	}
 	else
-		print_ups(ups_nbr - 1);
+		print_ups(ups_nbr - 1, &shc_ups_state[ups_nbr - 1]);
 }
 
 /****************************************************************************/
@@ -607,17 +753,29 @@ static void get_ups_state(u_int32 ups_nbr)
 */
 static void get_fan_state(u_int32 fan_nbr)
 {
-	int i;
+	int i, err;
+	struct shc_fan shc_fan_state[SMB2_SHC_FAN_NUM];
 
 	printf("Fan Status Reporting:\n");
 
+	if (fan_nbr > SMB2_SHC_FAN_NUM) {
+		PrintError("***ERROR: SMB2SHC_GET_FAN:", SMB2_SHC_ID_NA);
+		return;
+	}
+
+	err = SMB2SHC_GetAllFans(shc_fan_state);
+	if (err) {
+		PrintError("***ERROR: SMB2SHC_GET_FAN:", err);
+		return;
+	}
+
 	if (fan_nbr == 0) {
 		for (i=SHC_FAN1; i<=SHC_FAN3; i++) {
-			print_fan(i);
+			print_fan(i, &shc_fan_state[i]);
 		}
 	}
 	else
-		print_fan(fan_nbr - 1);
+		print_fan(fan_nbr - 1, &shc_fan_state[fan_nbr - 1]);
 }
 
 /****************************************************************************/
@@ -662,3 +820,37 @@ static void PrintError(char *info, int32 errCode)
 	printf("%s: %s\n", info, SMB2SHC_Errstring(errCode, errMsg));
 }
 
+/****************************************************************************/
+/** Get and print a status snapshot
+*
+*/
+static void print_snapshot()
+{
+	int err, i;
+	struct shc_snapshot snapshot;
+
+	err = SMB2SHC_GetSnapshot(&snapshot);
+	if (err) {
+		PrintError("***ERROR: SMB2SHC_GET_SNAPSHOT", err);
+		return;
+	}
+
+	printf("Status Snapshot at %u ms (bus time %u ms):\n",
+		   (unsigned int)snapshot.tstamp, (unsigned int)snapshot.bus_time);
+	printf("-----------------------------------------\n");
+	printf("Temperature: %dK (%dC)%s\n", snapshot.tempK,
+		   snapshot.tempK - ABS_ZERO,
+		   snapshot.tempOverride ? " overridden by host" : "");
+
+	for (i = SHC_PSU1; i <= SHC_PSU3; i++)
+		print_psu(i, &snapshot.psu[i]);
+	for (i = SHC_FAN1; i <= SHC_FAN3; i++)
+		print_fan(i, &snapshot.fan[i]);
+	for (i = SHC_UPS1; i <= SHC_UPS2; i++)
+		print_ups(i, &snapshot.ups[i]);
+
+	printf("-----------------------------------------\n");
+	for (i = SHC_PWR_MON_1; i <= SHC_PWR_MON_4; i++)
+		printf("PWR_MON %d Voltage Level in mV:\t\t%d\n", i + 1,
+			   snapshot.volt[i]);
+}
@@ -0,0 +1,420 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************/
+/*!
+ *        \file  dfu_image.c
+ *
+ *      \author  quoc.bui@men.de
+ *
+ *       \brief  DfuSe image file access
+ *
+ *               The file is mapped into memory (read into a buffer on
+ *               Windows), its suffix and CRC are checked and the target
+ *               and element tables are built. Element data is not copied,
+ *               it points into the file buffer.
+ *
+ *               File layout (all values little endian):
+ *               - prefix: "DfuSe", version, image size, number of targets
+ *               - per target: "Target", alternate setting, named flag,
+ *                 name, target size, number of elements, elements
+ *               - per element: address, size, data
+ *               - suffix: device, product, vendor, DFU version, "UFD",
+ *                 suffix length, CRC
+ *
+ *    \switches  WINNT
+ *
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2014-2019, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* still using deprecated sscanf, sprintf,.. */
+#ifdef WINNT
+#pragma warning(disable:4996)
+#endif
+
+/*-------------------------------------+
+|   INCLUDES                           |
++-------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#ifndef WINNT
+# include <fcntl.h>
+# include <unistd.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+#endif
+
+#include <MEN/men_typs.h>
+#include "dfu_image.h"
+
+/*-------------------------------------+
+|   DEFINES                            |
++-------------------------------------*/
+#define DFU_PREFIX_LEN       11
+#define DFU_SUFFIX_LEN       16
+#define DFU_TARGET_LEN       274
+#define DFU_ELEM_LEN         8
+
+#define DFU_CRC_POLY         0xedb88320
+
+/*-------------------------------------+
+|   MACROS                             |
++-------------------------------------*/
+#define GET_LE16(p)  ((u_int16)((p)[0] | ((p)[1] << 8)))
+#define GET_LE32(p)  ((u_int32)(p)[0] | ((u_int32)(p)[1] << 8) | \
+					  ((u_int32)(p)[2] << 16) | ((u_int32)(p)[3] << 24))
+
+/*-------------------------------------+
+|   GLOBALS                            |
++-------------------------------------*/
+/* slicing-by-8 CRC tables, built on first use */
+static u_int32 G_crcTbl[8][256];
+static int G_crcTblInit;
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+static void CrcTblInit(void);
+static int32 FileLoad(char *fileName, DFU_IMAGE *img);
+static int32 Parse(DFU_IMAGE *img);
+
+/****************************************************************************/
+/** Open and check a DfuSe file
+*
+*  \param fileName    \IN   name of the dfu file
+*  \param imgP        \OUT  image handle, release with DFU_Close()
+*
+*  \return            DFU_ERR_NO or DFU_ERR_xxx error code
+*/
+int32 DFU_Open(char *fileName, DFU_IMAGE **imgP)
+{
+	DFU_IMAGE *img;
+	int32 err;
+
+	*imgP = NULL;
+
+	img = (DFU_IMAGE*)malloc(sizeof(DFU_IMAGE));
+	if (!img)
+		return DFU_ERR_NO_MEM;
+	memset(img, 0, sizeof(DFU_IMAGE));
+
+	err = FileLoad(fileName, img);
+	if (!err)
+		err = Parse(img);
+	if (err) {
+		DFU_Close(&img);
+		return err;
+	}
+
+	*imgP = img;
+
+	return DFU_ERR_NO;
+}
+
+/****************************************************************************/
+/** Release a DfuSe file
+*
+*  Element data of the image must not be used afterwards.
+*
+*  \param imgP    \INOUT  image handle, set to NULL
+*/
+void DFU_Close(DFU_IMAGE **imgP)
+{
+	DFU_IMAGE *img = *imgP;
+	u_int32 i;
+
+	if (!img)
+		return;
+
+	if (img->target) {
+		for (i = 0; i < img->targetNum; i++)
+			free(img->target[i].elem);
+		free(img->target);
+	}
+
+	if (img->buf) {
+#ifndef WINNT
+		if (img->mapped)
+			munmap(img->buf, img->size);
+		else
+#endif
+			free(img->buf);
+	}
+
+	free(img);
+	*imgP = NULL;
+}
+
+/****************************************************************************/
+/** Get a chunk of element data
+*
+*  \param elem      \IN   element
+*  \param offset    \IN   offset in the element data
+*  \param maxLen    \IN   max. chunk length
+*  \param lenP      \OUT  chunk length (0 at the end of the element)
+*
+*  \return          pointer to the chunk in the file buffer
+*/
+const u_int8 *DFU_ElemChunk(const DFU_ELEMENT *elem, u_int32 offset,
+							u_int32 maxLen, u_int32 *lenP)
+{
+	if (offset >= elem->size) {
+		*lenP = 0;
+		return elem->data + elem->size;
+	}
+
+	*lenP = elem->size - offset > maxLen ? maxLen : elem->size - offset;
+
+	return elem->data + offset;
+}
+
+/****************************************************************************/
+/** Update a CRC32 (DfuSe/Ethernet polynomial)
+*
+*  Processes 8 bytes per step with the slicing-by-8 method. The CRC is
+*  neither pre- nor post-inverted, a DfuSe file CRC starts with
+*  0xffffffff.
+*
+*  \param crc     \IN  CRC so far
+*  \param data    \IN  data
+*  \param len     \IN  number of bytes
+*
+*  \return        updated CRC
+*/
+u_int32 DFU_Crc32(u_int32 crc, const u_int8 *data, u_int32 len)
+{
+	u_int32 one, two;
+
+	if (!G_crcTblInit)
+		CrcTblInit();
+
+	while (len >= 8) {
+		one = crc ^ GET_LE32(data);
+		two = GET_LE32(data + 4);
+		crc = G_crcTbl[7][one & 0xff] ^
+			  G_crcTbl[6][(one >> 8) & 0xff] ^
+			  G_crcTbl[5][(one >> 16) & 0xff] ^
+			  G_crcTbl[4][one >> 24] ^
+			  G_crcTbl[3][two & 0xff] ^
+			  G_crcTbl[2][(two >> 8) & 0xff] ^
+			  G_crcTbl[1][(two >> 16) & 0xff] ^
+			  G_crcTbl[0][two >> 24];
+		data += 8;
+		len -= 8;
+	}
+
+	while (len--)
+		crc = G_crcTbl[0][(crc ^ *data++) & 0xff] ^ (crc >> 8);
+
+	return crc;
+}
+
+/****************************************************************************/
+/** Get the description of an error code
+*
+*  \param err    \IN  DFU_ERR_xxx error code
+*
+*  \return       error description
+*/
+char *DFU_ErrString(int32 err)
+{
+	switch (err) {
+	case DFU_ERR_NO:     return "no error";
+	case DFU_ERR_OPEN:   return "cannot open or read file";
+	case DFU_ERR_NO_MEM: return "out of memory";
+	case DFU_ERR_FORMAT: return "firmware file not supported or truncated";
+	case DFU_ERR_CRC:    return "corrupted file (wrong CRC)";
+	default:             return "unknown error";
+	}
+}
+
+/****************************************************************************/
+/** Build the CRC tables
+*
+*  Table 0 is the classic byte table, table n advances a byte by n more
+*  zero bytes.
+*/
+static void CrcTblInit(void)
+{
+	u_int32 i, j, c;
+
+	for (i = 0; i < 256; i++) {
+		c = i;
+		for (j = 0; j < 8; j++)
+			c = (c & 1) ? (c >> 1) ^ DFU_CRC_POLY : c >> 1;
+		G_crcTbl[0][i] = c;
+	}
+
+	for (i = 0; i < 256; i++)
+		for (j = 1; j < 8; j++)
+			G_crcTbl[j][i] = (G_crcTbl[j - 1][i] >> 8) ^
+				G_crcTbl[0][G_crcTbl[j - 1][i] & 0xff];
+
+	G_crcTblInit = 1;
+}
+
+/****************************************************************************/
+/** Map or read the file into memory
+*
+*  \param fileName    \IN     name of the dfu file
+*  \param img         \INOUT  image, buf and size are set
+*
+*  \return            DFU_ERR_NO or DFU_ERR_xxx error code
+*/
+static int32 FileLoad(char *fileName, DFU_IMAGE *img)
+{
+#ifdef WINNT
+	FILE *fileP;
+	long size;
+
+	if ((fileP = fopen(fileName, "rb")) == NULL)
+		return DFU_ERR_OPEN;
+
+	if (fseek(fileP, 0, SEEK_END) || (size = ftell(fileP)) <= 0) {
+		fclose(fileP);
+		return DFU_ERR_OPEN;
+	}
+	rewind(fileP);
+
+	img->buf = (u_int8*)malloc(size);
+	if (!img->buf) {
+		fclose(fileP);
+		return DFU_ERR_NO_MEM;
+	}
+
+	if (fread(img->buf, 1, size, fileP) != (size_t)size) {
+		fclose(fileP);
+		return DFU_ERR_OPEN;
+	}
+	fclose(fileP);
+
+	img->size = (u_int32)size;
+#else
+	int fd;
+	struct stat st;
+	void *map;
+
+	if ((fd = open(fileName, O_RDONLY)) < 0)
+		return DFU_ERR_OPEN;
+
+	if (fstat(fd, &st) || st.st_size <= 0) {
+		close(fd);
+		return DFU_ERR_OPEN;
+	}
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+		return DFU_ERR_OPEN;
+
+	img->buf = (u_int8*)map;
+	img->size = (u_int32)st.st_size;
+	img->mapped = 1;
+#endif
+
+	return DFU_ERR_NO;
+}
+
+/****************************************************************************/
+/** Check the file and build the target and element tables
+*
+*  \param img    \INOUT  image
+*
+*  \return       DFU_ERR_NO or DFU_ERR_xxx error code
+*/
+static int32 Parse(DFU_IMAGE *img)
+{
+	const u_int8 *buf = img->buf;
+	const u_int8 *suffix;
+	u_int32 off, end, t, e;
+	DFU_TARGET *tgt;
+	DFU_ELEMENT *elem;
+
+	if (img->size < DFU_PREFIX_LEN + DFU_SUFFIX_LEN)
+		return DFU_ERR_FORMAT;
+
+	/* suffix */
+	suffix = buf + img->size - DFU_SUFFIX_LEN;
+	if (memcmp(suffix + 8, "UFD", 3) || suffix[11] != DFU_SUFFIX_LEN)
+		return DFU_ERR_FORMAT;
+
+	img->device = GET_LE16(suffix);
+	img->productId = GET_LE16(suffix + 2);
+	img->vendorId = GET_LE16(suffix + 4);
+	img->crc = GET_LE32(suffix + 12);
+
+	if (DFU_Crc32(0xffffffff, buf, img->size - 4) != img->crc)
+		return DFU_ERR_CRC;
+
+	/* prefix */
+	end = img->size - DFU_SUFFIX_LEN;
+	if (memcmp(buf, "DfuSe", 5) || GET_LE32(buf + 6) != end)
+		return DFU_ERR_FORMAT;
+
+	img->targetNum = buf[10];
+	img->target = (DFU_TARGET*)calloc(img->targetNum ? img->targetNum : 1,
+									  sizeof(DFU_TARGET));
+	if (!img->target)
+		return DFU_ERR_NO_MEM;
+
+	/* targets */
+	off = DFU_PREFIX_LEN;
+	for (t = 0; t < img->targetNum; t++) {
+		tgt = &img->target[t];
+
+		if (end - off < DFU_TARGET_LEN || memcmp(buf + off, "Target", 6))
+			return DFU_ERR_FORMAT;
+
+		tgt->alt = buf[off + 6];
+		if (GET_LE32(buf + off + 7))
+			memcpy(tgt->name, buf + off + 11, DFU_TARGET_NAME_LEN);
+		tgt->name[DFU_TARGET_NAME_LEN] = '\0';
+
+		tgt->elemNum = GET_LE32(buf + off + 270);
+		off += DFU_TARGET_LEN;
+
+		/* each element needs at least its header */
+		if (tgt->elemNum > (end - off) / DFU_ELEM_LEN)
+			return DFU_ERR_FORMAT;
+
+		tgt->elem = (DFU_ELEMENT*)calloc(tgt->elemNum ? tgt->elemNum : 1,
+										 sizeof(DFU_ELEMENT));
+		if (!tgt->elem)
+			return DFU_ERR_NO_MEM;
+
+		/* elements */
+		for (e = 0; e < tgt->elemNum; e++) {
+			elem = &tgt->elem[e];
+
+			if (end - off < DFU_ELEM_LEN)
+				return DFU_ERR_FORMAT;
+
+			elem->address = GET_LE32(buf + off);
+			elem->size = GET_LE32(buf + off + 4);
+			off += DFU_ELEM_LEN;
+
+			if (elem->size > end - off)
+				return DFU_ERR_FORMAT;
+
+			elem->data = buf + off;
+			off += elem->size;
+		}
+	}
+
+	return DFU_ERR_NO;
+}
@@ -0,0 +1,97 @@
+/***********************  I n c l u d e  -  F i l e  ************************/
+/*!
+ *        \file  dfu_image.h
+ *
+ *      \author  quoc.bui@men.de
+ *
+ *       \brief  DfuSe image file access
+ *
+ *    \switches  WINNT
+ */
+/*
+ *---------------------------------------------------------------------------
+ * Copyright 2014-2019, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _DFU_IMAGE_H
+#define _DFU_IMAGE_H
+
+#ifdef __cplusplus
+      extern "C" {
+#endif
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+/* error codes */
+#define DFU_ERR_NO           0
+#define DFU_ERR_OPEN         1   /**< cannot open or read file */
+#define DFU_ERR_NO_MEM       2   /**< cannot allocate memory */
+#define DFU_ERR_FORMAT       3   /**< not a DfuSe file or file truncated */
+#define DFU_ERR_CRC          4   /**< CRC of the file is wrong */
+
+#define DFU_TARGET_NAME_LEN  255
+
+/*--------------------------------------+
+|   TYPEDEFS                            |
++--------------------------------------*/
+/** image element: data for one memory area */
+typedef struct
+{
+	u_int32 address;       /**< start address in the target memory */
+	u_int32 size;          /**< number of data bytes */
+	const u_int8 *data;    /**< data, points into the file buffer */
+}DFU_ELEMENT;
+
+/** target: image for one alternate setting */
+typedef struct
+{
+	u_int8 alt;            /**< alternate setting */
+	char name[DFU_TARGET_NAME_LEN + 1];	/**< target name ("" if unnamed) */
+	u_int32 elemNum;       /**< number of elements */
+	DFU_ELEMENT *elem;     /**< elements */
+}DFU_TARGET;
+
+/** DfuSe file */
+typedef struct
+{
+	u_int8 *buf;           /**< file content */
+	u_int32 size;          /**< file size */
+	int mapped;            /**< buf is mapped, not allocated */
+	u_int32 crc;           /**< CRC of the file (from suffix) */
+	u_int16 vendorId;      /**< USB vendor ID (from suffix) */
+	u_int16 productId;     /**< USB product ID (from suffix) */
+	u_int16 device;        /**< device release number (from suffix) */
+	u_int32 targetNum;     /**< number of targets */
+	DFU_TARGET *target;    /**< targets */
+}DFU_IMAGE;
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+int32 DFU_Open(char *fileName, DFU_IMAGE **imgP);
+void DFU_Close(DFU_IMAGE **imgP);
+const u_int8 *DFU_ElemChunk(const DFU_ELEMENT *elem, u_int32 offset,
+							u_int32 maxLen, u_int32 *lenP);
+u_int32 DFU_Crc32(u_int32 crc, const u_int8 *data, u_int32 len);
+char *DFU_ErrString(int32 err);
+
+#ifdef __cplusplus
+      }
+#endif
+
+#endif /* _DFU_IMAGE_H */
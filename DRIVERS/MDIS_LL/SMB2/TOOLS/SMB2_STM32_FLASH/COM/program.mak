@@ -38,9 +38,11 @@ MAK_INCL=$(MEN_INC_DIR)/men_typs.h  \
          $(MEN_INC_DIR)/usr_oss.h   \
          $(MEN_INC_DIR)/smb2_api.h  \
          $(MEN_INC_DIR)/smb2.h      \
-         $(MEN_INC_DIR)/mdis_err.h
+         $(MEN_INC_DIR)/mdis_err.h  \
+         $(MEN_MOD_DIR)/dfu_image.h
 
 MAK_INP1=smb2_stm32_flash$(INP_SUFFIX)
+MAK_INP2=dfu_image$(INP_SUFFIX)
 
-MAK_INP=$(MAK_INP1)
+MAK_INP=$(MAK_INP1) $(MAK_INP2)
 
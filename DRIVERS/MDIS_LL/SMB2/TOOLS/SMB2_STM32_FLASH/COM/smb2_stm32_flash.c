@@ -11,6 +11,7 @@
 *        \brief  Tool to flash the STM32 Microcontroller via the SMB2_API.
 *
 *      Required: libraries: mdis_api, usr_oss, usr_utl, smb2_api
+*                module dfu_image
 *
 *
 *---------------------------------------------------------------------------
@@ -49,6 +50,7 @@
 #include <MEN/usr_oss.h>
 #include <MEN/usr_utl.h>
 #include <MEN/smb2_api.h>
+#include "dfu_image.h"
 
 static const char IdentString[]=MENT_XSTR(MAK_REVISION);
 
@@ -56,7 +58,17 @@ static const char IdentString[]=MENT_XSTR(MAK_REVISION);
 |   DEFINES                            |
 +-------------------------------------*/
 #define MAX_ZEICHEN          32
-#define DATA_OFFSET          293
+
+/* number of write chunks (MAX_ZEICHEN bytes) per transaction group */
+#define GRP_CHUNKS           16
+/* max. transfers per chunk: set address, status, write, status */
+#define GRP_XFER_PER_CHUNK   4
+
+/* wait time after erasing one page [ms] */
+#define ERASE_PAGE_DELAY     50
+
+/* suffix of the progress file of a differential download */
+#define PROGRESS_SUFFIX      ".prg"
 
 /* bootloader command codes */
 #define BTL_SETADDR_OPCODE   0x10
@@ -86,82 +98,41 @@ static const char IdentString[]=MENT_XSTR(MAK_REVISION);
 #define BYTE2                0x30
 #define BYTE3                0xC0
 
-/*-------------------------------------+
-|   MACROS                             |
-+-------------------------------------*/
-/* for dfu CRC check */
-#define _crc(accum,delta) \
-((accum) = _crctbl[((accum) ^ (delta)) & 0xff] ^ ((accum) >> 8))
-
 /*-------------------------------------+
 |   GLOBALS                            |
 +-------------------------------------*/
 /* SMB2 Handle */
 void *SMB2BTL_smbHdl;
 
-/* CRC table */
-unsigned long _crctbl[] = {
-	0x00000000, 0x77073096, 0xee0e612c, 0x990951ba, 0x076dc419, 0x706af48f,
-	0xe963a535, 0x9e6495a3, 0x0edb8832, 0x79dcb8a4, 0xe0d5e91e, 0x97d2d988,
-	0x09b64c2b, 0x7eb17cbd, 0xe7b82d07, 0x90bf1d91, 0x1db71064, 0x6ab020f2,
-	0xf3b97148, 0x84be41de, 0x1adad47d, 0x6ddde4eb, 0xf4d4b551, 0x83d385c7,
-	0x136c9856, 0x646ba8c0, 0xfd62f97a, 0x8a65c9ec, 0x14015c4f, 0x63066cd9,
-	0xfa0f3d63, 0x8d080df5, 0x3b6e20c8, 0x4c69105e, 0xd56041e4, 0xa2677172,
-	0x3c03e4d1, 0x4b04d447, 0xd20d85fd, 0xa50ab56b, 0x35b5a8fa, 0x42b2986c,
-	0xdbbbc9d6, 0xacbcf940, 0x32d86ce3, 0x45df5c75, 0xdcd60dcf, 0xabd13d59,
-	0x26d930ac, 0x51de003a, 0xc8d75180, 0xbfd06116, 0x21b4f4b5, 0x56b3c423,
-	0xcfba9599, 0xb8bda50f, 0x2802b89e, 0x5f058808, 0xc60cd9b2, 0xb10be924,
-	0x2f6f7c87, 0x58684c11, 0xc1611dab, 0xb6662d3d, 0x76dc4190, 0x01db7106,
-	0x98d220bc, 0xefd5102a, 0x71b18589, 0x06b6b51f, 0x9fbfe4a5, 0xe8b8d433,
-	0x7807c9a2, 0x0f00f934, 0x9609a88e, 0xe10e9818, 0x7f6a0dbb, 0x086d3d2d,
-	0x91646c97, 0xe6635c01, 0x6b6b51f4, 0x1c6c6162, 0x856530d8, 0xf262004e,
-	0x6c0695ed, 0x1b01a57b, 0x8208f4c1, 0xf50fc457, 0x65b0d9c6, 0x12b7e950,
-	0x8bbeb8ea, 0xfcb9887c, 0x62dd1ddf, 0x15da2d49, 0x8cd37cf3, 0xfbd44c65,
-	0x4db26158, 0x3ab551ce, 0xa3bc0074, 0xd4bb30e2, 0x4adfa541, 0x3dd895d7,
-	0xa4d1c46d, 0xd3d6f4fb, 0x4369e96a, 0x346ed9fc, 0xad678846, 0xda60b8d0,
-	0x44042d73, 0x33031de5, 0xaa0a4c5f, 0xdd0d7cc9, 0x5005713c, 0x270241aa,
-	0xbe0b1010, 0xc90c2086, 0x5768b525, 0x206f85b3, 0xb966d409, 0xce61e49f,
-	0x5edef90e, 0x29d9c998, 0xb0d09822, 0xc7d7a8b4, 0x59b33d17, 0x2eb40d81,
-	0xb7bd5c3b, 0xc0ba6cad, 0xedb88320, 0x9abfb3b6, 0x03b6e20c, 0x74b1d29a,
-	0xead54739, 0x9dd277af, 0x04db2615, 0x73dc1683, 0xe3630b12, 0x94643b84,
-	0x0d6d6a3e, 0x7a6a5aa8, 0xe40ecf0b, 0x9309ff9d, 0x0a00ae27, 0x7d079eb1,
-	0xf00f9344, 0x8708a3d2, 0x1e01f268, 0x6906c2fe, 0xf762575d, 0x806567cb,
-	0x196c3671, 0x6e6b06e7, 0xfed41b76, 0x89d32be0, 0x10da7a5a, 0x67dd4acc,
-	0xf9b9df6f, 0x8ebeeff9, 0x17b7be43, 0x60b08ed5, 0xd6d6a3e8, 0xa1d1937e,
-	0x38d8c2c4, 0x4fdff252, 0xd1bb67f1, 0xa6bc5767, 0x3fb506dd, 0x48b2364b,
-	0xd80d2bda, 0xaf0a1b4c, 0x36034af6, 0x41047a60, 0xdf60efc3, 0xa867df55,
-	0x316e8eef, 0x4669be79, 0xcb61b38c, 0xbc66831a, 0x256fd2a0, 0x5268e236,
-	0xcc0c7795, 0xbb0b4703, 0x220216b9, 0x5505262f, 0xc5ba3bbe, 0xb2bd0b28,
-	0x2bb45a92, 0x5cb36a04, 0xc2d7ffa7, 0xb5d0cf31, 0x2cd99e8b, 0x5bdeae1d,
-	0x9b64c2b0, 0xec63f226, 0x756aa39c, 0x026d930a, 0x9c0906a9, 0xeb0e363f,
-	0x72076785, 0x05005713, 0x95bf4a82, 0xe2b87a14, 0x7bb12bae, 0x0cb61b38,
-	0x92d28e9b, 0xe5d5be0d, 0x7cdcefb7, 0x0bdbdf21, 0x86d3d2d4, 0xf1d4e242,
-	0x68ddb3f8, 0x1fda836e, 0x81be16cd, 0xf6b9265b, 0x6fb077e1, 0x18b74777,
-	0x88085ae6, 0xff0f6a70, 0x66063bca, 0x11010b5c, 0x8f659eff, 0xf862ae69,
-	0x616bffd3, 0x166ccf45, 0xa00ae278, 0xd70dd2ee, 0x4e048354, 0x3903b3c2,
-	0xa7672661, 0xd06016f7, 0x4969474d, 0x3e6e77db, 0xaed16a4a, 0xd9d65adc,
-	0x40df0b66, 0x37d83bf0, 0xa9bcae53, 0xdebb9ec5, 0x47b2cf7f, 0x30b5ffe9,
-	0xbdbdf21c, 0xcabac28a, 0x53b39330, 0x24b4a3a6, 0xbad03605, 0xcdd70693,
-	0x54de5729, 0x23d967bf, 0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94,
-	0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d };
-
 /*--------------------------------------+
 |   PROTOTYPES                          |
 +--------------------------------------*/
-static int32 dfu_check(FILE *dfu_fileP);
-static int32 get_dfu_data(FILE *dfu_fileP, u_int8 *start_address, u_int32 *data_size);
+static int32 dfu_info(DFU_IMAGE *img);
 static int32 set_address(u_int8 *start_address);
 static int32 get_address(u_int8 *tmp_address);
-#if 0
-static int32 read_command(void);
-#endif
+static int32 read_chunks(void *grpHdl, u_int32 address, u_int8 *data,
+						 u_int32 size);
 static int32 write_command(u_int8 byte_count, u_int8 *data);
 static int32 erase_command(u_int8 page_count, u_int16 page_size);
+static int32 erase_page(u_int32 address);
 static int32 check_last_op(void);
 static int32 enter_bootloader(void);
 static int32 leave_bootloader(void);
 static int32 get_page_size(u_int16 *page_size);
-static int32 download_fw(FILE *dfu_fileP);
+static int32 write_chunks(void *grpHdl, u_int32 address, const u_int8 *data,
+						  u_int32 size, int autoinc);
+static void print_rate(u_int32 done, u_int32 total, u_int32 startTime);
+static int32 btl_prepare(const DFU_ELEMENT *elem, u_int16 *page_size);
+static int32 download_fw(const DFU_ELEMENT *elem, char *progName);
+static u_int32 progress_load(char *progName, char *deviceP, u_int32 crc,
+							 u_int32 start_32address, u_int16 page_size);
+static void progress_save(char *progName, char *deviceP, u_int32 crc,
+						  u_int32 start_32address, u_int16 page_size,
+						  u_int32 next_page);
+static int32 read_page(void *grpHdl, u_int32 address, u_int8 *data,
+					   u_int32 size);
+static int32 download_diff(const DFU_ELEMENT *elem, u_int32 crc,
+						   char *progName, char *deviceP);
 static int32 print_bootld_version(void);
 static void PrintError(char *info, int32 errCode);
 
@@ -190,12 +161,16 @@ static void usage(void)
 		"Options:\n"
 		"    devName    device name e.g. smb2_1     \n"
 		"    -f <file>  Download firmware           \n"
+		"    -d         With -f: read back each page, erase and \n"
+		"               write only changed pages and verify them.\n"
+		"               An interrupted download is resumed.     \n"
 		"    -e         Enter Bootloader            \n"
 		"    -l         Leave Bootloader            \n"
 		"    -r         Get Bootloader version      \n"
 		"\nAttention: Firmware must be a .dfu file! \n"
 		"\nCalling examples: \n"
 		"Download a firmware file: smb2_stm32_flash smb2_2 -f 14AF02-00.dfu \n"
+		"Update changed pages:     smb2_stm32_flash smb2_2 -f -d 14AF02-00.dfu \n"
 	);
     printf("\nCopyright 2014-2019, MEN Mikro Elektronik GmbH\n%s\n\n", IdentString);
 }
@@ -210,10 +185,12 @@ static void usage(void)
  */
 int main(int argc, char** argv)
 {
-	FILE *dfu_fileP;
+	DFU_IMAGE *img;
 	int i, ret=0, err=0;
 	char *errstr;
 	char *deviceP = NULL;
+	char *fileP = NULL;
+	char *progName = NULL;
 	char argbuf[100];
 
 	header();
@@ -221,7 +198,7 @@ int main(int argc, char** argv)
 	/*--------------------+
 	|  check arguments    |
 	+--------------------*/
-	errstr = UTL_ILLIOPT("?elfr", argbuf);
+	errstr = UTL_ILLIOPT("?delfr", argbuf);
 	if (errstr) {
 		printf("*** %s\n", errstr);
 		usage();
@@ -233,13 +210,15 @@ int main(int argc, char** argv)
 		return 1;
 	}
 
-	/*--------------------+
-	|  get SMBus device   |
-	+--------------------*/
+	/*-----------------------------+
+	|  get SMBus device and file   |
+	+-----------------------------*/
 	for (i=1; i<argc; i++) {
 		if (*argv[i] != '-') {
 			if (deviceP == NULL)
 				deviceP = argv[i];
+			else if (fileP == NULL)
+				fileP = argv[i];
 		}
 	}
 	if (!deviceP) {
@@ -280,15 +259,37 @@ int main(int argc, char** argv)
 	|  download firmware  |
 	+--------------------*/
 	if (UTL_TSTOPT("f")) {
-		if (argc < 4) {
+		if (fileP == NULL) {
 			printf("Not enough arguments.\n");
 			goto CLEANUP;
 		}
-		if ((dfu_fileP = fopen(argv[3], "rb")) == NULL) {
-			printf("***ERROR: cannot open %s file\n", argv[2]);
+		err = DFU_Open(fileP, &img);
+		if (err) {
+			printf("***ERROR: %s: %s\n", fileP, DFU_ErrString(err));
+			goto CLEANUP;
+		}
+
+		err = dfu_info(img);
+		if (err) {
+			DFU_Close(&img);
+			goto CLEANUP;
+		}
+
+		progName = (char*)malloc(strlen(fileP) + sizeof(PROGRESS_SUFFIX));
+		if (!progName) {
+			printf("***ERROR: cannot allocate memory\n");
+			DFU_Close(&img);
 			goto CLEANUP;
 		}
-		err = download_fw(dfu_fileP);
+		sprintf(progName, "%s%s", fileP, PROGRESS_SUFFIX);
+
+		if (UTL_TSTOPT("d"))
+			err = download_diff(&img->target[0].elem[0], img->crc, progName,
+								deviceP);
+		else
+			err = download_fw(&img->target[0].elem[0], progName);
+		free(progName);
+		DFU_Close(&img);
 
 		printf("-------------------------------------------------------\n");
 
@@ -321,140 +322,36 @@ EXIT:
 
 
 /****************************************************************************/
-/** Check DFU file
+/** Print the content of the DFU file
 *
-*  \param dfu_fileP    \IN    pointer to dfu file
+*  The firmware must be one target with one element.
 *
-*  \return             success (0) or error (-1)
-*/
-static int32 dfu_check(FILE *dfu_fileP)
-{
-	u_int8  buffer[100];
-	u_int32 filecrc, crc_check;
-	int i;
-
-	/* readout signature from file and compare it */
-	memset(buffer, '\0', sizeof(buffer));
-	if (fread(buffer, 1, 5, dfu_fileP) != 5) {
-		printf("***ERROR: DFU_CHECK: error in fread\n");
-		return -1;
-	}
-	printf("%s\n", buffer);
-	if (strncmp((char *)buffer, "DfuSe", 5)) {
-		printf("***ERROR: firmware file not supported\n");
-		return -1;
-	}
-
-	memset(buffer, '\0', sizeof(buffer));
-	fseek(dfu_fileP, 11, SEEK_SET);
-	if (fread(buffer, 1, 6, dfu_fileP) != 6) {
-		printf("***ERROR: DFU_CHECK: error in fread\n");
-		return -1;
-	}
-	printf("%s\n", buffer);
-	if (strncmp((char *)buffer, "Target", 6)) {
-		printf("***ERROR: firmware file not supported\n");
-		return -1;
-	}
-
-	memset(buffer, '\0', sizeof(buffer));
-	fseek(dfu_fileP, -8, SEEK_END);
-	if (fread(buffer, 1, 3, dfu_fileP) != 3) {
-		printf("***ERROR: DFU_CHECK: error in fread\n");
-		return -1;
-	}
-	printf("%s\n", buffer);
-	if (strncmp((char *)buffer, "UFD", 3)) {
-		printf("***ERROR: firmware file not supported\n");
-		return -1;
-	}
-
-	/* compute the CRC up to the last 4 bytes */
-	fseek(dfu_fileP, -4, SEEK_END);
-	i = ftell(dfu_fileP);
-	rewind(dfu_fileP);
-
-	filecrc = 0xffffffff;
-	for (; i; i--)
-		_crc(filecrc, (unsigned char)fgetc(dfu_fileP));
-
-	printf("Computed CRC: \t 0x%.8x\n", filecrc);
-
-	/* readout CRC from file*/
-	memset(buffer, '\0', sizeof(buffer));
-	fseek(dfu_fileP, -4, SEEK_END);
-	if (fread(buffer, 1, 4, dfu_fileP) != 4) {
-		printf("***ERROR: DFU_CHECK: error in fread\n");
-		return -1;
-	}
-
-	crc_check = (u_int32)buffer[0];
-	crc_check += (u_int32)buffer[1] << 8;
-	crc_check += (u_int32)buffer[2] << 16;
-	crc_check += (u_int32)buffer[3] << 24;
-
-	printf("File CRC: \t 0x%.8x\n", crc_check);
-
-	/* compare computed CRC and read CRC */
-	if (filecrc != crc_check){
-		printf("***ERROR: DFU_CHECK: Corrupted file\n");
-		return -1;
-	}
-
-	rewind(dfu_fileP);
-
-	return 0;
-}
-
-/****************************************************************************/
-/** Extract data information from DFU file
+*  \param img    \IN  dfu file
 *
-*  \param dfu_fileP        \IN   pointer to dfu file
-*  \param start_address    \OUT  start address of the firmware in the memory
-*  \param data_size        \OUT  size of the firmware
-*
-*  \return                 success (0) or error (-1)
+*  \return       success (0) or error (-1)
 */
-static int32 get_dfu_data(FILE *dfu_fileP, u_int8 *start_address, u_int32 *data_size)
+static int32 dfu_info(DFU_IMAGE *img)
 {
-	u_int8 data_size_buffer[4];
-	u_int8 buffer;
-
-	/*---------------------------------------+
-	|  extract start address                 |
-	|  ATTENTION: Little Endian format !     |
-	|             start_address[3] is MSB.   |
-	+---------------------------------------*/
-	fseek(dfu_fileP, 285, SEEK_SET);
-	if (fread(start_address, 1, 4, dfu_fileP) != 4) {
-		printf("***ERROR: GET_DFU_DATA: error in fread\n");
-		return -1;
+	u_int32 t, e;
+
+	printf("File CRC: \t 0x%.8x\n", img->crc);
+	printf("Vendor/Product ID: 0x%.4x/0x%.4x\n",
+		img->vendorId, img->productId);
+
+	for (t = 0; t < img->targetNum; t++) {
+		printf("Target %u (alt %d) %s\n", t, img->target[t].alt,
+			img->target[t].name);
+		for (e = 0; e < img->target[t].elemNum; e++)
+			printf("  Element %u: 0x%.8x, %u bytes\n", e,
+				img->target[t].elem[e].address, img->target[t].elem[e].size);
 	}
 
-	buffer = start_address[0];
-	start_address[0] = start_address[3];
-	start_address[3] = buffer;
-	buffer = start_address[1];
-	start_address[1] = start_address[2];
-	start_address[2] = buffer;
-
-	/*------------------------------------+
-	|  extract size of the data           |
-	|  ATTENTION: Little Endian format !  |
-	+------------------------------------*/
-	fseek(dfu_fileP, 289, SEEK_SET);
-	if (fread(data_size_buffer, 1, 4, dfu_fileP) != 4) {
-		printf("***ERROR: GET_DFU_DATA: error in fread\n");
+	if (img->targetNum != 1 || img->target[0].elemNum != 1) {
+		printf("***ERROR: firmware file not supported (needs 1 target "
+			"with 1 element)\n");
 		return -1;
 	}
 
-	*data_size  = (u_int32)data_size_buffer[0];
-	*data_size += (u_int32)data_size_buffer[1] << 8;
-	*data_size += (u_int32)data_size_buffer[2] << 16;
-	*data_size += (u_int32)data_size_buffer[3] << 24;
-
-	rewind(dfu_fileP);
-
 	return 0;
 }
 
@@ -506,35 +403,79 @@ static int32 get_address(u_int8 *tmp_address)
 }
 
 /****************************************************************************/
-/** Send read memory command - not used
+/** Read memory with one transaction group
 *
-*  \return    success (0) or error code
+*  The address of every chunk of MAX_ZEICHEN bytes is set before it is
+*  read with the read memory command.
+*
+*  \param grpHdl     \IN   transaction group handle
+*  \param address    \IN   flash address
+*  \param data       \OUT  read data
+*  \param size       \IN   number of bytes (max. GRP_CHUNKS * MAX_ZEICHEN)
+*
+*  \return           success (0) or error code
 */
-#if 0
-static int32 read_command()
+static int32 read_chunks(void *grpHdl, u_int32 address, u_int8 *data,
+						 u_int32 size)
 {
-	int err=0, i;
-	u_int8 length;
-	u_int8 data_buf[MAX_ZEICHEN];
+	int err = 0;
+	u_int32 i, n, off, len;
+	u_int8 chunk_address[GRP_CHUNKS][4];
+	u_int8 ack[GRP_CHUNKS];
+	u_int8 length[GRP_CHUNKS];
+	u_int8 data_buf[GRP_CHUNKS][MAX_ZEICHEN];
+
+	SMB2API_XferGroupReset(grpHdl);
+
+	n = (size + MAX_ZEICHEN - 1) / MAX_ZEICHEN;
+	memset(ack, 0, sizeof(ack));
+	memset(length, 0, sizeof(length));
+
+	for (i = 0; i < n && !err; i++) {
+		off = i * MAX_ZEICHEN;
+		chunk_address[i][0] = (u_int8)((address + off) >> 24);
+		chunk_address[i][1] = (u_int8)((address + off) >> 16);
+		chunk_address[i][2] = (u_int8)((address + off) >> 8);
+		chunk_address[i][3] = (u_int8)(address + off);
+
+		err = SMB2API_XferGroupAddWriteBlockData(grpHdl, STM32_SMBFLAGS,
+					CRC_BTL_SMBADDR, BTL_SETADDR_OPCODE,
+					MEMORY_ADDR_LENGTH, chunk_address[i]);
+		if (!err)
+			err = SMB2API_XferGroupAddReadByteData(grpHdl, STM32_SMBFLAGS,
+					CRC_BTL_SMBADDR, BTL_LASTOP_OPCODE, &ack[i]);
+		if (!err)
+			err = SMB2API_XferGroupAddReadBlockData(grpHdl, STM32_SMBFLAGS,
+					CRC_BTL_SMBADDR, BTL_READ_OPCODE, &length[i],
+					data_buf[i]);
+	}
 
-	err = SMB2API_ReadBlockData(SMB2BTL_smbHdl, STM32_SMBFLAGS, CRC_BTL_SMBADDR,
-								BTL_READ_OPCODE, &length, data_buf);
+	if (!err)
+		err = SMB2API_XferGroupCommit(grpHdl);
 	if (err) {
-		PrintError("***ERROR: READ_COMMAND:", err);
+		PrintError("***ERROR: READ_CHUNKS:", err);
 		return err;
 	}
 
-	printf("Number of read bytes: %d\n", length);
+	for (i = 0; i < n; i++) {
+		off = i * MAX_ZEICHEN;
+		len = size - off > MAX_ZEICHEN ? MAX_ZEICHEN : size - off;
 
-	for (i=0; i<length; i++) {
-		printf("%.x ", data_buf[i]);
-		if (((i+1)%8) == 0)
-			printf("\n");
+		if (ack[i] != BTL_ACK) {
+			printf("\n***ERROR: READ_CHUNKS: Set address failed at 0x%.8x\n",
+				   address + off);
+			return -1;
+		}
+		if (length[i] < len) {
+			printf("\n***ERROR: READ_CHUNKS: Wrong data length at 0x%.8x\n",
+				   address + off);
+			return -1;
+		}
+		memcpy(data + off, data_buf[i], len);
 	}
 
 	return 0;
 }
-#endif
 
 /****************************************************************************/
 /** Send write memory command
@@ -600,6 +541,42 @@ static int32 erase_command(u_int8 page_count, u_int16 page_size)
 	return 0;
 }
 
+/****************************************************************************/
+/** Erase one page
+*
+*  \param address    \IN  page address
+*
+*  \return           success (0) or error code
+*/
+static int32 erase_page(u_int32 address)
+{
+	int err=0;
+	u_int8 page_address[4];
+
+	page_address[0] = (u_int8)(address >> 24);
+	page_address[1] = (u_int8)(address >> 16);
+	page_address[2] = (u_int8)(address >> 8);
+	page_address[3] = (u_int8)address;
+
+	err = set_address(page_address);
+	if (err)
+		return err;
+	err = check_last_op();
+	if (err)
+		return err;
+
+	err = SMB2API_WriteByteData(SMB2BTL_smbHdl, STM32_SMBFLAGS, CRC_BTL_SMBADDR,
+									BTL_ERASE_OPCODE, 1);
+	if (err) {
+		PrintError("***ERROR: ERASE_PAGE:", err);
+		return err;
+	}
+
+	UOS_Delay(ERASE_PAGE_DELAY);
+
+	return check_last_op();
+}
+
 /****************************************************************************/
 /** Check the last operation
 *
@@ -713,30 +690,115 @@ static int32 get_page_size(u_int16 *page_size)
 }
 
 /***************************************************************************/
-/** Download firmware
+/** Write data with one transaction group
+*
+*  Every chunk of MAX_ZEICHEN bytes is written with the write command
+*  followed by a status read. Without address auto increment of the
+*  bootloader, the address of each chunk is set before. The status
+*  bytes are checked after the group has been executed.
+*
+*  \param grpHdl     \IN  transaction group handle
+*  \param address    \IN  flash address of the data
+*  \param data       \IN  data to be written
+*  \param size       \IN  number of bytes (max. GRP_CHUNKS * MAX_ZEICHEN)
+*  \param autoinc    \IN  bootloader increments the address after a write
+*
+*  \return           success (0) or error code
+*/
+static int32 write_chunks(void *grpHdl, u_int32 address, const u_int8 *data,
+						  u_int32 size, int autoinc)
+{
+	int err = 0;
+	u_int32 i, n, off, len;
+	u_int8 chunk_address[GRP_CHUNKS][4];
+	u_int8 ack[GRP_CHUNKS][2];
+
+	SMB2API_XferGroupReset(grpHdl);
+
+	n = (size + MAX_ZEICHEN - 1) / MAX_ZEICHEN;
+	memset(ack, 0, sizeof(ack));
+
+	for (i = 0, off = 0; i < n && !err; i++, off += MAX_ZEICHEN) {
+		len = size - off > MAX_ZEICHEN ? MAX_ZEICHEN : size - off;
+
+		if (!autoinc) {
+			chunk_address[i][0] = (u_int8)((address + off) >> 24);
+			chunk_address[i][1] = (u_int8)((address + off) >> 16);
+			chunk_address[i][2] = (u_int8)((address + off) >> 8);
+			chunk_address[i][3] = (u_int8)(address + off);
+
+			err = SMB2API_XferGroupAddWriteBlockData(grpHdl, STM32_SMBFLAGS,
+						CRC_BTL_SMBADDR, BTL_SETADDR_OPCODE,
+						MEMORY_ADDR_LENGTH, chunk_address[i]);
+			if (!err)
+				err = SMB2API_XferGroupAddReadByteData(grpHdl, STM32_SMBFLAGS,
+						CRC_BTL_SMBADDR, BTL_LASTOP_OPCODE, &ack[i][0]);
+		}
+		else {
+			ack[i][0] = BTL_ACK;
+		}
+
+		if (!err)
+			err = SMB2API_XferGroupAddWriteBlockData(grpHdl, STM32_SMBFLAGS,
+						CRC_BTL_SMBADDR, BTL_WRITE_OPCODE,
+						(u_int8)len, (u_int8*)data + off);
+		if (!err)
+			err = SMB2API_XferGroupAddReadByteData(grpHdl, STM32_SMBFLAGS,
+						CRC_BTL_SMBADDR, BTL_LASTOP_OPCODE, &ack[i][1]);
+	}
+
+	if (!err)
+		err = SMB2API_XferGroupCommit(grpHdl);
+	if (err) {
+		PrintError("***ERROR: WRITE_CHUNKS:", err);
+		return err;
+	}
+
+	for (i = 0; i < n; i++) {
+		if (ack[i][0] != BTL_ACK || ack[i][1] != BTL_ACK) {
+			printf("\n***ERROR: WRITE_CHUNKS: %s failed at 0x%.8x\n",
+				   ack[i][0] != BTL_ACK ? "Set address" : "Write",
+				   address + i * MAX_ZEICHEN);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/***************************************************************************/
+/** Print download progress and transfer rate
 *
-*  \param dfu_fileP    \IN  pointer to dfu file
+*  \param done         \IN  number of bytes written
+*  \param total        \IN  total number of bytes
+*  \param startTime    \IN  UOS_MsecTimerGet() at start of download
+*/
+static void print_rate(u_int32 done, u_int32 total, u_int32 startTime)
+{
+	u_int32 elapsed = UOS_MsecTimerGet() - startTime;
+
+	printf("\r%u/%u bytes, %u bytes/s   ", done, total,
+		   elapsed ? (u_int32)((double)done * 1000 / elapsed) : 0);
+	fflush(stdout);
+}
+
+/***************************************************************************/
+/** Prepare a download
+*
+*  Enters the bootloader, sets the operating address and gets the page
+*  size.
+*
+*  \param elem         \IN   firmware element of the dfu file
+*  \param page_size    \OUT  size of a page in the microcontroller
 *
 *  \return             success (0) or error code
 */
-static int32 download_fw(FILE *dfu_fileP)
+static int32 btl_prepare(const DFU_ELEMENT *elem, u_int16 *page_size)
 {
 	int err = 0, i;
-	int write_count;
-	u_int32 data_size;
-	u_int16 page_size = 0;
-	u_int8 page_count;
-	u_int8 byte_count;
 	u_int8 dum_byte;
-	u_int8 remainder;
 	u_int8 start_address[4];
 	u_int8 tmp_address[4];
-	u_int8 fw_data[MAX_ZEICHEN];
-	u_int32 start_32address;
-	u_int32 offset_address;
-
-	printf("Start Download Firmware\n");
-	printf("-------------------------------------------------------\n");
 
 	/* Check if we are in the bootloader */
 	err = SMB2API_ReadByteData(SMB2BTL_smbHdl, STM32_SMBFLAGS, CRC_BTL_SMBADDR,
@@ -753,19 +815,14 @@ static int32 download_fw(FILE *dfu_fileP)
 	else if (err)
 		return err;
 
-	/* Check dfu file */
-	err = dfu_check(dfu_fileP);
-	if (err)
-		return err;
-
-	/* Get start address and size of data */
-	err = get_dfu_data(dfu_fileP, start_address, &data_size);
-	if (err)
-		return err;
+	start_address[0] = (u_int8)(elem->address >> 24);
+	start_address[1] = (u_int8)(elem->address >> 16);
+	start_address[2] = (u_int8)(elem->address >> 8);
+	start_address[3] = (u_int8)elem->address;
 
 	printf("The flash address shall be 0x%.2x%.2x%.2x%.2x.\n", 
 		start_address[0], start_address[1], start_address[2], start_address[3]);
-	printf("The size of the data is %d bytes.\n", data_size);
+	printf("The size of the data is %d bytes.\n", elem->size);
 
 	/* Set operating address */
 	err = set_address(start_address);
@@ -800,17 +857,62 @@ static int32 download_fw(FILE *dfu_fileP)
 	}
 
 	/* Get page size */
-	err = get_page_size(&page_size);
+	err = get_page_size(page_size);
 	if (err)
 		return err;
 
-	printf("Size of a page: %d bytes\n", page_size);
+	printf("Size of a page: %d bytes\n", *page_size);
 
 	err = check_last_op();
 	if (err)
 		return err;
 
+	return 0;
+}
+
+/***************************************************************************/
+/** Download firmware
+*
+*  The first chunk is written to the start address, then the operating
+*  address is read back to check if the bootloader increments the
+*  address after a write. The rest of the data is written with one
+*  transaction group per GRP_CHUNKS chunks. The chunks are passed to
+*  the driver directly from the dfu file buffer.
+*
+*  The progress file of a former differential download is removed before
+*  the flash is erased, because its finished pages are lost then.
+*
+*  \param elem        \IN  firmware element of the dfu file
+*  \param progName    \IN  name of the progress file
+*
+*  \return            success (0) or error code
+*/
+static int32 download_fw(const DFU_ELEMENT *elem, char *progName)
+{
+	int err = 0;
+	int autoinc = 0;
+	u_int32 data_size, done, n;
+	u_int16 page_size = 0;
+	u_int8 page_count;
+	u_int8 tmp_address[4];
+	const u_int8 *chunk;
+	u_int32 start_32address;
+	u_int32 tmp_32address;
+	u_int32 startTime;
+	void *grpHdl;
+
+	printf("Start Download Firmware\n");
+	printf("-------------------------------------------------------\n");
+
+	err = btl_prepare(elem, &page_size);
+	if (err)
+		return err;
+
+	start_32address = elem->address;
+	data_size = elem->size;
+
 	/* Erase pages */
+	remove(progName);
 	page_count = (u_int8)((data_size / page_size) + 1);
 	err = erase_command(page_count, page_size);
 	if (err)
@@ -821,76 +923,300 @@ static int32 download_fw(FILE *dfu_fileP)
 	/*--------------+
 	| Flash memory  |
 	+--------------*/
-	start_32address  = (u_int32)start_address[0] << 24;
-	start_32address += (u_int32)start_address[1] << 16;
-	start_32address += (u_int32)start_address[2] << 8;
-	start_32address += (u_int32)start_address[3];
-	byte_count = MAX_ZEICHEN;
-
 	printf("Flash address: 0x%.8x\n", start_32address);
 	printf("Download firmware...\n");
 
-	write_count = data_size / MAX_ZEICHEN;
+	err = SMB2API_XferGroupBegin(SMB2BTL_smbHdl, 0,
+								 GRP_CHUNKS * GRP_XFER_PER_CHUNK, &grpHdl);
+	if (err) {
+		PrintError("***ERROR: DOWNLOAD_FW:", err);
+		return err;
+	}
 
-	for (i=0; i<write_count; i++) {
-		/* Copy data in buffer */
-		fseek(dfu_fileP, (DATA_OFFSET + i * MAX_ZEICHEN), SEEK_SET);
-		if (fread(fw_data, 1, MAX_ZEICHEN, dfu_fileP) != MAX_ZEICHEN) {
-			printf("***ERROR: DOWNLOAD_FW: error in fread\n");
-			return -1;
-		}
-		/* Set address */
-		offset_address = start_32address + i * MAX_ZEICHEN;
-		tmp_address[0] = (u_int8)(offset_address >> 24);
-		tmp_address[1] = (u_int8)(offset_address >> 16);
-		tmp_address[2] = (u_int8)(offset_address >> 8);
-		tmp_address[3] = (u_int8)offset_address;
-		err = set_address(tmp_address);
-		if (err)
-			return err;
-		err = check_last_op();
-		if (err)
-			return err;
-		/* Write data in memory */
-		err = write_command(byte_count, fw_data);
-		if (err)
-			return err;
-		err = check_last_op();
+	startTime = UOS_MsecTimerGet();
+
+	/* first chunk with explicit address */
+	chunk = DFU_ElemChunk(elem, 0, MAX_ZEICHEN, &done);
+	err = write_chunks(grpHdl, start_32address, chunk, done, 0);
+	if (err)
+		goto END;
+	print_rate(done, data_size, startTime);
+
+	/* check for address auto increment */
+	if (done < data_size) {
+		err = get_address(tmp_address);
 		if (err)
-			return err;
+			goto END;
+
+		tmp_32address  = (u_int32)tmp_address[0] << 24;
+		tmp_32address += (u_int32)tmp_address[1] << 16;
+		tmp_32address += (u_int32)tmp_address[2] << 8;
+		tmp_32address += (u_int32)tmp_address[3];
+		autoinc = (tmp_32address == start_32address + done);
+
+		printf("Address auto increment: %s\n", autoinc ? "yes" : "no");
 	}
 
-	remainder = (u_int8)(data_size - (write_count * MAX_ZEICHEN));
-	if (remainder != 0) {
-		/* Copy data in buffer */
-		fseek(dfu_fileP, (DATA_OFFSET + write_count * MAX_ZEICHEN), SEEK_SET);
-		if (fread(fw_data, 1, remainder, dfu_fileP) != remainder) {
-			printf("***ERROR: DOWNLOAD_FW: error in fread\n");
-			return -1;
-		}
+	while (done < data_size) {
+		chunk = DFU_ElemChunk(elem, done, GRP_CHUNKS * MAX_ZEICHEN, &n);
 
-		/* Set address */
-		offset_address = start_32address + write_count * MAX_ZEICHEN;
-		tmp_address[0] = (u_int8)(offset_address >> 24);
-		tmp_address[1] = (u_int8)(offset_address >> 16);
-		tmp_address[2] = (u_int8)(offset_address >> 8);
-		tmp_address[3] = (u_int8)offset_address;
-		err = set_address(tmp_address);
-		if (err)
-			return err;
-		err = check_last_op();
+		err = write_chunks(grpHdl, start_32address + done, chunk, n, autoinc);
 		if (err)
-			return err;
-		/* Write data in memory */
-		err = write_command(remainder, fw_data);
+			goto END;
+
+		done += n;
+		print_rate(done, data_size, startTime);
+	}
+	printf("\n");
+
+	/* the address must have followed the data */
+	if (autoinc) {
+		err = get_address(tmp_address);
 		if (err)
-			return err;
-		err = check_last_op();
+			goto END;
+
+		tmp_32address  = (u_int32)tmp_address[0] << 24;
+		tmp_32address += (u_int32)tmp_address[1] << 16;
+		tmp_32address += (u_int32)tmp_address[2] << 8;
+		tmp_32address += (u_int32)tmp_address[3];
+		if (tmp_32address != start_32address + data_size) {
+			printf("***ERROR: DOWNLOAD_FW: Operating address 0x%.8x, "
+				   "expected 0x%.8x\n", tmp_32address,
+				   start_32address + data_size);
+			err = -1;
+			goto END;
+		}
+	}
+
+END:
+	SMB2API_XferGroupEnd(&grpHdl);
+	if (err)
+		return err;
+
+	/* Leave bootloader */
+	err = leave_bootloader();
+	if (err)
+		return err;
+
+	return 0;
+}
+
+/***************************************************************************/
+/** Load the progress of an interrupted differential download
+*
+*  The progress file contains the SMB device, the SMBus address of the
+*  bootloader, the CRC of the DFU file, the flash address, the page size
+*  and the index of the next page. It is only used if all of them match
+*  the actual download.
+*
+*  \param progName           \IN  name of the progress file
+*  \param deviceP            \IN  SMB device name
+*  \param crc                \IN  CRC of the dfu file
+*  \param start_32address    \IN  flash address of the firmware
+*  \param page_size          \IN  size of a page in the microcontroller
+*
+*  \return                   index of the first page to be processed
+*/
+static u_int32 progress_load(char *progName, char *deviceP, u_int32 crc,
+							 u_int32 start_32address, u_int16 page_size)
+{
+	FILE *progP;
+	char device[100];
+	unsigned int smbaddr, filecrc, addr, psize, next;
+	int n;
+
+	if ((progP = fopen(progName, "r")) == NULL)
+		return 0;
+
+	n = fscanf(progP, "%99s %x %x %x %u %u", device, &smbaddr, &filecrc,
+			   &addr, &psize, &next);
+	fclose(progP);
+
+	if (n != 6 || strcmp(device, deviceP) || smbaddr != CRC_BTL_SMBADDR ||
+		filecrc != crc || addr != start_32address || psize != page_size)
+		return 0;
+
+	printf("Resume interrupted download at page %u.\n", next);
+
+	return next;
+}
+
+/***************************************************************************/
+/** Save the progress of a differential download
+*
+*  \param progName           \IN  name of the progress file
+*  \param deviceP            \IN  SMB device name
+*  \param crc                \IN  CRC of the dfu file
+*  \param start_32address    \IN  flash address of the firmware
+*  \param page_size          \IN  size of a page in the microcontroller
+*  \param next_page          \IN  index of the next page to be processed
+*/
+static void progress_save(char *progName, char *deviceP, u_int32 crc,
+						  u_int32 start_32address, u_int16 page_size,
+						  u_int32 next_page)
+{
+	FILE *progP;
+
+	if ((progP = fopen(progName, "w")) == NULL)
+		return;
+
+	fprintf(progP, "%s %02x %08x %08x %u %u\n", deviceP,
+			(unsigned int)CRC_BTL_SMBADDR, (unsigned int)crc,
+			(unsigned int)start_32address, (unsigned int)page_size,
+			(unsigned int)next_page);
+	fclose(progP);
+}
+
+/***************************************************************************/
+/** Read a page (or a part of it) in groups of GRP_CHUNKS chunks
+*
+*  \param grpHdl     \IN   transaction group handle
+*  \param address    \IN   flash address
+*  \param data       \OUT  read data
+*  \param size       \IN   number of bytes
+*
+*  \return           success (0) or error code
+*/
+static int32 read_page(void *grpHdl, u_int32 address, u_int8 *data,
+					   u_int32 size)
+{
+	int32 err = 0;
+	u_int32 done, n;
+
+	for (done = 0; !err && done < size; done += n) {
+		n = size - done > GRP_CHUNKS * MAX_ZEICHEN ?
+			GRP_CHUNKS * MAX_ZEICHEN : size - done;
+		err = read_chunks(grpHdl, address + done, data + done, n);
+	}
+
+	return err;
+}
+
+/***************************************************************************/
+/** Download only the changed pages of a firmware
+*
+*  Every page is read back and compared with the DFU file. Pages that
+*  differ are erased, written and verified by another read back. The
+*  index of the next page is saved in the progress file after each page,
+*  so an interrupted download continues behind the last finished page.
+*  The pages before it are compared at the end, because they may have
+*  been erased since (e.g. by a failed full download). The progress file
+*  is removed when the download is complete.
+*
+*  \param elem        \IN  firmware element of the dfu file
+*  \param crc         \IN  CRC of the dfu file
+*  \param progName    \IN  name of the progress file
+*  \param deviceP     \IN  SMB device name
+*
+*  \return            success (0) or error code
+*/
+static int32 download_diff(const DFU_ELEMENT *elem, u_int32 crc,
+						   char *progName, char *deviceP)
+{
+	int err = 0;
+	u_int32 data_size, i, page, page_num, first, off, len, done, n;
+	u_int32 start_32address, address;
+	u_int32 same = 0, written = 0;
+	u_int16 page_size = 0;
+	const u_int8 *page_data;
+	u_int8 *page_buf;
+	void *grpHdl;
+
+	printf("Start Differential Download Firmware\n");
+	printf("-------------------------------------------------------\n");
+
+	err = btl_prepare(elem, &page_size);
+	if (err)
+		return err;
+
+	start_32address = elem->address;
+	data_size = elem->size;
+
+	if (page_size == 0 || start_32address % page_size) {
+		printf("***ERROR: DOWNLOAD_DIFF: Address must be a multiple of %d "
+			   "(1 page)\n", page_size);
+		return -1;
+	}
+
+	page_num = (data_size + page_size - 1) / page_size;
+
+	first = progress_load(progName, deviceP, crc, start_32address, page_size);
+	if (first >= page_num)
+		first = 0;
+
+	page_buf = (u_int8*)malloc(page_size);
+	if (!page_buf) {
+		printf("***ERROR: DOWNLOAD_DIFF: cannot allocate memory\n");
+		return -1;
+	}
+
+	err = SMB2API_XferGroupBegin(SMB2BTL_smbHdl, 0,
+								 GRP_CHUNKS * GRP_XFER_PER_CHUNK, &grpHdl);
+	if (err) {
+		PrintError("***ERROR: DOWNLOAD_DIFF:", err);
+		free(page_buf);
+		return err;
+	}
+
+	/* start at the resume point, the skipped pages are compared last */
+	for (i = 0; i < page_num; i++) {
+		page = (first + i) % page_num;
+		off = page * page_size;
+		address = start_32address + off;
+		page_data = DFU_ElemChunk(elem, off, page_size, &len);
+
+		/* read back and compare */
+		err = read_page(grpHdl, address, page_buf, len);
 		if (err)
-			return err;
+			goto END;
+
+		if (memcmp(page_buf, page_data, len)) {
+			err = erase_page(address);
+			if (err)
+				goto END;
+
+			for (done = 0; done < len; done += n) {
+				n = len - done > GRP_CHUNKS * MAX_ZEICHEN ?
+					GRP_CHUNKS * MAX_ZEICHEN : len - done;
+				err = write_chunks(grpHdl, address + done, page_data + done,
+								   n, 0);
+				if (err)
+					goto END;
+			}
+
+			/* verify */
+			err = read_page(grpHdl, address, page_buf, len);
+			if (err)
+				goto END;
+
+			if (memcmp(page_buf, page_data, len)) {
+				printf("\n***ERROR: DOWNLOAD_DIFF: Verify failed at page %u "
+					   "(0x%.8x)\n", page, address);
+				err = -1;
+				goto END;
+			}
+			written++;
+		}
+		else {
+			same++;
+		}
+
+		progress_save(progName, deviceP, crc, start_32address, page_size,
+					  (page + 1) % page_num);
+
+		printf("\rPage %u/%u: %u unchanged, %u written   ",
+			   i + 1, page_num, same, written);
+		fflush(stdout);
 	}
+	printf("\n");
+
+	remove(progName);
 
-	rewind(dfu_fileP);
+END:
+	SMB2API_XferGroupEnd(&grpHdl);
+	free(page_buf);
+	if (err)
+		return err;
 
 	/* Leave bootloader */
 	err = leave_bootloader();
@@ -27,18 +27,25 @@ STAMPED_REVISION="13Y004-06_01_42-24-ge5f4d78-dirty_2019-05-30"
 DEF_REVISION=MAK_REVISION=$(STAMPED_REVISION)
 MAK_SWITCH=$(SW_PREFIX)$(DEF_REVISION)
 
+# stress test threads (smb2_os) use POSIX threads, clock_gettime
+# needs librt
 MAK_LIBS=$(LIB_PREFIX)$(MEN_LIB_DIR)/smb2_api$(LIB_SUFFIX)	\
 		 $(LIB_PREFIX)$(MEN_LIB_DIR)/usr_oss$(LIB_SUFFIX)	\
 		 $(LIB_PREFIX)$(MEN_LIB_DIR)/usr_utl$(LIB_SUFFIX)   \
 		 $(LIB_PREFIX)$(MEN_LIB_DIR)/mdis_api$(LIB_SUFFIX)	\
+		 -lpthread -lrt										\
 
 MAK_INCL=$(MEN_INC_DIR)/men_typs.h \
          $(MEN_INC_DIR)/usr_utl.h  \
          $(MEN_INC_DIR)/mdis_api.h \
          $(MEN_INC_DIR)/usr_oss.h  \
          $(MEN_INC_DIR)/smb2_api.h \
+         $(MEN_INC_DIR)/smb2_drv.h \
+         $(MEN_INC_DIR)/smb2_os.h  \
+         $(MEN_MOD_DIR)/smb2_test.h \
 
 
 MAK_INP1=smb2_test$(INP_SUFFIX)
+MAK_INP2=smb2_stress$(INP_SUFFIX)
 
-MAK_INP=$(MAK_INP1)
+MAK_INP=$(MAK_INP1) $(MAK_INP2)
@@ -0,0 +1,767 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************/
+/*!
+ *        \file  smb2_stress.c
+ *
+ *      \author  dieter.pfeuffer@men.de
+ *
+ *        \brief SMBus soak and stress test
+ *
+ *               Several threads, each with its own SMB2API handle, run a
+ *               weighted random mix of SMBus operations on a set of
+ *               addresses. Read data can be verified against a reference
+ *               read before the test, a scratch area of an EEPROM can be
+ *               written and read back with per-thread patterns.
+ *
+ *               Operations (-m=op[:weight],..):
+ *
+ *               q    QuickComm (write)
+ *               rb   ReadByte (not verified, data depends on device state)
+ *               rbd  ReadByteData \<cmd\>
+ *               rwd  ReadWordData \<cmd\>
+ *               rbk  ReadBlockData \<cmd\>
+ *               i2c  I2C write \<cmd\>, read 16 bytes
+ *               wv   WriteByteData to the scratch EEPROM, ACK polling,
+ *                    ReadByteData and compare
+ *
+ *               Devices don't tolerate every interleaving: another
+ *               transfer between the two messages of i2c moves the
+ *               address pointer, and an EEPROM NAKs everything during the
+ *               write cycle of wv. Therefore, if the mix contains i2c, all
+ *               operations on the same address are serialized, and wv
+ *               always runs exclusively on the scratch EEPROM. The bus is
+ *               still shared by all threads.
+ *
+ *               Per interval the throughput, errors and latency
+ *               percentiles are reported, at the end the errors by
+ *               error code and the latency histogram.
+ *
+ *     Switches: WINNT
+ */
+/*
+ *---------------------------------------------------------------------------
+ * Copyright 2016-2019, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "smb2_test.h"
+#include <MEN/smb2_drv.h>
+#include <MEN/smb2_os.h>
+
+#ifndef WINNT
+# include <time.h>
+#endif
+
+/* still using deprecated sscanf, sprintf,.. */
+#ifdef WINNT
+# pragma warning(disable:4996)
+#endif
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+#define SMB_FLAGS			0x0
+
+/* operations */
+#define OP_QUICK			0
+#define OP_RB				1
+#define OP_RBD				2
+#define OP_RWD				3
+#define OP_RBK				4
+#define OP_I2C				5
+#define OP_WV				6
+#define OP_NUM				7
+
+#define STRESS_I2C_LEN		16		/* i2c: read length */
+#define STRESS_WV_POLL		20		/* wv: max. write cycle time [ms] */
+#define STRESS_ERR_MAX		16		/* distinct error codes per thread */
+#define STRESS_HIST_NUM		24		/* latency buckets: <1us .. <2^22us,
+									   and longer */
+/* error code of a data mismatch */
+#define STRESS_ERR_VERIFY	(-1)
+
+/*--------------------------------------+
+|   TYPEDEFS                            |
++--------------------------------------*/
+/* operation definition */
+typedef struct {
+	char *name;
+	int  verify;			/* result can be verified */
+} STRESS_OPDEF;
+
+/* statistics, only written by the owning thread */
+typedef struct {
+	u_int32 ops;						/* executed operations */
+	u_int32 errs;						/* failed operations */
+	u_int32 verifyErrs;					/* data mismatches */
+	u_int32 opCnt[OP_NUM];				/* operations per type */
+	u_int32 opErr[OP_NUM];				/* errors per type */
+	u_int32 hist[STRESS_HIST_NUM];		/* latency histogram */
+	u_int32 latMax;						/* max. latency [us] */
+	double  latSum;						/* sum of latencies [us] */
+	u_int32 errNum;						/* entries in errCode[] */
+	int32   errCode[STRESS_ERR_MAX];	/* error codes */
+	u_int32 errCnt[STRESS_ERR_MAX];		/* occurrences per code */
+	u_int32 errOther;					/* errors not in errCode[] */
+} STRESS_STATS;
+
+/* reference data for verification */
+typedef struct {
+	int     valid;
+	u_int8  len;
+	u_int8  data[SMB_BLOCK_MAX_BYTES];
+} STRESS_REF;
+
+struct STRESS;
+
+/* worker thread */
+typedef struct {
+	struct STRESS  *s;			/* test */
+	u_int32        idx;			/* thread index */
+	u_int32        seed;		/* random generator */
+	u_int32        wvSeq;		/* wv: sequence number */
+	int32          initErr;		/* SMB2API_Init error */
+	STRESS_STATS   stats;
+	SMB2_OS_THREAD thread;
+	int            started;		/* thread started */
+} STRESS_WORKER;
+
+/* stress test */
+typedef struct STRESS {
+	STRESS_PARAMS *p;
+	u_int32       weight[OP_NUM];			/* operation mix */
+	u_int32       weightSum;
+	STRESS_REF    ref[OP_NUM][STRESS_ADDR_MAX];
+	u_int32       wvSlice;					/* wv: bytes per thread */
+	u_int32       wvIdx;					/* wv: lock index */
+	SMB2_OS_MUTEX lock[STRESS_ADDR_MAX+1];	/* per address, [MAX]=wv */
+	int           serialize[STRESS_ADDR_MAX+1];	/* use lock[] */
+	volatile int  stop;						/* stop request */
+	STRESS_WORKER worker[STRESS_THREAD_MAX];
+} STRESS;
+
+/*--------------------------------------+
+|   GLOBALS                             |
++--------------------------------------*/
+static const STRESS_OPDEF G_opDef[OP_NUM] = {
+	{ "q",   0 },
+	{ "rb",  0 },
+	{ "rbd", 1 },
+	{ "rwd", 1 },
+	{ "rbk", 1 },
+	{ "i2c", 1 },
+	{ "wv",  0 },	/* verified by itself */
+};
+
+/*-----------------------------------------+
+|  PROTOTYPES                              |
++-----------------------------------------*/
+static u_int32 UsecTimerGet( void );
+static u_int32 StressRand( u_int32 *seed );
+static int32 StressParseMix( STRESS *s );
+static int32 StressOp( STRESS_WORKER *w, void *smbHdl, int op, u_int8 addr,
+					   u_int8 *lenP, u_int8 *data );
+static void StressCount( STRESS_STATS *st, int op, int32 err, u_int32 lat );
+static void StressRun( STRESS_WORKER *w );
+static void StressSum( STRESS *s, STRESS_STATS *sum );
+static u_int32 StressPercentile( u_int32 *hist, u_int32 num, u_int32 pct );
+static void StressReport( STRESS *s, STRESS_STATS *sum );
+
+/**********************************************************************/
+/** Get a microsecond timestamp
+ *
+ *  The counter wraps after ~71 minutes, only differences are used.
+ *
+ *  \return timestamp [us]
+ */
+static u_int32 UsecTimerGet( void )
+{
+#ifdef WINNT
+	LARGE_INTEGER freq, cnt;
+
+	QueryPerformanceFrequency( &freq );
+	QueryPerformanceCounter( &cnt );
+	return (u_int32)((cnt.QuadPart / freq.QuadPart) * 1000000 +
+					 (cnt.QuadPart % freq.QuadPart) * 1000000 / freq.QuadPart);
+#else
+	struct timespec ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return (u_int32)ts.tv_sec * 1000000 + (u_int32)(ts.tv_nsec / 1000);
+#endif
+}
+
+/**********************************************************************/
+/** Per-thread random generator (rand() is not thread safe)
+ *
+ *  \param seed		generator state
+ *
+ *  \return random number 0..0x7fff
+ */
+static u_int32 StressRand( u_int32 *seed )
+{
+	*seed = *seed * 1103515245 + 12345;
+	return (*seed >> 16) & 0x7fff;
+}
+
+/**********************************************************************/
+/** Parse the operation mix "op[:weight],.."
+ *
+ *  \param s		stress test
+ *
+ *  \return 0=ok, or 1 on syntax error
+ */
+static int32 StressParseMix( STRESS *s )
+{
+	char    name[8], *mixP = s->p->mix;
+	u_int32 len, weight;
+	int     op;
+
+	while( *mixP ) {
+		len = (u_int32)strcspn( mixP, ":," );
+		if( !len || (len >= sizeof(name)) )
+			return 1;
+		strncpy( name, mixP, len );
+		name[len] = '\0';
+		mixP += len;
+
+		weight = 1;
+		if( *mixP == ':' ) {
+			if( sscanf( ++mixP, "%u", &weight ) != 1 )
+				return 1;
+			mixP += strcspn( mixP, "," );
+		}
+		if( *mixP == ',' )
+			mixP++;
+
+		for( op=0; op<OP_NUM; op++ )
+			if( !strcmp( name, G_opDef[op].name ) )
+				break;
+		if( op == OP_NUM ) {
+			printf( "*** unknown operation '%s'\n", name );
+			return 1;
+		}
+		s->weight[op] += weight;
+		s->weightSum += weight;
+	}
+
+	return s->weightSum ? 0 : 1;
+}
+
+/**********************************************************************/
+/** Execute one operation
+ *
+ *  \param w		worker
+ *  \param smbHdl	SMB2API handle
+ *  \param op		OP_xxx
+ *  \param addr		SMB address (ignored for OP_WV)
+ *  \param lenP		\OUT length of read data
+ *  \param data		\OUT read data (SMB_BLOCK_MAX_BYTES)
+ *
+ *  \return 0=ok, SMB2API error code or STRESS_ERR_VERIFY
+ */
+static int32 StressOp( STRESS_WORKER *w, void *smbHdl, int op, u_int8 addr,
+					   u_int8 *lenP, u_int8 *data )
+{
+	STRESS_PARAMS  *p = w->s->p;
+	SMB_I2CMESSAGE msg[2];
+	u_int16        word;
+	u_int8         offs, pattern, byte;
+	u_int32        start;
+	int32          err = 0;
+
+	*lenP = 0;
+
+	switch( op ) {
+	case OP_QUICK:
+		err = SMB2API_QuickComm( smbHdl, SMB_FLAGS, addr, SMB_WRITE );
+		break;
+	case OP_RB:
+		err = SMB2API_ReadByte( smbHdl, SMB_FLAGS, addr, data );
+		*lenP = 1;
+		break;
+	case OP_RBD:
+		err = SMB2API_ReadByteData( smbHdl, SMB_FLAGS, addr, p->cmd, data );
+		*lenP = 1;
+		break;
+	case OP_RWD:
+		err = SMB2API_ReadWordData( smbHdl, SMB_FLAGS, addr, p->cmd, &word );
+		data[0] = (u_int8)word;
+		data[1] = (u_int8)(word >> 8);
+		*lenP = 2;
+		break;
+	case OP_RBK:
+		err = SMB2API_ReadBlockData( smbHdl, SMB_FLAGS, addr, p->cmd,
+									 lenP, data );
+		break;
+	case OP_I2C:
+		msg[0].addr  = addr;
+		msg[0].flags = I2C_M_WR;
+		msg[0].len   = 1;
+		msg[0].buf   = &p->cmd;
+		msg[1].addr  = addr;
+		msg[1].flags = I2C_M_RD;
+		msg[1].len   = STRESS_I2C_LEN;
+		msg[1].buf   = data;
+		err = SMB2API_I2CXfer( smbHdl, msg, 2 );
+		*lenP = STRESS_I2C_LEN;
+		break;
+	case OP_WV:
+		/* each thread uses its own slice of the scratch area */
+		offs = (u_int8)(p->wvOffs + w->idx * w->s->wvSlice +
+						w->wvSeq % w->s->wvSlice);
+		pattern = (u_int8)(w->wvSeq ^ (w->idx << 5) ^ offs);
+		w->wvSeq++;
+
+		err = SMB2API_WriteByteData( smbHdl, SMB_FLAGS, p->wvAddr, offs,
+									 pattern );
+		if( err )
+			break;
+
+		/* ACK polling: EEPROM doesn't respond during write cycle */
+		start = UOS_MsecTimerGet();
+		do {
+			err = SMB2API_ReadByte( smbHdl, SMB_FLAGS, p->wvAddr, &byte );
+		} while( err && (UOS_MsecTimerGet() - start < STRESS_WV_POLL) );
+		if( err )
+			break;
+
+		err = SMB2API_ReadByteData( smbHdl, SMB_FLAGS, p->wvAddr, offs,
+									&byte );
+		if( !err && (byte != pattern) )
+			err = STRESS_ERR_VERIFY;
+		break;
+	}
+
+	return err;
+}
+
+/**********************************************************************/
+/** Add one operation to the statistics
+ *
+ *  \param st		statistics
+ *  \param op		OP_xxx
+ *  \param err		result of the operation
+ *  \param lat		latency [us]
+ */
+static void StressCount( STRESS_STATS *st, int op, int32 err, u_int32 lat )
+{
+	u_int32 b, i;
+
+	/* bucket b: 2^(b-1) <= lat < 2^b */
+	for( b=0; (b < STRESS_HIST_NUM-1) && (lat >> b); b++ )
+		;
+	st->hist[b]++;
+	st->latSum += lat;
+	if( lat > st->latMax )
+		st->latMax = lat;
+
+	st->opCnt[op]++;
+	st->ops++;
+
+	if( !err )
+		return;
+
+	st->opErr[op]++;
+	if( err == STRESS_ERR_VERIFY ) {
+		st->verifyErrs++;
+		return;
+	}
+
+	st->errs++;
+	for( i=0; i<st->errNum; i++ )
+		if( st->errCode[i] == err )
+			break;
+	if( i == st->errNum ) {
+		if( st->errNum == STRESS_ERR_MAX ) {
+			st->errOther++;
+			return;
+		}
+		st->errCode[st->errNum++] = err;
+	}
+	st->errCnt[i]++;
+}
+
+/**********************************************************************/
+/** Run operations until stop is requested
+ *
+ *  \param w		worker
+ */
+static void StressRun( STRESS_WORKER *w )
+{
+	STRESS     *s = w->s;
+	STRESS_REF *ref;
+	void       *smbHdl = NULL;
+	u_int8     len, data[SMB_BLOCK_MAX_BYTES];
+	u_int32    r, ai, li, start, lat;
+	int32      err;
+	int        op;
+
+	w->initErr = SMB2API_Init( s->p->device, &smbHdl );
+	if( w->initErr )
+		return;
+
+	while( !s->stop ) {
+		/* pick operation and address */
+		r = StressRand( &w->seed ) % s->weightSum;
+		for( op=0; r >= s->weight[op]; op++ )
+			r -= s->weight[op];
+		ai = StressRand( &w->seed ) % s->p->addrNum;
+
+		/* latency without the time waiting for other threads */
+		li = (op == OP_WV) ? s->wvIdx : ai;
+		if( s->serialize[li] )
+			SMB2_OsMutexLock( &s->lock[li] );
+		start = UsecTimerGet();
+		err = StressOp( w, smbHdl, op, s->p->addr[ai], &len, data );
+		lat = UsecTimerGet() - start;
+		if( s->serialize[li] )
+			SMB2_OsMutexUnlock( &s->lock[li] );
+
+		ref = &s->ref[op][ai];
+		if( !err && ref->valid &&
+			((len != ref->len) || memcmp( data, ref->data, len )) )
+			err = STRESS_ERR_VERIFY;
+
+		StressCount( &w->stats, op, err, lat );
+
+		if( err && s->p->stopOnErr )
+			s->stop = 1;
+	}
+
+	SMB2API_Exit( &smbHdl );
+}
+
+/**********************************************************************/
+/** Thread entry of a worker
+ *
+ *  \param arg		worker
+ */
+static void StressThread( void *arg )
+{
+	StressRun( (STRESS_WORKER*)arg );
+}
+
+/**********************************************************************/
+/** Sum up the statistics of all workers
+ *
+ *  The counters are read while the workers are running, an interval
+ *  report may be off by the operations in progress.
+ *
+ *  \param s		stress test
+ *  \param sum		\OUT statistics of all workers
+ */
+static void StressSum( STRESS *s, STRESS_STATS *sum )
+{
+	STRESS_STATS *st;
+	u_int32      t, i, k;
+
+	memset( sum, 0, sizeof(*sum) );
+
+	for( t=0; t<s->p->threads; t++ ) {
+		st = &s->worker[t].stats;
+
+		sum->ops        += st->ops;
+		sum->errs       += st->errs;
+		sum->verifyErrs += st->verifyErrs;
+		sum->latSum     += st->latSum;
+		sum->errOther   += st->errOther;
+		if( st->latMax > sum->latMax )
+			sum->latMax = st->latMax;
+		for( i=0; i<OP_NUM; i++ ) {
+			sum->opCnt[i] += st->opCnt[i];
+			sum->opErr[i] += st->opErr[i];
+		}
+		for( i=0; i<STRESS_HIST_NUM; i++ )
+			sum->hist[i] += st->hist[i];
+
+		for( i=0; i<st->errNum; i++ ) {
+			for( k=0; k<sum->errNum; k++ )
+				if( sum->errCode[k] == st->errCode[i] )
+					break;
+			if( k == sum->errNum ) {
+				if( sum->errNum == STRESS_ERR_MAX ) {
+					sum->errOther += st->errCnt[i];
+					continue;
+				}
+				sum->errCode[sum->errNum++] = st->errCode[i];
+			}
+			sum->errCnt[k] += st->errCnt[i];
+		}
+	}
+}
+
+/**********************************************************************/
+/** Get a latency percentile from a histogram
+ *
+ *  \param hist		histogram
+ *  \param num		number of samples in histogram
+ *  \param pct		percentile (1..100)
+ *
+ *  \return upper bound of the bucket [us]
+ */
+static u_int32 StressPercentile( u_int32 *hist, u_int32 num, u_int32 pct )
+{
+	u_int32 b, n = 0, limit;
+
+	limit = (u_int32)(((double)num * pct + 99) / 100);
+
+	for( b=0; b<STRESS_HIST_NUM-1; b++ ) {
+		n += hist[b];
+		if( n >= limit )
+			break;
+	}
+	return 1 << b;
+}
+
+/**********************************************************************/
+/** Print the final report
+ *
+ *  \param s		stress test
+ *  \param sum		statistics of all workers
+ */
+static void StressReport( STRESS *s, STRESS_STATS *sum )
+{
+	char    errMsg[512];
+	u_int32 i, n;
+
+	printf( "\nOperations:\n" );
+	for( i=0; i<OP_NUM; i++ ) {
+		if( s->weight[i] )
+			printf( "  %-4s %10u ops %8u errors\n", G_opDef[i].name,
+					sum->opCnt[i], sum->opErr[i] );
+	}
+
+	printf( "\nErrors by code:\n" );
+	for( i=0; i<sum->errNum; i++ )
+		printf( "  0x%04x %10u  %s\n", sum->errCode[i], sum->errCnt[i],
+				SMB2API_Errstring( sum->errCode[i], errMsg ) );
+	if( sum->errOther )
+		printf( "  other  %10u\n", sum->errOther );
+	printf( "  verify %10u  data mismatch\n", sum->verifyErrs );
+
+	printf( "\nLatency histogram:\n" );
+	for( n=STRESS_HIST_NUM; n && !sum->hist[n-1]; n-- )
+		;
+	for( i=0; i<n; i++ ) {
+		if( i < STRESS_HIST_NUM-1 )
+			printf( "  < %8u us", 1 << i );
+		else
+			printf( "  >=%8u us", 1 << (i-1) );
+		printf( " %10u  %5.1f%%\n", sum->hist[i],
+				sum->ops ? 100.0 * sum->hist[i] / sum->ops : 0.0 );
+	}
+	if( sum->ops )
+		printf( "  avg %.1f us, max %u us\n", sum->latSum / sum->ops,
+				sum->latMax );
+}
+
+/**********************************************************************/
+/** Run the stress test
+ *
+ *  Before the threads are started, the reference data for verification
+ *  is read with an own handle. Operations/addresses that fail here are
+ *  not verified.
+ *
+ *  \param p		parameters
+ *
+ *  \return 0=ok, or 1 on setup error or if an operation failed
+ */
+extern int32 SMB2TEST_Stress( STRESS_PARAMS *p )
+{
+	STRESS        *s;
+	STRESS_STATS  sum, last;
+	STRESS_WORKER *w;
+	STRESS_REF    *ref;
+	void          *smbHdl = NULL;
+	char          errMsg[512];
+	u_int32       i, ai, start, lastTime, now, n, ms;
+	u_int32       hist[STRESS_HIST_NUM];
+	int32         err, ret = 0;
+	int           op;
+
+	s = (STRESS*)calloc( 1, sizeof(STRESS) );
+	if( !s ) {
+		printf( "*** can't alloc stress test buffer\n" );
+		return 1;
+	}
+	s->p = p;
+	for( i=0; i<=STRESS_ADDR_MAX; i++ )
+		SMB2_OsMutexInit( &s->lock[i] );
+
+	if( StressParseMix( s ) ) {
+		printf( "*** invalid operation mix '%s'\n", p->mix );
+		ret = 1;
+		goto EXIT;
+	}
+	if( !p->addrNum && (s->weightSum != s->weight[OP_WV]) ) {
+		printf( "*** missing SMB device address\n" );
+		ret = 1;
+		goto EXIT;
+	}
+	if( !p->addrNum )
+		p->addr[p->addrNum++] = p->wvAddr;
+
+	if( p->threads > STRESS_THREAD_MAX )
+		p->threads = STRESS_THREAD_MAX;
+	if( !p->threads )
+		p->threads = 1;
+	if( !p->interval )
+		p->interval = 1;
+
+	if( s->weight[OP_WV] ) {
+		s->wvSlice = p->wvLen / p->threads;
+		if( !p->wvAddr || !s->wvSlice || (p->wvOffs + p->wvLen > 0x100) ) {
+			printf( "*** wv needs a scratch area (-w) of at least one byte "
+					"per thread\n" );
+			ret = 1;
+			goto EXIT;
+		}
+	}
+
+	/* serialize the operations that don't tolerate interleaving */
+	for( ai=0; ai<p->addrNum; ai++ )
+		s->serialize[ai] = (s->weight[OP_I2C] != 0);
+	for( s->wvIdx=0; s->wvIdx<p->addrNum; s->wvIdx++ )
+		if( p->addr[s->wvIdx] == p->wvAddr )
+			break;
+	if( s->wvIdx == p->addrNum )
+		s->wvIdx = STRESS_ADDR_MAX;
+	if( s->weight[OP_WV] )
+		s->serialize[s->wvIdx] = 1;
+
+	/*-----------------------+
+	|  Read reference data   |
+	+-----------------------*/
+	err = SMB2API_Init( p->device, &smbHdl );
+	if( err ) {
+		printf( "*** can't SMB2API_Init: %s\n",
+				SMB2API_Errstring( err, errMsg ) );
+		ret = 1;
+		goto EXIT;
+	}
+	if( p->verify ) {
+		w = &s->worker[0];
+		w->s = s;
+		for( op=0; op<OP_NUM; op++ ) {
+			if( !s->weight[op] || !G_opDef[op].verify )
+				continue;
+			for( ai=0; ai<p->addrNum; ai++ ) {
+				/* scratch EEPROM content changes */
+				if( s->weight[OP_WV] && (p->addr[ai] == p->wvAddr) )
+					continue;
+				ref = &s->ref[op][ai];
+				if( StressOp( w, smbHdl, op, p->addr[ai], &ref->len,
+							  ref->data ) ) {
+					printf( "%s 0x%02x: no reference data, not verified\n",
+							G_opDef[op].name, p->addr[ai] );
+					continue;
+				}
+				ref->valid = 1;
+			}
+		}
+	}
+	SMB2API_Exit( &smbHdl );
+
+	/*-----------------+
+	|  Start threads   |
+	+-----------------*/
+	printf( "Stress test on %s: %u thread(s), mix %s, %u address(es)\n",
+			p->device, p->threads, p->mix, p->addrNum );
+
+	start = lastTime = UOS_MsecTimerGet();
+	memset( &last, 0, sizeof(last) );
+
+	for( i=0; i<p->threads; i++ ) {
+		w = &s->worker[i];
+		w->s    = s;
+		w->idx  = i;
+		w->seed = start + i * 2654435761U;
+		w->started = !SMB2_OsThreadCreate( &w->thread, StressThread, w, 0 );
+		if( !w->started ) {
+			printf( "*** can't start thread %u\n", i );
+			s->stop = 1;
+			ret = 1;
+			break;
+		}
+	}
+
+	/*-----------------------+
+	|  Report per interval   |
+	+-----------------------*/
+	printf( "%10s %10s %8s %8s %8s %8s %8s\n", "time_s", "ops", "ops/s",
+			"errors", "verify", "p50_us", "p99_us" );
+
+	while( !s->stop ) {
+		UOS_Delay( 100 );
+		now = UOS_MsecTimerGet();
+
+		if( UOS_KeyPressed() != -1 )
+			s->stop = 1;
+		if( p->runtime && (now - start >= p->runtime * 1000) )
+			s->stop = 1;
+
+		ms = now - lastTime;
+		if( !s->stop && (ms < p->interval * 1000) )
+			continue;
+
+		StressSum( s, &sum );
+		for( i=0; i<STRESS_HIST_NUM; i++ )
+			hist[i] = sum.hist[i] - last.hist[i];
+		n = sum.ops - last.ops;
+
+		printf( "%10u %10u %8u %8u %8u %8u %8u\n", (now - start) / 1000, n,
+				ms ? (u_int32)((double)n * 1000 / ms) : 0,
+				sum.errs - last.errs, sum.verifyErrs - last.verifyErrs,
+				n ? StressPercentile( hist, n, 50 ) : 0,
+				n ? StressPercentile( hist, n, 99 ) : 0 );
+		fflush( stdout );
+
+		last = sum;
+		lastTime = now;
+	}
+
+	/*-----------------------+
+	|  Stop threads          |
+	+-----------------------*/
+	for( i=0; i<p->threads; i++ ) {
+		w = &s->worker[i];
+		if( !w->started )
+			continue;
+		SMB2_OsThreadJoin( &w->thread );
+		if( w->initErr ) {
+			printf( "*** thread %u: can't SMB2API_Init: %s\n", i,
+					SMB2API_Errstring( w->initErr, errMsg ) );
+			ret = 1;
+		}
+	}
+
+	StressSum( s, &sum );
+	now = UOS_MsecTimerGet() - start;
+	printf( "\n%u ops in %u s, %u ops/s, %u errors, %u verify errors\n",
+			sum.ops, now / 1000,
+			now ? (u_int32)((double)sum.ops * 1000 / now) : 0,
+			sum.errs, sum.verifyErrs );
+	StressReport( s, &sum );
+
+	if( sum.errs || sum.verifyErrs )
+		ret = 1;
+
+EXIT:
+	for( i=0; i<=STRESS_ADDR_MAX; i++ )
+		SMB2_OsMutexDestroy( &s->lock[i] );
+	free( s );
+	return ret;
+}
@@ -9,6 +9,9 @@
  *
  *        \brief Test tool for SMB2 functionality.
  *
+ *               Single address ReadByte test, or multithreaded soak and
+ *               stress test with a mix of operations (see smb2_stress.c).
+ *
  *     Required: libraries: mdis_api, usr_oss, usr_utl, smb2_api
  *
  *
@@ -43,6 +46,7 @@
 #include <MEN/usr_oss.h>
 #include <MEN/usr_utl.h>
 #include <MEN/smb2_api.h>
+#include "smb2_test.h"
 
 /* still using deprecated sscanf, sprintf,.. */
 #ifdef WINNT
@@ -67,13 +71,28 @@ static void usage(void)
 {
 	printf("\n"
 		"Usage:     smb2_test  devName  [<opts>]                             \n"
-		"Function:  Test with SMB2API_ReadByte.                              \n"
+		"Function:  Test with SMB2API_ReadByte, or stress test.              \n"
 		"Options:                                                            \n"
 		"  devName         device name e.g. smb2_1                           \n"
 		"  -a=hex          address of smb dev                                \n"
 		"  [-l <opts>]     read in a loop                                    \n"
 		"    [-d=<time>]    delay between read (in ms)..................[500]\n"
 		"    [-s]           stop after error                                 \n"
+		"  [-m=<mix> <opts>] stress test with operation mix op[:weight],..   \n"
+		"                   op: q rb rbd rwd rbk i2c wv                      \n"
+		"    [-a=hex[,hex]] addresses of smb devs (max. 16)                  \n"
+		"    [-c=hex]       command/offset for rbd/rwd/rbk/i2c.............[0]\n"
+		"    [-n=<num>]     number of threads (max. 32)....................[1]\n"
+		"    [-r=<sec>]     test time, 0 means until keypress..............[0]\n"
+		"    [-i=<sec>]     report interval...............................[60]\n"
+		"    [-v]           verify read data against reference read          \n"
+		"    [-w=hex,hex,hex] wv: scratch EEPROM address, offset, length     \n"
+		"                   (overwritten!)                                   \n"
+		"    [-s]           stop after error                                 \n"
+		"\n"
+		"Example: 4 threads, 1 hour, verify ID EEPROM reads, write scratch: \n"
+		"  smb2_test smb2_1 -m=rbd:4,rwd,i2c,wv -a=0xae,0x9c -c=0x10 -n=4   \n"
+		"            -r=3600 -v -w=0xa0,0x80,0x40                           \n"
 		"\n"
 		"(c)Copyright 2016 by MEN Mikro Elektronik GmbH\n"
 	);
@@ -97,11 +116,13 @@ int main(int argc, char *argv[])
 	void    *smbHdl=NULL;
 	u_int8	byteData;
 	u_int32	callCount=0;
+	u_int32	val[3];
+	STRESS_PARAMS stress;
 
 	/*------------------+
 	|  Check arguments  |
 	+------------------*/
-	errstr = UTL_ILLIOPT("?a=lsd=", ebuf);
+	errstr = UTL_ILLIOPT("?a=lsd=m=c=n=r=i=vw=", ebuf);
 	if (errstr) {
 		printf("*** %s\n", errstr);
 		usage();
@@ -131,6 +152,58 @@ int main(int argc, char *argv[])
 		goto EXIT;
 	}
 
+	/*---------------+
+	|  Stress test   |
+	+---------------*/
+	optp = UTL_TSTOPT("m=");
+	if (optp) {
+		memset(&stress, 0, sizeof(stress));
+		stress.device = deviceP;
+		stress.mix = optp;
+		stress.interval = 60;
+		stress.threads = 1;
+
+		/* list of addresses */
+		optp = UTL_TSTOPT("a=");
+		while (optp && *optp && (stress.addrNum < STRESS_ADDR_MAX)) {
+			if (sscanf(optp, "%x", &smbAddr) != 1)
+				break;
+			stress.addr[stress.addrNum++] = (u_int8)smbAddr;
+			if ((optp = strchr(optp, ',')) != NULL)
+				optp++;
+		}
+
+		if ((optp = UTL_TSTOPT("c=")) != NULL) {
+			sscanf(optp, "%x", &val[0]);
+			stress.cmd = (u_int8)val[0];
+		}
+		if ((optp = UTL_TSTOPT("n=")) != NULL)
+			sscanf(optp, "%u", &stress.threads);
+		if ((optp = UTL_TSTOPT("r=")) != NULL)
+			sscanf(optp, "%u", &stress.runtime);
+		if ((optp = UTL_TSTOPT("i=")) != NULL)
+			sscanf(optp, "%u", &stress.interval);
+		if ((optp = UTL_TSTOPT("w=")) != NULL) {
+			if (sscanf(optp, "%x,%x,%x", &val[0], &val[1], &val[2]) != 3) {
+				printf("\n***ERROR: invalid scratch area %s!\n", optp);
+				ret=1;
+				goto EXIT;
+			}
+			stress.wvAddr = (u_int8)val[0];
+			stress.wvOffs = (u_int8)val[1];
+			stress.wvLen  = val[2];
+		}
+		stress.verify    = (UTL_TSTOPT("v") ? 1 : 0);
+		stress.stopOnErr = (UTL_TSTOPT("s") ? 1 : 0);
+
+		printf("start time: ");
+		PrintTime();
+		ret = SMB2TEST_Stress(&stress);
+		printf("stop time: ");
+		PrintTime();
+		goto EXIT;
+	}
+
 	/* SMB device address */
 	optp = UTL_TSTOPT("a=");
 	if (optp)
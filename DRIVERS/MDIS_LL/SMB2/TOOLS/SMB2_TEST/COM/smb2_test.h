@@ -0,0 +1,80 @@
+/***********************  I n c l u d e  -  F i l e  ************************/
+/*!
+ *        \file  smb2_test.h
+ *
+ *      \author  dieter.pfeuffer@men.de
+ *
+ *  	 \brief SMB2_TEST master include file
+ *
+ *     Switches: -
+ */
+/*
+ *---------------------------------------------------------------------------
+ * Copyright 2016-2019, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _SMB2_TEST_H
+#define _SMB2_TEST_H
+
+#ifdef __cplusplus
+      extern "C" {
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <MEN/men_typs.h>
+#include <MEN/usr_oss.h>
+#include <MEN/smb2_api.h>
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+#define STRESS_ADDR_MAX		16		/* max. SMB addresses */
+#define STRESS_THREAD_MAX	32		/* max. threads */
+
+/*--------------------------------------+
+|   TYPEDEFS                            |
++--------------------------------------*/
+/* stress test parameters */
+typedef struct {
+	char    *device;				/* SMB device name */
+	char    *mix;					/* operation mix "op[:weight],.." */
+	u_int32 addrNum;				/* number of addresses */
+	u_int8  addr[STRESS_ADDR_MAX];	/* SMB addresses */
+	u_int8  cmd;					/* command/offset of data operations */
+	u_int32 threads;				/* number of threads */
+	u_int32 runtime;				/* test time [s], 0=until keypress */
+	u_int32 interval;				/* report interval [s] */
+	int     verify;					/* verify read data */
+	int     stopOnErr;				/* stop after first error */
+	u_int8  wvAddr;					/* write/verify: EEPROM address */
+	u_int8  wvOffs;					/* write/verify: first offset */
+	u_int32 wvLen;					/* write/verify: number of bytes */
+} STRESS_PARAMS;
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+extern int32 SMB2TEST_Stress( STRESS_PARAMS *p );
+
+#ifdef __cplusplus
+   }
+#endif
+
+#endif /* _SMB2_TEST_H */
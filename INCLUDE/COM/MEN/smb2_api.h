@@ -103,6 +103,35 @@ int32 __MAPILIB SMB2API_I2CXfer(
 char* __MAPILIB SMB2API_Errstring(
 	int32 errCode, char	*strBuf );
 
+int32 __MAPILIB SMB2API_XferGroupBegin(
+	void *smbHdl, u_int32 flags, u_int32 maxNum, void **grpHdlP );
+int32 __MAPILIB SMB2API_XferGroupReset( void *grpHdl );
+int32 __MAPILIB SMB2API_XferGroupEnd( void **grpHdlP );
+int32 __MAPILIB SMB2API_XferGroupAddQuickComm(
+	void *grpHdl, u_int32 flags, u_int16 addr, u_int8 readWrite );
+int32 __MAPILIB SMB2API_XferGroupAddWriteByte(
+	void *grpHdl, u_int32 flags, u_int16 addr, u_int8 data );
+int32 __MAPILIB SMB2API_XferGroupAddReadByte(
+	void *grpHdl, u_int32 flags, u_int16 addr, u_int8 *dataP );
+int32 __MAPILIB SMB2API_XferGroupAddWriteByteData(
+	void *grpHdl, u_int32 flags, u_int16 addr, u_int8 cmdAddr, u_int8 data );
+int32 __MAPILIB SMB2API_XferGroupAddReadByteData(
+	void *grpHdl, u_int32 flags, u_int16 addr, u_int8 cmdAddr, u_int8 *dataP );
+int32 __MAPILIB SMB2API_XferGroupAddWriteWordData(
+	void *grpHdl, u_int32 flags, u_int16 addr, u_int8 cmdAddr, u_int16 data );
+int32 __MAPILIB SMB2API_XferGroupAddReadWordData(
+	void *grpHdl, u_int32 flags, u_int16 addr, u_int8 cmdAddr, u_int16 *dataP );
+int32 __MAPILIB SMB2API_XferGroupAddWriteBlockData(
+	void *grpHdl, u_int32 flags, u_int16 addr, u_int8 cmdAddr,
+	u_int8 length, u_int8 *dataP );
+int32 __MAPILIB SMB2API_XferGroupAddReadBlockData(
+	void *grpHdl, u_int32 flags, u_int16 addr, u_int8 cmdAddr,
+	u_int8 *lengthP, u_int8 *dataP );
+int32 __MAPILIB SMB2API_XferGroupAddProcessCall(
+	void *grpHdl, u_int32 flags, u_int16 addr, u_int8 cmdAddr, u_int16 *dataP );
+int32 __MAPILIB SMB2API_XferGroupCommit( void *grpHdl );
+int32 __MAPILIB SMB2API_XferGroupError( void *grpHdl, u_int32 idx );
+
 
 #  ifdef __cplusplus
       }
@@ -51,6 +51,57 @@
 #define SMB2_BMC_ERR_LENGTH    (BMC_OFFS + 0x1)  /** Wrong length */
 #define SMB2_BMC_ERROR         (BMC_OFFS + 0x2)  /** Error Code 0xFF */
 #define SMB2_BMC_ERR_INPUT     (BMC_OFFS + 0x3)  /** Input Error */
+#define SMB2_BMC_ERR_NOT_SUPPORTED (BMC_OFFS + 0x4) /** Feature not supported */
+
+/*--------------------+
+|   BMC Capabilities  |
++--------------------*/
+#define SMB2_BMC_CAP_GPIO      0x0001  /**< Feature Set FS_GPIO */
+#define SMB2_BMC_CAP_CPCI      0x0002  /**< Feature Set FS_BACKPLANE_CPCI */
+#define SMB2_BMC_CAP_FUP       0x0004  /**< Feature Set FS_FIRMWARE_UPDATE */
+#define SMB2_BMC_CAP_RTC       0x0008  /**< Feature Set FS_RTC */
+#define SMB2_BMC_CAP_ERRCNT    0x0010  /**< Feature Set FS_ERROR_COUNTER */
+#define SMB2_BMC_CAP_EVLOG     0x0020  /**< Feature Set FS_EVENT_LOG */
+#define SMB2_BMC_CAP_VREP      0x0040  /**< Feature Set FS_VOLTAGE_REPORTING */
+#define SMB2_BMC_CAP_CLUS      0x0080  /**< Feature Set FS_CLUSTER_REPORT */
+#define SMB2_BMC_CAP_SRTCR     0x0100  /**< Command SW_RTC_RESET */
+#define SMB2_BMC_CAP_RSIMD     0x0200  /**< Command RESET_IN_MODE_SET/GET */
+#define SMB2_BMC_CAP_EPFMD     0x0400  /**< Command EXT_PWR_FAIL_MODE_SET/GET */
+#define SMB2_BMC_CAP_RESMD     0x0800  /**< Command RESUME_MODE_SET/GET */
+#define SMB2_BMC_CAP_HWB       0x1000  /**< Command HW_BOARD_GET/SET */
+
+/*--------------------+
+|   BMC Limits        |
++--------------------*/
+#define SMB2_BMC_VOLT_MAX      128  /**< max. voltages for SMB2BMC_Volt_GetAll */
+#define SMB2_BMC_ERRCNT_MAX    255  /**< max. error counters */
+#define SMB2_BMC_SMBADDR       0x9C /**< default SMBus address of the BMC */
+#define SMB2_BMC_SMPL_PERIOD_MIN 10  /**< min. status frame sampler period [ms] */
+#define SMB2_BMC_SMPL_STALL_CNT  3   /**< frames without life sign toggle
+                                         until SMB2_BMC_SMPL_EV_STALL */
+
+/*--------------------+
+|   BMC Health        |
++--------------------*/
+/* sections of struct bmc_health */
+#define SMB2_BMC_HEALTH_FW     0x0001  /**< firmware version and caps */
+#define SMB2_BMC_HEALTH_WDOG   0x0002  /**< watchdog state and window */
+#define SMB2_BMC_HEALTH_RSTR   0x0004  /**< reset reason */
+#define SMB2_BMC_HEALTH_LIFE   0x0008  /**< power cycles and operating hours */
+#define SMB2_BMC_HEALTH_VOLT   0x0010  /**< voltage reports */
+#define SMB2_BMC_HEALTH_ERRCNT 0x0020  /**< error counters */
+#define SMB2_BMC_HEALTH_RTC    0x0040  /**< RTC */
+#define SMB2_BMC_HEALTH_EVLOG  0x0080  /**< event log status */
+
+/*--------------------+
+|   BMC Sampler       |
++--------------------*/
+/* events passed to the SMB2BMC_SAMPLER_CB callback */
+#define SMB2_BMC_SMPL_EV_ERR   0x0001  /**< status frame read failed */
+#define SMB2_BMC_SMPL_EV_STALL 0x0004  /**< life_sign_bit stopped toggling */
+#define SMB2_BMC_SMPL_EV_ALIVE 0x0008  /**< life_sign_bit toggles again */
+#define SMB2_BMC_SMPL_EV_FAULT 0x0010  /**< fault_cause changed */
+#define SMB2_BMC_SMPL_EV_STATE 0x0020  /**< state changed */
 
 /*--------------------+
 |   BMC Enumerations  |
@@ -253,6 +304,14 @@ struct bmc_event_report{
 	u_int8 ev_info4;
 };
 
+/** Callback for SMB2BMC_EventLog_Sync
+ *
+ *  Called for every new event, return 0 to continue or
+ *  != 0 to stop the synchronization.
+ */
+typedef int32 (*SMB2BMC_EVLOG_CB)(void *cb_arg, u_int16 evlog_idx,
+								  struct bmc_event_report *event_report);
+
 struct bmc_rtc {
 	/**
 	 * Absolute year (e.g. 2011 = 0x7DB)
@@ -376,6 +435,156 @@ struct bmc_status_frame {
 	u_int8 crc;
 };
 
+/** changed error counter, see SMB2BMC_ErrCnt_GetChanged */
+struct bmc_errcnt_change {
+	/**
+	 * Error counter index
+	 */
+	u_int8 idx;
+	/**
+	 * Value at the previous call (0 for the first call)
+	 */
+	u_int16 prev;
+	/**
+	 * Actual value
+	 */
+	u_int16 count;
+};
+
+/** BMC health snapshot, see SMB2BMC_GetHealthSnapshot */
+struct bmc_health {
+	/**
+	 * SMB2_BMC_HEALTH_xxx sections read successfully
+	 */
+	u_int32 valid;
+	/**
+	 * SMB2_BMC_HEALTH_xxx sections that could not be read.
+	 * Sections neither valid nor failed are not supported by the BMC.
+	 */
+	u_int32 failed;
+	/**
+	 * Time needed for the snapshot [ms]
+	 */
+	u_int32 duration;
+	/**
+	 * Number of driver requests needed for the snapshot
+	 */
+	u_int32 requests;
+	/**
+	 * SMB2_BMC_CAP_xxx bitmap (SMB2_BMC_HEALTH_FW)
+	 */
+	u_int32 caps;
+	/**
+	 * Firmware version (SMB2_BMC_HEALTH_FW)
+	 */
+	struct bmc_fwversion fw_version;
+	/**
+	 * Watchdog state, arm state, upper limit (unit: 100 ms) and lower
+	 * limit (unit: 10 ms) of trigger window (SMB2_BMC_HEALTH_WDOG)
+	 */
+	u_int8 wd_state;
+	u_int8 wd_arm_state;
+	u_int16 wd_max_tout;
+	u_int16 wd_min_tout;
+	/**
+	 * Reset reason (SMB2_BMC_HEALTH_RSTR)
+	 */
+	struct bmc_rst_reason rst_reason;
+	/**
+	 * Power cycle counter and operating hours (SMB2_BMC_HEALTH_LIFE)
+	 */
+	u_int32 pwr_cycles;
+	u_int32 op_time;
+	/**
+	 * Voltage reports (SMB2_BMC_HEALTH_VOLT)
+	 */
+	u_int8 volt_num;
+	struct bmc_voltage_report volt[SMB2_BMC_VOLT_MAX];
+	/**
+	 * Error counters (SMB2_BMC_HEALTH_ERRCNT)
+	 */
+	u_int8 errcnt_num;
+	u_int16 errcnt[SMB2_BMC_ERRCNT_MAX];
+	/**
+	 * RTC (SMB2_BMC_HEALTH_RTC)
+	 */
+	struct bmc_rtc rtc;
+	/**
+	 * Event log status (SMB2_BMC_HEALTH_EVLOG)
+	 */
+	struct bmc_evlog_status evlog_status;
+};
+
+/** Status frame sample of the status frame sampler */
+struct bmc_status_sample {
+	/**
+	 * Sample number, gaps indicate samples dropped due to a full ring
+	 */
+	u_int32 seq;
+	/**
+	 * Time of the sample (UOS_MsecTimerGet) [ms]
+	 */
+	u_int32 tstamp;
+	/**
+	 * 0 or error code of the status frame read
+	 */
+	int32 err;
+	/**
+	 * Decoded status frame (valid for err == 0)
+	 */
+	struct bmc_status_frame frame;
+};
+
+/** Callback for the status frame sampler
+ *
+ *  Called from the sampler thread with the SMB2_BMC_SMPL_EV_xxx events
+ *  caused by \a sample. Each event is reported once when the condition
+ *  occurs, not for every sample.
+ */
+typedef void (*SMB2BMC_SAMPLER_CB)(void *cb_arg, u_int32 events,
+								   struct bmc_status_sample *sample);
+
+/** Statistics of the watchdog keep-alive service */
+struct bmc_wdog_keepalive_stats {
+	/**
+	 * Lower limit of the trigger window [ms]
+	 */
+	u_int32 win_min;
+	/**
+	 * Upper limit of the trigger window [ms]
+	 */
+	u_int32 win_max;
+	/**
+	 * Scheduled trigger period (middle of the window) [ms]
+	 */
+	u_int32 period;
+	/**
+	 * Number of successful triggers
+	 */
+	u_int32 trig_cnt;
+	/**
+	 * Number of failed triggers
+	 */
+	u_int32 err_cnt;
+	/**
+	 * Number of triggers outside the middle half of the window
+	 */
+	u_int32 near_miss_cnt;
+	/**
+	 * Smallest/largest trigger delay after the deadline [ms]
+	 */
+	int32 jitter_min;
+	int32 jitter_max;
+	/**
+	 * Average trigger delay after the deadline [ms]
+	 */
+	int32 jitter_avg;
+	/**
+	 * Error code of the last failed trigger
+	 */
+	int32 last_err;
+};
+
 extern int32 __MAPILIB SMB2BMC_Exit(void);
 extern char* __MAPILIB SMB2BMC_Ident(void);
 extern int32 __MAPILIB SMB2BMC_Init(char *deviceP);
@@ -384,6 +593,7 @@ extern int32 __MAPILIB SMB2BMC_GetFirm_Ver(struct bmc_fwversion *fw_revision);
 extern int32 __MAPILIB SMB2BMC_Set_HW_Brd(u_int16 s_board);
 extern int32 __MAPILIB SMB2BMC_Get_HW_Brd(u_int16 *g_board);
 extern int32 __MAPILIB SMB2BMC_Get_Features(struct bmc_features *features);
+extern int32 __MAPILIB SMB2BMC_Get_Caps(u_int32 *caps);
 extern int32 __MAPILIB SMB2BMC_WDOG_enable(void);
 extern int32 __MAPILIB SMB2BMC_WDOG_disable(void);
 extern int32 __MAPILIB SMB2BMC_WDOG_trig(void);
@@ -394,6 +604,10 @@ extern int32 __MAPILIB SMB2BMC_WDOG_Arm(void);
 extern int32 __MAPILIB SMB2BMC_WDOG_GetArmState(u_int8 *arm_state);
 extern int32 __MAPILIB SMB2BMC_WDOG_MinTimeSet(u_int16 wd_min_tout);
 extern int32 __MAPILIB SMB2BMC_WDOG_MinTimeGet(u_int16 *wd_min_tout);
+extern int32 __MAPILIB SMB2BMC_WDOG_KeepAliveStart(void **kaHdlP);
+extern int32 __MAPILIB SMB2BMC_WDOG_KeepAliveStop(void **kaHdlP);
+extern int32 __MAPILIB SMB2BMC_WDOG_KeepAliveGetStats(void *kaHdl,
+									struct bmc_wdog_keepalive_stats *stats);
 extern int32 __MAPILIB SMB2BMC_ResumeModeSet(u_int8 res_mode);
 extern int32 __MAPILIB SMB2BMC_ResumeModeGet(u_int8 *res_mode);
 extern int32 __MAPILIB SMB2BMC_ExtPwrFailModeSet(u_int8 ext_pwr_fail_mode);
@@ -409,6 +623,8 @@ extern int32 __MAPILIB SMB2BMC_RstReasonCLR(void);
 extern int32 __MAPILIB SMB2BMC_Volt_Max_Num(u_int8 *volt_max_num);
 extern int32 __MAPILIB SMB2BMC_Volt_Get(u_int8 volt_idx,
 										struct bmc_voltage_report *volt_report);
+extern int32 __MAPILIB SMB2BMC_Volt_GetAll(struct bmc_voltage_report *volt_report,
+										   u_int8 *count);
 extern int32 __MAPILIB SMB2BMC_Get_PwrCycleCnt(u_int32 *pwr_cycles);
 extern int32 __MAPILIB SMB2BMC_Get_OpHoursCnt(u_int32 *op_time);
 extern int32 __MAPILIB SMB2BMC_Get_EventLog_Status(struct bmc_evlog_status *evlog_stat);
@@ -416,9 +632,15 @@ extern int32 __MAPILIB SMB2BMC_Add_Event(u_int16 ev_code, u_int8 ev_info1,
 										u_int8 ev_info2, u_int8 ev_info3, u_int8 ev_info4);
 extern int32 __MAPILIB SMB2BMC_EventLog_Read(u_int16 evlog_idx, 
 											 struct bmc_event_report *evlog_report);
+extern int32 __MAPILIB SMB2BMC_EventLog_Sync(char *cursor_file,
+											 SMB2BMC_EVLOG_CB callback,
+											 void *cb_arg);
 extern int32 __MAPILIB SMB2BMC_ErrCnt_MaxIDX(u_int8 *errcnt_max_idx);
 extern int32 __MAPILIB SMB2BMC_ErrCnt_Clear(void);
 extern int32 __MAPILIB SMB2BMC_Get_ErrCnt(u_int8 errcnt_idx, u_int16 *error_cnt);
+extern int32 __MAPILIB SMB2BMC_ErrCnt_GetAll(u_int16 *counts, u_int8 *n);
+extern int32 __MAPILIB SMB2BMC_ErrCnt_GetChanged(struct bmc_errcnt_change *change,
+												 u_int8 *n);
 extern int32 __MAPILIB SMB2BMC_StatusOutput_Set(enum STATUS_OUTPUT status_out, u_int8 on_off);
 extern int32 __MAPILIB SMB2BMC_StatusOutput_Get(enum STATUS_OUTPUT status_out, u_int8 *status);
 extern int32 __MAPILIB SMB2BMC_RTC_Set(u_int16 year, u_int8 month, u_int8 mday, 
@@ -429,12 +651,134 @@ extern int32 __MAPILIB SMB2BMC_CPCI_SlotAddr(u_int8 *cpci_slotaddr);
 extern int32 __MAPILIB SMB2BMC_GPO_Caps(enum GPO gpo, u_int8 *gpo_support);
 extern int32 __MAPILIB SMB2BMC_GPO_Set(enum GPO gpo, u_int8 on_off);
 extern int32 __MAPILIB SMB2BMC_GPO_Get(enum GPO gpo, u_int8 *status);
+extern int32 __MAPILIB SMB2BMC_GPO_SetMask(u_int8 mask, u_int8 value);
+extern int32 __MAPILIB SMB2BMC_GPO_GetAll(u_int8 *levels, u_int8 *supported);
 extern int32 __MAPILIB SMB2BMC_GPI_Caps(enum GPI gpi, u_int8 *gpi_support);
 extern int32 __MAPILIB SMB2BMC_GPI_Get(enum GPI gpi, u_int8 *status);
+extern int32 __MAPILIB SMB2BMC_GPI_GetAll(u_int8 *levels, u_int8 *supported);
 extern int32 __MAPILIB SMB2BMC_PWR_GetEvLog(u_int8 *pwr_log_mode);
 extern int32 __MAPILIB SMB2BMC_PWR_SetEvLog(u_int8 pwr_log_mode);
 extern int32 __MAPILIB SMB2BMC_StatusFrame_trigger(void);
 extern int32 __MAPILIB SMB2BMC_GetStatusFrame(struct bmc_status_frame *status_frame);
+extern int32 __MAPILIB SMB2BMC_GetHealthSnapshot(struct bmc_health *health);
+extern int32 __MAPILIB SMB2BMC_Sampler_Start(u_int32 period, u_int32 ring_size,
+									u_int32 flags, SMB2BMC_SAMPLER_CB callback,
+									void *cb_arg, void **smplHdlP);
+extern int32 __MAPILIB SMB2BMC_Sampler_Stop(void **smplHdlP);
+extern int32 __MAPILIB SMB2BMC_Sampler_Read(void *smplHdl,
+									struct bmc_status_sample *sample,
+									u_int32 *count);
+
+/* handle based functions, see SMB2BMC_Open */
+extern int32 __MAPILIB SMB2BMC_Open(char *deviceP, u_int16 addr, void **bmcHdlP);
+extern int32 __MAPILIB SMB2BMC_Close(void **bmcHdlP);
+extern int32 __MAPILIB SMB2BMC_H_GetFirm_Ver(void *bmcHdl,
+										struct bmc_fwversion *fw_version);
+extern int32 __MAPILIB SMB2BMC_H_Set_HW_Brd(void *bmcHdl, u_int16 s_board);
+extern int32 __MAPILIB SMB2BMC_H_Get_HW_Brd(void *bmcHdl, u_int16 *g_board);
+extern int32 __MAPILIB SMB2BMC_H_Get_Features(void *bmcHdl,
+										struct bmc_features *features);
+extern int32 __MAPILIB SMB2BMC_H_Get_Caps(void *bmcHdl, u_int32 *caps);
+extern int32 __MAPILIB SMB2BMC_H_WDOG_enable(void *bmcHdl);
+extern int32 __MAPILIB SMB2BMC_H_WDOG_disable(void *bmcHdl);
+extern int32 __MAPILIB SMB2BMC_H_WDOG_trig(void *bmcHdl);
+extern int32 __MAPILIB SMB2BMC_H_WDOG_TimeSet(void *bmcHdl,
+										u_int16 wd_max_tout);
+extern int32 __MAPILIB SMB2BMC_H_WDOG_TimeGet(void *bmcHdl,
+										u_int16 *wd_max_tout);
+extern int32 __MAPILIB SMB2BMC_H_WDOG_GetState(void *bmcHdl, u_int8 *wd_state);
+extern int32 __MAPILIB SMB2BMC_H_WDOG_Arm(void *bmcHdl);
+extern int32 __MAPILIB SMB2BMC_H_WDOG_GetArmState(void *bmcHdl,
+										u_int8 *arm_state);
+extern int32 __MAPILIB SMB2BMC_H_WDOG_MinTimeSet(void *bmcHdl,
+										u_int16 wd_min_tout);
+extern int32 __MAPILIB SMB2BMC_H_WDOG_MinTimeGet(void *bmcHdl,
+										u_int16 *wd_min_tout);
+extern int32 __MAPILIB SMB2BMC_H_WDOG_KeepAliveStart(void *bmcHdl,
+										void **kaHdlP);
+extern int32 __MAPILIB SMB2BMC_H_ResumeModeSet(void *bmcHdl, u_int8 res_mode);
+extern int32 __MAPILIB SMB2BMC_H_ResumeModeGet(void *bmcHdl, u_int8 *res_mode);
+extern int32 __MAPILIB SMB2BMC_H_ExtPwrFailModeSet(void *bmcHdl,
+										u_int8 ext_pwr_fail_mode);
+extern int32 __MAPILIB SMB2BMC_H_ExtPwrFailModeGet(void *bmcHdl,
+										u_int8 *ext_pwr_fail_mode);
+extern int32 __MAPILIB SMB2BMC_H_ResetInModeSet(void *bmcHdl,
+										u_int8 reset_in_mode);
+extern int32 __MAPILIB SMB2BMC_H_ResetInModeGet(void *bmcHdl,
+										u_int8 *reset_in_mode);
+extern int32 __MAPILIB SMB2BMC_H_SW_Reset(void *bmcHdl, u_int16 reset_cause);
+extern int32 __MAPILIB SMB2BMC_H_SW_ColdReset(void *bmcHdl,
+										u_int16 reset_cause);
+extern int32 __MAPILIB SMB2BMC_H_SW_RTC_Reset(void *bmcHdl,
+										u_int16 reset_cause);
+extern int32 __MAPILIB SMB2BMC_H_SW_Halt(void *bmcHdl, u_int16 reset_cause);
+extern int32 __MAPILIB SMB2BMC_H_RstReasonGet(void *bmcHdl,
+										struct bmc_rst_reason *reset_reason);
+extern int32 __MAPILIB SMB2BMC_H_RstReasonCLR(void *bmcHdl);
+extern int32 __MAPILIB SMB2BMC_H_Volt_Max_Num(void *bmcHdl,
+										u_int8 *volt_max_num);
+extern int32 __MAPILIB SMB2BMC_H_Volt_Get(void *bmcHdl,
+										u_int8 volt_idx, struct bmc_voltage_report *volt_report);
+extern int32 __MAPILIB SMB2BMC_H_Volt_GetAll(void *bmcHdl,
+										struct bmc_voltage_report *volt_report, u_int8 *count);
+extern int32 __MAPILIB SMB2BMC_H_Get_PwrCycleCnt(void *bmcHdl,
+										u_int32 *pwr_cycles);
+extern int32 __MAPILIB SMB2BMC_H_Get_OpHoursCnt(void *bmcHdl, u_int32 *op_time);
+extern int32 __MAPILIB SMB2BMC_H_Get_EventLog_Status(void *bmcHdl,
+										struct bmc_evlog_status *evlog_stat);
+extern int32 __MAPILIB SMB2BMC_H_Add_Event(void *bmcHdl,
+										u_int16 ev_code, u_int8 ev_info1, u_int8 ev_info2, u_int8 ev_info3, u_int8 ev_info4);
+extern int32 __MAPILIB SMB2BMC_H_EventLog_Read(void *bmcHdl,
+										u_int16 evlog_idx, struct bmc_event_report *event_report);
+extern int32 __MAPILIB SMB2BMC_H_EventLog_Sync(void *bmcHdl,
+										char *cursor_file, SMB2BMC_EVLOG_CB callback, void *cb_arg);
+extern int32 __MAPILIB SMB2BMC_H_ErrCnt_MaxIDX(void *bmcHdl,
+										u_int8 *errcnt_max_idx);
+extern int32 __MAPILIB SMB2BMC_H_ErrCnt_Clear(void *bmcHdl);
+extern int32 __MAPILIB SMB2BMC_H_Get_ErrCnt(void *bmcHdl,
+										u_int8 errcnt_idx, u_int16 *error_cnt);
+extern int32 __MAPILIB SMB2BMC_H_ErrCnt_GetAll(void *bmcHdl,
+										u_int16 *counts, u_int8 *n);
+extern int32 __MAPILIB SMB2BMC_H_ErrCnt_GetChanged(void *bmcHdl,
+										struct bmc_errcnt_change *change, u_int8 *n);
+extern int32 __MAPILIB SMB2BMC_H_StatusOutput_Set(void *bmcHdl,
+										enum STATUS_OUTPUT status_out, u_int8 on_off);
+extern int32 __MAPILIB SMB2BMC_H_StatusOutput_Get(void *bmcHdl,
+										enum STATUS_OUTPUT status_out, u_int8 *status);
+extern int32 __MAPILIB SMB2BMC_H_RTC_Set(void *bmcHdl,
+										u_int16 year, u_int8 month, u_int8 mday, u_int8 hrs, u_int8 min, u_int8 sec);
+extern int32 __MAPILIB SMB2BMC_H_RTC_Get(void *bmcHdl, struct bmc_rtc *rtc);
+extern int32 __MAPILIB SMB2BMC_H_CPCI_BrdMode(void *bmcHdl, u_int8 *cpci_mode);
+extern int32 __MAPILIB SMB2BMC_H_CPCI_SlotAddr(void *bmcHdl,
+										u_int8 *cpci_slotaddr);
+extern int32 __MAPILIB SMB2BMC_H_GPO_Caps(void *bmcHdl,
+										enum GPO gpo, u_int8 *gpo_support);
+extern int32 __MAPILIB SMB2BMC_H_GPO_Set(void *bmcHdl,
+										enum GPO gpo, u_int8 on_off);
+extern int32 __MAPILIB SMB2BMC_H_GPO_Get(void *bmcHdl,
+										enum GPO gpo, u_int8 *status);
+extern int32 __MAPILIB SMB2BMC_H_GPO_SetMask(void *bmcHdl,
+										u_int8 mask, u_int8 value);
+extern int32 __MAPILIB SMB2BMC_H_GPO_GetAll(void *bmcHdl,
+										u_int8 *levels, u_int8 *supported);
+extern int32 __MAPILIB SMB2BMC_H_GPI_Caps(void *bmcHdl,
+										enum GPI gpi, u_int8 *gpi_support);
+extern int32 __MAPILIB SMB2BMC_H_GPI_Get(void *bmcHdl,
+										enum GPI gpi, u_int8 *status);
+extern int32 __MAPILIB SMB2BMC_H_GPI_GetAll(void *bmcHdl,
+										u_int8 *levels, u_int8 *supported);
+extern int32 __MAPILIB SMB2BMC_H_PWR_SetEvLog(void *bmcHdl,
+										u_int8 pwr_log_mode);
+extern int32 __MAPILIB SMB2BMC_H_PWR_GetEvLog(void *bmcHdl,
+										u_int8 *pwr_log_mode);
+extern int32 __MAPILIB SMB2BMC_H_StatusFrame_trigger(void *bmcHdl);
+extern int32 __MAPILIB SMB2BMC_H_GetStatusFrame(void *bmcHdl,
+										struct bmc_status_frame *status_frame);
+extern int32 __MAPILIB SMB2BMC_H_GetHealthSnapshot(void *bmcHdl,
+										struct bmc_health *health);
+extern int32 __MAPILIB SMB2BMC_H_Sampler_Start(void *bmcHdl,
+										u_int32 period, u_int32 ring_size, u_int32 flags,
+										SMB2BMC_SAMPLER_CB callback, void *cb_arg, void **smplHdlP);
 
 #ifdef __cplusplus
 	}
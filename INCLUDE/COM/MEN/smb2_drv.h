@@ -87,9 +87,43 @@ typedef struct
 	u_int32 sigCode;	/**< UOS_SIG_XXX code */
 }SMB2_ALERT;
 
+/** structure for one transfer of a transaction group */
+typedef struct
+{
+	int32 code;			/**< SMB2_BLK_xxx code of the transfer */
+	int32 error;		/**< result of the transfer (set by driver) */
+	union{
+		SMB2_TRANSFER trx;			/**< simple transfer */
+		SMB2_TRANSFER_BLOCK trxBlk;	/**< block transfer */
+	}u;
+}SMB2_XFER_GROUP_ENTRY;
+
+/** structure for XferGroup (SMB2_BLK_XFER_GROUP)
+ *
+ *  The structure has a variable length: M_SG_BLOCK.size must cover
+ *  the header and \a num entries.
+ */
+typedef struct
+{
+	u_int32 flags;		/**< SMB2_XFER_GROUP_xxx flags */
+	u_int32 num;		/**< number of transfers in entry[] */
+	u_int32 done;		/**< number of executed transfers (set by driver) */
+	SMB2_XFER_GROUP_ENTRY entry[1];	/**< transfers (variable length) */
+}SMB2_XFER_GROUP;
+
 /*-----------------------------------------+
 |  DEFINES                                 |
 +-----------------------------------------*/
+/** \name SMB2 transaction group defines */
+/**@{*/
+#define SMB2_XFER_GROUP_MAX		256		/**< max. transfers per group */
+#define SMB2_XFER_GROUP_CONT	0x01	/**< continue after failed transfer */
+
+/** size of a SMB2_XFER_GROUP with \a n entries */
+#define SMB2_XFER_GROUP_SIZE(n) \
+	(sizeof(SMB2_XFER_GROUP) + ((n)-1) * sizeof(SMB2_XFER_GROUP_ENTRY))
+/**@}*/
+
 /** \name SMB2 specific Getstat/Setstat standard codes 
  *  \anchor getstat_setstat_codes
  */
@@ -114,6 +148,7 @@ typedef struct
 #define SMB2_BLK_ALERT_CB_INSTALL	M_DEV_BLK_OF+0x0c  /**<   S: AlertCbInstall */
 #define SMB2_BLK_ALERT_CB_REMOVE	M_DEV_BLK_OF+0x0d  /**<   S: AlertCbRemove */
 #define SMB2_BLK_I2C_XFER			M_DEV_BLK_OF+0x0e  /**< G  : I2cXfer */
+#define SMB2_BLK_XFER_GROUP			M_DEV_BLK_OF+0x0f  /**< G  : XferGroup */
 
 /**@}*/
 
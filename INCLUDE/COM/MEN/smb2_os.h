@@ -0,0 +1,87 @@
+/***********************  I n c l u d e  -  F i l e  ************************/
+/*!
+ *        \file  smb2_os.h
+ *
+ *      \author  quoc.bui@men.de
+ *
+ *       \brief  Thread and mutex wrappers for the SMB2 libraries and tools
+ *
+ *               USR_OSS has no thread API, so the native Win32 or POSIX
+ *               thread functions are used. On POSIX systems, users must
+ *               link libpthread.
+ *
+ *    \switches  WINNT
+ */
+/*
+ *---------------------------------------------------------------------------
+ * Copyright 2014-2019, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _SMB2_OS_H
+#define _SMB2_OS_H
+
+#ifdef __cplusplus
+      extern "C" {
+#endif
+
+#ifdef WINNT
+# include <windows.h>
+#else
+# include <pthread.h>
+#endif
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+/* memory barrier for lock-free data exchange between threads */
+#ifdef WINNT
+# define SMB2_OS_MEMBAR()	MemoryBarrier()
+#else
+# define SMB2_OS_MEMBAR()	__sync_synchronize()
+#endif
+
+/*--------------------------------------+
+|   TYPEDEFS                            |
++--------------------------------------*/
+#ifdef WINNT
+typedef HANDLE				SMB2_OS_THREAD;
+typedef CRITICAL_SECTION	SMB2_OS_MUTEX;
+#else
+typedef pthread_t			SMB2_OS_THREAD;
+typedef pthread_mutex_t		SMB2_OS_MUTEX;
+#endif
+
+/** thread function */
+typedef void (*SMB2_OS_THREAD_FUNC)(void *arg);
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+int32 __MAPILIB SMB2_OsThreadCreate(SMB2_OS_THREAD *threadP,
+									SMB2_OS_THREAD_FUNC func,
+									void *arg, int rtPrio);
+void __MAPILIB SMB2_OsThreadJoin(SMB2_OS_THREAD *threadP);
+void __MAPILIB SMB2_OsMutexInit(SMB2_OS_MUTEX *mutexP);
+void __MAPILIB SMB2_OsMutexLock(SMB2_OS_MUTEX *mutexP);
+void __MAPILIB SMB2_OsMutexUnlock(SMB2_OS_MUTEX *mutexP);
+void __MAPILIB SMB2_OsMutexDestroy(SMB2_OS_MUTEX *mutexP);
+
+#ifdef __cplusplus
+      }
+#endif
+
+#endif /* _SMB2_OS_H */
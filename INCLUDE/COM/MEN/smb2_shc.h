@@ -52,6 +52,10 @@
 #define SMB2_SHC_ERR_LENGTH               (SHC_OFFS + 0x2)  /** Wrong length */
 #define SMB2_SHC_ERR_FEATURE_UNAVAILABLE  (SHC_OFFS + 0x3)  /** Feature unavailable */
 
+#define SMB2_SHC_SMBADDR                  0xea              /**< default SMBus address */
+
+#define SMB2_SHC_TEMP_OVR_TIME            60000             /**< duration of a temperature override [ms] */
+
 /*--------------------+
 |   SHC Power Supply  |
 +--------------------*/
@@ -63,6 +67,8 @@ enum SHC_PSU_NR {
 	SHC_PSU3
 };
 
+#define SMB2_SHC_PSU_NUM	3	/**< number of PSUs */
+
 /** Shelf Controller PSU Status information */
 struct shc_psu {
 	/**
@@ -90,6 +96,8 @@ enum SHC_FAN_NR {
 	SHC_FAN3
 };
 
+#define SMB2_SHC_FAN_NUM	3	/**< number of FANs */
+
 /** Shelf Controller FAN state */
 enum SHC_FAN_STAT {
 	SHC_FAN_OK = 0,
@@ -124,6 +132,8 @@ enum SHC_PWR_MON_ID {
 	SHC_PWR_MON_4
 };
 
+#define SMB2_SHC_PWR_MON_NUM	4	/**< number of power monitor inputs */
+
 /*--------------------+
 |   SHC UPS           |
 +--------------------*/
@@ -134,6 +144,8 @@ enum SHC_UPS_NR {
 	SHC_UPS2
 };
 
+#define SMB2_SHC_UPS_NUM	2	/**< number of UPS */
+
 /** Shelf Controller UPS Status information */
 struct shc_ups {
 	/**
@@ -269,6 +281,172 @@ struct shc_fwversion {
 	u_int8 veri_flag;
 };
 
+/*--------------------+
+|   SHC Snapshot      |
++--------------------*/
+
+/** Shelf Controller status snapshot, see SMB2SHC_GetSnapshot */
+struct shc_snapshot {
+	/**
+	 *  Time of the bus access (UOS_MsecTimerGet) in ms
+	 */
+	u_int32 tstamp;
+	/**
+	 *  Duration of the bus access in ms
+	 */
+	u_int32 bus_time;
+	/**
+	 *  Temperature in K (set value if override is active)
+	 */
+	u_int16 tempK;
+	/**
+	 *  Flag to indicate if the temperature override is active
+	 */
+	u_int8 tempOverride;
+	/**
+	 *  PSU status (indexed by enum SHC_PSU_NR)
+	 */
+	struct shc_psu psu[SMB2_SHC_PSU_NUM];
+	/**
+	 *  FAN status (indexed by enum SHC_FAN_NR)
+	 */
+	struct shc_fan fan[SMB2_SHC_FAN_NUM];
+	/**
+	 *  Voltage levels (indexed by enum SHC_PWR_MON_ID)
+	 */
+	u_int16 volt[SMB2_SHC_PWR_MON_NUM];
+	/**
+	 *  UPS status (indexed by enum SHC_UPS_NR)
+	 */
+	struct shc_ups ups[SMB2_SHC_UPS_NUM];
+};
+
+/*------------------------------+
+|   SHC Temperature Refresher   |
++------------------------------*/
+
+/** Callback for the temperature override refresher
+ *
+ *  Called from the refresher thread. Store the ambient temperature (K)
+ *  in \a tempK and return 0, or return != 0 if no valid value is
+ *  available.
+ */
+typedef int32 (*SMB2SHC_TEMP_CB)(void *cb_arg, u_int16 *tempK);
+
+/** Statistics of the temperature override refresher */
+struct shc_temp_refresh_stats {
+	/**
+	 *  Poll period and re-send time before expiry [ms]
+	 */
+	u_int32 period;
+	u_int32 lead;
+	/**
+	 *  Last temperature written (K)
+	 */
+	u_int16 tempK;
+	/**
+	 *  Number of successful writes
+	 */
+	u_int32 writeCnt;
+	/**
+	 *  Number of writes skipped (unchanged value, deadline not reached)
+	 */
+	u_int32 skipCnt;
+	/**
+	 *  Number of failed writes
+	 */
+	u_int32 errCnt;
+	/**
+	 *  Number of callback errors
+	 */
+	u_int32 cbErrCnt;
+	/**
+	 *  Number of missed deadlines (override expired before refresh)
+	 */
+	u_int32 missCnt;
+	/**
+	 *  Smallest/largest/average write latency after the scheduled time [ms]
+	 */
+	int32 latMin;
+	int32 latMax;
+	int32 latAvg;
+	/**
+	 *  Error code of the last failed write
+	 */
+	int32 lastErr;
+};
+
+/*--------------------------+
+|   SHC Power-Fail Monitor  |
++--------------------------*/
+
+/* monitor events, see SMB2SHC_MON_CB */
+#define SMB2_SHC_MON_EV_PSU_EPWR     0x0001  /**< PSU external power changed */
+#define SMB2_SHC_MON_EV_PSU_FAIL     0x0002  /**< PSU failure changed */
+#define SMB2_SHC_MON_EV_PSU_PRESENT  0x0004  /**< PSU inserted/removed */
+#define SMB2_SHC_MON_EV_UPS_PWR      0x0008  /**< UPS started/stopped providing power */
+#define SMB2_SHC_MON_EV_UPS_FAIL     0x0010  /**< UPS failure changed */
+#define SMB2_SHC_MON_EV_UPS_PRESENT  0x0020  /**< UPS inserted/removed */
+#define SMB2_SHC_MON_EV_FAN_FAIL     0x0040  /**< FAN state changed */
+#define SMB2_SHC_MON_EV_FAN_PRESENT  0x0080  /**< FAN inserted/removed */
+#define SMB2_SHC_MON_EV_ERR          0x0100  /**< status read failed/recovered */
+#define SMB2_SHC_MON_EV_ALL          0x01ff
+
+#define SMB2_SHC_MON_CB_MAX          4       /**< max. callbacks per monitor */
+
+/** Shelf Controller state seen by the power-fail monitor */
+struct shc_mon_state {
+	/**
+	 *  Start time of the status read (UOS_MsecTimerGet) in ms
+	 */
+	u_int32 tstamp;
+	/**
+	 *  Error code of the status read (0 = state is valid)
+	 */
+	int32 err;
+	/**
+	 *  PSU, FAN and UPS status
+	 */
+	struct shc_psu psu[SMB2_SHC_PSU_NUM];
+	struct shc_fan fan[SMB2_SHC_FAN_NUM];
+	struct shc_ups ups[SMB2_SHC_UPS_NUM];
+};
+
+/** Callback for the power-fail monitor
+ *
+ *  Called from the monitor thread on transitions only. \a events are the
+ *  SMB2_SHC_MON_EV_xxx events the callback was registered for, \a prev
+ *  the state before the transition.
+ */
+typedef void (*SMB2SHC_MON_CB)(void *cb_arg, u_int32 events,
+							   struct shc_mon_state *state,
+							   struct shc_mon_state *prev);
+
+/** Statistics of the power-fail monitor */
+struct shc_mon_stats {
+	/**
+	 *  Fastest/slowest poll period and actual poll period [ms]
+	 */
+	u_int32 periodMin;
+	u_int32 periodMax;
+	u_int32 period;
+	/**
+	 *  Number of status reads, failed reads and transitions
+	 */
+	u_int32 pollCnt;
+	u_int32 errCnt;
+	u_int32 evCnt;
+	/**
+	 *  Smallest/largest/average detection latency [ms]: from the start
+	 *  of the previous status read (last time the old state was seen)
+	 *  to the callback, i.e. poll delay plus bus time, up to periodMax
+	 *  plus bus time while the shelf was healthy
+	 */
+	int32 latMin;
+	int32 latMax;
+	int32 latAvg;
+};
+
 extern int32 __MAPILIB SMB2SHC_ShutDown();
 extern int32 __MAPILIB SMB2SHC_PowerOff();
 extern int32 __MAPILIB SMB2SHC_Exit(void);
@@ -276,6 +454,12 @@ extern char* __MAPILIB SMB2SHC_Ident(void);
 extern int32 __MAPILIB SMB2SHC_Init(char *deviceP);
 extern int32 __MAPILIB SMB2SHC_GetTemperature(u_int16 *tempK);
 extern int32 __MAPILIB SMB2SHC_SetTemperature(u_int16 tempK);
+extern int32 __MAPILIB SMB2SHC_TempRefresh_Start(u_int32 period, u_int32 lead,
+									SMB2SHC_TEMP_CB callback, void *cb_arg,
+									void **trefHdlP);
+extern int32 __MAPILIB SMB2SHC_TempRefresh_Stop(void **trefHdlP);
+extern int32 __MAPILIB SMB2SHC_TempRefresh_GetStats(void *trefHdl,
+									struct shc_temp_refresh_stats *stats);
 extern int32 __MAPILIB SMB2SHC_GetTemperatureOverrideStatus(u_int16 *status);
 extern int32 __MAPILIB SMB2SHC_GetPersistentPowerbuttonStatus(u_int8* status);
 extern int32 __MAPILIB SMB2SHC_SetPersistentPowerbuttonStatus(u_int32 status);
@@ -283,10 +467,52 @@ extern int32 __MAPILIB SMB2SHC_SetPowerCycleDuration(u_int16 delay);
 extern char* __MAPILIB SMB2SHC_Errstring(u_int32 errCode, char *strBuf);
 extern int32 __MAPILIB SMB2SHC_GetFirm_Ver(struct shc_fwversion *fw_version);
 extern int32 __MAPILIB SMB2SHC_GetConf_Data(struct shc_configdata *configdata);
+extern int32 __MAPILIB SMB2SHC_RefreshCache(void);
 extern int32 __MAPILIB SMB2SHC_GetPSU_State(enum SHC_PSU_NR psu_nr, struct shc_psu *shc_psu);
 extern int32 __MAPILIB SMB2SHC_GetFAN_State(enum SHC_FAN_NR fan_nr, struct shc_fan *shc_fan);
 extern int32 __MAPILIB SMB2SHC_GetUPS_State(enum SHC_UPS_NR ups_nr, struct shc_ups *shc_ups);
 extern int32 __MAPILIB SMB2SHC_GetVoltLevel(enum SHC_PWR_MON_ID pwr_mon_nr, u_int16 *volt_value);
+extern int32 __MAPILIB SMB2SHC_GetAllPSU(struct shc_psu shc_psu[SMB2_SHC_PSU_NUM]);
+extern int32 __MAPILIB SMB2SHC_GetAllFans(struct shc_fan shc_fan[SMB2_SHC_FAN_NUM]);
+extern int32 __MAPILIB SMB2SHC_GetAllUPS(struct shc_ups shc_ups[SMB2_SHC_UPS_NUM]);
+extern int32 __MAPILIB SMB2SHC_GetAllVoltLevels(u_int16 volt_value[SMB2_SHC_PWR_MON_NUM]);
+extern int32 __MAPILIB SMB2SHC_GetSnapshot(struct shc_snapshot *snapshot);
+extern int32 __MAPILIB SMB2SHC_Monitor_Start(u_int32 period_min, u_int32 period_max,
+									u_int32 events, SMB2SHC_MON_CB callback,
+									void *cb_arg, void **monHdlP);
+extern int32 __MAPILIB SMB2SHC_Monitor_Register(void *monHdl, u_int32 events,
+									SMB2SHC_MON_CB callback, void *cb_arg);
+extern int32 __MAPILIB SMB2SHC_Monitor_Stop(void **monHdlP);
+extern int32 __MAPILIB SMB2SHC_Monitor_GetStats(void *monHdl,
+									struct shc_mon_stats *stats);
+
+/* handle based functions, see SMB2SHC_Open */
+extern int32 __MAPILIB SMB2SHC_Open(char *deviceP, u_int16 addr, void **shcHdlP);
+extern int32 __MAPILIB SMB2SHC_Close(void **shcHdlP);
+extern int32 __MAPILIB SMB2SHC_H_GetTemperature(void *shcHdl, u_int16 *tempK);
+extern int32 __MAPILIB SMB2SHC_H_GetTemperatureOverrideStatus(void *shcHdl, u_int16 *status);
+extern int32 __MAPILIB SMB2SHC_H_SetTemperature(void *shcHdl, u_int16 tempK);
+extern int32 __MAPILIB SMB2SHC_H_TempRefresh_Start(void *shcHdl, u_int32 period, u_int32 lead,
+									SMB2SHC_TEMP_CB callback, void *cb_arg, void **trefHdlP);
+extern int32 __MAPILIB SMB2SHC_H_GetPSU_State(void *shcHdl, enum SHC_PSU_NR psu_nr, struct shc_psu *shc_psu);
+extern int32 __MAPILIB SMB2SHC_H_GetFAN_State(void *shcHdl, enum SHC_FAN_NR fan_nr, struct shc_fan *shc_fan);
+extern int32 __MAPILIB SMB2SHC_H_GetVoltLevel(void *shcHdl, enum SHC_PWR_MON_ID pwr_mon_nr, u_int16 *volt_value);
+extern int32 __MAPILIB SMB2SHC_H_GetAllPSU(void *shcHdl, struct shc_psu shc_psu[SMB2_SHC_PSU_NUM]);
+extern int32 __MAPILIB SMB2SHC_H_GetAllFans(void *shcHdl, struct shc_fan shc_fan[SMB2_SHC_FAN_NUM]);
+extern int32 __MAPILIB SMB2SHC_H_GetAllUPS(void *shcHdl, struct shc_ups shc_ups[SMB2_SHC_UPS_NUM]);
+extern int32 __MAPILIB SMB2SHC_H_GetAllVoltLevels(void *shcHdl, u_int16 volt_value[SMB2_SHC_PWR_MON_NUM]);
+extern int32 __MAPILIB SMB2SHC_H_GetSnapshot(void *shcHdl, struct shc_snapshot *snapshot);
+extern int32 __MAPILIB SMB2SHC_H_Monitor_Start(void *shcHdl, u_int32 period_min, u_int32 period_max,
+									u_int32 events, SMB2SHC_MON_CB callback, void *cb_arg, void **monHdlP);
+extern int32 __MAPILIB SMB2SHC_H_SetPowerCycleDuration(void *shcHdl, u_int16 duration);
+extern int32 __MAPILIB SMB2SHC_H_SetPersistentPowerbuttonStatus(void *shcHdl, u_int32 status);
+extern int32 __MAPILIB SMB2SHC_H_GetPersistentPowerbuttonStatus(void *shcHdl, u_int8 *status);
+extern int32 __MAPILIB SMB2SHC_H_GetUPS_State(void *shcHdl, enum SHC_UPS_NR ups_nr, struct shc_ups *shc_ups_state);
+extern int32 __MAPILIB SMB2SHC_H_ShutDown(void *shcHdl);
+extern int32 __MAPILIB SMB2SHC_H_PowerOff(void *shcHdl);
+extern int32 __MAPILIB SMB2SHC_H_GetConf_Data(void *shcHdl, struct shc_configdata *configdata);
+extern int32 __MAPILIB SMB2SHC_H_RefreshCache(void *shcHdl);
+extern int32 __MAPILIB SMB2SHC_H_GetFirm_Ver(void *shcHdl, struct shc_fwversion *fw_version);
 
 #ifdef __cplusplus
 	}
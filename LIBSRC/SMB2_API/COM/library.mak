@@ -27,6 +27,9 @@ STAMPED_REVISION="13Y004-06_01_42-24-ge5f4d78-dirty_2019-05-30"
 DEF_REVISION=MAK_REVISION=$(STAMPED_REVISION)
 MAK_SWITCH=$(SW_PREFIX)$(DEF_REVISION)
 
+# smb2_os uses POSIX threads
+MAK_LIBS=-lpthread
+
 MAK_INCL=$(MEN_INC_DIR)/men_typs.h    	\
 		 $(MEN_INC_DIR)/mdis_err.h		\
          $(MEN_INC_DIR)/mdis_api.h		\
@@ -34,8 +37,10 @@ MAK_INCL=$(MEN_INC_DIR)/men_typs.h    	\
 		 $(MEN_INC_DIR)/smb2_api.h		\
 		 $(MEN_INC_DIR)/smb2_drv.h		\
 		 $(MEN_INC_DIR)/smb2.h	\
+		 $(MEN_INC_DIR)/smb2_os.h		\
 
 MAK_INP1 = smb2_api$(INP_SUFFIX)
+MAK_INP2 = smb2_os$(INP_SUFFIX)
 
-MAK_INP  = $(MAK_INP1)
+MAK_INP  = $(MAK_INP1) $(MAK_INP2)
 
@@ -112,6 +112,7 @@ typedef struct
 	SMB_ENTRIES entries; 	/**< function entries */
 	MDIS_PATH	path;		/**< path returned from M_open */
 	SIGNAL		signal[NBR_OF_SIG];	/**< signal array */
+	u_int8		xferGroupOk;	/**< driver supports transaction groups */
 }SMB_HANDLE;
 
 /** Double linked List for alerts */
@@ -124,6 +125,25 @@ typedef struct
 	u_int32		sigCode; 					/**< UOS_SIG signal code */
 }ALERT_NODE;
 
+/** Local structure for the result pointers of a group transfer */
+typedef struct
+{
+	u_int8		*byteP;		/**< read byte */
+	u_int16		*wordP;		/**< read word */
+	u_int8		*lengthP;	/**< number of bytes read */
+	u_int8		*dataP;		/**< read data block */
+	u_int16		wordIn;		/**< word to write (process call) */
+}XFER_RESULT;
+
+/** Local structure for transaction group handle */
+typedef struct
+{
+	void			*smbHdl;	/**< SMB handle */
+	u_int32			maxNum;		/**< max. number of transfers */
+	SMB2_XFER_GROUP	*grp;		/**< transfers passed to the driver */
+	XFER_RESULT		*res;		/**< result pointers of the transfers */
+}XFER_GROUP_HANDLE;
+
 /*-----------------------------------------+
 |  GLOBALS                                 |
 +-----------------------------------------*/
@@ -137,6 +157,9 @@ static int32 AlertRemove( void *smbHdl, ALERT_NODE *alertNode );
 static ALERT_NODE* AlertFindByAddr( u_int16 addr );
 static ALERT_NODE* AlertFindBySig( u_int32 sigCode );
 static void __MAPILIB SigHandler(u_int32 sigCode);
+static int32 XferGroupAdd( void *grpHdl, int32 code, u_int32 flags,
+	u_int16 addr, u_int8 cmdAddr, SMB2_XFER_GROUP_ENTRY **entryP,
+	XFER_RESULT **resP );
 
 /**
  * \defgroup _SMB2_API SMB2_API
@@ -1052,6 +1075,612 @@ int32 __MAPILIB SMB2API_AlertCbRemove(
 	return (SMB_ERR_PARAM);
 }
 
+/****************************************************************************/
+/** Begin a transaction group
+ *
+ *  A transaction group collects several transfers which are passed to the
+ *  driver with one call by SMB2API_XferGroupCommit(). The driver executes
+ *  all transfers of the group in order without releasing the device lock,
+ *  so no other application can access the device in between (e.g. between
+ *  setting an index register and reading the indexed data).
+ *
+ *  Transfers are added with the SMB2API_XferGroupAddXxx() functions.
+ *  The result pointers passed to these functions are filled on commit.
+ *  A group can be committed several times and must be released with
+ *  SMB2API_XferGroupEnd().
+ *
+ *  If #SMB2_XFER_GROUP_CONT is set in \a flags, all transfers are executed
+ *  even if one of them fails. The result of each transfer can be queried
+ *  with SMB2API_XferGroupError().
+ *
+ *  The first call for \a smbHdl passes an empty group to the driver. If
+ *  the driver does not support transaction groups, its error code
+ *  (e.g. ERR_LL_UNK_CODE) is returned and the caller can fall back to
+ *  single transfers.
+ *
+ *---------------------------------------------------------------------------
+ *  \param     smbHdl	  \IN SMB handle
+ *	\param     flags      \IN 0 or #SMB2_XFER_GROUP_CONT
+ *	\param     maxNum     \IN max. number of transfers in the group
+ *	                          (1..#SMB2_XFER_GROUP_MAX)
+ *	\param     grpHdlP    \OUT transaction group handle
+ *
+ *  \return    0 | error code
+ *
+ *  \sa SMB2API_XferGroupCommit, SMB2API_XferGroupEnd
+ *
+ ****************************************************************************/
+int32 __MAPILIB SMB2API_XferGroupBegin(
+	void		*smbHdl,
+	u_int32		flags,
+	u_int32		maxNum,
+	void		**grpHdlP )
+{
+	SMB_HANDLE			*smbH = (SMB_HANDLE*)smbHdl;
+	XFER_GROUP_HANDLE	*h;
+	SMB2_XFER_GROUP		probe;
+	M_SG_BLOCK			blk;
+
+	*grpHdlP = NULL;
+
+	if( (maxNum < 1) || (maxNum > SMB2_XFER_GROUP_MAX) )
+		return (SMB_ERR_PARAM);
+
+	/* check once that the driver knows transaction groups */
+	if( !smbH->xferGroupOk ){
+		zeroOut( (int8*)&probe, sizeof(probe) );
+		blk.size = SMB2_XFER_GROUP_SIZE(1);
+		blk.data = (void*)&probe;
+		if( M_getstat( smbH->path, SMB2_BLK_XFER_GROUP, (int32*)&blk ) )
+			return UOS_ErrnoGet();
+		smbH->xferGroupOk = 1;
+	}
+
+	if( !(h = (XFER_GROUP_HANDLE*)malloc( sizeof(XFER_GROUP_HANDLE) )) )
+		return (SMB_ERR_NO_MEM);
+	zeroOut( (int8*)h, sizeof(XFER_GROUP_HANDLE) );
+
+	h->grp = (SMB2_XFER_GROUP*)malloc( SMB2_XFER_GROUP_SIZE(maxNum) );
+	h->res = (XFER_RESULT*)malloc( maxNum * sizeof(XFER_RESULT) );
+	if( !h->grp || !h->res ){
+		SMB2API_XferGroupEnd( (void**)&h );
+		return (SMB_ERR_NO_MEM);
+	}
+
+	h->smbHdl = smbHdl;
+	h->maxNum = maxNum;
+	zeroOut( (int8*)h->grp, SMB2_XFER_GROUP_SIZE(maxNum) );
+	zeroOut( (int8*)h->res, maxNum * sizeof(XFER_RESULT) );
+	h->grp->flags = flags;
+
+	*grpHdlP = (void*)h;
+	return 0;
+}
+
+/****************************************************************************/
+/** Remove all transfers from a transaction group
+ *
+ *---------------------------------------------------------------------------
+ *  \param     grpHdl	  \IN transaction group handle
+ *
+ *  \return    0 | error code
+ *
+ *  \sa SMB2API_XferGroupBegin
+ *
+ ****************************************************************************/
+int32 __MAPILIB SMB2API_XferGroupReset( void *grpHdl )
+{
+	XFER_GROUP_HANDLE *h = (XFER_GROUP_HANDLE*)grpHdl;
+
+	h->grp->num = 0;
+	h->grp->done = 0;
+
+	return 0;
+}
+
+/****************************************************************************/
+/** End a transaction group
+ *
+ *  The transaction group handle is freed and *grpHdlP will be set to NULL.
+ *
+ *---------------------------------------------------------------------------
+ *  \param     grpHdlP	  \INOUT pointer to transaction group handle
+ *
+ *  \return    0 | error code
+ *
+ *  \sa SMB2API_XferGroupBegin
+ *
+ ****************************************************************************/
+int32 __MAPILIB SMB2API_XferGroupEnd( void **grpHdlP )
+{
+	XFER_GROUP_HANDLE *h = (XFER_GROUP_HANDLE*)*grpHdlP;
+
+	if( h ){
+		if( h->grp )
+			free( (void*)h->grp );
+		if( h->res )
+			free( (void*)h->res );
+		free( (void*)h );
+	}
+	*grpHdlP = NULL;
+
+	return 0;
+}
+
+/****************************************************************************/
+/** Add a quick command to a transaction group
+ *
+ *---------------------------------------------------------------------------
+ *  \param     grpHdl	  \IN transaction group handle
+ *	\param     flags      \IN flags, see \ref _SMB2_FLAG
+ *	\param     addr	      \IN device address
+ *	\param     readWrite  \IN access to perform ( #SMB_READ or #SMB_WRITE )
+ *
+ *  \return    0 | error code
+ *
+ *  \sa SMB2API_QuickComm
+ *
+ ****************************************************************************/
+int32 __MAPILIB SMB2API_XferGroupAddQuickComm(
+	void		*grpHdl,
+	u_int32		flags,
+	u_int16		addr,
+	u_int8		readWrite )
+{
+	SMB2_XFER_GROUP_ENTRY *entry;
+	XFER_RESULT *res;
+	int32 rv;
+
+	if( (rv = XferGroupAdd( grpHdl, SMB2_BLK_QUICK_COMM, flags, addr, 0,
+							&entry, &res )) )
+		return rv;
+
+	entry->u.trx.readWrite = readWrite;
+
+	return 0;
+}
+
+/****************************************************************************/
+/** Add a write byte transfer to a transaction group
+ *
+ *---------------------------------------------------------------------------
+ *  \param     grpHdl	  \IN transaction group handle
+ *	\param     flags      \IN flags, see \ref _SMB2_FLAG
+ *	\param     addr	      \IN device address
+ *	\param     data		  \IN byte to write
+ *
+ *  \return    0 | error code
+ *
+ *  \sa SMB2API_WriteByte
+ *
+ ****************************************************************************/
+int32 __MAPILIB SMB2API_XferGroupAddWriteByte(
+	void		*grpHdl,
+	u_int32		flags,
+	u_int16		addr,
+	u_int8		data )
+{
+	SMB2_XFER_GROUP_ENTRY *entry;
+	XFER_RESULT *res;
+	int32 rv;
+
+	if( (rv = XferGroupAdd( grpHdl, SMB2_BLK_WRITE_BYTE, flags, addr, 0,
+							&entry, &res )) )
+		return rv;
+
+	entry->u.trx.u.byteData = data;
+
+	return 0;
+}
+
+/****************************************************************************/
+/** Add a read byte transfer to a transaction group
+ *
+ *  \a dataP will be filled on SMB2API_XferGroupCommit().
+ *
+ *---------------------------------------------------------------------------
+ *  \param     grpHdl	  \IN transaction group handle
+ *	\param     flags      \IN flags, see \ref _SMB2_FLAG
+ *	\param     addr	      \IN device address
+ *	\param     dataP	  \OUT read byte
+ *
+ *  \return    0 | error code
+ *
+ *  \sa SMB2API_ReadByte
+ *
+ ****************************************************************************/
+int32 __MAPILIB SMB2API_XferGroupAddReadByte(
+	void		*grpHdl,
+	u_int32		flags,
+	u_int16		addr,
+	u_int8		*dataP )
+{
+	SMB2_XFER_GROUP_ENTRY *entry;
+	XFER_RESULT *res;
+	int32 rv;
+
+	if( (rv = XferGroupAdd( grpHdl, SMB2_BLK_READ_BYTE, flags, addr, 0,
+							&entry, &res )) )
+		return rv;
+
+	res->byteP = dataP;
+
+	return 0;
+}
+
+/****************************************************************************/
+/** Add a write byte data transfer to a transaction group
+ *
+ *---------------------------------------------------------------------------
+ *  \param     grpHdl	  \IN transaction group handle
+ *	\param     flags      \IN flags, see \ref _SMB2_FLAG
+ *	\param     addr	      \IN device address
+ *	\param     cmdAddr	  \IN device command or index value
+ *	\param     data		  \IN byte to write
+ *
+ *  \return    0 | error code
+ *
+ *  \sa SMB2API_WriteByteData
+ *
+ ****************************************************************************/
+int32 __MAPILIB SMB2API_XferGroupAddWriteByteData(
+	void		*grpHdl,
+	u_int32		flags,
+	u_int16		addr,
+	u_int8		cmdAddr,
+	u_int8		data )
+{
+	SMB2_XFER_GROUP_ENTRY *entry;
+	XFER_RESULT *res;
+	int32 rv;
+
+	if( (rv = XferGroupAdd( grpHdl, SMB2_BLK_WRITE_BYTE_DATA, flags, addr,
+							cmdAddr, &entry, &res )) )
+		return rv;
+
+	entry->u.trx.u.byteData = data;
+
+	return 0;
+}
+
+/****************************************************************************/
+/** Add a read byte data transfer to a transaction group
+ *
+ *  \a dataP will be filled on SMB2API_XferGroupCommit().
+ *
+ *---------------------------------------------------------------------------
+ *  \param     grpHdl	  \IN transaction group handle
+ *	\param     flags      \IN flags, see \ref _SMB2_FLAG
+ *	\param     addr	      \IN device address
+ *	\param     cmdAddr	  \IN device command or index value
+ *	\param     dataP	  \OUT read byte
+ *
+ *  \return    0 | error code
+ *
+ *  \sa SMB2API_ReadByteData
+ *
+ ****************************************************************************/
+int32 __MAPILIB SMB2API_XferGroupAddReadByteData(
+	void		*grpHdl,
+	u_int32		flags,
+	u_int16		addr,
+	u_int8		cmdAddr,
+	u_int8		*dataP )
+{
+	SMB2_XFER_GROUP_ENTRY *entry;
+	XFER_RESULT *res;
+	int32 rv;
+
+	if( (rv = XferGroupAdd( grpHdl, SMB2_BLK_READ_BYTE_DATA, flags, addr,
+							cmdAddr, &entry, &res )) )
+		return rv;
+
+	res->byteP = dataP;
+
+	return 0;
+}
+
+/****************************************************************************/
+/** Add a write word data transfer to a transaction group
+ *
+ *---------------------------------------------------------------------------
+ *  \param     grpHdl	  \IN transaction group handle
+ *	\param     flags      \IN flags, see \ref _SMB2_FLAG
+ *	\param     addr	      \IN device address
+ *	\param     cmdAddr	  \IN device command or index value
+ *	\param     data		  \IN word to write
+ *
+ *  \return    0 | error code
+ *
+ *  \sa SMB2API_WriteWordData
+ *
+ ****************************************************************************/
+int32 __MAPILIB SMB2API_XferGroupAddWriteWordData(
+	void		*grpHdl,
+	u_int32		flags,
+	u_int16		addr,
+	u_int8		cmdAddr,
+	u_int16		data )
+{
+	SMB2_XFER_GROUP_ENTRY *entry;
+	XFER_RESULT *res;
+	int32 rv;
+
+	if( (rv = XferGroupAdd( grpHdl, SMB2_BLK_WRITE_WORD_DATA, flags, addr,
+							cmdAddr, &entry, &res )) )
+		return rv;
+
+	entry->u.trx.u.wordData = data;
+
+	return 0;
+}
+
+/****************************************************************************/
+/** Add a read word data transfer to a transaction group
+ *
+ *  \a dataP will be filled on SMB2API_XferGroupCommit().
+ *
+ *---------------------------------------------------------------------------
+ *  \param     grpHdl	  \IN transaction group handle
+ *	\param     flags      \IN flags, see \ref _SMB2_FLAG
+ *	\param     addr	      \IN device address
+ *	\param     cmdAddr	  \IN device command or index value
+ *	\param     dataP	  \OUT read word
+ *
+ *  \return    0 | error code
+ *
+ *  \sa SMB2API_ReadWordData
+ *
+ ****************************************************************************/
+int32 __MAPILIB SMB2API_XferGroupAddReadWordData(
+	void		*grpHdl,
+	u_int32		flags,
+	u_int16		addr,
+	u_int8		cmdAddr,
+	u_int16		*dataP )
+{
+	SMB2_XFER_GROUP_ENTRY *entry;
+	XFER_RESULT *res;
+	int32 rv;
+
+	if( (rv = XferGroupAdd( grpHdl, SMB2_BLK_READ_WORD_DATA, flags, addr,
+							cmdAddr, &entry, &res )) )
+		return rv;
+
+	res->wordP = dataP;
+
+	return 0;
+}
+
+/****************************************************************************/
+/** Add a write block data transfer to a transaction group
+ *
+ *  The data block is copied, so \a dataP may be reused after the call.
+ *
+ *---------------------------------------------------------------------------
+ *  \param     grpHdl	  \IN transaction group handle
+ *	\param     flags      \IN flags, see \ref _SMB2_FLAG
+ *	\param     addr	      \IN device address
+ *	\param     cmdAddr	  \IN device command or index value
+ *	\param     length	  \IN number of bytes to write
+ *	\param     dataP	  \IN data block to write (1..32 bytes)
+ *
+ *  \return    0 | error code
+ *
+ *  \sa SMB2API_WriteBlockData
+ *
+ ****************************************************************************/
+int32 __MAPILIB SMB2API_XferGroupAddWriteBlockData(
+	void		*grpHdl,
+	u_int32		flags,
+	u_int16		addr,
+	u_int8		cmdAddr,
+	u_int8		length,
+	u_int8		*dataP )
+{
+	SMB2_XFER_GROUP_ENTRY *entry;
+	XFER_RESULT *res;
+	int32 rv;
+
+	/* check length */
+	if( (length < 1) || (length > SMB_BLOCK_MAX_BYTES) )
+		return (SMB_ERR_PARAM);
+
+	if( (rv = XferGroupAdd( grpHdl, SMB2_BLK_WRITE_BLOCK_DATA, flags, addr,
+							cmdAddr, &entry, &res )) )
+		return rv;
+
+	entry->u.trxBlk.u.length = length;
+	memcpy( (void*)entry->u.trxBlk.data, (void*)dataP, length );
+
+	return 0;
+}
+
+/****************************************************************************/
+/** Add a read block data transfer to a transaction group
+ *
+ *  \a lengthP and \a dataP will be filled on SMB2API_XferGroupCommit().
+ *
+ *---------------------------------------------------------------------------
+ *  \param     grpHdl	  \IN transaction group handle
+ *	\param     flags      \IN flags, see \ref _SMB2_FLAG
+ *	\param     addr	      \IN device address
+ *	\param     cmdAddr	  \IN device command or index value
+ *	\param     lengthP	  \OUT number of bytes read
+ *	\param     dataP	  \OUT read data block (1..32 bytes)
+ *
+ *  \return    0 | error code
+ *
+ *  \sa SMB2API_ReadBlockData
+ *
+ ****************************************************************************/
+int32 __MAPILIB SMB2API_XferGroupAddReadBlockData(
+	void		*grpHdl,
+	u_int32		flags,
+	u_int16		addr,
+	u_int8		cmdAddr,
+	u_int8		*lengthP,
+	u_int8		*dataP )
+{
+	SMB2_XFER_GROUP_ENTRY *entry;
+	XFER_RESULT *res;
+	int32 rv;
+
+	if( (rv = XferGroupAdd( grpHdl, SMB2_BLK_READ_BLOCK_DATA, flags, addr,
+							cmdAddr, &entry, &res )) )
+		return rv;
+
+	*lengthP = 0;
+	res->lengthP = lengthP;
+	res->dataP = dataP;
+
+	return 0;
+}
+
+/****************************************************************************/
+/** Add a process call to a transaction group
+ *
+ *  \a dataP will be read now and overwritten on SMB2API_XferGroupCommit().
+ *
+ *---------------------------------------------------------------------------
+ *  \param     grpHdl	  \IN transaction group handle
+ *	\param     flags      \IN flags, see \ref _SMB2_FLAG
+ *	\param     addr	      \IN device address
+ *	\param     cmdAddr	  \IN device command or index value
+ *	\param     dataP	  \INOUT word to write / read word
+ *
+ *  \return    0 | error code
+ *
+ *  \sa SMB2API_ProcessCall
+ *
+ ****************************************************************************/
+int32 __MAPILIB SMB2API_XferGroupAddProcessCall(
+	void		*grpHdl,
+	u_int32		flags,
+	u_int16		addr,
+	u_int8		cmdAddr,
+	u_int16		*dataP )
+{
+	SMB2_XFER_GROUP_ENTRY *entry;
+	XFER_RESULT *res;
+	int32 rv;
+
+	if( (rv = XferGroupAdd( grpHdl, SMB2_BLK_PROCESS_CALL, flags, addr,
+							cmdAddr, &entry, &res )) )
+		return rv;
+
+	res->wordIn = *dataP;
+	res->wordP = dataP;
+
+	return 0;
+}
+
+/****************************************************************************/
+/** Execute all transfers of a transaction group
+ *
+ *  All transfers are passed to the driver with one call and executed
+ *  without interruption by other applications. On success the result
+ *  pointers of the read transfers are filled.
+ *
+ *  Without #SMB2_XFER_GROUP_CONT the execution stops at the first failed
+ *  transfer and its error code is returned; SMB2API_XferGroupError()
+ *  then reports the executed transfers. With #SMB2_XFER_GROUP_CONT
+ *  the results of all successful transfers are filled and the error
+ *  of each transfer must be checked with SMB2API_XferGroupError().
+ *
+ *---------------------------------------------------------------------------
+ *  \param     grpHdl	  \IN transaction group handle
+ *
+ *  \return    0 | error code
+ *
+ *  \sa SMB2API_XferGroupBegin, SMB2API_XferGroupError
+ *
+ ****************************************************************************/
+int32 __MAPILIB SMB2API_XferGroupCommit( void *grpHdl )
+{
+	XFER_GROUP_HANDLE		*h = (XFER_GROUP_HANDLE*)grpHdl;
+	SMB2_XFER_GROUP_ENTRY	*entry;
+	XFER_RESULT				*res;
+	M_SG_BLOCK				blk;
+	u_int32					n;
+	int32					rv;
+
+	if( h->grp->num == 0 )
+		return 0;
+
+	/* no results of a previous commit if the driver call fails */
+	h->grp->done = 0;
+
+	/* the driver returned the read word of a process call in its entry */
+	for( n=0; n<h->grp->num; n++ ){
+		if( h->grp->entry[n].code == SMB2_BLK_PROCESS_CALL )
+			h->grp->entry[n].u.trx.u.wordData = h->res[n].wordIn;
+	}
+
+	blk.size = SMB2_XFER_GROUP_SIZE(h->grp->num);
+	blk.data = (void*)h->grp;
+	rv = M_getstat( ((SMB_HANDLE*)h->smbHdl)->path, SMB2_BLK_XFER_GROUP,
+					(int32*)&blk );
+	if( rv )
+		return UOS_ErrnoGet();
+
+	/* copy results of successful transfers */
+	for( n=0; n<h->grp->done; n++ ){
+		entry = &h->grp->entry[n];
+		res = &h->res[n];
+
+		if( entry->error )
+			continue;
+
+		switch( entry->code ){
+		case SMB2_BLK_READ_BYTE:
+		case SMB2_BLK_READ_BYTE_DATA:
+			*res->byteP = entry->u.trx.u.byteData;
+			break;
+		case SMB2_BLK_READ_WORD_DATA:
+		case SMB2_BLK_PROCESS_CALL:
+			*res->wordP = entry->u.trx.u.wordData;
+			break;
+		case SMB2_BLK_READ_BLOCK_DATA:
+			*res->lengthP = entry->u.trxBlk.u.length;
+			memcpy( (void*)res->dataP, (void*)entry->u.trxBlk.data,
+					*res->lengthP );
+			break;
+		}
+	}
+
+	/* without SMB2_XFER_GROUP_CONT the driver stops at the failed transfer */
+	if( !(h->grp->flags & SMB2_XFER_GROUP_CONT) && h->grp->done )
+		return h->grp->entry[h->grp->done - 1].error;
+
+	return 0;
+}
+
+/****************************************************************************/
+/** Get the result of one transfer of a committed transaction group
+ *
+ *---------------------------------------------------------------------------
+ *  \param     grpHdl	  \IN transaction group handle
+ *	\param     idx        \IN index of transfer (order of adding, 0..n-1)
+ *
+ *  \return    0 | error code of the transfer |
+ *             #SMB_ERR_PARAM if the transfer was not executed
+ *
+ *  \sa SMB2API_XferGroupCommit
+ *
+ ****************************************************************************/
+int32 __MAPILIB SMB2API_XferGroupError(
+	void		*grpHdl,
+	u_int32		idx )
+{
+	XFER_GROUP_HANDLE *h = (XFER_GROUP_HANDLE*)grpHdl;
+
+	if( idx >= h->grp->done )
+		return (SMB_ERR_PARAM);
+
+	return h->grp->entry[idx].error;
+}
+
 /*! @} */
 
 /* * * * * * * * * * * * * * * helper funtion * * * * * * * * * * * * * *
@@ -1063,6 +1692,50 @@ static void zeroOut( int8 *p, int32 size ){
 		*p++ = 0;
 }
 
+/* * * * * * * * * * * * * * * helper funtion * * * * * * * * * * * * * *
+ *
+ * Append transfer to transaction group and return entry and result slot
+ */
+static int32 XferGroupAdd(
+	void					*grpHdl,
+	int32					code,
+	u_int32					flags,
+	u_int16					addr,
+	u_int8					cmdAddr,
+	SMB2_XFER_GROUP_ENTRY	**entryP,
+	XFER_RESULT				**resP )
+{
+	XFER_GROUP_HANDLE		*h = (XFER_GROUP_HANDLE*)grpHdl;
+	SMB2_XFER_GROUP_ENTRY	*entry;
+	XFER_RESULT				*res;
+
+	if( h->grp->num >= h->maxNum )
+		return (SMB_ERR_PARAM);
+
+	entry = &h->grp->entry[h->grp->num];
+	res = &h->res[h->grp->num];
+	h->grp->num++;
+
+	zeroOut( (int8*)entry, sizeof(SMB2_XFER_GROUP_ENTRY) );
+	zeroOut( (int8*)res, sizeof(XFER_RESULT) );
+
+	entry->code = code;
+	if( code == SMB2_BLK_WRITE_BLOCK_DATA || code == SMB2_BLK_READ_BLOCK_DATA ){
+		entry->u.trxBlk.flags = flags;
+		entry->u.trxBlk.addr = addr;
+		entry->u.trxBlk.cmdAddr = cmdAddr;
+	}
+	else {
+		entry->u.trx.flags = flags;
+		entry->u.trx.addr = addr;
+		entry->u.trx.cmdAddr = cmdAddr;
+	}
+
+	*entryP = entry;
+	*resP = res;
+	return 0;
+}
+
 /* * * * * * * * * * * * * * * helper funtion * * * * * * * * * * * * * *
  *
  * Remove specified alert node
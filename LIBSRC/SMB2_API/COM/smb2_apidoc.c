@@ -75,6 +75,13 @@
   - Quick command SMB2API_QuickComm()
   - Read/write using the I2C protocol SMB2API_I2CXfer()
 
+  <b>Transaction groups</b>\n
+  - Collect several transfers and execute them with one driver call
+    without interruption by other applications (e.g. set index register,
+    then read indexed data) SMB2API_XferGroupBegin(), SMB2API_XferGroupAddXxx(),
+    SMB2API_XferGroupCommit(), SMB2API_XferGroupError(),
+    SMB2API_XferGroupReset(), SMB2API_XferGroupEnd()
+
   <b>Alert support</b>\n
   - Issue a read byte command to the Alert Response Address SMB2API_AlertResponse()
   - Install/remove alert callback function SMB2API_AlertCbInstall(), SMB2API_AlertCbInstallSig(), SMB2API_AlertCbRemove()
@@ -0,0 +1,213 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************/
+/*!
+ *        \file  smb2_os.c
+ *
+ *      \author  quoc.bui@men.de
+ *
+ *       \brief  Thread and mutex wrappers for the SMB2 libraries and tools
+ *
+ *               USR_OSS has no thread API, so the native Win32 or POSIX
+ *               thread functions are used. Shared by the background
+ *               services of SMB2_BMC_API and SMB2_SHC and the SMB2 tools.
+ *
+ *    \switches  WINNT
+ *
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2014-2019, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+ /*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <MEN/men_typs.h>
+#include <MEN/mdis_err.h>
+#include <MEN/smb2_api.h>
+#include <MEN/smb2_os.h>
+
+/*-----------------------------------------+
+|  TYPEDEFS                                |
++-----------------------------------------*/
+/** start parameters passed to the new thread */
+typedef struct
+{
+	SMB2_OS_THREAD_FUNC	func;	/**< thread function */
+	void				*arg;	/**< argument for func */
+}THREAD_START;
+
+/*-----------------------------------------+
+|  STATICS                                 |
++-----------------------------------------*/
+#ifdef WINNT
+/****************************************************************************/
+/** Win32 thread entry
+*
+*  \param     param    \IN  THREAD_START (freed here)
+*  \return    0
+*/
+static DWORD WINAPI ThreadEntry(LPVOID param)
+{
+	THREAD_START start = *(THREAD_START*)param;
+
+	free(param);
+	start.func(start.arg);
+	return 0;
+}
+#else
+/****************************************************************************/
+/** POSIX thread entry
+*
+*  \param     param    \IN  THREAD_START (freed here)
+*  \return    NULL
+*/
+static void *ThreadEntry(void *param)
+{
+	THREAD_START start = *(THREAD_START*)param;
+
+	free(param);
+	start.func(start.arg);
+	return NULL;
+}
+#endif
+
+/****************************************************************************/
+/** Create a thread
+*
+*  If \a rtPrio is set, the thread is raised to real-time priority
+*  (THREAD_PRIORITY_TIME_CRITICAL resp. SCHED_FIFO). If the caller lacks
+*  the privilege for this, the thread runs with normal priority.
+*
+*  \param     threadP    \OUT  thread
+*  \param     func       \IN   thread function
+*  \param     arg        \IN   argument for func
+*  \param     rtPrio     \IN   0=normal priority, 1=real-time priority
+*  \return    0 on success or error code
+*/
+int32 __MAPILIB SMB2_OsThreadCreate(
+	SMB2_OS_THREAD *threadP,
+	SMB2_OS_THREAD_FUNC func,
+	void *arg,
+	int rtPrio)
+{
+	THREAD_START *start;
+#ifndef WINNT
+	struct sched_param sp;
+#endif
+
+	if ((start = (THREAD_START*)malloc(sizeof(THREAD_START))) == NULL)
+		return SMB_ERR_NO_MEM;
+
+	start->func = func;
+	start->arg = arg;
+
+#ifdef WINNT
+	*threadP = CreateThread(NULL, 0, ThreadEntry, start, 0, NULL);
+	if (*threadP == NULL) {
+		free(start);
+		return SMB_ERR_GENERAL;
+	}
+
+	if (rtPrio)
+		SetThreadPriority(*threadP, THREAD_PRIORITY_TIME_CRITICAL);
+#else
+	if (pthread_create(threadP, NULL, ThreadEntry, start)) {
+		free(start);
+		return SMB_ERR_GENERAL;
+	}
+
+	if (rtPrio) {
+		memset(&sp, 0, sizeof(sp));
+		sp.sched_priority = sched_get_priority_max(SCHED_FIFO);
+		/* fails with EPERM for unprivileged callers: keep priority */
+		pthread_setschedparam(*threadP, SCHED_FIFO, &sp);
+	}
+#endif
+
+	return SMB_ERR_NO;
+}
+
+/****************************************************************************/
+/** Wait for termination of a thread
+*
+*  \param     threadP    \IN  thread from SMB2_OsThreadCreate
+*/
+void __MAPILIB SMB2_OsThreadJoin(SMB2_OS_THREAD *threadP)
+{
+#ifdef WINNT
+	WaitForSingleObject(*threadP, INFINITE);
+	CloseHandle(*threadP);
+#else
+	pthread_join(*threadP, NULL);
+#endif
+}
+
+/****************************************************************************/
+/** Initialize a mutex
+*
+*  \param     mutexP    \OUT  mutex
+*/
+void __MAPILIB SMB2_OsMutexInit(SMB2_OS_MUTEX *mutexP)
+{
+#ifdef WINNT
+	InitializeCriticalSection(mutexP);
+#else
+	pthread_mutex_init(mutexP, NULL);
+#endif
+}
+
+/****************************************************************************/
+/** Lock a mutex
+*
+*  \param     mutexP    \IN  mutex
+*/
+void __MAPILIB SMB2_OsMutexLock(SMB2_OS_MUTEX *mutexP)
+{
+#ifdef WINNT
+	EnterCriticalSection(mutexP);
+#else
+	pthread_mutex_lock(mutexP);
+#endif
+}
+
+/****************************************************************************/
+/** Unlock a mutex
+*
+*  \param     mutexP    \IN  mutex
+*/
+void __MAPILIB SMB2_OsMutexUnlock(SMB2_OS_MUTEX *mutexP)
+{
+#ifdef WINNT
+	LeaveCriticalSection(mutexP);
+#else
+	pthread_mutex_unlock(mutexP);
+#endif
+}
+
+/****************************************************************************/
+/** Destroy a mutex
+*
+*  \param     mutexP    \IN  mutex
+*/
+void __MAPILIB SMB2_OsMutexDestroy(SMB2_OS_MUTEX *mutexP)
+{
+#ifdef WINNT
+	DeleteCriticalSection(mutexP);
+#else
+	pthread_mutex_destroy(mutexP);
+#endif
+}
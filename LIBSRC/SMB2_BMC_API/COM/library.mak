@@ -26,13 +26,22 @@ STAMPED_REVISION="13Y004-06_01_42-24-ge5f4d78-dirty_2019-05-30"
 
 DEF_REVISION=MAK_REVISION=$(STAMPED_REVISION)
 MAK_SWITCH=$(SW_PREFIX)$(DEF_REVISION)
+# background service threads (smb2_os) use POSIX threads
 MAK_LIBS=$(LIB_PREFIX)$(MEN_LIB_DIR)/smb2_api$(LIB_SUFFIX)  \
+         $(LIB_PREFIX)$(MEN_LIB_DIR)/usr_oss$(LIB_SUFFIX)   \
+         -lpthread                                          \
 
 MAK_INCL=$(MEN_INC_DIR)/men_typs.h  \
+         $(MEN_INC_DIR)/usr_oss.h   \
          $(MEN_INC_DIR)/smb2_api.h  \
-         $(MEN_INC_DIR)/smb2_bmc_api.h
+         $(MEN_INC_DIR)/smb2_drv.h  \
+         $(MEN_INC_DIR)/smb2_os.h   \
+         $(MEN_INC_DIR)/smb2_bmc_api.h \
+         $(MEN_MOD_DIR)/smb2_bmc_int.h
 
 MAK_INP1 = smb2_bmc_api$(INP_SUFFIX)
+MAK_INP2 = smb2_bmc_wdog$(INP_SUFFIX)
+MAK_INP3 = smb2_bmc_sampler$(INP_SUFFIX)
 
-MAK_INP  = $(MAK_INP1)
+MAK_INP  = $(MAK_INP1) $(MAK_INP2) $(MAK_INP3)
 
@@ -32,9 +32,12 @@
 #include <stdlib.h>
 
 #include <MEN/men_typs.h>
+#include <MEN/usr_oss.h>
 #include <MEN/smb2_bmc_api.h>
 #include <MEN/smb2_api.h>
+#include <MEN/smb2_drv.h>
 #include <MEN/mdis_err.h>
+#include "smb2_bmc_int.h"
 
 static const char IdentString[]=MENT_XSTR(MAK_REVISION);
 
@@ -148,6 +151,7 @@ static const char IdentString[]=MENT_XSTR(MAK_REVISION);
 #define STATUSOUT_HOTSWAP		0x02
 #define STATUSOUT_STA			0x01
 #define GPIO_ERR				0x80
+#define GPIO_MASK				0x7F
 #define RTC_BATTERY_LOW			0x01
 
 #define BMC_GET_FW_REV_LENGTH	0x07
@@ -168,13 +172,111 @@ static const char IdentString[]=MENT_XSTR(MAK_REVISION);
 #define RTC_GET_LENGTH			0x09
 #define BMC_STAT_FRM_LENGTH		0x09
 
-#define ERROR_CODE				0xFF			
+#define ERROR_CODE				0xFF
+
+#define EVLOG_BATCH				64		/* events per transaction group */
+
+#define HR_BYTE					0		/* health read: ReadByteData */
+#define HR_WORD					1		/* health read: ReadWordData */
+#define HR_BLOCK				2		/* health read: ReadBlockData */
+
+/* reject call if feature set is known to be unsupported */
+#define BMC_CHECK_CAP(cap) \
+	do { \
+		if (h->capsValid && !(h->caps & (cap))) \
+			return SMB2_BMC_ERR_NOT_SUPPORTED; \
+	} while (0)
+
+/* feature set is supported or unknown */
+#define BMC_HAS_CAP(cap) \
+	(!h->capsValid || (h->caps & (cap)))
+
+/*-----------------------------------------+
+|  TYPEDEFS                                |
++-----------------------------------------*/
+/** BMC handle */
+typedef struct
+{
+	void		*smbHdl;		/**< SMB handle */
+	u_int16		addr;			/**< SMBus address of the BMC */
+	u_int8		voltMaxNum;		/**< number of voltages (0=not read yet) */
+	u_int8		errCntNum;		/**< number of error counters (0=not read yet) */
+	int			capsValid;		/**< caps read from BMC */
+	u_int32		caps;			/**< SMB2_BMC_CAP_xxx bitmap */
+	int			fwVersionValid;	/**< fwVersion read from BMC */
+	struct bmc_fwversion fwVersion;	/**< firmware version */
+	int			gpioCapsValid;	/**< gpoCaps/gpiCaps read from BMC */
+	u_int8		gpoCaps;		/**< supported GPOs bitmap */
+	u_int8		gpiCaps;		/**< supported GPIs bitmap */
+	int			errCntLastValid;	/**< errCntLast holds a readout */
+	u_int16		errCntLast[SMB2_BMC_ERRCNT_MAX];	/**< error counters of
+											the last SMB2BMC_ErrCnt_GetChanged */
+}BMC_HANDLE;
+
+/** one read of a health snapshot */
+typedef struct
+{
+	u_int32		section;	/**< SMB2_BMC_HEALTH_xxx section */
+	int			type;		/**< HR_BYTE, HR_WORD or HR_BLOCK */
+	u_int8		cmd;		/**< read command */
+	int			idxSet;		/**< write index with idxCmd before reading */
+	u_int8		idxCmd;		/**< command to set the index */
+	u_int8		idx;		/**< index */
+	u_int8		byteData;	/**< HR_BYTE result */
+	u_int16		wordData;	/**< HR_WORD result */
+	u_int8		length;		/**< HR_BLOCK result length */
+	u_int8		blkData[SMB_BLOCK_MAX_BYTES];	/**< HR_BLOCK result */
+	int32		err;		/**< result of the read */
+}HEALTH_READ;
 
 /*-----------------------------------------+
 |  GLOBALS                                 |
 +-----------------------------------------*/
 void *SMB2BMC_smbHdl;
 
+/* BMC handle used by the functions without handle */
+static BMC_HANDLE G_bmc;
+
+/*-----------------------------------------+
+|  PROTOTYPES                              |
++-----------------------------------------*/
+static int32 BmcOpen(BMC_HANDLE *h, char *deviceP, u_int16 addr);
+static int32 BmcClose(BMC_HANDLE *h);
+static int32 IndexedBlockRead(BMC_HANDLE *h, u_int8 idx_cmd, u_int16 idx,
+							  int word_idx, u_int8 read_cmd, u_int8 *length,
+							  u_int8 *blkData);
+static int32 CapsRead(BMC_HANDLE *h, u_int32 *caps);
+static int32 FirmVerRead(BMC_HANDLE *h, struct bmc_fwversion *fw_version);
+static int32 GpioRead(BMC_HANDLE *h);
+static void HealthReadAdd(HEALTH_READ *rd, u_int32 *num, u_int32 section,
+						  int type, u_int8 cmd, int idxSet, u_int8 idxCmd,
+						  u_int8 idx);
+static int32 HealthReadExec(BMC_HANDLE *h, HEALTH_READ *rd, u_int32 num,
+							u_int32 *requests);
+static void StatusFrameDecode(u_int8 *blkData,
+							  struct bmc_status_frame *status_frame);
+static int32 VoltReportDecode(u_int8 length, u_int8 *blkData,
+							  struct bmc_voltage_report *volt_report);
+static int32 EventReportDecode(u_int8 length, u_int8 *blkData,
+							   struct bmc_event_report *event_report);
+static int32 RstReasonDecode(u_int8 length, u_int8 *blkData,
+							 struct bmc_rst_reason *reset_reason);
+static int32 CounterDecode(u_int8 length, u_int8 exp_length, u_int8 *blkData,
+						   u_int32 *value);
+static int32 ErrCntDecode(u_int8 length, u_int8 *blkData, u_int16 *error_cnt);
+static int32 ErrCntReadAll(BMC_HANDLE *h, u_int16 *counts);
+static int32 RtcDecode(u_int8 length, u_int8 *blkData, struct bmc_rtc *rtc);
+static int32 EvLogStatusDecode(u_int8 length, u_int8 *blkData,
+							   struct bmc_evlog_status *evlog_stat);
+static int EventReportEqual(struct bmc_event_report *a,
+							struct bmc_event_report *b);
+static int32 EventLogReadBatch(BMC_HANDLE *h, u_int16 first_idx, u_int16 num,
+							   struct bmc_event_report *event_report);
+static int32 EventLogCursorLoad(char *cursor_file, u_int16 *act_entries,
+								struct bmc_event_report *event_report);
+static int32 EventLogCursorStore(char *cursor_file, u_int16 act_entries,
+								 struct bmc_event_report *event_report);
+
 /**
  * \defgroup _SMB2_BMC SMB2_BMC
  *  The SMB2_BMC_API provides access functions to communicate
@@ -227,6 +329,7 @@ char* __MAPILIB SMB2BMC_Errstring(u_int32 errCode, char *strBuf)
 		{ SMB2_BMC_ERR_LENGTH	,		"Data has wrong length" },
 		{ SMB2_BMC_ERROR		,		"Error Code 0xFF" },
 		{ SMB2_BMC_ERR_INPUT    ,		"Invalid Input"},
+		{ SMB2_BMC_ERR_NOT_SUPPORTED,	"Feature not supported by BMC"},
 		/* max string size indicator  |1---------------------------------------------50| */
 	};
 
@@ -266,6 +369,14 @@ char* __MAPILIB SMB2BMC_Errstring(u_int32 errCode, char *strBuf)
 
 /****************************************************************************/
 /** Initialization of the BMC API library
+ *
+ *  The supported feature sets and the firmware version are read once.
+ *  Afterwards, functions of unsupported feature sets return
+ *  SMB2_BMC_ERR_NOT_SUPPORTED without accessing the BMC. If the
+ *  features cannot be read, all functions access the BMC.
+ *
+ *  To access more than one BMC, use SMB2BMC_Open() and the
+ *  SMB2BMC_H_xxx() functions instead.
  *
  *  \param     deviceP    \IN  MDIS device name
  *  \return    0 on success or error code
@@ -274,7 +385,12 @@ char* __MAPILIB SMB2BMC_Errstring(u_int32 errCode, char *strBuf)
  */
 int32 __MAPILIB SMB2BMC_Init(char *deviceP)
 {
-	return SMB2API_Init(deviceP, &SMB2BMC_smbHdl);
+	int err;
+
+	err = BmcOpen(&G_bmc, deviceP, BMC_SMBADDR);
+	SMB2BMC_smbHdl = G_bmc.smbHdl;
+
+	return err;
 }
 
 
@@ -287,10 +403,71 @@ int32 __MAPILIB SMB2BMC_Init(char *deviceP)
  */
 int32 __MAPILIB SMB2BMC_Exit()
 {
-	if (SMB2BMC_smbHdl)
-		return (SMB2API_Exit(&SMB2BMC_smbHdl));
+	int err;
+
+	err = BmcClose(&G_bmc);
+	SMB2BMC_smbHdl = NULL;
+
+	return err;
+}
+
+/****************************************************************************/
+/** Open a BMC and return a handle for the SMB2BMC_H_xxx() functions.
+ *
+ *  Each handle keeps its own SMB handle, address and cached BMC data,
+ *  so one process can access several BMCs. See SMB2BMC_Init() for
+ *  the cached data.
+ *
+ *  \param     deviceP    \IN   MDIS device name
+ *  \param     addr       \IN   SMBus address of the BMC (e.g. SMB2_BMC_SMBADDR)
+ *  \param     bmcHdlP    \OUT  BMC handle
+ *  \return    0 on success or error code
+ *
+ *  \sa SMB2BMC_Close
+ */
+int32 __MAPILIB SMB2BMC_Open(char *deviceP, u_int16 addr, void **bmcHdlP)
+{
+	int err;
+	BMC_HANDLE *h;
+
+	*bmcHdlP = NULL;
+
+	h = (BMC_HANDLE*)malloc(sizeof(BMC_HANDLE));
+	if (!h)
+		return SMB_ERR_NO_MEM;
+
+	err = BmcOpen(h, deviceP, addr);
+
+	if (err) {
+		free(h);
+		return err;
+	}
+
+	*bmcHdlP = (void*)h;
+
+	return SMB2_BMC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Close a BMC handle opened with SMB2BMC_Open().
+ *
+ *  \param     bmcHdlP    \INOUT  BMC handle, set to NULL
+ *  \return    0 on success or error code
+ *
+ *  \sa SMB2BMC_Open
+ */
+int32 __MAPILIB SMB2BMC_Close(void **bmcHdlP)
+{
+	int err = 0;
+	BMC_HANDLE *h = (BMC_HANDLE*)*bmcHdlP;
 
-	return 0;
+	if (h) {
+		err = BmcClose(h);
+		free(h);
+	}
+	*bmcHdlP = NULL;
+
+	return err;
 }
 
 /****************************************************************************/
@@ -303,30 +480,32 @@ int32 __MAPILIB SMB2BMC_Exit()
 */
 int32 __MAPILIB SMB2BMC_GetFirm_Ver(struct bmc_fwversion *fw_version)
 {
-	int err;
-	u_int8 length;
-	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
-
-	err = SMB2API_ReadBlockData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
-				    BMC_GET_FW_REV, &length, blkData);
+	return SMB2BMC_H_GetFirm_Ver(&G_bmc, fw_version);
+}
 
-	if (err)
-		return err;
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_GetFirm_Ver().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_GetFirm_Ver, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_GetFirm_Ver(void *bmcHdl,
+	struct bmc_fwversion *fw_version)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
+	int err;
 
-	if (length != BMC_GET_FW_REV_LENGTH)
-		return SMB2_BMC_ERR_LENGTH;
+	if (!h->fwVersionValid) {
+		err = FirmVerRead(h, &h->fwVersion);
 
-	if(blkData[0] == ERROR_CODE)
-		return SMB2_BMC_ERROR;
-	
-	fw_version->maj_revision = blkData[1];
-	fw_version->min_revision = blkData[2];
+		if (err)
+			return err;
 
-	fw_version->mtnce_revision = blkData[3];
-	fw_version->build_nbr = (u_int16)blkData[4] << 8;
-	fw_version->build_nbr += blkData[5];
+		h->fwVersionValid = 1;
+	}
 
-	fw_version->veri_flag = blkData[6];
+	*fw_version = h->fwVersion;
 
 	return SMB2_BMC_ERR_NO;
 }
@@ -341,9 +520,24 @@ int32 __MAPILIB SMB2BMC_GetFirm_Ver(struct bmc_fwversion *fw_version)
 */
 int32 __MAPILIB SMB2BMC_Set_HW_Brd(u_int16 s_board)
 {
+	return SMB2BMC_H_Set_HW_Brd(&G_bmc, s_board);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_Set_HW_Brd().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_Set_HW_Brd, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_Set_HW_Brd(void *bmcHdl, u_int16 s_board)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 		
-	err = SMB2API_WriteWordData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR, 
+	BMC_CHECK_CAP(SMB2_BMC_CAP_HWB);
+
+	err = SMB2API_WriteWordData(h->smbHdl, BMC_SMBFLAGS, h->addr, 
 								BMC_SET_HW_BRD, s_board);
 
 	if (err)
@@ -362,9 +556,24 @@ int32 __MAPILIB SMB2BMC_Set_HW_Brd(u_int16 s_board)
 */
 int32 __MAPILIB SMB2BMC_Get_HW_Brd(u_int16 *g_board)
 {
+	return SMB2BMC_H_Get_HW_Brd(&G_bmc, g_board);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_Get_HW_Brd().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_Get_HW_Brd, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_Get_HW_Brd(void *bmcHdl, u_int16 *g_board)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 
-	err = SMB2API_ReadWordData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	BMC_CHECK_CAP(SMB2_BMC_CAP_HWB);
+
+	err = SMB2API_ReadWordData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								BMC_GET_HW_BRD, g_board);
 
 	if (err)
@@ -383,37 +592,87 @@ int32 __MAPILIB SMB2BMC_Get_HW_Brd(u_int16 *g_board)
 */
 int32 __MAPILIB SMB2BMC_Get_Features(struct bmc_features *features)
 {
+	return SMB2BMC_H_Get_Features(&G_bmc, features);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_Get_Features().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_Get_Features, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_Get_Features(void *bmcHdl,
+	struct bmc_features *features)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
-	u_int8 length;
-	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
-	
-	err = SMB2API_ReadBlockData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
-								BMC_GET_FEAT, &length, blkData);
 
-	if (err)
-		return err;
+	if (!h->capsValid) {
+		err = CapsRead(h, &h->caps);
 
-	if (length != BMC_GET_FEAT_LENGTH)
-		return SMB2_BMC_ERR_LENGTH;
-	
-	if(blkData[0] == ERROR_CODE)
-		return SMB2_BMC_ERROR;
-	
-	features->gpio_support		= blkData[1] & GPIO_SUPPORT;
-	features->cpci_support		= blkData[1] & CPCI_SUPPORT;
-	features->fup_support 		= blkData[1] & FUP_SUPPORT;
-	features->rtc_support 		= blkData[1] & RTC_SUPPORT;
-	features->errcnt_support 	= blkData[1] & ERRCNT_SUPPORT;
-	features->evlog_support  	= blkData[1] & EVLOG_SUPPORT;
-	features->vrep_support 		= blkData[1] & VREP_SUPPORT;
+		if (err)
+			return err;
+
+		h->capsValid = 1;
+	}
+
+	features->gpio_support		= (h->caps & SMB2_BMC_CAP_GPIO) ? 1 : 0;
+	features->cpci_support		= (h->caps & SMB2_BMC_CAP_CPCI) ? 1 : 0;
+	features->fup_support 		= (h->caps & SMB2_BMC_CAP_FUP) ? 1 : 0;
+	features->rtc_support 		= (h->caps & SMB2_BMC_CAP_RTC) ? 1 : 0;
+	features->errcnt_support 	= (h->caps & SMB2_BMC_CAP_ERRCNT) ? 1 : 0;
+	features->evlog_support  	= (h->caps & SMB2_BMC_CAP_EVLOG) ? 1 : 0;
+	features->vrep_support 		= (h->caps & SMB2_BMC_CAP_VREP) ? 1 : 0;
 	
-	features->clus_support		= blkData[2] & CLUS_SUPPORT;
+	features->clus_support		= (h->caps & SMB2_BMC_CAP_CLUS) ? 1 : 0;
 	
-	features->srtcr_support  	= blkData[5] & SRTCR_SUPPORT;
-	features->rsimd_support  	= blkData[5] & RSIMD_SUPPORT;
-	features->epfmd_support  	= blkData[5] & EPFMD_SUPPORT;
-	features->resmd_support  	= blkData[5] & RESMD_SUPPORT;
-	features->hwb_support  		= blkData[5] & HWB_SUPPORT;
+	features->srtcr_support  	= (h->caps & SMB2_BMC_CAP_SRTCR) ? 1 : 0;
+	features->rsimd_support  	= (h->caps & SMB2_BMC_CAP_RSIMD) ? 1 : 0;
+	features->epfmd_support  	= (h->caps & SMB2_BMC_CAP_EPFMD) ? 1 : 0;
+	features->resmd_support  	= (h->caps & SMB2_BMC_CAP_RESMD) ? 1 : 0;
+	features->hwb_support  		= (h->caps & SMB2_BMC_CAP_HWB) ? 1 : 0;
+
+	return SMB2_BMC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Get the capabilities.
+*
+*  Returns the supported feature sets as bitmap, read once on SMB2BMC_Init.
+*
+*  \param     caps    \OUT  SMB2_BMC_CAP_xxx bitmap
+*  \return    0 on success or error code
+*
+*  \sa SMB2BMC_Get_Features, SMB2BMC_H_Get_Caps
+*/
+int32 __MAPILIB SMB2BMC_Get_Caps(u_int32 *caps)
+{
+	return SMB2BMC_H_Get_Caps(&G_bmc, caps);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_Get_Caps().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_Get_Caps, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_Get_Caps(void *bmcHdl, u_int32 *caps)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
+	int err;
+
+	if (!h->capsValid) {
+		err = CapsRead(h, &h->caps);
+
+		if (err)
+			return err;
+
+		h->capsValid = 1;
+	}
+
+	*caps = h->caps;
 
 	return SMB2_BMC_ERR_NO;
 }
@@ -427,9 +686,22 @@ int32 __MAPILIB SMB2BMC_Get_Features(struct bmc_features *features)
 */
 int32 __MAPILIB SMB2BMC_WDOG_enable(void)
 {
+	return SMB2BMC_H_WDOG_enable(&G_bmc);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_WDOG_enable().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_WDOG_enable, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_WDOG_enable(void *bmcHdl)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 
-	err = SMB2API_WriteByte(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	err = SMB2API_WriteByte(h->smbHdl, BMC_SMBFLAGS, h->addr,
 							BMC_WDOG_ON);
 
 	if (err)
@@ -447,9 +719,22 @@ int32 __MAPILIB SMB2BMC_WDOG_enable(void)
 */
 int32 __MAPILIB SMB2BMC_WDOG_disable(void)
 {
+	return SMB2BMC_H_WDOG_disable(&G_bmc);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_WDOG_disable().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_WDOG_disable, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_WDOG_disable(void *bmcHdl)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 
-	err = SMB2API_WriteByteData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	err = SMB2API_WriteByteData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								BMC_WDOG_OFF, WDOG_OFF);
 
 	if (err)
@@ -467,9 +752,22 @@ int32 __MAPILIB SMB2BMC_WDOG_disable(void)
 */
 int32 __MAPILIB SMB2BMC_WDOG_trig(void)
 {
+	return SMB2BMC_H_WDOG_trig(&G_bmc);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_WDOG_trig().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_WDOG_trig, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_WDOG_trig(void *bmcHdl)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 
-	err = SMB2API_WriteByte(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	err = SMB2API_WriteByte(h->smbHdl, BMC_SMBFLAGS, h->addr,
 							BMC_WDOG_TRIG);
 
 	if (err)
@@ -489,9 +787,22 @@ int32 __MAPILIB SMB2BMC_WDOG_trig(void)
 */
 int32 __MAPILIB SMB2BMC_WDOG_TimeSet(u_int16 wd_max_tout)
 {
+	return SMB2BMC_H_WDOG_TimeSet(&G_bmc, wd_max_tout);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_WDOG_TimeSet().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_WDOG_TimeSet, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_WDOG_TimeSet(void *bmcHdl, u_int16 wd_max_tout)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 
-	err = SMB2API_WriteWordData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	err = SMB2API_WriteWordData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								BMC_WDOG_TIME_SET, wd_max_tout);
 
 	if (err)
@@ -511,9 +822,22 @@ int32 __MAPILIB SMB2BMC_WDOG_TimeSet(u_int16 wd_max_tout)
 */
 int32 __MAPILIB SMB2BMC_WDOG_TimeGet(u_int16 *wd_max_tout)
 {
+	return SMB2BMC_H_WDOG_TimeGet(&G_bmc, wd_max_tout);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_WDOG_TimeGet().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_WDOG_TimeGet, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_WDOG_TimeGet(void *bmcHdl, u_int16 *wd_max_tout)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 
-	err = SMB2API_ReadWordData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	err = SMB2API_ReadWordData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								BMC_WDOG_TIME_GET, wd_max_tout);
 
 	if (err)
@@ -537,9 +861,22 @@ int32 __MAPILIB SMB2BMC_WDOG_TimeGet(u_int16 *wd_max_tout)
 */
 int32 __MAPILIB SMB2BMC_WDOG_GetState(u_int8 *wd_state)
 {
+	return SMB2BMC_H_WDOG_GetState(&G_bmc, wd_state);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_WDOG_GetState().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_WDOG_GetState, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_WDOG_GetState(void *bmcHdl, u_int8 *wd_state)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 
-	err = SMB2API_ReadByteData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	err = SMB2API_ReadByteData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								BMC_WDOG_STATE_GET, wd_state);
 
 	if (err)
@@ -560,9 +897,22 @@ int32 __MAPILIB SMB2BMC_WDOG_GetState(u_int8 *wd_state)
 */
 int32 __MAPILIB SMB2BMC_WDOG_Arm(void)
 {
+	return SMB2BMC_H_WDOG_Arm(&G_bmc);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_WDOG_Arm().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_WDOG_Arm, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_WDOG_Arm(void *bmcHdl)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 
-	err = SMB2API_WriteByte(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	err = SMB2API_WriteByte(h->smbHdl, BMC_SMBFLAGS, h->addr,
 							BMC_WDOG_ARM);
 
 	if (err)
@@ -583,9 +933,22 @@ int32 __MAPILIB SMB2BMC_WDOG_Arm(void)
 */
 int32 __MAPILIB SMB2BMC_WDOG_GetArmState(u_int8 *arm_state)
 {
+	return SMB2BMC_H_WDOG_GetArmState(&G_bmc, arm_state);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_WDOG_GetArmState().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_WDOG_GetArmState, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_WDOG_GetArmState(void *bmcHdl, u_int8 *arm_state)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 
-	err = SMB2API_ReadByteData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	err = SMB2API_ReadByteData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								BMC_WDOG_ARM_STATE, arm_state);
 
 	if (err)
@@ -605,9 +968,22 @@ int32 __MAPILIB SMB2BMC_WDOG_GetArmState(u_int8 *arm_state)
 */
 int32 __MAPILIB SMB2BMC_WDOG_MinTimeSet(u_int16 wd_min_tout)
 {
+	return SMB2BMC_H_WDOG_MinTimeSet(&G_bmc, wd_min_tout);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_WDOG_MinTimeSet().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_WDOG_MinTimeSet, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_WDOG_MinTimeSet(void *bmcHdl, u_int16 wd_min_tout)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 
-	err = SMB2API_WriteWordData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	err = SMB2API_WriteWordData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								BMC_WDOG_MIN_TIME_SET, wd_min_tout);
 
 	if (err)
@@ -627,9 +1003,22 @@ int32 __MAPILIB SMB2BMC_WDOG_MinTimeSet(u_int16 wd_min_tout)
 */
 int32 __MAPILIB SMB2BMC_WDOG_MinTimeGet(u_int16 *wd_min_tout)
 {
+	return SMB2BMC_H_WDOG_MinTimeGet(&G_bmc, wd_min_tout);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_WDOG_MinTimeGet().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_WDOG_MinTimeGet, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_WDOG_MinTimeGet(void *bmcHdl, u_int16 *wd_min_tout)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 
-	err = SMB2API_ReadWordData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	err = SMB2API_ReadWordData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								BMC_WDOG_MIN_TIME_GET, wd_min_tout);
 
 	if (err)
@@ -641,6 +1030,33 @@ int32 __MAPILIB SMB2BMC_WDOG_MinTimeGet(u_int16 *wd_min_tout)
 	return SMB2_BMC_ERR_NO;
 }
 
+/****************************************************************************/
+/** Start the watchdog keep-alive service.
+*
+*  Reads the trigger window (SMB2BMC_WDOG_MinTimeGet, SMB2BMC_WDOG_TimeGet)
+*  and starts a thread with real-time priority that triggers the watchdog
+*  in the middle of the window. The time of the last trigger is unknown,
+*  so the first trigger is issued immediately, or at the lower window
+*  limit after the start if the window has one. If the caller has no
+*  privilege for real-time priority, the thread runs with normal priority.
+*
+*  The thread only uses the SMB handle and address of the library's BMC
+*  handle, none of its cached data, so other SMB2BMC functions may be
+*  called concurrently.
+*
+*  The service must be stopped with SMB2BMC_WDOG_KeepAliveStop before
+*  SMB2BMC_Exit is called.
+*
+*  \param     kaHdlP    \OUT  keep-alive handle
+*  \return    0 on success or error code
+*
+*  \sa SMB2BMC_WDOG_KeepAliveStop, SMB2BMC_WDOG_KeepAliveGetStats
+*/
+int32 __MAPILIB SMB2BMC_WDOG_KeepAliveStart(void **kaHdlP)
+{
+	return SMB2BMC_H_WDOG_KeepAliveStart(&G_bmc, kaHdlP);
+}
+
 /****************************************************************************/
 /** Set Power Resume Mode.
 *
@@ -654,12 +1070,27 @@ int32 __MAPILIB SMB2BMC_WDOG_MinTimeGet(u_int16 *wd_min_tout)
 */
 int32 __MAPILIB SMB2BMC_ResumeModeSet(u_int8 res_mode)
 {
+	return SMB2BMC_H_ResumeModeSet(&G_bmc, res_mode);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_ResumeModeSet().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_ResumeModeSet, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_ResumeModeSet(void *bmcHdl, u_int8 res_mode)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 
+	BMC_CHECK_CAP(SMB2_BMC_CAP_RESMD);
+
 	if ((res_mode < 0x00) || (res_mode > 0x02))
 		return SMB2_BMC_ERR_INPUT;
 	
-	err = SMB2API_WriteByteData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	err = SMB2API_WriteByteData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								BMC_RESUME_MODE_SET, res_mode);
 
 	if (err)
@@ -682,9 +1113,24 @@ int32 __MAPILIB SMB2BMC_ResumeModeSet(u_int8 res_mode)
 */
 int32 __MAPILIB SMB2BMC_ResumeModeGet(u_int8 *res_mode)
 {
+	return SMB2BMC_H_ResumeModeGet(&G_bmc, res_mode);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_ResumeModeGet().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_ResumeModeGet, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_ResumeModeGet(void *bmcHdl, u_int8 *res_mode)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 
-	err = SMB2API_ReadByteData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	BMC_CHECK_CAP(SMB2_BMC_CAP_RESMD);
+
+	err = SMB2API_ReadByteData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								BMC_RESUME_MODE_GET, res_mode);
 
 	if (err)
@@ -706,12 +1152,28 @@ int32 __MAPILIB SMB2BMC_ResumeModeGet(u_int8 *res_mode)
 */
 int32 __MAPILIB SMB2BMC_ExtPwrFailModeSet(u_int8 ext_pwr_fail_mode)
 {
+	return SMB2BMC_H_ExtPwrFailModeSet(&G_bmc, ext_pwr_fail_mode);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_ExtPwrFailModeSet().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_ExtPwrFailModeSet, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_ExtPwrFailModeSet(void *bmcHdl,
+	u_int8 ext_pwr_fail_mode)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 
+	BMC_CHECK_CAP(SMB2_BMC_CAP_EPFMD);
+
 	if ((ext_pwr_fail_mode < 0) || (ext_pwr_fail_mode > 1))
 		return SMB2_BMC_ERR_INPUT;
 	
-	err = SMB2API_WriteByteData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	err = SMB2API_WriteByteData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								BMC_EXT_PWR_FAIL_MODE_SET, ext_pwr_fail_mode);
 
 	if (err)
@@ -733,9 +1195,25 @@ int32 __MAPILIB SMB2BMC_ExtPwrFailModeSet(u_int8 ext_pwr_fail_mode)
 */
 int32 __MAPILIB SMB2BMC_ExtPwrFailModeGet(u_int8 *ext_pwr_fail_mode)
 {
+	return SMB2BMC_H_ExtPwrFailModeGet(&G_bmc, ext_pwr_fail_mode);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_ExtPwrFailModeGet().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_ExtPwrFailModeGet, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_ExtPwrFailModeGet(void *bmcHdl,
+	u_int8 *ext_pwr_fail_mode)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 
-	err = SMB2API_ReadByteData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	BMC_CHECK_CAP(SMB2_BMC_CAP_EPFMD);
+
+	err = SMB2API_ReadByteData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								BMC_EXT_PWR_FAIL_MODE_GET, ext_pwr_fail_mode);
 
 	if (err)
@@ -760,12 +1238,27 @@ int32 __MAPILIB SMB2BMC_ExtPwrFailModeGet(u_int8 *ext_pwr_fail_mode)
 */
 int32 __MAPILIB SMB2BMC_ResetInModeSet(u_int8 reset_in_mode)
 {
-	int err;
-	
-	if ((reset_in_mode < 0) || (reset_in_mode > 1))
-		return SMB2_BMC_ERR_INPUT;
-	
-	err = SMB2API_WriteByteData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	return SMB2BMC_H_ResetInModeSet(&G_bmc, reset_in_mode);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_ResetInModeSet().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_ResetInModeSet, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_ResetInModeSet(void *bmcHdl, u_int8 reset_in_mode)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
+	int err;
+	
+	BMC_CHECK_CAP(SMB2_BMC_CAP_RSIMD);
+
+	if ((reset_in_mode < 0) || (reset_in_mode > 1))
+		return SMB2_BMC_ERR_INPUT;
+	
+	err = SMB2API_WriteByteData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								BMC_RESET_IN_MODE_SET, reset_in_mode);
 
 	if (err)
@@ -787,9 +1280,24 @@ int32 __MAPILIB SMB2BMC_ResetInModeSet(u_int8 reset_in_mode)
 */
 int32 __MAPILIB SMB2BMC_ResetInModeGet(u_int8 *reset_in_mode)
 {
+	return SMB2BMC_H_ResetInModeGet(&G_bmc, reset_in_mode);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_ResetInModeGet().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_ResetInModeGet, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_ResetInModeGet(void *bmcHdl, u_int8 *reset_in_mode)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 
-	err = SMB2API_ReadByteData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	BMC_CHECK_CAP(SMB2_BMC_CAP_RSIMD);
+
+	err = SMB2API_ReadByteData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								BMC_RESET_IN_MODE_GET, reset_in_mode);
 
 	if (err)
@@ -829,6 +1337,19 @@ int32 __MAPILIB SMB2BMC_ResetInModeGet(u_int8 *reset_in_mode)
 */
 int32 __MAPILIB SMB2BMC_SW_Reset(u_int16 reset_cause)
 {
+	return SMB2BMC_H_SW_Reset(&G_bmc, reset_cause);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_SW_Reset().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_SW_Reset, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_SW_Reset(void *bmcHdl, u_int16 reset_cause)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 	u_int8 reset_cause_lsb;
 	u_int8 reset_cause_msb;
@@ -842,7 +1363,7 @@ int32 __MAPILIB SMB2BMC_SW_Reset(u_int16 reset_cause)
 	blkData[2] = reset_cause_lsb;
 	blkData[3] = reset_cause_msb;
 
-	err = SMB2API_WriteBlockData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	err = SMB2API_WriteBlockData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								 BMC_SW_RESET, SW_RESET_LENGTH, blkData);
 
 	if (err)
@@ -861,6 +1382,19 @@ int32 __MAPILIB SMB2BMC_SW_Reset(u_int16 reset_cause)
 */
 int32 __MAPILIB SMB2BMC_SW_ColdReset(u_int16 reset_cause)
 {
+	return SMB2BMC_H_SW_ColdReset(&G_bmc, reset_cause);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_SW_ColdReset().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_SW_ColdReset, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_SW_ColdReset(void *bmcHdl, u_int16 reset_cause)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 	u_int8 reset_cause_lsb;
 	u_int8 reset_cause_msb;
@@ -874,7 +1408,7 @@ int32 __MAPILIB SMB2BMC_SW_ColdReset(u_int16 reset_cause)
 	blkData[2] = reset_cause_lsb;
 	blkData[3] = reset_cause_msb;
 
-	err = SMB2API_WriteBlockData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	err = SMB2API_WriteBlockData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								 BMC_SW_COLD_RESET, SW_COLD_RESET_LENGTH, blkData);
 
 	if (err)
@@ -893,11 +1427,26 @@ int32 __MAPILIB SMB2BMC_SW_ColdReset(u_int16 reset_cause)
 */
 int32 __MAPILIB SMB2BMC_SW_RTC_Reset(u_int16 reset_cause)
 {
+	return SMB2BMC_H_SW_RTC_Reset(&G_bmc, reset_cause);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_SW_RTC_Reset().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_SW_RTC_Reset, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_SW_RTC_Reset(void *bmcHdl, u_int16 reset_cause)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 	u_int8 reset_cause_lsb;
 	u_int8 reset_cause_msb;
 	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
 	
+	BMC_CHECK_CAP(SMB2_BMC_CAP_SRTCR);
+
 	reset_cause_lsb = (u_int8)reset_cause;
 	reset_cause_msb = (u_int8)(reset_cause >> 8);
 	
@@ -906,7 +1455,7 @@ int32 __MAPILIB SMB2BMC_SW_RTC_Reset(u_int16 reset_cause)
 	blkData[2] = reset_cause_lsb;
 	blkData[3] = reset_cause_msb;
 
-	err = SMB2API_WriteBlockData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	err = SMB2API_WriteBlockData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								 BMC_SW_RTC_RESET, SW_RTC_RESET_LENGTH, blkData);
 
 	if (err)
@@ -925,6 +1474,19 @@ int32 __MAPILIB SMB2BMC_SW_RTC_Reset(u_int16 reset_cause)
 */
 int32 __MAPILIB SMB2BMC_SW_Halt(u_int16 reset_cause)
 {
+	return SMB2BMC_H_SW_Halt(&G_bmc, reset_cause);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_SW_Halt().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_SW_Halt, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_SW_Halt(void *bmcHdl, u_int16 reset_cause)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 	u_int8 reset_cause_lsb;
 	u_int8 reset_cause_msb;
@@ -938,7 +1500,7 @@ int32 __MAPILIB SMB2BMC_SW_Halt(u_int16 reset_cause)
 	blkData[2] = reset_cause_lsb;
 	blkData[3] = reset_cause_msb;
 	
-	err = SMB2API_WriteBlockData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	err = SMB2API_WriteBlockData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								 BMC_SW_HALT, SW_HALT_LENGTH, blkData);
 
 	if (err)
@@ -974,30 +1536,31 @@ int32 __MAPILIB SMB2BMC_SW_Halt(u_int16 reset_cause)
 */
 int32 __MAPILIB SMB2BMC_RstReasonGet(struct bmc_rst_reason *reset_reason)
 {
+	return SMB2BMC_H_RstReasonGet(&G_bmc, reset_reason);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_RstReasonGet().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_RstReasonGet, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_RstReasonGet(void *bmcHdl,
+	struct bmc_rst_reason *reset_reason)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 	u_int8 length;
 	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
 	
-	err = SMB2API_ReadBlockData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	err = SMB2API_ReadBlockData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								BMC_RST_REASON_GET, &length, blkData);
 
 	if (err)
 		return err;
 	
-	if (length != RST_REASON_LENGTH)
-		return SMB2_BMC_ERR_LENGTH;
-
-	if(blkData[0] == ERROR_CODE)
-		return SMB2_BMC_ERROR;
-	
-	reset_reason->procID = blkData[1];
-	reset_reason->ev_code = ((u_int16)blkData[3] << 8) + blkData[2];
-	reset_reason->ev_info1 = blkData[4];
-	reset_reason->ev_info2 = blkData[5];
-	reset_reason->ev_info3 = blkData[6];
-	reset_reason->ev_info4 = blkData[7];
-	
-	return SMB2_BMC_ERR_NO;
+	return RstReasonDecode(length, blkData, reset_reason);
 }
 
 /****************************************************************************/
@@ -1009,9 +1572,22 @@ int32 __MAPILIB SMB2BMC_RstReasonGet(struct bmc_rst_reason *reset_reason)
 */
 int32 __MAPILIB SMB2BMC_RstReasonCLR(void)
 {
+	return SMB2BMC_H_RstReasonCLR(&G_bmc);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_RstReasonCLR().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_RstReasonCLR, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_RstReasonCLR(void *bmcHdl)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 	
-	err = SMB2API_WriteByteData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	err = SMB2API_WriteByteData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								BMC_RST_REASON_CLR, RST_REASON_CLR);
 
 	if (err)
@@ -1030,9 +1606,24 @@ int32 __MAPILIB SMB2BMC_RstReasonCLR(void)
 */
 int32 __MAPILIB SMB2BMC_Volt_Max_Num(u_int8 *volt_max_num)
 {
+	return SMB2BMC_H_Volt_Max_Num(&G_bmc, volt_max_num);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_Volt_Max_Num().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_Volt_Max_Num, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_Volt_Max_Num(void *bmcHdl, u_int8 *volt_max_num)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 
-	err = SMB2API_ReadByteData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	BMC_CHECK_CAP(SMB2_BMC_CAP_VREP);
+
+	err = SMB2API_ReadByteData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								BMC_VOLT_MAX_NUM, volt_max_num);
 
 	if (err)
@@ -1052,33 +1643,129 @@ int32 __MAPILIB SMB2BMC_Volt_Max_Num(u_int8 *volt_max_num)
 */
 int32 __MAPILIB SMB2BMC_Volt_Get(u_int8 volt_idx, struct bmc_voltage_report *volt_report)
 {
+	return SMB2BMC_H_Volt_Get(&G_bmc, volt_idx, volt_report);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_Volt_Get().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_Volt_Get, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_Volt_Get(void *bmcHdl,
+	u_int8 volt_idx, struct bmc_voltage_report *volt_report)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 	u_int8 length;
 	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
 
-	err = SMB2API_WriteByteData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
-								BMC_VOLT_SET_IDX, volt_idx);
+	BMC_CHECK_CAP(SMB2_BMC_CAP_VREP);
+
+	err = IndexedBlockRead(h, BMC_VOLT_SET_IDX, volt_idx, 0,
+						   BMC_VOLTAGE_GET, &length, blkData);
 
 	if (err)
 		return err;
-	
-	err = SMB2API_ReadBlockData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
-								BMC_VOLTAGE_GET, &length, blkData);
+
+	return VoltReportDecode(length, blkData, volt_report);
+}
+
+/****************************************************************************/
+/** Get actual value and configured value of all voltages.
+*
+*  The number of voltages is read from the BMC on the first call only.
+*  All voltage reports are read with one transaction group.
+*
+*  If \a volt_report is too small for all voltages, SMB2_BMC_ERR_INPUT is
+*  returned and \a count is set to the number of voltages.
+*
+*  \param     volt_report    \OUT    voltage reports
+*  \param     count          \INOUT  in: number of elements in \a volt_report
+*                                    out: number of voltage reports read
+*  \return    0 on success or error code
+*
+*  \sa SMB2BMC_Volt_Get, SMB2BMC_H_Volt_GetAll
+*/
+int32 __MAPILIB SMB2BMC_Volt_GetAll(struct bmc_voltage_report *volt_report,
+									u_int8 *count)
+{
+	return SMB2BMC_H_Volt_GetAll(&G_bmc, volt_report, count);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_Volt_GetAll().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_Volt_GetAll, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_Volt_GetAll(void *bmcHdl,
+	struct bmc_voltage_report *volt_report, u_int8 *count)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
+	int err;
+	u_int8 volt_idx;
+	u_int8 *length;
+	u_int8 *blkData;
+	void *grpHdl;
+
+	BMC_CHECK_CAP(SMB2_BMC_CAP_VREP);
+
+	if (h->voltMaxNum == 0) {
+		err = SMB2BMC_H_Volt_Max_Num(h, &h->voltMaxNum);
+
+		if (err)
+			return err;
+
+		if (h->voltMaxNum > SMB2_BMC_VOLT_MAX)
+			h->voltMaxNum = SMB2_BMC_VOLT_MAX;
+	}
+
+	if (*count < h->voltMaxNum) {
+		*count = h->voltMaxNum;
+		return SMB2_BMC_ERR_INPUT;
+	}
+
+	*count = 0;
+	if (h->voltMaxNum == 0)
+		return SMB2_BMC_ERR_NO;
+
+	length = (u_int8*)malloc(h->voltMaxNum * (1 + SMB_BLOCK_MAX_BYTES));
+	if (!length)
+		return SMB_ERR_NO_MEM;
+	blkData = length + h->voltMaxNum;
+
+	err = SMB2API_XferGroupBegin(h->smbHdl, 0, 2 * h->voltMaxNum, &grpHdl);
+
+	for (volt_idx=0; !err && volt_idx < h->voltMaxNum; volt_idx++) {
+		err = SMB2API_XferGroupAddWriteByteData(grpHdl, BMC_SMBFLAGS,
+												h->addr, BMC_VOLT_SET_IDX,
+												volt_idx);
+		if (!err)
+			err = SMB2API_XferGroupAddReadBlockData(grpHdl, BMC_SMBFLAGS,
+								h->addr, BMC_VOLTAGE_GET, &length[volt_idx],
+								&blkData[volt_idx * SMB_BLOCK_MAX_BYTES]);
+	}
+
+	if (!err)
+		err = SMB2API_XferGroupCommit(grpHdl);
+
+	SMB2API_XferGroupEnd(&grpHdl);
+
+	for (volt_idx=0; !err && volt_idx < h->voltMaxNum; volt_idx++)
+		err = VoltReportDecode(length[volt_idx],
+							   &blkData[volt_idx * SMB_BLOCK_MAX_BYTES],
+							   &volt_report[volt_idx]);
+
+	free(length);
 
 	if (err)
 		return err;
-	
-	if (length != VOLT_REPORT_LENGTH)
-		return SMB2_BMC_ERR_LENGTH;
 
-	if(blkData[0] == ERROR_CODE)
-		return SMB2_BMC_ERROR;
-	
-	volt_report->actual_volt = ((u_int16)blkData[2] << 8)+ blkData[1];
-	volt_report->nominal_volt = ((u_int16)blkData[4] << 8) + blkData[3];
-	volt_report->low_lim_volt = ((u_int16)blkData[6] << 8) + blkData[5];
-	volt_report->up_lim_volt = ((u_int16)blkData[8] << 8) + blkData[7];
-	
+	*count = h->voltMaxNum;
+
 	return SMB2_BMC_ERR_NO;
 }
 
@@ -1092,25 +1779,30 @@ int32 __MAPILIB SMB2BMC_Volt_Get(u_int8 volt_idx, struct bmc_voltage_report *vol
 */
 int32 __MAPILIB SMB2BMC_Get_PwrCycleCnt(u_int32 *pwr_cycles)
 {
+	return SMB2BMC_H_Get_PwrCycleCnt(&G_bmc, pwr_cycles);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_Get_PwrCycleCnt().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_Get_PwrCycleCnt, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_Get_PwrCycleCnt(void *bmcHdl, u_int32 *pwr_cycles)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 	u_int8 length;
 	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
 	
-	err = SMB2API_ReadBlockData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	err = SMB2API_ReadBlockData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								BMC_PWRCYCLE_CNT, &length, blkData);
 
 	if (err)
 		return err;
 	
-	if (length != PWRCYCL_CNT_LENGTH)
-		return SMB2_BMC_ERR_LENGTH;
-
-	*pwr_cycles = (u_int32)(blkData[3] << 24);
-	*pwr_cycles += (u_int32)(blkData[2] << 16);
-	*pwr_cycles += (u_int32)(blkData[1] << 8);
-	*pwr_cycles += (u_int32)(blkData[0]);
-	
-	return SMB2_BMC_ERR_NO;
+	return CounterDecode(length, PWRCYCL_CNT_LENGTH, blkData, pwr_cycles);
 }
 
 /****************************************************************************/
@@ -1123,25 +1815,30 @@ int32 __MAPILIB SMB2BMC_Get_PwrCycleCnt(u_int32 *pwr_cycles)
 */
 int32 __MAPILIB SMB2BMC_Get_OpHoursCnt(u_int32 *op_time)
 {
+	return SMB2BMC_H_Get_OpHoursCnt(&G_bmc, op_time);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_Get_OpHoursCnt().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_Get_OpHoursCnt, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_Get_OpHoursCnt(void *bmcHdl, u_int32 *op_time)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 	u_int8 length;
 	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
 	
-	err = SMB2API_ReadBlockData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	err = SMB2API_ReadBlockData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								BMC_OP_HRS_CNT, &length, blkData);
 
 	if (err)
 		return err;
 	
-	if (length != OP_TIME_LENGTH)
-		return SMB2_BMC_ERR_LENGTH;
-
-	*op_time = (u_int32)(blkData[3] << 24);
-	*op_time += (u_int32)(blkData[2] << 16);
-	*op_time += (u_int32)(blkData[1] << 8);
-	*op_time += (u_int32)(blkData[0]);
-	
-	return SMB2_BMC_ERR_NO;
+	return CounterDecode(length, OP_TIME_LENGTH, blkData, op_time);
 }
 
 /****************************************************************************/
@@ -1154,29 +1851,33 @@ int32 __MAPILIB SMB2BMC_Get_OpHoursCnt(u_int32 *op_time)
 */
 int32 __MAPILIB SMB2BMC_Get_EventLog_Status(struct bmc_evlog_status *evlog_stat)
 {
+	return SMB2BMC_H_Get_EventLog_Status(&G_bmc, evlog_stat);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_Get_EventLog_Status().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_Get_EventLog_Status, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_Get_EventLog_Status(void *bmcHdl,
+	struct bmc_evlog_status *evlog_stat)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 	u_int8 length;
 	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
 	
-	err = SMB2API_ReadBlockData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	BMC_CHECK_CAP(SMB2_BMC_CAP_EVLOG);
+
+	err = SMB2API_ReadBlockData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								BMC_EVLOG_STAT, &length, blkData);
 
 	if (err)
 		return err;
 	
-	if (length != EVLOG_STAT_LENGTH)
-		return SMB2_BMC_ERR_LENGTH;
-	
-	if(blkData[0] == ERROR_CODE)
-		return SMB2_BMC_ERROR;
-	
-	evlog_stat->rtcts = blkData[1] & 0x01;
-	evlog_stat->max_entries = blkData[2];
-	evlog_stat->max_entries += (u_int16)blkData[3] << 8;
-	evlog_stat->act_entries = blkData[4];
-	evlog_stat->act_entries += (u_int16)blkData[5] << 8;
-	
-	return SMB2_BMC_ERR_NO;
+	return EvLogStatusDecode(length, blkData, evlog_stat);
 }
 
 /****************************************************************************/
@@ -1194,9 +1895,25 @@ int32 __MAPILIB SMB2BMC_Get_EventLog_Status(struct bmc_evlog_status *evlog_stat)
 int32 __MAPILIB SMB2BMC_Add_Event(u_int16 ev_code, u_int8 ev_info1, u_int8 ev_info2,
 									u_int8 ev_info3, u_int8 ev_info4)
 {
+	return SMB2BMC_H_Add_Event(&G_bmc, ev_code, ev_info1, ev_info2, ev_info3, ev_info4);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_Add_Event().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_Add_Event, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_Add_Event(void *bmcHdl,
+	u_int16 ev_code, u_int8 ev_info1, u_int8 ev_info2, u_int8 ev_info3, u_int8 ev_info4)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
 	
+	BMC_CHECK_CAP(SMB2_BMC_CAP_EVLOG);
+
 	blkData[0] = (u_int8)ev_code;
 	blkData[1] = (u_int8)(ev_code >> 8);
 	blkData[2] = ev_info1;
@@ -1204,7 +1921,7 @@ int32 __MAPILIB SMB2BMC_Add_Event(u_int16 ev_code, u_int8 ev_info1, u_int8 ev_in
 	blkData[4] = ev_info3;
 	blkData[5] = ev_info4;
 
-	err = SMB2API_WriteBlockData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	err = SMB2API_WriteBlockData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								 BMC_EVLOG_WRITE, EVLOG_WRITE_LENGTH, blkData);
 
 	if (err)
@@ -1225,120 +1942,402 @@ int32 __MAPILIB SMB2BMC_Add_Event(u_int16 ev_code, u_int8 ev_info1, u_int8 ev_in
 int32 __MAPILIB SMB2BMC_EventLog_Read(u_int16 evlog_idx, 
 									  struct bmc_event_report *event_report)
 {
+	return SMB2BMC_H_EventLog_Read(&G_bmc, evlog_idx, event_report);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_EventLog_Read().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_EventLog_Read, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_EventLog_Read(void *bmcHdl,
+	u_int16 evlog_idx, struct bmc_event_report *event_report)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 	u_int8 length;
 	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
 	
-	err = SMB2API_WriteWordData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR, 
-								BMC_EVLOG_READ_IDX, evlog_idx);
+	BMC_CHECK_CAP(SMB2_BMC_CAP_EVLOG);
 
-	if (err)
-		return err;
-	
-	err = SMB2API_ReadBlockData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
-								BMC_EVLOG_READ, &length, blkData);
+	err = IndexedBlockRead(h, BMC_EVLOG_READ_IDX, evlog_idx, 1,
+						   BMC_EVLOG_READ, &length, blkData);
 
 	if (err)
 		return err;
-	
-	if (length != EVLOG_READ_LENGTH)
-		return SMB2_BMC_ERR_LENGTH;
-	
-	if(blkData[0] == ERROR_CODE)
-		return SMB2_BMC_ERROR;
 
-	event_report->tstamp = ((u_int64)blkData[5] & 0x7F) << 32;
-	event_report->tstamp += (u_int64)blkData[4] << 24;
-	event_report->tstamp += (u_int64)blkData[3] << 16;
-	event_report->tstamp += (u_int64)blkData[2] << 8;
-	event_report->tstamp += (u_int64)blkData[1]; 
-	
-	event_report->rtcv = blkData[5] & 0x80;
-	event_report->procID = blkData[6];
-	event_report->ev_code = ((u_int16)blkData[8] << 8) + blkData[7];
-	event_report->ev_info1 = blkData[9];
-	event_report->ev_info2 = blkData[10];
-	event_report->ev_info3 = blkData[11];
-	event_report->ev_info4 = blkData[12];
-	
-	return SMB2_BMC_ERR_NO;
+	return EventReportDecode(length, blkData, event_report);
 }
 
 /****************************************************************************/
-/** Get number of error counters supported by this BMC.
+/** Synchronize the event log incrementally.
 *
-*  \param     errcnt_max_idx    \OUT  number of error counters supported by this BMC
+*  Reads only the events added since the last synchronization and passes
+*  them to \a callback, oldest event first. The newest event already
+*  delivered is stored in \a cursor_file (created if it does not exist).
+*
+*  The cursor holds the log index of the last delivered event (the
+*  number of entries at that time) and a copy of that event. The index
+*  selects the new events; the copy is used to check that the event is
+*  still at that index.
+*
+*  Once the log holds max_entries events, the BMC drops the oldest event
+*  for every new one, so the cursor event moves towards index 0. The
+*  whole log is read then and searched for the cursor event, and only
+*  the events behind it are delivered. If the cursor event is not found
+*  or the log has fewer entries than the cursor, the log was cleared or
+*  all delivered events were overwritten, so all events are delivered.
+*
+*  The events are read in batches with one transaction group each. The
+*  bus load is proportional to the number of new events as long as the
+*  log is not full, and to max_entries when it is.
+*
+*  If \a callback returns a value != 0, the synchronization stops. The
+*  cursor then points to the last event accepted by the callback and the
+*  callback return value is returned.
+*
+*  \param     cursor_file    \IN  path of the cursor file
+*  \param     callback       \IN  function called for every new event
+*  \param     cb_arg         \IN  argument passed to \a callback
 *  \return    0 on success or error code
 *
-*  \sa SMB2BMC_ErrCnt_MaxIDX
+*  \sa SMB2BMC_EventLog_Read, SMB2BMC_H_EventLog_Sync
 */
-int32 __MAPILIB SMB2BMC_ErrCnt_MaxIDX(u_int8 *errcnt_max_idx)
+int32 __MAPILIB SMB2BMC_EventLog_Sync(char *cursor_file,
+									  SMB2BMC_EVLOG_CB callback, void *cb_arg)
 {
-	int err;
-
-	err = SMB2API_ReadByteData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
-								BMC_ERRCNT_MAX, errcnt_max_idx);
-
-	if (err)
-		return err;
-
-	return SMB2_BMC_ERR_NO;
+	return SMB2BMC_H_EventLog_Sync(&G_bmc, cursor_file, callback, cb_arg);
 }
 
 /****************************************************************************/
-/** Clear all Error Counters.
+/** Handle based variant of SMB2BMC_EventLog_Sync().
 *
-*  \return    0 on success or error code
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
 *
-*  \sa SMB2BMC_ErrCnt_Clear
+*  \sa SMB2BMC_EventLog_Sync, SMB2BMC_Open
 */
-int32 __MAPILIB SMB2BMC_ErrCnt_Clear(void)
+int32 __MAPILIB SMB2BMC_H_EventLog_Sync(void *bmcHdl,
+	char *cursor_file, SMB2BMC_EVLOG_CB callback, void *cb_arg)
 {
-	int err;
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
+	int err = 0;
+	u_int16 last_act = 0;
+	u_int16 idx, first_new, rd;
+	int full;
+	struct bmc_evlog_status evlog_stat;
+	struct bmc_event_report last_event;
+	struct bmc_event_report *reports;
 
-	err = SMB2API_WriteByteData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
-								BMC_ERRCNT_CLR, ERRCNT_CLR);
+	BMC_CHECK_CAP(SMB2_BMC_CAP_EVLOG);
+
+	err = EventLogCursorLoad(cursor_file, &last_act, &last_event);
 
 	if (err)
 		return err;
 
-	return SMB2_BMC_ERR_NO;
-}
+	err = SMB2BMC_H_Get_EventLog_Status(h, &evlog_stat);
 
-/****************************************************************************/
-/** Get Error Counter by Index.
-*
-*  \param     errcnt_idx   \IN  index to read from
-*  \param     error_cnt    \OUT  error counter by index
-*  \return    0 on success or error code
-*
-*  \sa SMB2BMC_Get_ErrCnt
+	if (err)
+		return err;
+
+	if (evlog_stat.act_entries == 0)
+		return SMB2_BMC_ERR_NO;
+
+	reports = (struct bmc_event_report*)
+		malloc(evlog_stat.act_entries * sizeof(struct bmc_event_report));
+	if (!reports)
+		return SMB_ERR_NO_MEM;
+
+	full = (evlog_stat.max_entries &&
+			evlog_stat.act_entries >= evlog_stat.max_entries);
+
+	/*
+	 * New events start at the cursor index. Read them together with the
+	 * last delivered event to check that the cursor is still valid. In a
+	 * full log, the cursor event may have moved to any lower index.
+	 */
+	first_new = 0;
+	rd = evlog_stat.act_entries;
+	if (last_act && last_act <= evlog_stat.act_entries) {
+		rd = full ? 0 : last_act - 1;
+		err = EventLogReadBatch(h, rd, (u_int16)(evlog_stat.act_entries - rd),
+								&reports[rd]);
+
+		for (idx = last_act; !err && idx > rd; idx--) {
+			if (EventReportEqual(&reports[idx - 1], &last_event)) {
+				first_new = idx;
+				break;
+			}
+		}
+	}
+
+	/* no valid cursor: read the older events too and deliver all */
+	if (!err && first_new == 0 && rd > 0)
+		err = EventLogReadBatch(h, 0, rd, reports);
+
+	for (idx = first_new; !err && idx < evlog_stat.act_entries; idx++) {
+		err = callback(cb_arg, idx, &reports[idx]);
+
+		if (err)
+			break;
+
+		last_event = reports[idx];
+		last_act = idx + 1;
+	}
+
+	/* store cursor of the last delivered event */
+	if (idx > first_new) {
+		int32 store_err;
+
+		store_err = EventLogCursorStore(cursor_file, last_act, &last_event);
+		if (!err)
+			err = store_err;
+	}
+
+	free(reports);
+
+	return err;
+}
+
+/****************************************************************************/
+/** Get number of error counters supported by this BMC.
+*
+*  \param     errcnt_max_idx    \OUT  number of error counters supported by this BMC
+*  \return    0 on success or error code
+*
+*  \sa SMB2BMC_ErrCnt_MaxIDX
+*/
+int32 __MAPILIB SMB2BMC_ErrCnt_MaxIDX(u_int8 *errcnt_max_idx)
+{
+	return SMB2BMC_H_ErrCnt_MaxIDX(&G_bmc, errcnt_max_idx);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_ErrCnt_MaxIDX().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_ErrCnt_MaxIDX, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_ErrCnt_MaxIDX(void *bmcHdl, u_int8 *errcnt_max_idx)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
+	int err;
+
+	BMC_CHECK_CAP(SMB2_BMC_CAP_ERRCNT);
+
+	err = SMB2API_ReadByteData(h->smbHdl, BMC_SMBFLAGS, h->addr,
+								BMC_ERRCNT_MAX, errcnt_max_idx);
+
+	if (err)
+		return err;
+
+	return SMB2_BMC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Clear all Error Counters.
+*
+*  \return    0 on success or error code
+*
+*  \sa SMB2BMC_ErrCnt_Clear
+*/
+int32 __MAPILIB SMB2BMC_ErrCnt_Clear(void)
+{
+	return SMB2BMC_H_ErrCnt_Clear(&G_bmc);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_ErrCnt_Clear().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_ErrCnt_Clear, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_ErrCnt_Clear(void *bmcHdl)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
+	int err;
+
+	BMC_CHECK_CAP(SMB2_BMC_CAP_ERRCNT);
+
+	err = SMB2API_WriteByteData(h->smbHdl, BMC_SMBFLAGS, h->addr,
+								BMC_ERRCNT_CLR, ERRCNT_CLR);
+
+	if (err)
+		return err;
+
+	return SMB2_BMC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Get Error Counter by Index.
+*
+*  \param     errcnt_idx   \IN  index to read from
+*  \param     error_cnt    \OUT  error counter by index
+*  \return    0 on success or error code
+*
+*  \sa SMB2BMC_Get_ErrCnt
 */
 int32 __MAPILIB SMB2BMC_Get_ErrCnt(u_int8 errcnt_idx, u_int16 *error_cnt)
 {
+	return SMB2BMC_H_Get_ErrCnt(&G_bmc, errcnt_idx, error_cnt);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_Get_ErrCnt().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_Get_ErrCnt, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_Get_ErrCnt(void *bmcHdl,
+	u_int8 errcnt_idx, u_int16 *error_cnt)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 	u_int8 length;
 	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
 
-	err = SMB2API_WriteByteData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
-								BMC_ERRCNT_SET_IDX, errcnt_idx);
+	BMC_CHECK_CAP(SMB2_BMC_CAP_ERRCNT);
+
+	err = IndexedBlockRead(h, BMC_ERRCNT_SET_IDX, errcnt_idx, 0,
+						   BMC_ERRCNT_GET, &length, blkData);
 
 	if (err)
 		return err;
-	
-	err = SMB2API_ReadBlockData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
-								BMC_ERRCNT_GET, &length, blkData);
+
+	return ErrCntDecode(length, blkData, error_cnt);
+}
+
+/****************************************************************************/
+/** Get all Error Counters.
+*
+*  The number of error counters is read from the BMC on the first call
+*  only. All counters are read with one transaction group, i.e. as one
+*  atomic driver request. Only if the BMC has more than
+*  SMB2_XFER_GROUP_MAX/2 counters, further requests are done.
+*
+*  If \a counts is too small for all counters, SMB2_BMC_ERR_INPUT is
+*  returned and \a n is set to the number of counters.
+*
+*  \param     counts    \OUT    error counters, indexed by counter index
+*  \param     n         \INOUT  in: number of elements in \a counts
+*                               out: number of error counters read
+*  \return    0 on success or error code
+*
+*  \sa SMB2BMC_Get_ErrCnt, SMB2BMC_H_ErrCnt_GetAll, SMB2BMC_ErrCnt_GetChanged
+*/
+int32 __MAPILIB SMB2BMC_ErrCnt_GetAll(u_int16 *counts, u_int8 *n)
+{
+	return SMB2BMC_H_ErrCnt_GetAll(&G_bmc, counts, n);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_ErrCnt_GetAll().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_ErrCnt_GetAll, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_ErrCnt_GetAll(void *bmcHdl,
+	u_int16 *counts, u_int8 *n)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
+	int err;
+
+	BMC_CHECK_CAP(SMB2_BMC_CAP_ERRCNT);
+
+	if (h->errCntNum == 0) {
+		err = SMB2BMC_H_ErrCnt_MaxIDX(h, &h->errCntNum);
+
+		if (err)
+			return err;
+	}
+
+	if (*n < h->errCntNum) {
+		*n = h->errCntNum;
+		return SMB2_BMC_ERR_INPUT;
+	}
+
+	*n = 0;
+
+	err = ErrCntReadAll(h, counts);
 
 	if (err)
 		return err;
 
-	if (length != ERRCNT_LENGTH)
-		return SMB2_BMC_ERR_LENGTH;
+	*n = h->errCntNum;
 
-	if(blkData[0] == ERROR_CODE)
-		return SMB2_BMC_ERROR;
-	
-	*error_cnt = ((u_int16)blkData[2] << 8) + blkData[1];
+	return SMB2_BMC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Get the Error Counters changed since the last call.
+*
+*  Delta mode of SMB2BMC_ErrCnt_GetAll: all counters are read in one
+*  batch, but only the counters that differ from the previous call of
+*  this function are returned. The first call returns all counters.
+*  After SMB2BMC_ErrCnt_Clear, the cleared counters are reported as
+*  changed.
+*
+*  If \a change is too small for all counters, SMB2_BMC_ERR_INPUT is
+*  returned and \a n is set to the number of counters.
+*
+*  \param     change    \OUT    changed error counters
+*  \param     n         \INOUT  in: number of elements in \a change
+*                               out: number of changed error counters
+*  \return    0 on success or error code
+*
+*  \sa SMB2BMC_ErrCnt_GetAll, SMB2BMC_H_ErrCnt_GetChanged
+*/
+int32 __MAPILIB SMB2BMC_ErrCnt_GetChanged(struct bmc_errcnt_change *change,
+										  u_int8 *n)
+{
+	return SMB2BMC_H_ErrCnt_GetChanged(&G_bmc, change, n);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_ErrCnt_GetChanged().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_ErrCnt_GetChanged, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_ErrCnt_GetChanged(void *bmcHdl,
+	struct bmc_errcnt_change *change, u_int8 *n)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
+	int err;
+	u_int8 num;
+	u_int16 i;
+	u_int16 counts[SMB2_BMC_ERRCNT_MAX];
+
+	num = SMB2_BMC_ERRCNT_MAX;
+	err = SMB2BMC_H_ErrCnt_GetAll(h, counts, &num);
+
+	if (err)
+		return err;
+
+	if (*n < num) {
+		*n = num;
+		return SMB2_BMC_ERR_INPUT;
+	}
+
+	*n = 0;
+	for (i = 0; i < num; i++) {
+		if (h->errCntLastValid && counts[i] == h->errCntLast[i])
+			continue;
+
+		change[*n].idx = (u_int8)i;
+		change[*n].prev = h->errCntLastValid ? h->errCntLast[i] : 0;
+		change[*n].count = counts[i];
+		(*n)++;
+		h->errCntLast[i] = counts[i];
+	}
+	h->errCntLastValid = 1;
 
 	return SMB2_BMC_ERR_NO;
 }
@@ -1354,11 +2353,25 @@ int32 __MAPILIB SMB2BMC_Get_ErrCnt(u_int8 errcnt_idx, u_int16 *error_cnt)
 */
 int32 __MAPILIB SMB2BMC_StatusOutput_Set(enum STATUS_OUTPUT status_out, u_int8 on_off)
 {
+	return SMB2BMC_H_StatusOutput_Set(&G_bmc, status_out, on_off);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_StatusOutput_Set().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_StatusOutput_Set, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_StatusOutput_Set(void *bmcHdl,
+	enum STATUS_OUTPUT status_out, u_int8 on_off)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 	u_int16 status_output_data=0;
 
 	status_output_data = (1 << (status_out + 8)) | ((on_off?1:0) << status_out);
-	err = SMB2API_WriteWordData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	err = SMB2API_WriteWordData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 		BMC_STAT_OUT_SET, status_output_data);
 
 	if (err)
@@ -1379,10 +2392,24 @@ int32 __MAPILIB SMB2BMC_StatusOutput_Set(enum STATUS_OUTPUT status_out, u_int8 o
 */
 int32 __MAPILIB SMB2BMC_StatusOutput_Get(enum STATUS_OUTPUT status_out, u_int8 *status)
 {
+	return SMB2BMC_H_StatusOutput_Get(&G_bmc, status_out, status);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_StatusOutput_Get().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_StatusOutput_Get, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_StatusOutput_Get(void *bmcHdl,
+	enum STATUS_OUTPUT status_out, u_int8 *status)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 	u_int8 status_buffer;
 
-	err = SMB2API_ReadByteData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	err = SMB2API_ReadByteData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								BMC_STAT_OUT_GET, &status_buffer);
 
 	if (err)
@@ -1412,11 +2439,27 @@ int32 __MAPILIB SMB2BMC_StatusOutput_Get(enum STATUS_OUTPUT status_out, u_int8 *
 int32 __MAPILIB SMB2BMC_RTC_Set(u_int16 year, u_int8 month, u_int8 mday, 
 								u_int8 hrs, u_int8 min, u_int8 sec )
 {
+	return SMB2BMC_H_RTC_Set(&G_bmc, year, month, mday, hrs, min, sec);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_RTC_Set().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_RTC_Set, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_RTC_Set(void *bmcHdl,
+	u_int16 year, u_int8 month, u_int8 mday, u_int8 hrs, u_int8 min, u_int8 sec)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 	u_int8 year_lsb;
 	u_int8 year_msb;
 	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
 	
+	BMC_CHECK_CAP(SMB2_BMC_CAP_RTC);
+
 	if (!((0 < month) && (month <= 12)))
 		return SMB2_BMC_ERR_INPUT;
 	if (!((0 < mday) && (mday <= 31)))
@@ -1439,7 +2482,7 @@ int32 __MAPILIB SMB2BMC_RTC_Set(u_int16 year, u_int8 month, u_int8 mday,
 	blkData[5] = min;
 	blkData[6] = sec;
 	
-	err = SMB2API_WriteBlockData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	err = SMB2API_WriteBlockData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								 BMC_RTC_SET, RTC_SET_LENGTH, blkData);
 
 	if (err)
@@ -1458,31 +2501,32 @@ int32 __MAPILIB SMB2BMC_RTC_Set(u_int16 year, u_int8 month, u_int8 mday,
 */
 int32 __MAPILIB SMB2BMC_RTC_Get(struct bmc_rtc *rtc)
 {
+	return SMB2BMC_H_RTC_Get(&G_bmc, rtc);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_RTC_Get().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_RTC_Get, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_RTC_Get(void *bmcHdl, struct bmc_rtc *rtc)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 	u_int8 length;
 	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
 
-	err = SMB2API_ReadBlockData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	BMC_CHECK_CAP(SMB2_BMC_CAP_RTC);
+
+	err = SMB2API_ReadBlockData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								BMC_RTC_GET, &length, blkData);
 
 	if (err)
 		return err;
 
-	if (length != RTC_GET_LENGTH)
-		return SMB2_BMC_ERR_LENGTH;
-
-	if(blkData[0] == ERROR_CODE)
-		return SMB2_BMC_ERROR;
-	
-	rtc->year = ((u_int16)blkData[2] << 8) + blkData[1];
-	rtc->month = blkData[3];
-	rtc->mday = blkData[4];
-	rtc->hours = blkData[5];
-	rtc->minutes = blkData[6];
-	rtc->seconds = blkData[7];
-	rtc->battery = blkData[8] & RTC_BATTERY_LOW;
-
-	return SMB2_BMC_ERR_NO;
+	return RtcDecode(length, blkData, rtc);
 }
 
 /****************************************************************************/
@@ -1495,9 +2539,24 @@ int32 __MAPILIB SMB2BMC_RTC_Get(struct bmc_rtc *rtc)
 */
 int32 __MAPILIB SMB2BMC_CPCI_BrdMode(u_int8 *cpci_mode)
 {
+	return SMB2BMC_H_CPCI_BrdMode(&G_bmc, cpci_mode);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_CPCI_BrdMode().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_CPCI_BrdMode, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_CPCI_BrdMode(void *bmcHdl, u_int8 *cpci_mode)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 
-	err = SMB2API_ReadByteData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	BMC_CHECK_CAP(SMB2_BMC_CAP_CPCI);
+
+	err = SMB2API_ReadByteData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								BMC_CPCI_BRDMODE, cpci_mode);
 
 	if (err)
@@ -1519,9 +2578,24 @@ int32 __MAPILIB SMB2BMC_CPCI_BrdMode(u_int8 *cpci_mode)
 */
 int32 __MAPILIB SMB2BMC_CPCI_SlotAddr(u_int8 *cpci_slotaddr)
 {
+	return SMB2BMC_H_CPCI_SlotAddr(&G_bmc, cpci_slotaddr);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_CPCI_SlotAddr().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_CPCI_SlotAddr, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_CPCI_SlotAddr(void *bmcHdl, u_int8 *cpci_slotaddr)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 
-	err = SMB2API_ReadByteData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	BMC_CHECK_CAP(SMB2_BMC_CAP_CPCI);
+
+	err = SMB2API_ReadByteData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								BMC_CPCI_SLOTADDR, cpci_slotaddr);
 
 	if (err)
@@ -1542,10 +2616,31 @@ int32 __MAPILIB SMB2BMC_CPCI_SlotAddr(u_int8 *cpci_slotaddr)
 */
 int32 __MAPILIB SMB2BMC_GPO_Caps(enum GPO gpo, u_int8 *gpo_support)
 {
+	return SMB2BMC_H_GPO_Caps(&G_bmc, gpo, gpo_support);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_GPO_Caps().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_GPO_Caps, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_GPO_Caps(void *bmcHdl,
+	enum GPO gpo, u_int8 *gpo_support)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 	u_int8 gpo_caps;
 
-	err = SMB2API_ReadByteData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	BMC_CHECK_CAP(SMB2_BMC_CAP_GPIO);
+
+	if (h->gpioCapsValid) {
+		*gpo_support = h->gpoCaps & (0x01 << gpo);
+		return SMB2_BMC_ERR_NO;
+	}
+
+	err = SMB2API_ReadByteData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								BMC_GPO_CAPS, &gpo_caps);
 
 	if (err)
@@ -1571,11 +2666,65 @@ int32 __MAPILIB SMB2BMC_GPO_Caps(enum GPO gpo, u_int8 *gpo_support)
 */
 int32 __MAPILIB SMB2BMC_GPO_Set(enum GPO gpo, u_int8 on_off)
 {
+	return SMB2BMC_H_GPO_Set(&G_bmc, gpo, on_off);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_GPO_Set().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_GPO_Set, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_GPO_Set(void *bmcHdl, enum GPO gpo, u_int8 on_off)
+{
+	return SMB2BMC_H_GPO_SetMask(bmcHdl, (u_int8)(1 << gpo),
+								 (u_int8)(on_off ? GPIO_MASK : 0));
+}
+
+/****************************************************************************/
+/** Set several general purpose outputs with one bus write.
+*
+*  Only the outputs selected by \a mask are changed. If \a mask is 0,
+*  no bus access is done.
+*
+*  \param     mask     \IN  outputs to change, bit n = GPO_n
+*  \param     value    \IN  new levels, bit n = GPO_n (0=off, 1=on)
+*  \return    0 on success or error code
+*
+*  \sa SMB2BMC_GPO_Set, SMB2BMC_GPO_GetAll
+*/
+int32 __MAPILIB SMB2BMC_GPO_SetMask(u_int8 mask, u_int8 value)
+{
+	return SMB2BMC_H_GPO_SetMask(&G_bmc, mask, value);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_GPO_SetMask().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_GPO_SetMask, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_GPO_SetMask(void *bmcHdl, u_int8 mask, u_int8 value)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 	u_int16 gpo_data;
 	
-	gpo_data = (1 << (gpo + 8)) | ((on_off ? 1 : 0) << gpo);
-	err = SMB2API_WriteWordData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	BMC_CHECK_CAP(SMB2_BMC_CAP_GPIO);
+
+	if (mask & ~GPIO_MASK)
+		return SMB2_BMC_ERR_INPUT;
+
+	if (h->gpioCapsValid && (mask & ~h->gpoCaps))
+		return SMB2_BMC_ERR_NOT_SUPPORTED;
+
+	if (!mask)
+		return SMB2_BMC_ERR_NO;
+
+	gpo_data = ((u_int16)mask << 8) | (value & mask);
+	err = SMB2API_WriteWordData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 		BMC_GPO_SET, gpo_data);
 
 	if (err)
@@ -1597,11 +2746,26 @@ int32 __MAPILIB SMB2BMC_GPO_Set(enum GPO gpo, u_int8 on_off)
 */
 int32 __MAPILIB SMB2BMC_GPO_Get(enum GPO gpo, u_int8 *status)
 {
-	int err;
-	u_int8 gpo_level;
+	return SMB2BMC_H_GPO_Get(&G_bmc, gpo, status);
+}
 
-	err = SMB2API_ReadByteData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
-								BMC_GPO_GET, &gpo_level);
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_GPO_Get().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_GPO_Get, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_GPO_Get(void *bmcHdl, enum GPO gpo, u_int8 *status)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
+	int err;
+	u_int8 gpo_level;
+
+	BMC_CHECK_CAP(SMB2_BMC_CAP_GPIO);
+
+	err = SMB2API_ReadByteData(h->smbHdl, BMC_SMBFLAGS, h->addr,
+								BMC_GPO_GET, &gpo_level);
 
 	if (err)
 		return err;
@@ -1614,6 +2778,59 @@ int32 __MAPILIB SMB2BMC_GPO_Get(enum GPO gpo, u_int8 *status)
 	return SMB2_BMC_ERR_NO;
 }
 
+/****************************************************************************/
+/** Get all general purpose outputs with one bus read.
+*
+*  \param     levels      \OUT  output levels, bit n = GPO_n (0=LOW, 1=HIGH)
+*  \param     supported   \OUT  supported outputs, bit n = GPO_n
+*                                (may be NULL)
+*  \return    0 on success or error code
+*
+*  \sa SMB2BMC_GPO_Get, SMB2BMC_GPO_SetMask
+*/
+int32 __MAPILIB SMB2BMC_GPO_GetAll(u_int8 *levels, u_int8 *supported)
+{
+	return SMB2BMC_H_GPO_GetAll(&G_bmc, levels, supported);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_GPO_GetAll().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_GPO_GetAll, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_GPO_GetAll(void *bmcHdl,
+	u_int8 *levels, u_int8 *supported)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
+	int err;
+	u_int8 gpo_level;
+
+	BMC_CHECK_CAP(SMB2_BMC_CAP_GPIO);
+
+	if (supported && !h->gpioCapsValid) {
+		err = GpioRead(h);
+		if (err)
+			return err;
+	}
+
+	err = SMB2API_ReadByteData(h->smbHdl, BMC_SMBFLAGS, h->addr,
+								BMC_GPO_GET, &gpo_level);
+
+	if (err)
+		return err;
+	
+	if (gpo_level & GPIO_ERR)
+		return SMB2_BMC_ERROR;
+
+	*levels = gpo_level & GPIO_MASK;
+	if (supported)
+		*supported = h->gpoCaps;
+
+	return SMB2_BMC_ERR_NO;
+}
+
 
 /****************************************************************************/
 /** Report which GPIs are supported.
@@ -1627,10 +2844,31 @@ int32 __MAPILIB SMB2BMC_GPO_Get(enum GPO gpo, u_int8 *status)
 */
 int32 __MAPILIB SMB2BMC_GPI_Caps(enum GPI gpi, u_int8 *gpi_support)
 {
+	return SMB2BMC_H_GPI_Caps(&G_bmc, gpi, gpi_support);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_GPI_Caps().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_GPI_Caps, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_GPI_Caps(void *bmcHdl,
+	enum GPI gpi, u_int8 *gpi_support)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 	u_int8 gpi_caps;
 
-	err = SMB2API_ReadByteData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	BMC_CHECK_CAP(SMB2_BMC_CAP_GPIO);
+
+	if (h->gpioCapsValid) {
+		*gpi_support = h->gpiCaps & (0x01 << gpi);
+		return SMB2_BMC_ERR_NO;
+	}
+
+	err = SMB2API_ReadByteData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								BMC_GPI_CAPS, &gpi_caps);
 
 	if (err)
@@ -1657,10 +2895,25 @@ int32 __MAPILIB SMB2BMC_GPI_Caps(enum GPI gpi, u_int8 *gpi_support)
 */
 int32 __MAPILIB SMB2BMC_GPI_Get(enum GPI gpi, u_int8 *status)
 {
+	return SMB2BMC_H_GPI_Get(&G_bmc, gpi, status);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_GPI_Get().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_GPI_Get, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_GPI_Get(void *bmcHdl, enum GPI gpi, u_int8 *status)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 	u_int8 gpi_levels;
 
-	err = SMB2API_ReadByteData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	BMC_CHECK_CAP(SMB2_BMC_CAP_GPIO);
+
+	err = SMB2API_ReadByteData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								BMC_GPI_GET, &gpi_levels);
 
 	if (err)
@@ -1674,6 +2927,59 @@ int32 __MAPILIB SMB2BMC_GPI_Get(enum GPI gpi, u_int8 *status)
 	return SMB2_BMC_ERR_NO;
 }
 
+/****************************************************************************/
+/** Get all general purpose inputs with one bus read.
+*
+*  \param     levels      \OUT  input levels, bit n = GPI_n (0=LOW, 1=HIGH)
+*  \param     supported   \OUT  supported inputs, bit n = GPI_n
+*                                (may be NULL)
+*  \return    0 on success or error code
+*
+*  \sa SMB2BMC_GPI_Get
+*/
+int32 __MAPILIB SMB2BMC_GPI_GetAll(u_int8 *levels, u_int8 *supported)
+{
+	return SMB2BMC_H_GPI_GetAll(&G_bmc, levels, supported);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_GPI_GetAll().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_GPI_GetAll, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_GPI_GetAll(void *bmcHdl,
+	u_int8 *levels, u_int8 *supported)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
+	int err;
+	u_int8 gpi_levels;
+
+	BMC_CHECK_CAP(SMB2_BMC_CAP_GPIO);
+
+	if (supported && !h->gpioCapsValid) {
+		err = GpioRead(h);
+		if (err)
+			return err;
+	}
+
+	err = SMB2API_ReadByteData(h->smbHdl, BMC_SMBFLAGS, h->addr,
+								BMC_GPI_GET, &gpi_levels);
+
+	if (err)
+		return err;
+	
+	if (gpi_levels & GPIO_ERR)
+		return SMB2_BMC_ERROR;
+
+	*levels = gpi_levels & GPIO_MASK;
+	if (supported)
+		*supported = h->gpiCaps;
+
+	return SMB2_BMC_ERR_NO;
+}
+
 /****************************************************************************/
 /** Enable/Disable power on/off event logging.
 *
@@ -1684,12 +2990,25 @@ int32 __MAPILIB SMB2BMC_GPI_Get(enum GPI gpi, u_int8 *status)
 */
 int32 __MAPILIB SMB2BMC_PWR_SetEvLog(u_int8 pwr_log_mode)
 {
+	return SMB2BMC_H_PWR_SetEvLog(&G_bmc, pwr_log_mode);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_PWR_SetEvLog().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_PWR_SetEvLog, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_PWR_SetEvLog(void *bmcHdl, u_int8 pwr_log_mode)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 	
 	if ((pwr_log_mode < 0) || (pwr_log_mode > 1))
 		return SMB2_BMC_ERR_INPUT;
 	
-	err = SMB2API_WriteByteData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	err = SMB2API_WriteByteData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								BMC_PWR_LOG_SET, pwr_log_mode);
 
 	if (err)
@@ -1708,9 +3027,22 @@ int32 __MAPILIB SMB2BMC_PWR_SetEvLog(u_int8 pwr_log_mode)
 */
 int32 __MAPILIB SMB2BMC_PWR_GetEvLog(u_int8 *pwr_log_mode)
 {
+	return SMB2BMC_H_PWR_GetEvLog(&G_bmc, pwr_log_mode);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_PWR_GetEvLog().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_PWR_GetEvLog, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_PWR_GetEvLog(void *bmcHdl, u_int8 *pwr_log_mode)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 
-	err = SMB2API_ReadByteData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	err = SMB2API_ReadByteData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								BMC_PWR_LOG_GET, pwr_log_mode);
 
 	if (err)
@@ -1728,9 +3060,22 @@ int32 __MAPILIB SMB2BMC_PWR_GetEvLog(u_int8 *pwr_log_mode)
 */
 int32 __MAPILIB SMB2BMC_StatusFrame_trigger(void)
 {
+	return SMB2BMC_H_StatusFrame_trigger(&G_bmc);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_StatusFrame_trigger().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_StatusFrame_trigger, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_StatusFrame_trigger(void *bmcHdl)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 
-	err = SMB2API_WriteByte(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	err = SMB2API_WriteByte(h->smbHdl, BMC_SMBFLAGS, h->addr,
 							BMC_STAT_FRM_TRIG);
 
 	if (err)
@@ -1749,11 +3094,25 @@ int32 __MAPILIB SMB2BMC_StatusFrame_trigger(void)
 */
 int32 __MAPILIB SMB2BMC_GetStatusFrame(struct bmc_status_frame *status_frame)
 {
+	return SMB2BMC_H_GetStatusFrame(&G_bmc, status_frame);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_GetStatusFrame().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_GetStatusFrame, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_GetStatusFrame(void *bmcHdl,
+	struct bmc_status_frame *status_frame)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
 	int err;
 	u_int8 length;
 	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
 
-	err = SMB2API_ReadBlockData(SMB2BMC_smbHdl, BMC_SMBFLAGS, BMC_SMBADDR,
+	err = SMB2API_ReadBlockData(h->smbHdl, BMC_SMBFLAGS, h->addr,
 								BMC_GET_STAT_FRM, &length, blkData);
 
 	if (err)
@@ -1762,35 +3121,295 @@ int32 __MAPILIB SMB2BMC_GetStatusFrame(struct bmc_status_frame *status_frame)
 	if (length != BMC_STAT_FRM_LENGTH)
 		return SMB2_BMC_ERR_LENGTH;
 	
-	status_frame->wd_itout = blkData[0] & 0x40;
-	status_frame->isw_st = blkData[0] & 0x20;
-	status_frame->fpga_rdy = blkData[0] & 0x10;
-	status_frame->state = blkData[0] & 0x0F;
-	
-	status_frame->fault_cause = blkData[1] & 0x7F;
-	
-	status_frame->maj_rev = (blkData[2] >> 4) & 0x07;
-	status_frame->min_rev = blkData[2] & 0x0F;
+	StatusFrameDecode(blkData, status_frame);
 
-	status_frame->ov_shdn = blkData[3] & 0x40;
-	status_frame->fpga_mon_en = blkData[3] & 0x20;
-	status_frame->restart = blkData[3] & 0x10;
-	status_frame->test_mode = blkData[3] & 0x08;
-	status_frame->nom_ss_clk = blkData[3] & 0x07;
-	
-	status_frame->wd_tout_ul = (blkData[4] >> 4) & 0x07;
-	status_frame->wd_tout_ll = blkData[4] & 0x08;
-	status_frame->wd_en = blkData[4] & 0x04;
-	status_frame->wd_init_tout = blkData[4] & 0x03;
-	
-	status_frame->supv_id = blkData[5] & 0x7F;
-	status_frame->supv_id += ((u_int16)blkData[6] << 8) & 0x1F00;
-	
-	status_frame->life_sign_bit = blkData[6] & 0x40;
-	
-	status_frame->supv_id_build_no = blkData[7] & 0x7F;
-	
-	status_frame->crc = blkData[8] & 0xFF;
+	return SMB2_BMC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Get a health snapshot of the BMC.
+*
+*  Reads firmware version, watchdog state and window, reset reason,
+*  power cycle and operating hour counters, all voltage reports, all
+*  error counters, RTC and event log status. Sections of feature sets
+*  the BMC does not support are skipped.
+*
+*  All reads are done with one transaction group, i.e. one driver request.
+*  Only if more than SMB2_XFER_GROUP_MAX transfers are needed, further
+*  requests are done. The first call additionally reads the number of
+*  voltages and error counters.
+*
+*  A failed section does not abort the snapshot: check
+*  \a health->valid and \a health->failed.
+*
+*  \param     health    \OUT  health snapshot
+*  \return    0 on success or error code
+*
+*  \sa SMB2BMC_H_GetHealthSnapshot, SMB2BMC_Get_Caps
+*/
+int32 __MAPILIB SMB2BMC_GetHealthSnapshot(struct bmc_health *health)
+{
+	return SMB2BMC_H_GetHealthSnapshot(&G_bmc, health);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_GetHealthSnapshot().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_GetHealthSnapshot, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_GetHealthSnapshot(void *bmcHdl,
+	struct bmc_health *health)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
+	int err;
+	u_int32 start, num = 0, i;
+	u_int32 voltNum = 0, errCntNum = 0;
+	HEALTH_READ *rd;
+
+	start = UOS_MsecTimerGet();
+	memset(health, 0, sizeof(struct bmc_health));
+
+	if (h->capsValid && h->fwVersionValid) {
+		health->caps = h->caps;
+		health->fw_version = h->fwVersion;
+		health->valid |= SMB2_BMC_HEALTH_FW;
+	}
+	else {
+		health->failed |= SMB2_BMC_HEALTH_FW;
+	}
+
+	/* number of voltages and error counters, first call only */
+	if (BMC_HAS_CAP(SMB2_BMC_CAP_VREP)) {
+		if (h->voltMaxNum == 0) {
+			health->requests++;
+			if (SMB2BMC_H_Volt_Max_Num(h, &h->voltMaxNum))
+				health->failed |= SMB2_BMC_HEALTH_VOLT;
+			if (h->voltMaxNum > SMB2_BMC_VOLT_MAX)
+				h->voltMaxNum = SMB2_BMC_VOLT_MAX;
+		}
+		voltNum = h->voltMaxNum;
+	}
+
+	if (BMC_HAS_CAP(SMB2_BMC_CAP_ERRCNT)) {
+		if (h->errCntNum == 0) {
+			health->requests++;
+			if (SMB2BMC_H_ErrCnt_MaxIDX(h, &h->errCntNum))
+				health->failed |= SMB2_BMC_HEALTH_ERRCNT;
+		}
+		errCntNum = h->errCntNum;
+	}
+
+	rd = (HEALTH_READ*)malloc((9 + voltNum + errCntNum) * sizeof(HEALTH_READ));
+	if (!rd)
+		return SMB_ERR_NO_MEM;
+
+	HealthReadAdd(rd, &num, SMB2_BMC_HEALTH_WDOG, HR_BYTE,
+				  BMC_WDOG_STATE_GET, 0, 0, 0);
+	HealthReadAdd(rd, &num, SMB2_BMC_HEALTH_WDOG, HR_BYTE,
+				  BMC_WDOG_ARM_STATE, 0, 0, 0);
+	HealthReadAdd(rd, &num, SMB2_BMC_HEALTH_WDOG, HR_WORD,
+				  BMC_WDOG_TIME_GET, 0, 0, 0);
+	HealthReadAdd(rd, &num, SMB2_BMC_HEALTH_WDOG, HR_WORD,
+				  BMC_WDOG_MIN_TIME_GET, 0, 0, 0);
+	HealthReadAdd(rd, &num, SMB2_BMC_HEALTH_RSTR, HR_BLOCK,
+				  BMC_RST_REASON_GET, 0, 0, 0);
+	HealthReadAdd(rd, &num, SMB2_BMC_HEALTH_LIFE, HR_BLOCK,
+				  BMC_PWRCYCLE_CNT, 0, 0, 0);
+	HealthReadAdd(rd, &num, SMB2_BMC_HEALTH_LIFE, HR_BLOCK,
+				  BMC_OP_HRS_CNT, 0, 0, 0);
+
+	for (i = 0; i < voltNum; i++)
+		HealthReadAdd(rd, &num, SMB2_BMC_HEALTH_VOLT, HR_BLOCK,
+					  BMC_VOLTAGE_GET, 1, BMC_VOLT_SET_IDX, (u_int8)i);
+
+	for (i = 0; i < errCntNum; i++)
+		HealthReadAdd(rd, &num, SMB2_BMC_HEALTH_ERRCNT, HR_BLOCK,
+					  BMC_ERRCNT_GET, 1, BMC_ERRCNT_SET_IDX, (u_int8)i);
+
+	if (BMC_HAS_CAP(SMB2_BMC_CAP_RTC))
+		HealthReadAdd(rd, &num, SMB2_BMC_HEALTH_RTC, HR_BLOCK,
+					  BMC_RTC_GET, 0, 0, 0);
+
+	if (BMC_HAS_CAP(SMB2_BMC_CAP_EVLOG))
+		HealthReadAdd(rd, &num, SMB2_BMC_HEALTH_EVLOG, HR_BLOCK,
+					  BMC_EVLOG_STAT, 0, 0, 0);
+
+	err = HealthReadExec(h, rd, num, &health->requests);
+	if (err) {
+		free(rd);
+		return err;
+	}
+
+	for (i = 0; i < num; i++) {
+		err = rd[i].err;
+
+		if (!err) {
+			switch (rd[i].cmd) {
+			case BMC_WDOG_STATE_GET:
+				if (rd[i].byteData == 0xFF)
+					err = SMB2_BMC_ERROR;
+				health->wd_state = rd[i].byteData;
+				break;
+			case BMC_WDOG_ARM_STATE:
+				health->wd_arm_state = rd[i].byteData;
+				break;
+			case BMC_WDOG_TIME_GET:
+				if (rd[i].wordData == 0xFFFF)
+					err = SMB2_BMC_ERROR;
+				health->wd_max_tout = rd[i].wordData;
+				break;
+			case BMC_WDOG_MIN_TIME_GET:
+				if (rd[i].wordData == 0xFFFF)
+					err = SMB2_BMC_ERROR;
+				health->wd_min_tout = rd[i].wordData;
+				break;
+			case BMC_RST_REASON_GET:
+				err = RstReasonDecode(rd[i].length, rd[i].blkData,
+									  &health->rst_reason);
+				break;
+			case BMC_PWRCYCLE_CNT:
+				err = CounterDecode(rd[i].length, PWRCYCL_CNT_LENGTH,
+									rd[i].blkData, &health->pwr_cycles);
+				break;
+			case BMC_OP_HRS_CNT:
+				err = CounterDecode(rd[i].length, OP_TIME_LENGTH,
+									rd[i].blkData, &health->op_time);
+				break;
+			case BMC_VOLTAGE_GET:
+				err = VoltReportDecode(rd[i].length, rd[i].blkData,
+									   &health->volt[rd[i].idx]);
+				break;
+			case BMC_ERRCNT_GET:
+				err = ErrCntDecode(rd[i].length, rd[i].blkData,
+								   &health->errcnt[rd[i].idx]);
+				break;
+			case BMC_RTC_GET:
+				err = RtcDecode(rd[i].length, rd[i].blkData, &health->rtc);
+				break;
+			case BMC_EVLOG_STAT:
+				err = EvLogStatusDecode(rd[i].length, rd[i].blkData,
+										&health->evlog_status);
+				break;
+			}
+		}
+
+		if (err)
+			health->failed |= rd[i].section;
+		else
+			health->valid |= rd[i].section;
+	}
+
+	free(rd);
+
+	health->valid &= ~health->failed;
+	if (health->valid & SMB2_BMC_HEALTH_VOLT)
+		health->volt_num = (u_int8)voltNum;
+	if (health->valid & SMB2_BMC_HEALTH_ERRCNT)
+		health->errcnt_num = (u_int8)errCntNum;
+
+	health->duration = UOS_MsecTimerGet() - start;
+
+	return SMB2_BMC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Start the status frame sampler.
+*
+*  Starts a thread with real-time priority that reads the SUPV status
+*  frame every \a period ms and triggers the next one in the same bus
+*  transaction. The samples are stored with a time stamp in a ring
+*  buffer and can be fetched with SMB2BMC_Sampler_Read. If the ring is
+*  full, new samples are dropped.
+*
+*  If \a callback is set, it is called from the sampler thread when
+*  - a read fails (SMB2_BMC_SMPL_EV_ERR)
+*  - life_sign_bit did not toggle for SMB2_BMC_SMPL_STALL_CNT frames
+*    (SMB2_BMC_SMPL_EV_STALL) or toggles again (SMB2_BMC_SMPL_EV_ALIVE)
+*  - fault_cause or state changes (SMB2_BMC_SMPL_EV_FAULT/_STATE)
+*
+*  Frames with read error are not used for change detection. The crc
+*  field of the frame is passed on unchecked, because the BMC
+*  documentation does not specify the CRC algorithm.
+*
+*  The thread only uses the SMB handle and address of the library's BMC
+*  handle, none of its cached data, so other SMB2BMC functions may be
+*  called concurrently.
+*
+*  The sampler must be stopped with SMB2BMC_Sampler_Stop before
+*  SMB2BMC_Exit is called.
+*
+*  \param     period       \IN   sample period [ms],
+*                                min. SMB2_BMC_SMPL_PERIOD_MIN
+*  \param     ring_size    \IN   number of samples in the ring buffer,
+*                                must be a power of 2
+*  \param     flags        \IN   reserved, must be 0
+*  \param     callback     \IN   event callback (may be NULL)
+*  \param     cb_arg       \IN   argument for callback
+*  \param     smplHdlP     \OUT  sampler handle
+*  \return    0 on success or error code
+*
+*  \sa SMB2BMC_Sampler_Read, SMB2BMC_Sampler_Stop
+*/
+int32 __MAPILIB SMB2BMC_Sampler_Start(
+	u_int32 period,
+	u_int32 ring_size,
+	u_int32 flags,
+	SMB2BMC_SAMPLER_CB callback,
+	void *cb_arg,
+	void **smplHdlP)
+{
+	return SMB2BMC_H_Sampler_Start(&G_bmc, period, ring_size, flags,
+								   callback, cb_arg, smplHdlP);
+}
+
+/****************************************************************************/
+/** Read the last status frame and trigger the next one (internal).
+*
+*  Both transfers are executed as one transaction group. The trigger is
+*  sent even if the read fails.
+*
+*  \param     bmcHdl          \IN   BMC handle
+*  \param     status_frame    \OUT  contains SUPV Status Frame
+*  \return    0 on success or error code
+*
+*  \sa SMB2BMC_Sampler_Start
+*/
+int32 BMC_StatusFrameSample(void *bmcHdl,
+							struct bmc_status_frame *status_frame)
+{
+	BMC_HANDLE *h = (BMC_HANDLE*)bmcHdl;
+	int err;
+	void *grpHdl;
+	u_int8 length = 0;
+	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
+
+	err = SMB2API_XferGroupBegin(h->smbHdl, SMB2_XFER_GROUP_CONT, 2, &grpHdl);
+
+	if (err)
+		return err;
+
+	err = SMB2API_XferGroupAddReadBlockData(grpHdl, BMC_SMBFLAGS, h->addr,
+											BMC_GET_STAT_FRM, &length,
+											blkData);
+	if (!err)
+		err = SMB2API_XferGroupAddWriteByte(grpHdl, BMC_SMBFLAGS, h->addr,
+											BMC_STAT_FRM_TRIG);
+	if (!err)
+		err = SMB2API_XferGroupCommit(grpHdl);
+	if (!err)
+		err = SMB2API_XferGroupError(grpHdl, 0);
+
+	SMB2API_XferGroupEnd(&grpHdl);
+
+	if (err)
+		return err;
+
+	if (length != BMC_STAT_FRM_LENGTH)
+		return SMB2_BMC_ERR_LENGTH;
+
+	StatusFrameDecode(blkData, status_frame);
 
 	return SMB2_BMC_ERR_NO;
 }
@@ -1802,3 +3421,769 @@ int32 __MAPILIB SMB2BMC_GetStatusFrame(struct bmc_status_frame *status_frame)
 
 
 
+
+/****************************************************************************/
+/** Write an index register and read the indexed data block.
+*
+*  Both transfers are executed as one transaction group, so no other
+*  application can change the index register in between.
+*
+*  \param     h          \IN   BMC handle
+*  \param     idx_cmd    \IN   command to set the index
+*  \param     idx        \IN   index to write
+*  \param     word_idx   \IN   0=write index as byte, 1=write index as word
+*  \param     read_cmd   \IN   command to read the data block
+*  \param     length     \OUT  number of bytes read
+*  \param     blkData    \OUT  data block (SMB_BLOCK_MAX_BYTES)
+*  \return    0 on success or error code
+*/
+static int32 IndexedBlockRead(BMC_HANDLE *h, u_int8 idx_cmd, u_int16 idx,
+							  int word_idx, u_int8 read_cmd, u_int8 *length,
+							  u_int8 *blkData)
+{
+	int err;
+	void *grpHdl;
+
+	err = SMB2API_XferGroupBegin(h->smbHdl, 0, 2, &grpHdl);
+
+	if (err)
+		return err;
+
+	if (word_idx)
+		err = SMB2API_XferGroupAddWriteWordData(grpHdl, BMC_SMBFLAGS,
+												h->addr, idx_cmd, idx);
+	else
+		err = SMB2API_XferGroupAddWriteByteData(grpHdl, BMC_SMBFLAGS,
+												h->addr, idx_cmd,
+												(u_int8)idx);
+	if (!err)
+		err = SMB2API_XferGroupAddReadBlockData(grpHdl, BMC_SMBFLAGS,
+												h->addr, read_cmd,
+												length, blkData);
+	if (!err)
+		err = SMB2API_XferGroupCommit(grpHdl);
+
+	SMB2API_XferGroupEnd(&grpHdl);
+
+	return err;
+}
+
+/****************************************************************************/
+/** Decode a voltage report data block.
+*
+*  \param     length         \IN   number of bytes in \a blkData
+*  \param     blkData        \IN   data block read with BMC_VOLTAGE_GET
+*  \param     volt_report    \OUT  voltage report
+*  \return    0 on success or error code
+*/
+static int32 VoltReportDecode(u_int8 length, u_int8 *blkData,
+							  struct bmc_voltage_report *volt_report)
+{
+	if (length != VOLT_REPORT_LENGTH)
+		return SMB2_BMC_ERR_LENGTH;
+
+	if(blkData[0] == ERROR_CODE)
+		return SMB2_BMC_ERROR;
+	
+	volt_report->actual_volt = ((u_int16)blkData[2] << 8)+ blkData[1];
+	volt_report->nominal_volt = ((u_int16)blkData[4] << 8) + blkData[3];
+	volt_report->low_lim_volt = ((u_int16)blkData[6] << 8) + blkData[5];
+	volt_report->up_lim_volt = ((u_int16)blkData[8] << 8) + blkData[7];
+	
+	return SMB2_BMC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Decode an event report data block.
+*
+*  \param     length          \IN   number of bytes in \a blkData
+*  \param     blkData         \IN   data block read with BMC_EVLOG_READ
+*  \param     event_report    \OUT  event report
+*  \return    0 on success or error code
+*/
+static int32 EventReportDecode(u_int8 length, u_int8 *blkData,
+							   struct bmc_event_report *event_report)
+{
+	if (length != EVLOG_READ_LENGTH)
+		return SMB2_BMC_ERR_LENGTH;
+	
+	if(blkData[0] == ERROR_CODE)
+		return SMB2_BMC_ERROR;
+
+	event_report->tstamp = ((u_int64)blkData[5] & 0x7F) << 32;
+	event_report->tstamp += (u_int64)blkData[4] << 24;
+	event_report->tstamp += (u_int64)blkData[3] << 16;
+	event_report->tstamp += (u_int64)blkData[2] << 8;
+	event_report->tstamp += (u_int64)blkData[1]; 
+	
+	event_report->rtcv = blkData[5] & 0x80;
+	event_report->procID = blkData[6];
+	event_report->ev_code = ((u_int16)blkData[8] << 8) + blkData[7];
+	event_report->ev_info1 = blkData[9];
+	event_report->ev_info2 = blkData[10];
+	event_report->ev_info3 = blkData[11];
+	event_report->ev_info4 = blkData[12];
+	
+	return SMB2_BMC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Decode a reset reason data block.
+*
+*  \param     length          \IN   number of bytes in \a blkData
+*  \param     blkData         \IN   data block read with BMC_RST_REASON_GET
+*  \param     reset_reason    \OUT  reset reason
+*  \return    0 on success or error code
+*/
+static int32 RstReasonDecode(u_int8 length, u_int8 *blkData,
+							 struct bmc_rst_reason *reset_reason)
+{
+	if (length != RST_REASON_LENGTH)
+		return SMB2_BMC_ERR_LENGTH;
+
+	if(blkData[0] == ERROR_CODE)
+		return SMB2_BMC_ERROR;
+	
+	reset_reason->procID = blkData[1];
+	reset_reason->ev_code = ((u_int16)blkData[3] << 8) + blkData[2];
+	reset_reason->ev_info1 = blkData[4];
+	reset_reason->ev_info2 = blkData[5];
+	reset_reason->ev_info3 = blkData[6];
+	reset_reason->ev_info4 = blkData[7];
+	
+	return SMB2_BMC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Decode a 32 bit counter data block (little endian).
+*
+*  \param     length        \IN   number of bytes in \a blkData
+*  \param     exp_length    \IN   expected number of bytes
+*  \param     blkData       \IN   data block
+*  \param     value         \OUT  counter value
+*  \return    0 on success or error code
+*/
+static int32 CounterDecode(u_int8 length, u_int8 exp_length, u_int8 *blkData,
+						   u_int32 *value)
+{
+	if (length != exp_length)
+		return SMB2_BMC_ERR_LENGTH;
+
+	*value = (u_int32)(blkData[3] << 24);
+	*value += (u_int32)(blkData[2] << 16);
+	*value += (u_int32)(blkData[1] << 8);
+	*value += (u_int32)(blkData[0]);
+	
+	return SMB2_BMC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Decode an error counter data block.
+*
+*  \param     length       \IN   number of bytes in \a blkData
+*  \param     blkData      \IN   data block read with BMC_ERRCNT_GET
+*  \param     error_cnt    \OUT  error counter
+*  \return    0 on success or error code
+*/
+static int32 ErrCntDecode(u_int8 length, u_int8 *blkData, u_int16 *error_cnt)
+{
+	if (length != ERRCNT_LENGTH)
+		return SMB2_BMC_ERR_LENGTH;
+
+	if(blkData[0] == ERROR_CODE)
+		return SMB2_BMC_ERROR;
+	
+	*error_cnt = ((u_int16)blkData[2] << 8) + blkData[1];
+
+	return SMB2_BMC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Decode a RTC data block.
+*
+*  \param     length     \IN   number of bytes in \a blkData
+*  \param     blkData    \IN   data block read with BMC_RTC_GET
+*  \param     rtc        \OUT  RTC time and battery state
+*  \return    0 on success or error code
+*/
+static int32 RtcDecode(u_int8 length, u_int8 *blkData, struct bmc_rtc *rtc)
+{
+	if (length != RTC_GET_LENGTH)
+		return SMB2_BMC_ERR_LENGTH;
+
+	if(blkData[0] == ERROR_CODE)
+		return SMB2_BMC_ERROR;
+	
+	rtc->year = ((u_int16)blkData[2] << 8) + blkData[1];
+	rtc->month = blkData[3];
+	rtc->mday = blkData[4];
+	rtc->hours = blkData[5];
+	rtc->minutes = blkData[6];
+	rtc->seconds = blkData[7];
+	rtc->battery = blkData[8] & RTC_BATTERY_LOW;
+
+	return SMB2_BMC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Decode an event log status data block.
+*
+*  \param     length        \IN   number of bytes in \a blkData
+*  \param     blkData       \IN   data block read with BMC_EVLOG_STAT
+*  \param     evlog_stat    \OUT  event log status
+*  \return    0 on success or error code
+*/
+static int32 EvLogStatusDecode(u_int8 length, u_int8 *blkData,
+							   struct bmc_evlog_status *evlog_stat)
+{
+	if (length != EVLOG_STAT_LENGTH)
+		return SMB2_BMC_ERR_LENGTH;
+	
+	if(blkData[0] == ERROR_CODE)
+		return SMB2_BMC_ERROR;
+	
+	evlog_stat->rtcts = blkData[1] & 0x01;
+	evlog_stat->max_entries = blkData[2];
+	evlog_stat->max_entries += (u_int16)blkData[3] << 8;
+	evlog_stat->act_entries = blkData[4];
+	evlog_stat->act_entries += (u_int16)blkData[5] << 8;
+	
+	return SMB2_BMC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Compare two event reports.
+*
+*  \param     a    \IN  event report
+*  \param     b    \IN  event report
+*  \return    1 if equal, 0 otherwise
+*/
+static int EventReportEqual(struct bmc_event_report *a,
+							struct bmc_event_report *b)
+{
+	return (a->tstamp == b->tstamp && a->rtcv == b->rtcv &&
+			a->procID == b->procID && a->ev_code == b->ev_code &&
+			a->ev_info1 == b->ev_info1 && a->ev_info2 == b->ev_info2 &&
+			a->ev_info3 == b->ev_info3 && a->ev_info4 == b->ev_info4);
+}
+
+/****************************************************************************/
+/** Read consecutive events from the event log.
+*
+*  Up to EVLOG_BATCH events are read with one transaction group.
+*
+*  \param     h               \IN   BMC handle
+*  \param     first_idx       \IN   index of first event
+*  \param     num             \IN   number of events to read
+*  \param     event_report    \OUT  event reports (num elements)
+*  \return    0 on success or error code
+*/
+static int32 EventLogReadBatch(BMC_HANDLE *h, u_int16 first_idx, u_int16 num,
+							   struct bmc_event_report *event_report)
+{
+	int err = 0;
+	u_int16 n, i;
+	u_int8 length[EVLOG_BATCH];
+	u_int8 blkData[EVLOG_BATCH][SMB_BLOCK_MAX_BYTES];
+	void *grpHdl;
+
+	while (!err && num) {
+		n = (num > EVLOG_BATCH) ? EVLOG_BATCH : num;
+
+		err = SMB2API_XferGroupBegin(h->smbHdl, 0, 2 * n, &grpHdl);
+
+		if (err)
+			return err;
+
+		for (i=0; !err && i < n; i++) {
+			err = SMB2API_XferGroupAddWriteWordData(grpHdl, BMC_SMBFLAGS,
+							h->addr, BMC_EVLOG_READ_IDX,
+							(u_int16)(first_idx + i));
+			if (!err)
+				err = SMB2API_XferGroupAddReadBlockData(grpHdl, BMC_SMBFLAGS,
+							h->addr, BMC_EVLOG_READ, &length[i], blkData[i]);
+		}
+
+		if (!err)
+			err = SMB2API_XferGroupCommit(grpHdl);
+
+		SMB2API_XferGroupEnd(&grpHdl);
+
+		for (i=0; !err && i < n; i++)
+			err = EventReportDecode(length[i], blkData[i], &event_report[i]);
+
+		first_idx += n;
+		event_report += n;
+		num -= n;
+	}
+
+	return err;
+}
+
+/****************************************************************************/
+/** Load the event log cursor.
+*
+*  A missing cursor file is no error, \a act_entries is set to 0 then.
+*
+*  \param     cursor_file     \IN   path of the cursor file
+*  \param     act_entries     \OUT  log index of the last delivered event + 1
+*  \param     event_report    \OUT  last delivered event
+*  \return    0 on success or error code
+*/
+static int32 EventLogCursorLoad(char *cursor_file, u_int16 *act_entries,
+								struct bmc_event_report *event_report)
+{
+	FILE *fp;
+	unsigned int act, rtcv, procID, ev_code, info1, info2, info3, info4;
+	unsigned long long tstamp;
+
+	*act_entries = 0;
+	memset(event_report, 0, sizeof(struct bmc_event_report));
+
+	fp = fopen(cursor_file, "r");
+	if (!fp)
+		return SMB2_BMC_ERR_NO;
+
+	if (fscanf(fp, "%u %llu %u %u %u %u %u %u %u", &act, &tstamp, &rtcv,
+			   &procID, &ev_code, &info1, &info2, &info3, &info4) != 9) {
+		fclose(fp);
+		return SMB2_BMC_ERR_INPUT;
+	}
+	fclose(fp);
+
+	*act_entries = (u_int16)act;
+	event_report->tstamp = (u_int64)tstamp;
+	event_report->rtcv = (u_int8)rtcv;
+	event_report->procID = (u_int8)procID;
+	event_report->ev_code = (u_int16)ev_code;
+	event_report->ev_info1 = (u_int8)info1;
+	event_report->ev_info2 = (u_int8)info2;
+	event_report->ev_info3 = (u_int8)info3;
+	event_report->ev_info4 = (u_int8)info4;
+
+	return SMB2_BMC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Store the event log cursor.
+*
+*  The cursor is written to a temporary file which then replaces the
+*  cursor file, so an interrupted write does not destroy the old cursor.
+*
+*  \param     cursor_file     \IN  path of the cursor file
+*  \param     act_entries     \IN  log index of the last delivered event + 1
+*  \param     event_report    \IN  last delivered event
+*  \return    0 on success or error code
+*/
+static int32 EventLogCursorStore(char *cursor_file, u_int16 act_entries,
+								 struct bmc_event_report *event_report)
+{
+	FILE *fp;
+	char *tmp_file;
+	int err;
+
+	tmp_file = (char*)malloc(strlen(cursor_file) + 5);
+	if (!tmp_file)
+		return SMB_ERR_NO_MEM;
+	sprintf(tmp_file, "%s.tmp", cursor_file);
+
+	fp = fopen(tmp_file, "w");
+	if (!fp) {
+		free(tmp_file);
+		return SMB2_BMC_ERR_INPUT;
+	}
+
+	fprintf(fp, "%u %llu %u %u %u %u %u %u %u\n",
+			(unsigned int)act_entries,
+			(unsigned long long)event_report->tstamp,
+			(unsigned int)event_report->rtcv,
+			(unsigned int)event_report->procID,
+			(unsigned int)event_report->ev_code,
+			(unsigned int)event_report->ev_info1,
+			(unsigned int)event_report->ev_info2,
+			(unsigned int)event_report->ev_info3,
+			(unsigned int)event_report->ev_info4);
+
+	err = ferror(fp);
+	if (fclose(fp) || err || rename(tmp_file, cursor_file)) {
+		remove(tmp_file);
+		free(tmp_file);
+		return SMB2_BMC_ERR_INPUT;
+	}
+
+	free(tmp_file);
+
+	return SMB2_BMC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Read the features from the BMC.
+*
+*  \param     h       \IN   BMC handle
+*  \param     caps    \OUT  SMB2_BMC_CAP_xxx bitmap
+*  \return    0 on success or error code
+*/
+static int32 CapsRead(BMC_HANDLE *h, u_int32 *caps)
+{
+	int err;
+	u_int8 length;
+	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
+	
+	err = SMB2API_ReadBlockData(h->smbHdl, BMC_SMBFLAGS, h->addr,
+								BMC_GET_FEAT, &length, blkData);
+
+	if (err)
+		return err;
+
+	if (length != BMC_GET_FEAT_LENGTH)
+		return SMB2_BMC_ERR_LENGTH;
+	
+	if(blkData[0] == ERROR_CODE)
+		return SMB2_BMC_ERROR;
+
+	*caps = 0;
+	if (blkData[1] & GPIO_SUPPORT)		*caps |= SMB2_BMC_CAP_GPIO;
+	if (blkData[1] & CPCI_SUPPORT)		*caps |= SMB2_BMC_CAP_CPCI;
+	if (blkData[1] & FUP_SUPPORT)		*caps |= SMB2_BMC_CAP_FUP;
+	if (blkData[1] & RTC_SUPPORT)		*caps |= SMB2_BMC_CAP_RTC;
+	if (blkData[1] & ERRCNT_SUPPORT)	*caps |= SMB2_BMC_CAP_ERRCNT;
+	if (blkData[1] & EVLOG_SUPPORT)		*caps |= SMB2_BMC_CAP_EVLOG;
+	if (blkData[1] & VREP_SUPPORT)		*caps |= SMB2_BMC_CAP_VREP;
+
+	if (blkData[2] & CLUS_SUPPORT)		*caps |= SMB2_BMC_CAP_CLUS;
+
+	if (blkData[5] & SRTCR_SUPPORT)		*caps |= SMB2_BMC_CAP_SRTCR;
+	if (blkData[5] & RSIMD_SUPPORT)		*caps |= SMB2_BMC_CAP_RSIMD;
+	if (blkData[5] & EPFMD_SUPPORT)		*caps |= SMB2_BMC_CAP_EPFMD;
+	if (blkData[5] & RESMD_SUPPORT)		*caps |= SMB2_BMC_CAP_RESMD;
+	if (blkData[5] & HWB_SUPPORT)		*caps |= SMB2_BMC_CAP_HWB;
+
+	return SMB2_BMC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Read the firmware version from the BMC.
+*
+*  \param     h             \IN   BMC handle
+*  \param     fw_version    \OUT  contains firmware version informations
+*  \return    0 on success or error code
+*/
+static int32 FirmVerRead(BMC_HANDLE *h, struct bmc_fwversion *fw_version)
+{
+	int err;
+	u_int8 length;
+	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
+
+	err = SMB2API_ReadBlockData(h->smbHdl, BMC_SMBFLAGS, h->addr,
+				    BMC_GET_FW_REV, &length, blkData);
+
+	if (err)
+		return err;
+
+	if (length != BMC_GET_FW_REV_LENGTH)
+		return SMB2_BMC_ERR_LENGTH;
+
+	if(blkData[0] == ERROR_CODE)
+		return SMB2_BMC_ERROR;
+	
+	fw_version->maj_revision = blkData[1];
+	fw_version->min_revision = blkData[2];
+
+	fw_version->mtnce_revision = blkData[3];
+	fw_version->build_nbr = (u_int16)blkData[4] << 8;
+	fw_version->build_nbr += blkData[5];
+
+	fw_version->veri_flag = blkData[6];
+
+	return SMB2_BMC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Decode a SUPV status frame data block.
+*
+*  \param     blkData         \IN   data block read with BMC_GET_STAT_FRM
+*  \param     status_frame    \OUT  decoded status frame
+*/
+static void StatusFrameDecode(u_int8 *blkData,
+							  struct bmc_status_frame *status_frame)
+{
+	status_frame->wd_itout = blkData[0] & 0x40;
+	status_frame->isw_st = blkData[0] & 0x20;
+	status_frame->fpga_rdy = blkData[0] & 0x10;
+	status_frame->state = blkData[0] & 0x0F;
+	
+	status_frame->fault_cause = blkData[1] & 0x7F;
+	
+	status_frame->maj_rev = (blkData[2] >> 4) & 0x07;
+	status_frame->min_rev = blkData[2] & 0x0F;
+
+	status_frame->ov_shdn = blkData[3] & 0x40;
+	status_frame->fpga_mon_en = blkData[3] & 0x20;
+	status_frame->restart = blkData[3] & 0x10;
+	status_frame->test_mode = blkData[3] & 0x08;
+	status_frame->nom_ss_clk = blkData[3] & 0x07;
+	
+	status_frame->wd_tout_ul = (blkData[4] >> 4) & 0x07;
+	status_frame->wd_tout_ll = blkData[4] & 0x08;
+	status_frame->wd_en = blkData[4] & 0x04;
+	status_frame->wd_init_tout = blkData[4] & 0x03;
+	
+	status_frame->supv_id = blkData[5] & 0x7F;
+	status_frame->supv_id += ((u_int16)blkData[6] << 8) & 0x1F00;
+	
+	status_frame->life_sign_bit = blkData[6] & 0x40;
+	
+	status_frame->supv_id_build_no = blkData[7] & 0x7F;
+	
+	status_frame->crc = blkData[8] & 0xFF;
+}
+
+/****************************************************************************/
+/** Read all error counters.
+*
+*  Uses the health snapshot reads, so the counters are read with as few
+*  transaction groups as possible. h->errCntNum must be valid.
+*
+*  \param     h         \IN   BMC handle
+*  \param     counts    \OUT  h->errCntNum error counters
+*  \return    0 on success or error code
+*/
+static int32 ErrCntReadAll(BMC_HANDLE *h, u_int16 *counts)
+{
+	int err;
+	u_int32 num = 0, requests = 0, i;
+	HEALTH_READ *rd;
+
+	if (h->errCntNum == 0)
+		return SMB2_BMC_ERR_NO;
+
+	rd = (HEALTH_READ*)malloc(h->errCntNum * sizeof(HEALTH_READ));
+	if (!rd)
+		return SMB_ERR_NO_MEM;
+
+	for (i = 0; i < h->errCntNum; i++)
+		HealthReadAdd(rd, &num, SMB2_BMC_HEALTH_ERRCNT, HR_BLOCK,
+					  BMC_ERRCNT_GET, 1, BMC_ERRCNT_SET_IDX, (u_int8)i);
+
+	err = HealthReadExec(h, rd, num, &requests);
+
+	for (i = 0; !err && i < num; i++) {
+		err = rd[i].err;
+		if (!err)
+			err = ErrCntDecode(rd[i].length, rd[i].blkData, &counts[i]);
+	}
+
+	free(rd);
+
+	return err;
+}
+
+/****************************************************************************/
+/** Append a read to a health snapshot read list.
+*
+*  \param     rd         \OUT    read list
+*  \param     num        \INOUT  number of reads in \a rd
+*  \param     section    \IN     SMB2_BMC_HEALTH_xxx section
+*  \param     type       \IN     HR_BYTE, HR_WORD or HR_BLOCK
+*  \param     cmd        \IN     read command
+*  \param     idxSet     \IN     1=write \a idx with \a idxCmd before reading
+*  \param     idxCmd     \IN     command to set the index
+*  \param     idx        \IN     index
+*/
+static void HealthReadAdd(HEALTH_READ *rd, u_int32 *num, u_int32 section,
+						  int type, u_int8 cmd, int idxSet, u_int8 idxCmd,
+						  u_int8 idx)
+{
+	HEALTH_READ *r = &rd[(*num)++];
+
+	memset(r, 0, sizeof(HEALTH_READ));
+	r->section = section;
+	r->type = type;
+	r->cmd = cmd;
+	r->idxSet = idxSet;
+	r->idxCmd = idxCmd;
+	r->idx = idx;
+}
+
+/****************************************************************************/
+/** Execute the reads of a health snapshot.
+*
+*  The reads are packed into as few transaction groups as possible. An
+*  index write and its read are never split. The result of each read
+*  is stored in its \a err field.
+*
+*  \param     h           \IN     BMC handle
+*  \param     rd          \INOUT  read list
+*  \param     num         \IN     number of reads in \a rd
+*  \param     requests    \INOUT  incremented for each driver request
+*  \return    0 on success or error code
+*/
+static int32 HealthReadExec(BMC_HANDLE *h, HEALTH_READ *rd, u_int32 num,
+							u_int32 *requests)
+{
+	int err;
+	void *grpHdl;
+	u_int32 first, last, i, e, xfers;
+	int32 idxErr;
+
+	for (first = 0; first < num; first = last) {
+		/* as many reads as fit into one group */
+		xfers = 0;
+		for (last = first; last < num; last++) {
+			e = rd[last].idxSet ? 2 : 1;
+			if (xfers + e > SMB2_XFER_GROUP_MAX)
+				break;
+			xfers += e;
+		}
+
+		err = SMB2API_XferGroupBegin(h->smbHdl, SMB2_XFER_GROUP_CONT, xfers,
+									 &grpHdl);
+		if (err)
+			return err;
+
+		for (i = first; !err && i < last; i++) {
+			if (rd[i].idxSet)
+				err = SMB2API_XferGroupAddWriteByteData(grpHdl, BMC_SMBFLAGS,
+							h->addr, rd[i].idxCmd, rd[i].idx);
+			if (err)
+				break;
+
+			switch (rd[i].type) {
+			case HR_BYTE:
+				err = SMB2API_XferGroupAddReadByteData(grpHdl, BMC_SMBFLAGS,
+							h->addr, rd[i].cmd, &rd[i].byteData);
+				break;
+			case HR_WORD:
+				err = SMB2API_XferGroupAddReadWordData(grpHdl, BMC_SMBFLAGS,
+							h->addr, rd[i].cmd, &rd[i].wordData);
+				break;
+			default:
+				err = SMB2API_XferGroupAddReadBlockData(grpHdl, BMC_SMBFLAGS,
+							h->addr, rd[i].cmd, &rd[i].length,
+							rd[i].blkData);
+				break;
+			}
+		}
+
+		if (!err) {
+			err = SMB2API_XferGroupCommit(grpHdl);
+			(*requests)++;
+		}
+
+		for (i = first, e = 0; i < last; i++) {
+			if (err) {
+				rd[i].err = err;
+				continue;
+			}
+
+			idxErr = 0;
+			if (rd[i].idxSet)
+				idxErr = SMB2API_XferGroupError(grpHdl, e++);
+			rd[i].err = SMB2API_XferGroupError(grpHdl, e++);
+			if (idxErr)
+				rd[i].err = idxErr;
+		}
+
+		SMB2API_XferGroupEnd(&grpHdl);
+	}
+
+	return SMB2_BMC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Read the GPO/GPI capabilities from the BMC.
+*
+*  Sets the GPIO cache of the handle (gpoCaps, gpiCaps).
+*
+*  \param     h    \INOUT  BMC handle
+*  \return    0 on success or error code
+*/
+static int32 GpioRead(BMC_HANDLE *h)
+{
+	int err;
+	void *grpHdl;
+	u_int8 gpo_caps, gpi_caps;
+
+	err = SMB2API_XferGroupBegin(h->smbHdl, 0, 2, &grpHdl);
+
+	if (err)
+		return err;
+
+	err = SMB2API_XferGroupAddReadByteData(grpHdl, BMC_SMBFLAGS, h->addr,
+										   BMC_GPO_CAPS, &gpo_caps);
+	if (!err)
+		err = SMB2API_XferGroupAddReadByteData(grpHdl, BMC_SMBFLAGS, h->addr,
+											   BMC_GPI_CAPS, &gpi_caps);
+	if (!err)
+		err = SMB2API_XferGroupCommit(grpHdl);
+
+	SMB2API_XferGroupEnd(&grpHdl);
+
+	if (err)
+		return err;
+
+	if ((gpo_caps & GPIO_ERR) || (gpi_caps & GPIO_ERR))
+		return SMB2_BMC_ERROR;
+
+	h->gpoCaps = gpo_caps;
+	h->gpiCaps = gpi_caps;
+	h->gpioCapsValid = 1;
+
+	return SMB2_BMC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Initialize a BMC handle.
+*
+*  Reads the features and firmware version, see SMB2BMC_Init.
+*
+*  \param     h          \OUT  BMC handle
+*  \param     deviceP    \IN   MDIS device name
+*  \param     addr       \IN   SMBus address of the BMC
+*  \return    0 on success or error code
+*/
+static int32 BmcOpen(BMC_HANDLE *h, char *deviceP, u_int16 addr)
+{
+	int err;
+
+	memset(h, 0, sizeof(BMC_HANDLE));
+	h->addr = addr;
+
+	err = SMB2API_Init(deviceP, &h->smbHdl);
+
+	if (err)
+		return err;
+
+	if (CapsRead(h, &h->caps) == SMB2_BMC_ERR_NO)
+		h->capsValid = 1;
+
+	if (FirmVerRead(h, &h->fwVersion) == SMB2_BMC_ERR_NO)
+		h->fwVersionValid = 1;
+
+	if (h->capsValid && (h->caps & SMB2_BMC_CAP_GPIO))
+		GpioRead(h);
+
+	return SMB2_BMC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Deinitialize a BMC handle.
+*
+*  \param     h    \INOUT  BMC handle
+*  \return    0 on success or error code
+*/
+static int32 BmcClose(BMC_HANDLE *h)
+{
+	int err = 0;
+
+	if (h->smbHdl)
+		err = SMB2API_Exit(&h->smbHdl);
+
+	h->voltMaxNum = 0;
+	h->errCntNum = 0;
+	h->capsValid = 0;
+	h->fwVersionValid = 0;
+	h->gpioCapsValid = 0;
+
+	return err;
+}
@@ -0,0 +1,52 @@
+/***********************  I n c l u d e  -  F i l e  ************************/
+/*!
+ *        \file  smb2_bmc_int.h
+ *
+ *      \author  quoc.bui@men.de
+ *
+ *       \brief  SMB2_BMC_API internal include file
+ *
+ *               Functions shared between the library modules and the
+ *               background services (e.g. watchdog keep-alive).
+ *
+ *    \switches  -
+ */
+/*
+ *---------------------------------------------------------------------------
+ * Copyright 2014-2019, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _SMB2_BMC_INT_H
+#define _SMB2_BMC_INT_H
+
+#ifdef __cplusplus
+      extern "C" {
+#endif
+
+#include <MEN/smb2_os.h>
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+int32 BMC_StatusFrameSample(void *bmcHdl,
+							struct bmc_status_frame *status_frame);
+
+#ifdef __cplusplus
+      }
+#endif
+
+#endif /* _SMB2_BMC_INT_H */
@@ -0,0 +1,316 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************/
+/*!
+ *        \file  smb2_bmc_sampler.c
+ *
+ *      \author  quoc.bui@men.de
+ *
+ *       \brief  BMC status frame sampler
+ *
+ *               A background thread samples the SUPV status frame at a
+ *               fixed rate. The samples are passed to the application
+ *               through a single-producer/single-consumer ring buffer
+ *               without locks: the sampler thread only writes the head
+ *               index, SMB2BMC_Sampler_Read only writes the tail index.
+ *
+ *    \switches  WINNT
+ *
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2014-2019, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+ /*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <MEN/men_typs.h>
+#include <MEN/usr_oss.h>
+#include <MEN/smb2_bmc_api.h>
+#include <MEN/smb2_api.h>
+#include "smb2_bmc_int.h"
+
+/*-----------------------------------------+
+|  DEFINES                                 |
++-----------------------------------------*/
+#define SMPL_SLICE				100		/* max. sleep time before checking
+										   for stop request [ms] */
+
+/*-----------------------------------------+
+|  TYPEDEFS                                |
++-----------------------------------------*/
+/** sampler handle */
+typedef struct
+{
+	void			*bmcHdl;	/**< BMC handle */
+	SMB2_OS_THREAD	thread;		/**< sampler thread */
+	volatile int	stop;		/**< stop request for the thread */
+	u_int32			period;		/**< sample period [ms] */
+	SMB2BMC_SAMPLER_CB callback;	/**< event callback */
+	void			*cbArg;		/**< argument for callback */
+	u_int32			ringMask;	/**< ring size - 1 */
+	volatile u_int32 head;		/**< next sample to write (sampler) */
+	volatile u_int32 tail;		/**< next sample to read (application) */
+	struct bmc_status_sample *ring;	/**< ring buffer */
+}SMPL_HANDLE;
+
+/** change detection state of the sampler thread */
+typedef struct
+{
+	int				valid;		/**< last frame is valid */
+	int				failed;		/**< last read failed */
+	int				stalled;	/**< life sign stall reported */
+	u_int32			sameCnt;	/**< frames without life sign toggle */
+	struct bmc_status_frame last;	/**< last valid frame */
+}SMPL_STATE;
+
+/*-----------------------------------------+
+|  PROTOTYPES                              |
++-----------------------------------------*/
+static void SamplerThread(void *arg);
+static u_int32 SamplerCheck(SMPL_STATE *st, struct bmc_status_sample *sample);
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_Sampler_Start().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_Sampler_Start, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_Sampler_Start(
+	void *bmcHdl,
+	u_int32 period,
+	u_int32 ring_size,
+	u_int32 flags,
+	SMB2BMC_SAMPLER_CB callback,
+	void *cb_arg,
+	void **smplHdlP)
+{
+	SMPL_HANDLE *smpl;
+	int32 err;
+
+	*smplHdlP = NULL;
+
+	if (period < SMB2_BMC_SMPL_PERIOD_MIN || flags ||
+		ring_size == 0 || (ring_size & (ring_size - 1)))
+		return SMB2_BMC_ERR_INPUT;
+
+	smpl = (SMPL_HANDLE*)malloc(sizeof(SMPL_HANDLE));
+	if (!smpl)
+		return SMB_ERR_NO_MEM;
+
+	memset(smpl, 0, sizeof(SMPL_HANDLE));
+
+	smpl->ring = (struct bmc_status_sample*)
+		malloc(ring_size * sizeof(struct bmc_status_sample));
+	if (!smpl->ring) {
+		free(smpl);
+		return SMB_ERR_NO_MEM;
+	}
+
+	smpl->bmcHdl = bmcHdl;
+	smpl->period = period;
+	smpl->callback = callback;
+	smpl->cbArg = cb_arg;
+	smpl->ringMask = ring_size - 1;
+
+	err = SMB2_OsThreadCreate(&smpl->thread, SamplerThread, smpl, 1);
+	if (err) {
+		free(smpl->ring);
+		free(smpl);
+		return err;
+	}
+
+	*smplHdlP = smpl;
+
+	return SMB2_BMC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Stop the status frame sampler.
+*
+*  Waits for the sampler thread to terminate and frees the handle.
+*  Samples not yet read are discarded.
+*
+*  \param     smplHdlP    \INOUT  sampler handle, set to NULL
+*  \return    0 on success or error code
+*
+*  \sa SMB2BMC_Sampler_Start
+*/
+int32 __MAPILIB SMB2BMC_Sampler_Stop(void **smplHdlP)
+{
+	SMPL_HANDLE *smpl = (SMPL_HANDLE*)*smplHdlP;
+
+	if (!smpl)
+		return SMB2_BMC_ERR_INPUT;
+
+	smpl->stop = 1;
+	SMB2_OsThreadJoin(&smpl->thread);
+	free(smpl->ring);
+	free(smpl);
+	*smplHdlP = NULL;
+
+	return SMB2_BMC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Fetch samples from the status frame sampler.
+*
+*  Copies up to \a count of the oldest samples from the ring buffer and
+*  removes them. Does not block. Must be called from one thread only.
+*
+*  \param     smplHdl    \IN     sampler handle
+*  \param     sample     \OUT    array for the samples
+*  \param     count      \INOUT  in: number of elements of \a sample
+*                                out: number of samples copied
+*  \return    0 on success or error code
+*
+*  \sa SMB2BMC_Sampler_Start
+*/
+int32 __MAPILIB SMB2BMC_Sampler_Read(
+	void *smplHdl,
+	struct bmc_status_sample *sample,
+	u_int32 *count)
+{
+	SMPL_HANDLE *smpl = (SMPL_HANDLE*)smplHdl;
+	u_int32 n = 0;
+	u_int32 tail;
+
+	if (!smpl)
+		return SMB2_BMC_ERR_INPUT;
+
+	tail = smpl->tail;
+	while (n < *count && tail != smpl->head) {
+		/* read the sample only after the head index */
+		SMB2_OS_MEMBAR();
+		sample[n++] = smpl->ring[tail & smpl->ringMask];
+		tail++;
+		/* release the slot only after the sample was copied */
+		SMB2_OS_MEMBAR();
+		smpl->tail = tail;
+	}
+
+	*count = n;
+
+	return SMB2_BMC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Sampler thread
+*
+*  Samples are taken at fixed absolute times (start + n * period). If the
+*  thread falls behind by more than one period, the schedule restarts at
+*  the current time. The first status frame is triggered at start and
+*  read one period later.
+*
+*  \param     arg    \IN  sampler handle
+*/
+static void SamplerThread(void *arg)
+{
+	SMPL_HANDLE *smpl = (SMPL_HANDLE*)arg;
+	SMPL_STATE st;
+	struct bmc_status_sample sample;
+	u_int32 wake, now, head, events;
+	u_int32 seq = 0;
+	int32 rem;
+
+	memset(&st, 0, sizeof(st));
+
+	SMB2BMC_H_StatusFrame_trigger(smpl->bmcHdl);
+	wake = UOS_MsecTimerGet() + smpl->period;
+
+	while (!smpl->stop) {
+		now = UOS_MsecTimerGet();
+		rem = (int32)(wake - now);
+		if (rem > 0) {
+			UOS_Delay(rem > SMPL_SLICE ? SMPL_SLICE : rem);
+			continue;
+		}
+
+		wake += smpl->period;
+		if ((int32)(wake - now) <= 0)
+			wake = now + smpl->period;
+
+		memset(&sample, 0, sizeof(sample));
+		sample.err = BMC_StatusFrameSample(smpl->bmcHdl, &sample.frame);
+		sample.tstamp = UOS_MsecTimerGet();
+		sample.seq = seq++;
+
+		/* store sample, drop it if the ring is full */
+		head = smpl->head;
+		if (head - smpl->tail <= smpl->ringMask) {
+			smpl->ring[head & smpl->ringMask] = sample;
+			/* publish the head index only after the sample was written */
+			SMB2_OS_MEMBAR();
+			smpl->head = head + 1;
+		}
+
+		events = SamplerCheck(&st, &sample);
+		if (events && smpl->callback)
+			smpl->callback(smpl->cbArg, events, &sample);
+	}
+}
+
+/****************************************************************************/
+/** Detect changes caused by a sample
+*
+*  \param     st        \INOUT  change detection state
+*  \param     sample    \IN     new sample
+*  \return    SMB2_BMC_SMPL_EV_xxx events
+*/
+static u_int32 SamplerCheck(SMPL_STATE *st, struct bmc_status_sample *sample)
+{
+	u_int32 events = 0;
+	struct bmc_status_frame *frame = &sample->frame;
+
+	if (sample->err) {
+		if (!st->failed)
+			events |= SMB2_BMC_SMPL_EV_ERR;
+		st->failed = 1;
+		return events;
+	}
+	st->failed = 0;
+
+	/* first valid frame: reference for the following frames */
+	if (!st->valid) {
+		st->valid = 1;
+		st->last = *frame;
+		return events;
+	}
+
+	if ((frame->life_sign_bit != 0) == (st->last.life_sign_bit != 0)) {
+		if (++st->sameCnt == SMB2_BMC_SMPL_STALL_CNT) {
+			events |= SMB2_BMC_SMPL_EV_STALL;
+			st->stalled = 1;
+		}
+	}
+	else {
+		st->sameCnt = 0;
+		if (st->stalled)
+			events |= SMB2_BMC_SMPL_EV_ALIVE;
+		st->stalled = 0;
+	}
+
+	if (frame->fault_cause != st->last.fault_cause)
+		events |= SMB2_BMC_SMPL_EV_FAULT;
+
+	if (frame->state != st->last.state)
+		events |= SMB2_BMC_SMPL_EV_STATE;
+
+	st->last = *frame;
+
+	return events;
+}
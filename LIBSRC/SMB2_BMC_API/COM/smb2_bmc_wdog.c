@@ -0,0 +1,250 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************/
+/*!
+ *        \file  smb2_bmc_wdog.c
+ *
+ *      \author  quoc.bui@men.de
+ *
+ *       \brief  BMC watchdog keep-alive service
+ *
+ *               A background thread triggers the BMC watchdog in the middle
+ *               of the trigger window [lower limit .. upper limit]. Trigger
+ *               deadlines are absolute times from UOS_MsecTimerGet(), so
+ *               the time spent for the SMBus access does not accumulate.
+ *
+ *               The time of the last trigger before the start is unknown,
+ *               so the first trigger is done immediately, or after the
+ *               lower limit if the window has one.
+ *
+ *    \switches  WINNT
+ *
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2014-2019, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+ /*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <MEN/men_typs.h>
+#include <MEN/usr_oss.h>
+#include <MEN/smb2_bmc_api.h>
+#include <MEN/smb2_api.h>
+#include "smb2_bmc_int.h"
+
+/*-----------------------------------------+
+|  DEFINES                                 |
++-----------------------------------------*/
+#define KA_SLICE				100		/* max. sleep time before checking
+										   for stop request [ms] */
+#define KA_RETRY				10		/* retry time after failed trigger [ms] */
+#define WDOG_MIN_TOUT_UNIT		10		/* unit of lower window limit [ms] */
+#define WDOG_MAX_TOUT_UNIT		100		/* unit of upper window limit [ms] */
+
+/*-----------------------------------------+
+|  TYPEDEFS                                |
++-----------------------------------------*/
+/** keep-alive handle */
+typedef struct
+{
+	void			*bmcHdl;	/**< BMC handle */
+	SMB2_OS_THREAD	thread;		/**< trigger thread */
+	SMB2_OS_MUTEX	lock;		/**< protects stats and jitterSum */
+	volatile int	stop;		/**< stop request for the thread */
+	double			jitterSum;	/**< sum of jitter values [ms] */
+	struct bmc_wdog_keepalive_stats stats;	/**< statistics */
+}KA_HANDLE;
+
+/*-----------------------------------------+
+|  PROTOTYPES                              |
++-----------------------------------------*/
+static void KeepAliveThread(void *arg);
+
+/****************************************************************************/
+/** Handle based variant of SMB2BMC_WDOG_KeepAliveStart().
+*
+*  \param     bmcHdl    \IN  BMC handle from SMB2BMC_Open
+*
+*  \sa SMB2BMC_WDOG_KeepAliveStart, SMB2BMC_Open
+*/
+int32 __MAPILIB SMB2BMC_H_WDOG_KeepAliveStart(void *bmcHdl, void **kaHdlP)
+{
+	KA_HANDLE *ka;
+	u_int16 wd_min_tout, wd_max_tout;
+	int32 err;
+
+	*kaHdlP = NULL;
+
+	err = SMB2BMC_H_WDOG_TimeGet(bmcHdl, &wd_max_tout);
+	if (err)
+		return err;
+
+	/* BMC without lower limit support: trigger window starts at 0 */
+	if (SMB2BMC_H_WDOG_MinTimeGet(bmcHdl, &wd_min_tout))
+		wd_min_tout = 0;
+
+	if (wd_max_tout * WDOG_MAX_TOUT_UNIT <= wd_min_tout * WDOG_MIN_TOUT_UNIT)
+		return SMB2_BMC_ERR_INPUT;
+
+	ka = (KA_HANDLE*)malloc(sizeof(KA_HANDLE));
+	if (!ka)
+		return SMB_ERR_NO_MEM;
+
+	memset(ka, 0, sizeof(KA_HANDLE));
+	ka->bmcHdl = bmcHdl;
+	ka->stats.win_min = wd_min_tout * WDOG_MIN_TOUT_UNIT;
+	ka->stats.win_max = wd_max_tout * WDOG_MAX_TOUT_UNIT;
+	ka->stats.period = (ka->stats.win_min + ka->stats.win_max) / 2;
+
+	SMB2_OsMutexInit(&ka->lock);
+
+	err = SMB2_OsThreadCreate(&ka->thread, KeepAliveThread, ka, 1);
+	if (err) {
+		SMB2_OsMutexDestroy(&ka->lock);
+		free(ka);
+		return err;
+	}
+
+	*kaHdlP = ka;
+
+	return SMB2_BMC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Stop the watchdog keep-alive service.
+*
+*  Waits for the trigger thread to terminate (max. ~100 ms) and frees the
+*  handle. The watchdog itself is not disabled: if it is still running,
+*  the application must trigger it from now on.
+*
+*  \param     kaHdlP    \INOUT  keep-alive handle, set to NULL
+*  \return    0 on success or error code
+*
+*  \sa SMB2BMC_WDOG_KeepAliveStart
+*/
+int32 __MAPILIB SMB2BMC_WDOG_KeepAliveStop(void **kaHdlP)
+{
+	KA_HANDLE *ka = (KA_HANDLE*)*kaHdlP;
+
+	if (!ka)
+		return SMB2_BMC_ERR_INPUT;
+
+	ka->stop = 1;
+	SMB2_OsThreadJoin(&ka->thread);
+	SMB2_OsMutexDestroy(&ka->lock);
+	free(ka);
+	*kaHdlP = NULL;
+
+	return SMB2_BMC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Get statistics of the watchdog keep-alive service.
+*
+*  The jitter is the delay of a trigger after its scheduled deadline.
+*  A near miss is a trigger whose distance to the previous trigger lies
+*  outside the middle half of the trigger window.
+*
+*  \param     kaHdl    \IN   keep-alive handle
+*  \param     stats    \OUT  statistics
+*  \return    0 on success or error code
+*
+*  \sa SMB2BMC_WDOG_KeepAliveStart
+*/
+int32 __MAPILIB SMB2BMC_WDOG_KeepAliveGetStats(
+	void *kaHdl,
+	struct bmc_wdog_keepalive_stats *stats)
+{
+	KA_HANDLE *ka = (KA_HANDLE*)kaHdl;
+
+	if (!ka)
+		return SMB2_BMC_ERR_INPUT;
+
+	SMB2_OsMutexLock(&ka->lock);
+	*stats = ka->stats;
+	if (ka->stats.trig_cnt)
+		stats->jitter_avg = (int32)(ka->jitterSum / ka->stats.trig_cnt);
+	SMB2_OsMutexUnlock(&ka->lock);
+
+	return SMB2_BMC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Trigger thread of the keep-alive service
+*
+*  The first trigger is due at the lower window limit (0 = immediately)
+*  after the start, at the earliest time that is safe without knowing the
+*  last trigger. The next deadline is computed from the time of the last
+*  successful trigger, because the BMC measures the window from there.
+*  Sleeps are split into KA_SLICE pieces to notice a stop request.
+*
+*  \param     arg    \IN  keep-alive handle
+*/
+static void KeepAliveThread(void *arg)
+{
+	KA_HANDLE *ka = (KA_HANDLE*)arg;
+	u_int32 last, deadline, wake, now, interval, guard;
+	int32 rem, jitter, err;
+
+	guard = (ka->stats.win_max - ka->stats.win_min) / 4;
+	last = UOS_MsecTimerGet();
+	deadline = wake = last + ka->stats.win_min;
+
+	while (!ka->stop) {
+		rem = (int32)(wake - UOS_MsecTimerGet());
+		if (rem > 0) {
+			UOS_Delay(rem > KA_SLICE ? KA_SLICE : rem);
+			continue;
+		}
+
+		err = SMB2BMC_H_WDOG_trig(ka->bmcHdl);
+		now = UOS_MsecTimerGet();
+
+		SMB2_OsMutexLock(&ka->lock);
+		if (err) {
+			ka->stats.err_cnt++;
+			ka->stats.last_err = err;
+		}
+		else {
+			jitter = (int32)(now - deadline);
+			interval = now - last;
+
+			if (ka->stats.trig_cnt == 0 || jitter < ka->stats.jitter_min)
+				ka->stats.jitter_min = jitter;
+			if (ka->stats.trig_cnt == 0 || jitter > ka->stats.jitter_max)
+				ka->stats.jitter_max = jitter;
+			ka->jitterSum += jitter;
+			ka->stats.trig_cnt++;
+
+			/* interval of the first trigger is unknown */
+			if (ka->stats.trig_cnt > 1 &&
+				(interval < ka->stats.win_min + guard ||
+				 interval > ka->stats.win_max - guard))
+				ka->stats.near_miss_cnt++;
+		}
+		SMB2_OsMutexUnlock(&ka->lock);
+
+		if (err) {
+			/* retry soon, keep deadline for jitter measurement */
+			wake = now + KA_RETRY;
+		}
+		else {
+			last = now;
+			deadline = wake = now + ka->stats.period;
+		}
+	}
+}
@@ -32,9 +32,11 @@
 #include <stdlib.h>
 
 #include <MEN/men_typs.h>
+#include <MEN/usr_oss.h>
 #include <MEN/smb2_shc.h>
 #include <MEN/smb2_api.h>
 #include <MEN/mdis_err.h>
+#include "smb2_shc_int.h"
 
 static const char IdentString[]=MENT_XSTR(MAK_REVISION);
 
@@ -84,13 +86,52 @@ static const char IdentString[]=MENT_XSTR(MAK_REVISION);
 #define SHC_SMBADDR          0xea
 #define SHC_SMBFLAGS         0x00
 
+/* snapshot transfers: temperature override block, temperature word,
+   PSU, FAN, voltage and UPS blocks */
+#define SHC_SNAP_BLOCKS      5
+#define SHC_SNAP_XFERS       (SHC_SNAP_BLOCKS + 1)
+
+/*-----------------------------------------+
+|  TYPEDEFS                                |
++-----------------------------------------*/
+/** SHC handle */
+typedef struct
+{
+	void					*smbHdl;	/**< SMB handle */
+	u_int16					addr;		/**< SMBus address of the SHC */
+	struct shc_fwversion	fwVersion;	/**< firmware version */
+	int						confValid;	/**< conf holds the SHC config */
+	struct shc_configdata	conf;		/**< cached configuration data */
+	int						tempOvrValid;	/**< tempOvr holds an active
+												 override until tempOvrEnd */
+	u_int8					tempOvr;	/**< temperature override active */
+	u_int16					tempOvrK;	/**< override temperature [K] */
+	u_int32					tempOvrEnd;	/**< end of cached override */
+	SMB2_OS_MUTEX			lock;		/**< protects the cached data */
+}SHC_HANDLE;
+
 /*-----------------------------------------+
 |  GLOBALS                                 |
 +-----------------------------------------*/
-static void *g_SMB2SHC_smbHdl;
-static struct shc_fwversion g_firm_version;
+/* SHC handle used by the functions without handle */
+static SHC_HANDLE G_shc;
 
-#define SHC_V416_OR_BELOW (g_firm_version.maj_revision <= 4 && g_firm_version.min_revision <= 16)
+/*-----------------------------------------+
+|  PROTOTYPES                              |
++-----------------------------------------*/
+static int32 ShcOpen(SHC_HANDLE *h, char *deviceP, u_int16 addr);
+static int32 ShcClose(SHC_HANDLE *h);
+static int32 ConfRead(SHC_HANDLE *h, struct shc_configdata *configdata);
+static int32 TempOvrRead(SHC_HANDLE *h);
+static int32 ShcBlockRead(SHC_HANDLE *h, u_int8 opcode, u_int8 exp_length,
+						  u_int8 *blkData);
+static void PsuDecode(u_int8 *blkData, int psu_nr, struct shc_psu *shc_psu);
+static void FanDecode(u_int8 *blkData, int fan_nr, struct shc_fan *shc_fan);
+static void UpsDecode(u_int8 *blkData, int ups_nr, struct shc_ups *shc_ups);
+static u_int16 VoltDecode(u_int8 *blkData, int pwr_mon_nr);
+
+/* version checks, require SHC_HANDLE *h */
+#define SHC_V416_OR_BELOW (h->fwVersion.maj_revision <= 4 && h->fwVersion.min_revision <= 16)
 #define SHC_AT_LEAST_V417 (!SHC_V416_OR_BELOW)
 
 /**
@@ -183,6 +224,9 @@ char* __MAPILIB SMB2SHC_Errstring(u_int32 errCode, char *strBuf)
 
 /****************************************************************************/
 /** Initialization of the shelf controller library
+ *
+ *  To access more than one shelf controller, use SMB2SHC_Open() and the
+ *  SMB2SHC_H_xxx() functions instead.
  *
  *  \param     deviceP    \IN  MDIS device name
  *  \return    0 on success or error code
@@ -191,15 +235,7 @@ char* __MAPILIB SMB2SHC_Errstring(u_int32 errCode, char *strBuf)
  */
 int32 __MAPILIB SMB2SHC_Init(char *deviceP)
 {
-	int err = SMB2API_Init(deviceP, &g_SMB2SHC_smbHdl);
-	if (err) {
-		return err;
-	}
-	err = SMB2SHC_GetFirm_Ver(&g_firm_version);
-	if (err) {
-		return err;
-	}
-        return SMB2_SHC_ERR_NO;
+	return ShcOpen(&G_shc, deviceP, SHC_SMBADDR);
 }
 
 
@@ -212,11 +248,66 @@ int32 __MAPILIB SMB2SHC_Init(char *deviceP)
  */
 int32 __MAPILIB SMB2SHC_Exit()
 {
-	if (g_SMB2SHC_smbHdl) {
-		return (SMB2API_Exit(&g_SMB2SHC_smbHdl));
+	return ShcClose(&G_shc);
+}
+
+
+/****************************************************************************/
+/** Open a shelf controller and return a handle for the SMB2SHC_H_xxx()
+ *  functions.
+ *
+ *  Each handle keeps its own SMB handle, address and firmware version,
+ *  so one process can access several shelf controllers.
+ *
+ *  \param     deviceP    \IN   MDIS device name
+ *  \param     addr       \IN   SMBus address of the SHC (e.g. SMB2_SHC_SMBADDR)
+ *  \param     shcHdlP    \OUT  SHC handle
+ *  \return    0 on success or error code
+ *
+ *  \sa SMB2SHC_Close
+ */
+int32 __MAPILIB SMB2SHC_Open(char *deviceP, u_int16 addr, void **shcHdlP)
+{
+	int err;
+	SHC_HANDLE *h;
+
+	*shcHdlP = NULL;
+
+	h = (SHC_HANDLE*)malloc(sizeof(SHC_HANDLE));
+	if (!h)
+		return SMB_ERR_NO_MEM;
+
+	err = ShcOpen(h, deviceP, addr);
+	if (err) {
+		free(h);
+		return err;
 	}
 
-	return (0);
+	*shcHdlP = (void*)h;
+	return SMB2_SHC_ERR_NO;
+}
+
+
+/****************************************************************************/
+/** Close a shelf controller handle opened with SMB2SHC_Open().
+ *
+ *  \param     shcHdlP    \INOUT  SHC handle, set to NULL
+ *  \return    0 on success or error code
+ *
+ *  \sa SMB2SHC_Open
+ */
+int32 __MAPILIB SMB2SHC_Close(void **shcHdlP)
+{
+	int err = 0;
+	SHC_HANDLE *h = (SHC_HANDLE*)*shcHdlP;
+
+	if (h) {
+		err = ShcClose(h);
+		free(h);
+	}
+	*shcHdlP = NULL;
+
+	return err;
 }
 
 
@@ -232,26 +323,34 @@ int32 __MAPILIB SMB2SHC_Exit()
  */
 int32 __MAPILIB SMB2SHC_GetTemperature(u_int16 *tempK)
 {
+	return SMB2SHC_H_GetTemperature(&G_shc, tempK);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2SHC_GetTemperature().
+ *
+ *  \param     shcHdl    \IN  SHC handle from SMB2SHC_Open
+ *
+ *  \sa SMB2SHC_GetTemperature, SMB2SHC_Open
+ */
+int32 __MAPILIB SMB2SHC_H_GetTemperature(void *shcHdl, u_int16 *tempK)
+{
+	SHC_HANDLE *h = (SHC_HANDLE*)shcHdl;
 	int err;
-	u_int8 length;
-	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
+	u_int8 tempOvr;
 
-	err = SMB2API_ReadBlockData(g_SMB2SHC_smbHdl, SHC_SMBFLAGS, SHC_SMBADDR,
-								SHC_TEMP_SET_OPCODE, &length, blkData);
+	SMB2_OsMutexLock(&h->lock);
+	err = TempOvrRead(h);
+	tempOvr = h->tempOvr;
+	*tempK = h->tempOvrK;
+	SMB2_OsMutexUnlock(&h->lock);
 	if (err)
 		return err;
 
-	if (length != SHC_TEMP_SET_LENGTH)
-		return SMB2_SHC_ERR_LENGTH;
-
-	if (blkData[0] != SET_TEMP_ENABLE){
-		return SMB2API_ReadWordData(g_SMB2SHC_smbHdl, SHC_SMBFLAGS, SHC_SMBADDR,
+	if (!tempOvr){
+		return SMB2API_ReadWordData(h->smbHdl, SHC_SMBFLAGS, h->addr,
 									SHC_TEMP_OPCODE, tempK);
 	}
-	else{
-		*tempK = ((u_int16)blkData[2] << 8);    /* MSB */
-		*tempK = *tempK | (u_int16)blkData[1];  /* LSB */
-	}
 	return SMB2_SHC_ERR_NO;
 }
 
@@ -264,20 +363,31 @@ int32 __MAPILIB SMB2SHC_GetTemperature(u_int16 *tempK)
  *
  *  \sa SMB2SHC_GetTemperature, SMB2SHC_SetTemperature
  */
-int32 __MAPILIB SMB2SHC_GetTemperatureOverrideStatus(u_int16 *status) {
-	u_int8 length;
-	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
+int32 __MAPILIB SMB2SHC_GetTemperatureOverrideStatus(u_int16 *status)
+{
+	return SMB2SHC_H_GetTemperatureOverrideStatus(&G_shc, status);
+}
 
-	int err = SMB2API_ReadBlockData(g_SMB2SHC_smbHdl, SHC_SMBFLAGS, SHC_SMBADDR,
-		      SHC_TEMP_SET_OPCODE, &length, blkData);
-	if (err)
-		return err;
+/****************************************************************************/
+/** Handle based variant of SMB2SHC_GetTemperatureOverrideStatus().
+ *
+ *  \param     shcHdl    \IN  SHC handle from SMB2SHC_Open
+ *
+ *  \sa SMB2SHC_GetTemperatureOverrideStatus, SMB2SHC_Open
+ */
+int32 __MAPILIB SMB2SHC_H_GetTemperatureOverrideStatus(void *shcHdl,
+	u_int16 *status)
+{
+	SHC_HANDLE *h = (SHC_HANDLE*)shcHdl;
+	int err;
 
-	if (length != SHC_TEMP_SET_LENGTH)
-		return SMB2_SHC_ERR_LENGTH;
+	SMB2_OsMutexLock(&h->lock);
+	err = TempOvrRead(h);
+	if (!err)
+		*status = h->tempOvr;
+	SMB2_OsMutexUnlock(&h->lock);
 
-	*status = blkData[0] == SET_TEMP_ENABLE ? 1 : 0;
-	return SMB2_SHC_ERR_NO;
+	return err;
 }
 
 /****************************************************************************/
@@ -292,14 +402,73 @@ int32 __MAPILIB SMB2SHC_GetTemperatureOverrideStatus(u_int16 *status) {
  */
 int32 __MAPILIB SMB2SHC_SetTemperature(u_int16 tempK)
 {
+	return SMB2SHC_H_SetTemperature(&G_shc, tempK);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2SHC_SetTemperature().
+ *
+ *  \param     shcHdl    \IN  SHC handle from SMB2SHC_Open
+ *
+ *  \sa SMB2SHC_SetTemperature, SMB2SHC_Open
+ */
+int32 __MAPILIB SMB2SHC_H_SetTemperature(void *shcHdl, u_int16 tempK)
+{
+	SHC_HANDLE *h = (SHC_HANDLE*)shcHdl;
+	int err;
+	u_int32 start;
 	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
 	
 	blkData[0] = (u_int8)SET_TEMP_ENABLE; 
 	blkData[1] = (u_int8)tempK;      /* LSB */
 	blkData[2] = (u_int8)(tempK>>8); /* MSB */
 	
-	return SMB2API_WriteBlockData( g_SMB2SHC_smbHdl, SHC_SMBFLAGS, SHC_SMBADDR,
+	SMB2_OsMutexLock(&h->lock);
+	h->tempOvrValid = 0;
+	start = UOS_MsecTimerGet();
+	err = SMB2API_WriteBlockData( h->smbHdl, SHC_SMBFLAGS, h->addr,
 									SHC_TEMP_SET_OPCODE, SHC_TEMP_SET_LENGTH, blkData);
+	if (!err) {
+		/* override is active for SMB2_SHC_TEMP_OVR_TIME after the write */
+		h->tempOvr = 1;
+		h->tempOvrK = tempK;
+		h->tempOvrEnd = start + SMB2_SHC_TEMP_OVR_TIME;
+		h->tempOvrValid = 1;
+	}
+	SMB2_OsMutexUnlock(&h->lock);
+
+	return err;
+}
+
+/****************************************************************************/
+/** Start the temperature override refresher.
+ *
+ *  Creates a thread that calls \a callback every \a period ms for the
+ *  current ambient temperature and writes it with
+ *  SMB2SHC_SetTemperature() if it changed. An unchanged temperature is
+ *  re-sent \a lead ms before the override expires. If \a callback
+ *  returns an error, nothing is written, so the override expires when
+ *  the sensor fails for longer than \a lead.
+ *
+ *  The thread uses the library's SHC handle. Its cached data is
+ *  protected by a handle lock, so other SMB2SHC functions may be called
+ *  concurrently.
+ *
+ *  \param     period      \IN   poll period of \a callback [ms]
+ *  \param     lead        \IN   re-send time before expiry [ms],
+ *                               1..SMB2_SHC_TEMP_OVR_TIME-1
+ *  \param     callback    \IN   provides the temperature
+ *  \param     cb_arg      \IN   argument for \a callback
+ *  \param     trefHdlP    \OUT  refresher handle
+ *  \return    0 on success or error code
+ *
+ *  \sa SMB2SHC_TempRefresh_Stop, SMB2SHC_TempRefresh_GetStats
+ */
+int32 __MAPILIB SMB2SHC_TempRefresh_Start(u_int32 period, u_int32 lead,
+	SMB2SHC_TEMP_CB callback, void *cb_arg, void **trefHdlP)
+{
+	return SMB2SHC_H_TempRefresh_Start(&G_shc, period, lead, callback,
+									   cb_arg, trefHdlP);
 }
 
 /****************************************************************************/
@@ -312,26 +481,71 @@ int32 __MAPILIB SMB2SHC_SetTemperature(u_int16 tempK)
  */
 int32 __MAPILIB SMB2SHC_GetPSU_State(enum SHC_PSU_NR psu_nr, struct shc_psu *shc_psu)
 {
+	return SMB2SHC_H_GetPSU_State(&G_shc, psu_nr, shc_psu);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2SHC_GetPSU_State().
+ *
+ *  \param     shcHdl    \IN  SHC handle from SMB2SHC_Open
+ *
+ *  \sa SMB2SHC_GetPSU_State, SMB2SHC_Open
+ */
+int32 __MAPILIB SMB2SHC_H_GetPSU_State(void *shcHdl,
+	enum SHC_PSU_NR psu_nr, struct shc_psu *shc_psu)
+{
+	SHC_HANDLE *h = (SHC_HANDLE*)shcHdl;
 	int err;
-	u_int8 length;
-	u_int8 psu_data;
 	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
 
-	err = SMB2API_ReadBlockData(g_SMB2SHC_smbHdl, SHC_SMBFLAGS, SHC_SMBADDR,
-								SHC_PSU_GET_OPCODE, &length, blkData);
+	err = ShcBlockRead(h, SHC_PSU_GET_OPCODE, SHC_PSU_GET_LENGTH, blkData);
 	if (err)
 		return err;
 
-	if (length != SHC_PSU_GET_LENGTH)
-		return SMB2_SHC_ERR_LENGTH;
-
 	if (psu_nr < SHC_PSU1 || psu_nr > SHC_PSU3)
 		return SMB2_SHC_ID_NA;
 
-	psu_data = blkData[psu_nr];
-	shc_psu->intFailure    = psu_data & BIT_ERR;
-	shc_psu->isPresent     = psu_data & BIT_IS_PRESENT;
-	shc_psu->isEPwrPresent = psu_data & BIT_EX_PWR;
+	PsuDecode(blkData, psu_nr, shc_psu);
+
+	return SMB2_SHC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Get the Power Supply Reports of all PSUs
+ *
+ *  All PSUs are decoded from one block read.
+ *
+ *  \param     shc_psu    \OUT  status of PSU 1..SMB2_SHC_PSU_NUM
+ *                              (indexed by enum SHC_PSU_NR)
+ *  \return    0 on success or error code
+ *
+ *  \sa SMB2SHC_GetPSU_State
+ */
+int32 __MAPILIB SMB2SHC_GetAllPSU(struct shc_psu shc_psu[SMB2_SHC_PSU_NUM])
+{
+	return SMB2SHC_H_GetAllPSU(&G_shc, shc_psu);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2SHC_GetAllPSU().
+ *
+ *  \param     shcHdl    \IN  SHC handle from SMB2SHC_Open
+ *
+ *  \sa SMB2SHC_GetAllPSU, SMB2SHC_Open
+ */
+int32 __MAPILIB SMB2SHC_H_GetAllPSU(void *shcHdl,
+	struct shc_psu shc_psu[SMB2_SHC_PSU_NUM])
+{
+	SHC_HANDLE *h = (SHC_HANDLE*)shcHdl;
+	int err, i;
+	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
+
+	err = ShcBlockRead(h, SHC_PSU_GET_OPCODE, SHC_PSU_GET_LENGTH, blkData);
+	if (err)
+		return err;
+
+	for (i = 0; i < SMB2_SHC_PSU_NUM; i++)
+		PsuDecode(blkData, i, &shc_psu[i]);
 
 	return SMB2_SHC_ERR_NO;
 }
@@ -347,29 +561,71 @@ int32 __MAPILIB SMB2SHC_GetPSU_State(enum SHC_PSU_NR psu_nr, struct shc_psu *shc
  */
 int32 __MAPILIB SMB2SHC_GetFAN_State(enum SHC_FAN_NR fan_nr, struct shc_fan *shc_fan)
 {
+	return SMB2SHC_H_GetFAN_State(&G_shc, fan_nr, shc_fan);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2SHC_GetFAN_State().
+ *
+ *  \param     shcHdl    \IN  SHC handle from SMB2SHC_Open
+ *
+ *  \sa SMB2SHC_GetFAN_State, SMB2SHC_Open
+ */
+int32 __MAPILIB SMB2SHC_H_GetFAN_State(void *shcHdl,
+	enum SHC_FAN_NR fan_nr, struct shc_fan *shc_fan)
+{
+	SHC_HANDLE *h = (SHC_HANDLE*)shcHdl;
 	int err;
-	u_int8 length;
-	u_int8 statByte, rpmLSB, rpmMSB;
 	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
 
-	err = SMB2API_ReadBlockData(g_SMB2SHC_smbHdl, SHC_SMBFLAGS, SHC_SMBADDR,
-								SHC_FAN_GET_OPCODE, &length, blkData);
+	err = ShcBlockRead(h, SHC_FAN_GET_OPCODE, SHC_FAN_GET_LENGTH, blkData);
 	if (err)
 		return err;
 
-	if (length != SHC_FAN_GET_LENGTH)
-		return SMB2_SHC_ERR_LENGTH;
-
 	if (fan_nr < SHC_FAN1 || fan_nr > SHC_FAN3)
 		return SMB2_SHC_ID_NA;
 
-	statByte = TO_FAN_STAT_BYTE(fan_nr);
-	rpmLSB = TO_FAN_RPM_LSB(fan_nr);
-	rpmMSB = TO_FAN_RPM_MSB(fan_nr);
+	FanDecode(blkData, fan_nr, shc_fan);
 
-	shc_fan->isPresent = blkData[statByte] & BIT_FAN_IS_PRESENT;
-	shc_fan->state     = blkData[statByte] & BIT_FAN_STAT;
-	shc_fan->speedRpm  = (u_int16)blkData[rpmLSB] | ( (u_int16)blkData[rpmMSB] << 8);
+	return SMB2_SHC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Get the FAN status of all FANs.
+ *
+ *  All FANs are decoded from one block read.
+ *
+ *  \param     shc_fan    \OUT  status of FAN 1..SMB2_SHC_FAN_NUM
+ *                              (indexed by enum SHC_FAN_NR)
+ *  \return    0 on success or error code
+ *
+ *  \sa SMB2SHC_GetFAN_State
+ */
+int32 __MAPILIB SMB2SHC_GetAllFans(struct shc_fan shc_fan[SMB2_SHC_FAN_NUM])
+{
+	return SMB2SHC_H_GetAllFans(&G_shc, shc_fan);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2SHC_GetAllFans().
+ *
+ *  \param     shcHdl    \IN  SHC handle from SMB2SHC_Open
+ *
+ *  \sa SMB2SHC_GetAllFans, SMB2SHC_Open
+ */
+int32 __MAPILIB SMB2SHC_H_GetAllFans(void *shcHdl,
+	struct shc_fan shc_fan[SMB2_SHC_FAN_NUM])
+{
+	SHC_HANDLE *h = (SHC_HANDLE*)shcHdl;
+	int err, i;
+	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
+
+	err = ShcBlockRead(h, SHC_FAN_GET_OPCODE, SHC_FAN_GET_LENGTH, blkData);
+	if (err)
+		return err;
+
+	for (i = 0; i < SMB2_SHC_FAN_NUM; i++)
+		FanDecode(blkData, i, &shc_fan[i]);
 
 	return SMB2_SHC_ERR_NO;
 }
@@ -385,29 +641,209 @@ int32 __MAPILIB SMB2SHC_GetFAN_State(enum SHC_FAN_NR fan_nr, struct shc_fan *shc
 */
 int32 __MAPILIB SMB2SHC_GetVoltLevel(enum SHC_PWR_MON_ID pwr_mon_nr, u_int16 *volt_value)
 {
+	return SMB2SHC_H_GetVoltLevel(&G_shc, pwr_mon_nr, volt_value);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2SHC_GetVoltLevel().
+ *
+ *  \param     shcHdl    \IN  SHC handle from SMB2SHC_Open
+ *
+ *  \sa SMB2SHC_GetVoltLevel, SMB2SHC_Open
+ */
+int32 __MAPILIB SMB2SHC_H_GetVoltLevel(void *shcHdl,
+	enum SHC_PWR_MON_ID pwr_mon_nr, u_int16 *volt_value)
+{
+	SHC_HANDLE *h = (SHC_HANDLE*)shcHdl;
 	int err;
-	u_int8 length;
-	u_int16 volt_data;
 	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
 
-	err = SMB2API_ReadBlockData(g_SMB2SHC_smbHdl, SHC_SMBFLAGS, SHC_SMBADDR,
-								SHC_VOLT_GET_OPCODE, &length, blkData);
+	err = ShcBlockRead(h, SHC_VOLT_GET_OPCODE, SHC_VOLT_GET_LENGTH, blkData);
 	if (err)
 		return err;
 
-	if (length != SHC_VOLT_GET_LENGTH)
-		return SMB2_SHC_ERR_LENGTH;
-
 	if (pwr_mon_nr < SHC_PWR_MON_1 || pwr_mon_nr > SHC_PWR_MON_4)
 		return SMB2_SHC_ID_NA;
 
-	volt_data = blkData[pwr_mon_nr * 2];
-	volt_data += ((u_int16)blkData[pwr_mon_nr * 2 + 1] << 8);
-	*volt_value = volt_data;
+	*volt_value = VoltDecode(blkData, pwr_mon_nr);
+
+	return SMB2_SHC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Get the voltage levels of all power monitor inputs
+*
+*  All inputs are decoded from one block read.
+*
+*  \param     volt_value    \OUT  voltage level of PWR_MON 1..SMB2_SHC_PWR_MON_NUM
+*                                 (indexed by enum SHC_PWR_MON_ID)
+*  \return    0 on success or error code
+*
+*  \sa SMB2SHC_GetVoltLevel
+*/
+int32 __MAPILIB SMB2SHC_GetAllVoltLevels(u_int16 volt_value[SMB2_SHC_PWR_MON_NUM])
+{
+	return SMB2SHC_H_GetAllVoltLevels(&G_shc, volt_value);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2SHC_GetAllVoltLevels().
+ *
+ *  \param     shcHdl    \IN  SHC handle from SMB2SHC_Open
+ *
+ *  \sa SMB2SHC_GetAllVoltLevels, SMB2SHC_Open
+ */
+int32 __MAPILIB SMB2SHC_H_GetAllVoltLevels(void *shcHdl,
+	u_int16 volt_value[SMB2_SHC_PWR_MON_NUM])
+{
+	SHC_HANDLE *h = (SHC_HANDLE*)shcHdl;
+	int err, i;
+	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
+
+	err = ShcBlockRead(h, SHC_VOLT_GET_OPCODE, SHC_VOLT_GET_LENGTH, blkData);
+	if (err)
+		return err;
+
+	for (i = 0; i < SMB2_SHC_PWR_MON_NUM; i++)
+		volt_value[i] = VoltDecode(blkData, i);
+
+	return SMB2_SHC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Get a coherent snapshot of the shelf controller status
+*
+*  Reads temperature, PSU, FAN, voltage and UPS status back to back with
+*  one transaction group, i.e. one driver call, and decodes them in a
+*  single pass. The temperature override block and the measured
+*  temperature are both read, so no second request is needed as in
+*  SMB2SHC_GetTemperature().
+*
+*  \a snapshot->tstamp is the UOS_MsecTimerGet() time when the bus
+*  access started, \a snapshot->bus_time the duration of the driver call.
+*
+*  \param     snapshot    \OUT  status snapshot
+*  \return    0 on success or error code
+*
+*  \sa SMB2SHC_GetTemperature, SMB2SHC_GetAllPSU, SMB2SHC_GetAllFans,
+*      SMB2SHC_GetAllVoltLevels, SMB2SHC_GetAllUPS
+*/
+int32 __MAPILIB SMB2SHC_GetSnapshot(struct shc_snapshot *snapshot)
+{
+	return SMB2SHC_H_GetSnapshot(&G_shc, snapshot);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2SHC_GetSnapshot().
+ *
+ *  \param     shcHdl    \IN  SHC handle from SMB2SHC_Open
+ *
+ *  \sa SMB2SHC_GetSnapshot, SMB2SHC_Open
+ */
+int32 __MAPILIB SMB2SHC_H_GetSnapshot(void *shcHdl,
+	struct shc_snapshot *snapshot)
+{
+	SHC_HANDLE *h = (SHC_HANDLE*)shcHdl;
+	int err, i;
+	void *grpHdl;
+	u_int16 tempK;
+	u_int32 end;
+	static const u_int8 opcode[SHC_SNAP_BLOCKS] = {
+		SHC_TEMP_SET_OPCODE, SHC_PSU_GET_OPCODE, SHC_FAN_GET_OPCODE,
+		SHC_VOLT_GET_OPCODE, SHC_UPS_GET_OPCODE
+	};
+	static const u_int8 expLength[SHC_SNAP_BLOCKS] = {
+		SHC_TEMP_SET_LENGTH, SHC_PSU_GET_LENGTH, SHC_FAN_GET_LENGTH,
+		SHC_VOLT_GET_LENGTH, SHC_UPS_GET_LENGTH
+	};
+	u_int8 length[SHC_SNAP_BLOCKS];
+	u_int8 blkData[SHC_SNAP_BLOCKS][SMB_BLOCK_MAX_BYTES];
+
+	memset(snapshot, 0, sizeof(struct shc_snapshot));
+
+	err = SMB2API_XferGroupBegin(h->smbHdl, 0, SHC_SNAP_XFERS, &grpHdl);
+	if (err)
+		return err;
+
+	err = SMB2API_XferGroupAddReadWordData(grpHdl, SHC_SMBFLAGS, h->addr,
+										   SHC_TEMP_OPCODE, &tempK);
+	for (i = 0; !err && i < SHC_SNAP_BLOCKS; i++)
+		err = SMB2API_XferGroupAddReadBlockData(grpHdl, SHC_SMBFLAGS,
+							h->addr, opcode[i], &length[i], blkData[i]);
+
+	if (!err) {
+		snapshot->tstamp = UOS_MsecTimerGet();
+		err = SMB2API_XferGroupCommit(grpHdl);
+		end = UOS_MsecTimerGet();
+		snapshot->bus_time = end - snapshot->tstamp;
+	}
+
+	SMB2API_XferGroupEnd(&grpHdl);
+
+	if (err)
+		return err;
+
+	for (i = 0; i < SHC_SNAP_BLOCKS; i++)
+		if (length[i] != expLength[i])
+			return SMB2_SHC_ERR_LENGTH;
+
+	/* blkData[0]: temperature override */
+	snapshot->tempOverride = blkData[0][0] == SET_TEMP_ENABLE ? 1 : 0;
+	if (snapshot->tempOverride)
+		snapshot->tempK = (u_int16)blkData[0][1] |
+						  ((u_int16)blkData[0][2] << 8);
+	else
+		snapshot->tempK = tempK;
+
+	for (i = 0; i < SMB2_SHC_PSU_NUM; i++)
+		PsuDecode(blkData[1], i, &snapshot->psu[i]);
+	for (i = 0; i < SMB2_SHC_FAN_NUM; i++)
+		FanDecode(blkData[2], i, &snapshot->fan[i]);
+	for (i = 0; i < SMB2_SHC_PWR_MON_NUM; i++)
+		snapshot->volt[i] = VoltDecode(blkData[3], i);
+	for (i = 0; i < SMB2_SHC_UPS_NUM; i++)
+		UpsDecode(blkData[4], i, &snapshot->ups[i]);
 
 	return SMB2_SHC_ERR_NO;
 }
 
+/****************************************************************************/
+/** Start the power-fail monitor.
+*
+*  Creates a thread that reads the PSU, FAN and UPS status with one
+*  transaction group per poll and compares the decoded state with the
+*  previous one. Registered callbacks are called on transitions only.
+*
+*  The poll period adapts between \a period_min and \a period_max: it
+*  starts at \a period_min, is doubled after each poll without
+*  transition while the shelf is healthy, and falls back to
+*  \a period_min on any transition or while a PSU has no external power,
+*  a UPS provides power or a unit fails. While the shelf is healthy the
+*  period backs off to \a period_max, so a power failure is detected up
+*  to \a period_max ms (plus bus time) after it occurs.
+*
+*  The thread uses the library's SHC handle. Its cached data is
+*  protected by a handle lock, so other SMB2SHC functions may be called
+*  concurrently.
+*
+*  \param     period_min    \IN   fastest poll period [ms]
+*  \param     period_max    \IN   slowest poll period [ms], >= \a period_min
+*  \param     events        \IN   SMB2_SHC_MON_EV_xxx events for \a callback
+*  \param     callback      \IN   first callback (NULL = none)
+*  \param     cb_arg        \IN   argument for \a callback
+*  \param     monHdlP       \OUT  monitor handle
+*  \return    0 on success or error code
+*
+*  \sa SMB2SHC_Monitor_Register, SMB2SHC_Monitor_Stop,
+*      SMB2SHC_Monitor_GetStats
+*/
+int32 __MAPILIB SMB2SHC_Monitor_Start(u_int32 period_min, u_int32 period_max,
+	u_int32 events, SMB2SHC_MON_CB callback, void *cb_arg, void **monHdlP)
+{
+	return SMB2SHC_H_Monitor_Start(&G_shc, period_min, period_max, events,
+								   callback, cb_arg, monHdlP);
+}
+
 /****************************************************************************/
 /** Set power cycle duration in milliseconds
  *
@@ -415,7 +851,22 @@ int32 __MAPILIB SMB2SHC_GetVoltLevel(enum SHC_PWR_MON_ID pwr_mon_nr, u_int16 *vo
  *  \return    SMB2_SHC_ERR_NO on success or error code
  *
 */
-int32 __MAPILIB SMB2SHC_SetPowerCycleDuration(u_int16 duration) {
+int32 __MAPILIB SMB2SHC_SetPowerCycleDuration(u_int16 duration)
+{
+	return SMB2SHC_H_SetPowerCycleDuration(&G_shc, duration);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2SHC_SetPowerCycleDuration().
+ *
+ *  \param     shcHdl    \IN  SHC handle from SMB2SHC_Open
+ *
+ *  \sa SMB2SHC_SetPowerCycleDuration, SMB2SHC_Open
+ */
+int32 __MAPILIB SMB2SHC_H_SetPowerCycleDuration(void *shcHdl, u_int16 duration)
+{
+	SHC_HANDLE *h = (SHC_HANDLE*)shcHdl;
+	int err;
 	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
 	if (SHC_V416_OR_BELOW) {
 		return SMB2_SHC_ERR_FEATURE_UNAVAILABLE;
@@ -426,8 +877,13 @@ int32 __MAPILIB SMB2SHC_SetPowerCycleDuration(u_int16 duration) {
 	blkData[1] = (u_int8) duration;         /* LSB */
 	blkData[2] = (u_int8) (duration >> 8);  /* MSB */
 
-	return SMB2API_WriteBlockData(g_SMB2SHC_smbHdl, SHC_SMBFLAGS, SHC_SMBADDR,
+	SMB2_OsMutexLock(&h->lock);
+	h->confValid = 0;
+	err = SMB2API_WriteBlockData(h->smbHdl, SHC_SMBFLAGS, h->addr,
 			SHC_PWRCYCLE_DUR_SET_OPCODE, SHC_DUR_SET_LENGTH, blkData);
+	SMB2_OsMutexUnlock(&h->lock);
+
+	return err;
 }
 
 /****************************************************************************/
@@ -438,13 +894,31 @@ int32 __MAPILIB SMB2SHC_SetPowerCycleDuration(u_int16 duration) {
  *
  *  \sa SMB2SHC_GetPersistentPowerbuttonStatus
 */
-int32 __MAPILIB SMB2SHC_SetPersistentPowerbuttonStatus(u_int32 status) {
-	int err;
-	if (SHC_V416_OR_BELOW) {
+int32 __MAPILIB SMB2SHC_SetPersistentPowerbuttonStatus(u_int32 status)
+{
+	return SMB2SHC_H_SetPersistentPowerbuttonStatus(&G_shc, status);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2SHC_SetPersistentPowerbuttonStatus().
+ *
+ *  \param     shcHdl    \IN  SHC handle from SMB2SHC_Open
+ *
+ *  \sa SMB2SHC_SetPersistentPowerbuttonStatus, SMB2SHC_Open
+ */
+int32 __MAPILIB SMB2SHC_H_SetPersistentPowerbuttonStatus(void *shcHdl,
+	u_int32 status)
+{
+	SHC_HANDLE *h = (SHC_HANDLE*)shcHdl;
+	int err;
+	if (SHC_V416_OR_BELOW) {
 		return SMB2_SHC_ERR_FEATURE_UNAVAILABLE;
 	}
-	err = SMB2API_WriteByteData(g_SMB2SHC_smbHdl, SHC_SMBFLAGS, SHC_SMBADDR,
+	SMB2_OsMutexLock(&h->lock);
+	h->confValid = 0;
+	err = SMB2API_WriteByteData(h->smbHdl, SHC_SMBFLAGS, h->addr,
 		SHC_PERS_PWRBTN_SET_OPCODE, status == 1 ? 1 : 0);
+	SMB2_OsMutexUnlock(&h->lock);
 	if (err) {
 		return err;
 	}
@@ -459,12 +933,27 @@ int32 __MAPILIB SMB2SHC_SetPersistentPowerbuttonStatus(u_int32 status) {
  *
  *  \sa SMB2SHC_SetPersistentPowerbuttonStatus
 */
-int32 __MAPILIB SMB2SHC_GetPersistentPowerbuttonStatus(u_int8 *status) {
+int32 __MAPILIB SMB2SHC_GetPersistentPowerbuttonStatus(u_int8 *status)
+{
+	return SMB2SHC_H_GetPersistentPowerbuttonStatus(&G_shc, status);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2SHC_GetPersistentPowerbuttonStatus().
+ *
+ *  \param     shcHdl    \IN  SHC handle from SMB2SHC_Open
+ *
+ *  \sa SMB2SHC_GetPersistentPowerbuttonStatus, SMB2SHC_Open
+ */
+int32 __MAPILIB SMB2SHC_H_GetPersistentPowerbuttonStatus(void *shcHdl,
+	u_int8 *status)
+{
+	SHC_HANDLE *h = (SHC_HANDLE*)shcHdl;
 	int err;
 	if (SHC_V416_OR_BELOW) {
 		return SMB2_SHC_ERR_FEATURE_UNAVAILABLE;
 	}
-	err = SMB2API_ReadByteData(g_SMB2SHC_smbHdl, SHC_SMBFLAGS, SHC_SMBADDR,
+	err = SMB2API_ReadByteData(h->smbHdl, SHC_SMBFLAGS, h->addr,
 		SHC_PERS_PWRBTN_GET_OPCODE, status);
 	if (err) {
 		return err;
@@ -482,29 +971,71 @@ int32 __MAPILIB SMB2SHC_GetPersistentPowerbuttonStatus(u_int8 *status) {
 */
 int32 __MAPILIB SMB2SHC_GetUPS_State(enum SHC_UPS_NR ups_nr, struct shc_ups *shc_ups_state)
 {
+	return SMB2SHC_H_GetUPS_State(&G_shc, ups_nr, shc_ups_state);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2SHC_GetUPS_State().
+ *
+ *  \param     shcHdl    \IN  SHC handle from SMB2SHC_Open
+ *
+ *  \sa SMB2SHC_GetUPS_State, SMB2SHC_Open
+ */
+int32 __MAPILIB SMB2SHC_H_GetUPS_State(void *shcHdl,
+	enum SHC_UPS_NR ups_nr, struct shc_ups *shc_ups_state)
+{
+	SHC_HANDLE *h = (SHC_HANDLE*)shcHdl;
 	int err;
-	u_int8 length;
-	u_int8 ups_status, ups_charging_lvl;
 	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
 
-	err = SMB2API_ReadBlockData(g_SMB2SHC_smbHdl, SHC_SMBFLAGS, SHC_SMBADDR,
-								SHC_UPS_GET_OPCODE, &length, blkData);
+	err = ShcBlockRead(h, SHC_UPS_GET_OPCODE, SHC_UPS_GET_LENGTH, blkData);
 	if (err)
 		return err;
 
-	if (length != SHC_UPS_GET_LENGTH)
-		return SMB2_SHC_ERR_LENGTH;
-
 	if (ups_nr < SHC_UPS1 || ups_nr > SHC_UPS2)
 		return SMB2_SHC_ID_NA;
 
-	ups_status       = blkData[ups_nr * 2];
-	ups_charging_lvl = blkData[ups_nr * 2 + 1];
+	UpsDecode(blkData, ups_nr, shc_ups_state);
+
+	return SMB2_SHC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Get the Uninterruptible Power Supply reports of all UPS
+*
+*  All UPS are decoded from one block read.
+*
+*  \param     shc_ups_state    \OUT  status of UPS 1..SMB2_SHC_UPS_NUM
+*                                    (indexed by enum SHC_UPS_NR)
+*  \return    0 on success or error code
+*
+*  \sa SMB2SHC_GetUPS_State
+*/
+int32 __MAPILIB SMB2SHC_GetAllUPS(struct shc_ups shc_ups_state[SMB2_SHC_UPS_NUM])
+{
+	return SMB2SHC_H_GetAllUPS(&G_shc, shc_ups_state);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2SHC_GetAllUPS().
+ *
+ *  \param     shcHdl    \IN  SHC handle from SMB2SHC_Open
+ *
+ *  \sa SMB2SHC_GetAllUPS, SMB2SHC_Open
+ */
+int32 __MAPILIB SMB2SHC_H_GetAllUPS(void *shcHdl,
+	struct shc_ups shc_ups_state[SMB2_SHC_UPS_NUM])
+{
+	SHC_HANDLE *h = (SHC_HANDLE*)shcHdl;
+	int err, i;
+	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
+
+	err = ShcBlockRead(h, SHC_UPS_GET_OPCODE, SHC_UPS_GET_LENGTH, blkData);
+	if (err)
+		return err;
 
-	shc_ups_state->intFailure = ups_status & BIT_ERR;
-	shc_ups_state->isPresent  = ups_status & BIT_IS_PRESENT;
-	shc_ups_state->provPWR    = ups_status & BIT_PROV_PWR;
-	shc_ups_state->chrg_lvl   = ups_charging_lvl;
+	for (i = 0; i < SMB2_SHC_UPS_NUM; i++)
+		UpsDecode(blkData, i, &shc_ups_state[i]);
 
 	return SMB2_SHC_ERR_NO;
 }
@@ -519,10 +1050,23 @@ int32 __MAPILIB SMB2SHC_GetUPS_State(enum SHC_UPS_NR ups_nr, struct shc_ups *shc
 */
 int32 __MAPILIB SMB2SHC_ShutDown()
 {
+	return SMB2SHC_H_ShutDown(&G_shc);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2SHC_ShutDown().
+ *
+ *  \param     shcHdl    \IN  SHC handle from SMB2SHC_Open
+ *
+ *  \sa SMB2SHC_ShutDown, SMB2SHC_Open
+ */
+int32 __MAPILIB SMB2SHC_H_ShutDown(void *shcHdl)
+{
+	SHC_HANDLE *h = (SHC_HANDLE*)shcHdl;
 	int err;
 
-	err = SMB2API_WriteByte(g_SMB2SHC_smbHdl, SHC_SMBFLAGS,
-							SHC_SMBADDR, SHC_SH_DOWN_OPCODE);
+	err = SMB2API_WriteByte(h->smbHdl, SHC_SMBFLAGS,
+							h->addr, SHC_SH_DOWN_OPCODE);
 	if (err)
 		return err;
 
@@ -539,10 +1083,23 @@ int32 __MAPILIB SMB2SHC_ShutDown()
 */
 int32 __MAPILIB SMB2SHC_PowerOff()
 {
+	return SMB2SHC_H_PowerOff(&G_shc);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2SHC_PowerOff().
+ *
+ *  \param     shcHdl    \IN  SHC handle from SMB2SHC_Open
+ *
+ *  \sa SMB2SHC_PowerOff, SMB2SHC_Open
+ */
+int32 __MAPILIB SMB2SHC_H_PowerOff(void *shcHdl)
+{
+	SHC_HANDLE *h = (SHC_HANDLE*)shcHdl;
 	int err;
 
-	err = SMB2API_WriteByte(g_SMB2SHC_smbHdl, SHC_SMBFLAGS,
-							SHC_SMBADDR, SHC_PWR_OFF_OPCODE);
+	err = SMB2API_WriteByte(h->smbHdl, SHC_SMBFLAGS,
+							h->addr, SHC_PWR_OFF_OPCODE);
 	if (err)
 		return err;
 
@@ -553,18 +1110,299 @@ int32 __MAPILIB SMB2SHC_PowerOff()
 /****************************************************************************/
 /** Get the Configuration Data.
 *
+*  The configuration data is read from the SHC on the first call only
+*  and after a setter that may change it. Use SMB2SHC_RefreshCache()
+*  to force a re-read.
+*
 *  \param     configdata    \OUT  contains all the confiuration data
 *  \return    0 on success or error code
 *
 */
 int32 __MAPILIB SMB2SHC_GetConf_Data(struct shc_configdata *configdata)
+{
+	return SMB2SHC_H_GetConf_Data(&G_shc, configdata);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2SHC_GetConf_Data().
+ *
+ *  \param     shcHdl    \IN  SHC handle from SMB2SHC_Open
+ *
+ *  \sa SMB2SHC_GetConf_Data, SMB2SHC_Open
+ */
+int32 __MAPILIB SMB2SHC_H_GetConf_Data(void *shcHdl,
+	struct shc_configdata *configdata)
+{
+	SHC_HANDLE *h = (SHC_HANDLE*)shcHdl;
+	int err = SMB2_SHC_ERR_NO;
+
+	SMB2_OsMutexLock(&h->lock);
+	if (!h->confValid) {
+		err = ConfRead(h, &h->conf);
+		if (!err)
+			h->confValid = 1;
+	}
+	if (!err)
+		*configdata = h->conf;
+	SMB2_OsMutexUnlock(&h->lock);
+
+	return err;
+}
+
+
+/****************************************************************************/
+/** Refresh the cached configuration data and temperature override status.
+*
+*  SMB2SHC_GetConf_Data() uses cached values that are only re-read
+*  after the library's own setters. SMB2SHC_GetTemperatureOverrideStatus()
+*  and SMB2SHC_GetTemperature() cache an override written with
+*  SMB2SHC_SetTemperature() until it expires. Call this function if the
+*  SHC may have been reconfigured otherwise (e.g. by another process).
+*
+*  \return    0 on success or error code
+*
+*  \sa SMB2SHC_GetConf_Data, SMB2SHC_GetTemperatureOverrideStatus
+*/
+int32 __MAPILIB SMB2SHC_RefreshCache(void)
+{
+	return SMB2SHC_H_RefreshCache(&G_shc);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2SHC_RefreshCache().
+ *
+ *  \param     shcHdl    \IN  SHC handle from SMB2SHC_Open
+ *
+ *  \sa SMB2SHC_RefreshCache, SMB2SHC_Open
+ */
+int32 __MAPILIB SMB2SHC_H_RefreshCache(void *shcHdl)
+{
+	SHC_HANDLE *h = (SHC_HANDLE*)shcHdl;
+	int err;
+
+	SMB2_OsMutexLock(&h->lock);
+	h->confValid = 0;
+	h->tempOvrValid = 0;
+
+	err = ConfRead(h, &h->conf);
+	if (!err) {
+		h->confValid = 1;
+		err = TempOvrRead(h);
+	}
+	SMB2_OsMutexUnlock(&h->lock);
+
+	return err;
+}
+
+
+/****************************************************************************/
+/** Get the firmware version.
+*
+*  \param     fw_version    \OUT  contains firmware version informations
+*  \return    0 on success or error code
+*
+*/
+int32 __MAPILIB SMB2SHC_GetFirm_Ver(struct shc_fwversion *fw_version)
+{
+	return SMB2SHC_H_GetFirm_Ver(&G_shc, fw_version);
+}
+
+/****************************************************************************/
+/** Handle based variant of SMB2SHC_GetFirm_Ver().
+ *
+ *  \param     shcHdl    \IN  SHC handle from SMB2SHC_Open
+ *
+ *  \sa SMB2SHC_GetFirm_Ver, SMB2SHC_Open
+ */
+int32 __MAPILIB SMB2SHC_H_GetFirm_Ver(void *shcHdl,
+	struct shc_fwversion *fw_version)
+{
+	SHC_HANDLE *h = (SHC_HANDLE*)shcHdl;
+	int err;
+	u_int8 length;
+	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
+
+	err = SMB2API_ReadBlockData(h->smbHdl, SHC_SMBFLAGS, h->addr,
+								SHC_FVER_GET_OPCODE, &length, blkData);
+
+	if (err)
+		return err;
+
+	if (length != SHC_FVER_GET_LENGTH)
+		return SMB2_SHC_ERR_LENGTH;
+
+	fw_version->errcode = blkData[0];
+
+	fw_version->maj_revision = blkData[1];
+	fw_version->min_revision = blkData[2];
+
+	fw_version->mtnce_revision = blkData[3];
+	fw_version->build_nbr = (u_int16)blkData[4] << 8;
+	fw_version->build_nbr += blkData[5];
+
+	fw_version->veri_flag = blkData[6];
+
+	return SMB2_SHC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Initialize a SHC handle and read the firmware version.
+*
+*  \param     h          \OUT  SHC handle
+*  \param     deviceP    \IN   MDIS device name
+*  \param     addr       \IN   SMBus address of the SHC
+*  \return    0 on success or error code
+*/
+static int32 ShcOpen(SHC_HANDLE *h, char *deviceP, u_int16 addr)
+{
+	int err;
+
+	memset(h, 0, sizeof(SHC_HANDLE));
+	h->addr = addr;
+
+	err = SMB2API_Init(deviceP, &h->smbHdl);
+	if (err) {
+		return err;
+	}
+	err = SMB2SHC_H_GetFirm_Ver(h, &h->fwVersion);
+	if (err) {
+		SMB2API_Exit(&h->smbHdl);
+		return err;
+	}
+	SMB2_OsMutexInit(&h->lock);
+	return SMB2_SHC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Deinitialize a SHC handle.
+*
+*  \param     h    \INOUT  SHC handle
+*  \return    0 on success or error code
+*/
+static int32 ShcClose(SHC_HANDLE *h)
+{
+	if (h->smbHdl) {
+		SMB2_OsMutexDestroy(&h->lock);
+		return (SMB2API_Exit(&h->smbHdl));
+	}
+
+	return (0);
+}
+
+/****************************************************************************/
+/** Read a status block and check its length.
+*
+*  \param     h             \IN   SHC handle
+*  \param     opcode        \IN   SHC_xxx_GET_OPCODE
+*  \param     exp_length    \IN   expected block length
+*  \param     blkData       \OUT  block data (SMB_BLOCK_MAX_BYTES)
+*  \return    0 on success or error code
+*/
+static int32 ShcBlockRead(SHC_HANDLE *h, u_int8 opcode, u_int8 exp_length,
+						  u_int8 *blkData)
+{
+	int err;
+	u_int8 length;
+
+	err = SMB2API_ReadBlockData(h->smbHdl, SHC_SMBFLAGS, h->addr,
+								opcode, &length, blkData);
+	if (err)
+		return err;
+
+	if (length != exp_length)
+		return SMB2_SHC_ERR_LENGTH;
+
+	return SMB2_SHC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Decode one PSU from the PSU status block.
+*
+*  \param     blkData    \IN   PSU status block
+*  \param     psu_nr     \IN   PSU ID number
+*  \param     shc_psu    \OUT  status of the PSU
+*/
+static void PsuDecode(u_int8 *blkData, int psu_nr, struct shc_psu *shc_psu)
+{
+	u_int8 psu_data = blkData[psu_nr];
+
+	shc_psu->intFailure    = psu_data & BIT_ERR;
+	shc_psu->isPresent     = psu_data & BIT_IS_PRESENT;
+	shc_psu->isEPwrPresent = psu_data & BIT_EX_PWR;
+}
+
+/****************************************************************************/
+/** Decode one FAN from the FAN status block.
+*
+*  \param     blkData    \IN   FAN status block
+*  \param     fan_nr     \IN   FAN ID number
+*  \param     shc_fan    \OUT  status of the FAN
+*/
+static void FanDecode(u_int8 *blkData, int fan_nr, struct shc_fan *shc_fan)
+{
+	u_int8 statByte, rpmLSB, rpmMSB;
+
+	statByte = TO_FAN_STAT_BYTE(fan_nr);
+	rpmLSB = TO_FAN_RPM_LSB(fan_nr);
+	rpmMSB = TO_FAN_RPM_MSB(fan_nr);
+
+	shc_fan->isPresent = blkData[statByte] & BIT_FAN_IS_PRESENT;
+	shc_fan->state     = blkData[statByte] & BIT_FAN_STAT;
+	shc_fan->speedRpm  = (u_int16)blkData[rpmLSB] | ( (u_int16)blkData[rpmMSB] << 8);
+}
+
+/****************************************************************************/
+/** Decode one UPS from the UPS status block.
+*
+*  \param     blkData    \IN   UPS status block
+*  \param     ups_nr     \IN   UPS ID number
+*  \param     shc_ups    \OUT  status of the UPS
+*/
+static void UpsDecode(u_int8 *blkData, int ups_nr, struct shc_ups *shc_ups)
+{
+	u_int8 ups_status, ups_charging_lvl;
+
+	ups_status       = blkData[ups_nr * 2];
+	ups_charging_lvl = blkData[ups_nr * 2 + 1];
+
+	shc_ups->intFailure = ups_status & BIT_ERR;
+	shc_ups->isPresent  = ups_status & BIT_IS_PRESENT;
+	shc_ups->provPWR    = ups_status & BIT_PROV_PWR;
+	shc_ups->chrg_lvl   = ups_charging_lvl;
+}
+
+/****************************************************************************/
+/** Decode one voltage level from the voltage block.
+*
+*  \param     blkData       \IN  voltage block
+*  \param     pwr_mon_nr    \IN  power monitor number
+*  \return    voltage level
+*/
+static u_int16 VoltDecode(u_int8 *blkData, int pwr_mon_nr)
+{
+	u_int16 volt_data;
+
+	volt_data = blkData[pwr_mon_nr * 2];
+	volt_data += ((u_int16)blkData[pwr_mon_nr * 2 + 1] << 8);
+
+	return volt_data;
+}
+
+/****************************************************************************/
+/** Read the configuration data from the SHC.
+*
+*  \param     h             \IN   SHC handle
+*  \param     configdata    \OUT  configuration data
+*  \return    0 on success or error code
+*/
+static int32 ConfRead(SHC_HANDLE *h, struct shc_configdata *configdata)
 {
 	int err;
 	u_int8 length;
 	u_int16 config_data16;
 	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
 
-	err = SMB2API_ReadBlockData(g_SMB2SHC_smbHdl, SHC_SMBFLAGS, SHC_SMBADDR,
+	err = SMB2API_ReadBlockData(h->smbHdl, SHC_SMBFLAGS, h->addr,
 								SHC_CONF_GET_OPCODE, &length, blkData);
 	if (err) {
 		return err;
@@ -641,40 +1479,97 @@ int32 __MAPILIB SMB2SHC_GetConf_Data(struct shc_configdata *configdata)
 	return SMB2_SHC_ERR_NO;
 }
 
-
 /****************************************************************************/
-/** Get the firmware version.
+/** Read the temperature override status unless it is cached.
 *
-*  \param     fw_version    \OUT  contains firmware version informations
-*  \return    0 on success or error code
+*  Only an active override set by SMB2SHC_SetTemperature() is cached,
+*  until it times out. Any other status is re-read on each call: the end
+*  of an override set by someone else is unknown, and an inactive
+*  override may be activated by another application at any time.
 *
+*  The caller must hold the handle lock.
+*
+*  \param     h    \INOUT  SHC handle
+*  \return    0 on success or error code
 */
-int32 __MAPILIB SMB2SHC_GetFirm_Ver(struct shc_fwversion *fw_version)
+static int32 TempOvrRead(SHC_HANDLE *h)
 {
 	int err;
-	u_int8 length;
 	u_int8 blkData[SMB_BLOCK_MAX_BYTES];
 
-	err = SMB2API_ReadBlockData(g_SMB2SHC_smbHdl, SHC_SMBFLAGS, SHC_SMBADDR,
-								SHC_FVER_GET_OPCODE, &length, blkData);
+	if (h->tempOvrValid &&
+		(int32)(h->tempOvrEnd - UOS_MsecTimerGet()) <= 0)
+		h->tempOvrValid = 0;
 
+	if (h->tempOvrValid)
+		return SMB2_SHC_ERR_NO;
+
+	err = ShcBlockRead(h, SHC_TEMP_SET_OPCODE, SHC_TEMP_SET_LENGTH, blkData);
 	if (err)
 		return err;
 
-	if (length != SHC_FVER_GET_LENGTH)
-		return SMB2_SHC_ERR_LENGTH;
+	h->tempOvr = blkData[0] == SET_TEMP_ENABLE ? 1 : 0;
+	h->tempOvrK = ((u_int16)blkData[2] << 8) | (u_int16)blkData[1];
+	/* end unknown or may become active anytime: don't cache it */
+	h->tempOvrValid = 0;
 
-	fw_version->errcode = blkData[0];
+	return SMB2_SHC_ERR_NO;
+}
 
-	fw_version->maj_revision = blkData[1];
-	fw_version->min_revision = blkData[2];
+/****************************************************************************/
+/** Read the PSU, FAN and UPS status for the power-fail monitor.
+*
+*  The three status blocks are read with one transaction group.
+*  \a state->tstamp is the time before the bus access, as for
+*  SMB2SHC_H_GetSnapshot.
+*
+*  \param     shcHdl    \IN   SHC handle
+*  \param     state     \OUT  decoded state
+*  \return    0 on success or error code
+*/
+int32 SHC_MonStatusRead(void *shcHdl, struct shc_mon_state *state)
+{
+	SHC_HANDLE *h = (SHC_HANDLE*)shcHdl;
+	int err, i;
+	void *grpHdl;
+	u_int8 psuLen, fanLen, upsLen;
+	u_int8 psuData[SMB_BLOCK_MAX_BYTES];
+	u_int8 fanData[SMB_BLOCK_MAX_BYTES];
+	u_int8 upsData[SMB_BLOCK_MAX_BYTES];
+
+	err = SMB2API_XferGroupBegin(h->smbHdl, 0, 3, &grpHdl);
+	if (err)
+		return err;
 
-	fw_version->mtnce_revision = blkData[3];
-	fw_version->build_nbr = (u_int16)blkData[4] << 8;
-	fw_version->build_nbr += blkData[5];
+	err = SMB2API_XferGroupAddReadBlockData(grpHdl, SHC_SMBFLAGS, h->addr,
+								SHC_PSU_GET_OPCODE, &psuLen, psuData);
+	if (!err)
+		err = SMB2API_XferGroupAddReadBlockData(grpHdl, SHC_SMBFLAGS, h->addr,
+								SHC_FAN_GET_OPCODE, &fanLen, fanData);
+	if (!err)
+		err = SMB2API_XferGroupAddReadBlockData(grpHdl, SHC_SMBFLAGS, h->addr,
+								SHC_UPS_GET_OPCODE, &upsLen, upsData);
 
-	fw_version->veri_flag = blkData[6];
+	state->tstamp = UOS_MsecTimerGet();
+
+	if (!err)
+		err = SMB2API_XferGroupCommit(grpHdl);
+
+	SMB2API_XferGroupEnd(&grpHdl);
+
+	if (err)
+		return err;
+
+	if (psuLen != SHC_PSU_GET_LENGTH || fanLen != SHC_FAN_GET_LENGTH ||
+		upsLen != SHC_UPS_GET_LENGTH)
+		return SMB2_SHC_ERR_LENGTH;
+
+	for (i = 0; i < SMB2_SHC_PSU_NUM; i++)
+		PsuDecode(psuData, i, &state->psu[i]);
+	for (i = 0; i < SMB2_SHC_FAN_NUM; i++)
+		FanDecode(fanData, i, &state->fan[i]);
+	for (i = 0; i < SMB2_SHC_UPS_NUM; i++)
+		UpsDecode(upsData, i, &state->ups[i]);
 
 	return SMB2_SHC_ERR_NO;
 }
-
@@ -54,6 +54,16 @@
   \verbatim
   err = SMB2SHC_GetTemperature(u_int16 *value); \endverbatim
 
+\n
+  <b>Multiple shelf controllers:</b>\n
+  SMB2SHC_Init() opens one shelf controller for the whole process.
+  To access several shelf controllers, open each with SMB2SHC_Open()
+  and pass the handle to the SMB2SHC_H_xxx() variants:
+  \verbatim
+  err = SMB2SHC_Open("smb2_1", SMB2_SHC_SMBADDR, &shcHdl);
+  err = SMB2SHC_H_GetTemperature(shcHdl, &value);
+  err = SMB2SHC_Close(&shcHdl); \endverbatim
+
 \n
 
 */
@@ -0,0 +1,424 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************/
+/*!
+ *        \file  smb2_shc_mon.c
+ *
+ *      \author  quoc.bui@men.de
+ *
+ *       \brief  SHC power-fail monitor
+ *
+ *               A background thread polls the PSU, FAN and UPS status of
+ *               the SHC at an adaptive rate and calls the registered
+ *               callbacks on transitions only. The detection latency is
+ *               measured from the start of the previous status read (the
+ *               last time the old state was seen) to the callback
+ *               delivery, i.e. poll delay plus bus time.
+ *
+ *    \switches  WINNT
+ *
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2014-2019, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+ /*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <MEN/men_typs.h>
+#include <MEN/usr_oss.h>
+#include <MEN/smb2_shc.h>
+#include <MEN/smb2_api.h>
+#include "smb2_shc_int.h"
+
+/*-----------------------------------------+
+|  DEFINES                                 |
++-----------------------------------------*/
+#define MON_SLICE				100		/* max. sleep time before checking
+										   for stop request [ms] */
+
+/* compare decoded flags, which are bit values, not 0/1 */
+#define MON_CHANGED(a, b)		(((a) != 0) != ((b) != 0))
+
+/*-----------------------------------------+
+|  TYPEDEFS                                |
++-----------------------------------------*/
+/** registered callback */
+typedef struct
+{
+	u_int32			events;		/**< SMB2_SHC_MON_EV_xxx events */
+	SMB2SHC_MON_CB	callback;	/**< callback */
+	void			*cbArg;		/**< argument for callback */
+}MON_CB_ENTRY;
+
+/** monitor handle */
+typedef struct
+{
+	void			*shcHdl;	/**< SHC handle */
+	SMB2_OS_THREAD	thread;		/**< monitor thread */
+	SMB2_OS_MUTEX	lock;		/**< protects cb, cbNum, stats and latSum */
+	volatile int	stop;		/**< stop request for the thread */
+	MON_CB_ENTRY	cb[SMB2_SHC_MON_CB_MAX];	/**< registered callbacks */
+	u_int32			cbNum;		/**< number of registered callbacks */
+	double			latSum;		/**< sum of latency values [ms] */
+	u_int32			latCnt;		/**< number of latency values */
+	struct shc_mon_stats stats;	/**< statistics */
+}MON_HANDLE;
+
+/*-----------------------------------------+
+|  PROTOTYPES                              |
++-----------------------------------------*/
+static void MonitorThread(void *arg);
+static u_int32 MonitorDiff(struct shc_mon_state *state,
+						   struct shc_mon_state *prev);
+static int MonitorAlert(struct shc_mon_state *state);
+static void MonitorDeliver(MON_HANDLE *mon, u_int32 events,
+						   struct shc_mon_state *state,
+						   struct shc_mon_state *prev);
+
+/****************************************************************************/
+/** Handle based variant of SMB2SHC_Monitor_Start().
+ *
+ *  \param     shcHdl    \IN  SHC handle from SMB2SHC_Open
+ *
+ *  \sa SMB2SHC_Monitor_Start, SMB2SHC_Open
+ */
+int32 __MAPILIB SMB2SHC_H_Monitor_Start(
+	void *shcHdl,
+	u_int32 period_min,
+	u_int32 period_max,
+	u_int32 events,
+	SMB2SHC_MON_CB callback,
+	void *cb_arg,
+	void **monHdlP)
+{
+	MON_HANDLE *mon;
+	int32 err;
+
+	*monHdlP = NULL;
+
+	if (period_min == 0 || period_max < period_min)
+		return SMB_ERR_PARAM;
+
+	mon = (MON_HANDLE*)malloc(sizeof(MON_HANDLE));
+	if (!mon)
+		return SMB_ERR_NO_MEM;
+
+	memset(mon, 0, sizeof(MON_HANDLE));
+	mon->shcHdl = shcHdl;
+	mon->stats.periodMin = period_min;
+	mon->stats.periodMax = period_max;
+	mon->stats.period = period_min;
+
+	if (callback) {
+		mon->cb[0].events = events;
+		mon->cb[0].callback = callback;
+		mon->cb[0].cbArg = cb_arg;
+		mon->cbNum = 1;
+	}
+
+	SMB2_OsMutexInit(&mon->lock);
+
+	err = SMB2_OsThreadCreate(&mon->thread, MonitorThread, mon, 1);
+	if (err) {
+		SMB2_OsMutexDestroy(&mon->lock);
+		free(mon);
+		return err;
+	}
+
+	*monHdlP = mon;
+
+	return SMB2_SHC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Register a further callback at the power-fail monitor.
+ *
+ *  \param     monHdl      \IN  monitor handle
+ *  \param     events      \IN  SMB2_SHC_MON_EV_xxx events for \a callback
+ *  \param     callback    \IN  callback
+ *  \param     cb_arg      \IN  argument for \a callback
+ *  \return    0 on success or error code
+ *
+ *  \sa SMB2SHC_Monitor_Start
+ */
+int32 __MAPILIB SMB2SHC_Monitor_Register(
+	void *monHdl,
+	u_int32 events,
+	SMB2SHC_MON_CB callback,
+	void *cb_arg)
+{
+	MON_HANDLE *mon = (MON_HANDLE*)monHdl;
+	int32 err = SMB2_SHC_ERR_NO;
+
+	if (!mon || !callback)
+		return SMB_ERR_PARAM;
+
+	SMB2_OsMutexLock(&mon->lock);
+	if (mon->cbNum < SMB2_SHC_MON_CB_MAX) {
+		mon->cb[mon->cbNum].events = events;
+		mon->cb[mon->cbNum].callback = callback;
+		mon->cb[mon->cbNum].cbArg = cb_arg;
+		mon->cbNum++;
+	}
+	else {
+		err = SMB_ERR_NO_MEM;
+	}
+	SMB2_OsMutexUnlock(&mon->lock);
+
+	return err;
+}
+
+/****************************************************************************/
+/** Stop the power-fail monitor.
+ *
+ *  Waits for the monitor thread to terminate and frees the handle.
+ *
+ *  \param     monHdlP    \INOUT  monitor handle, set to NULL
+ *  \return    0 on success or error code
+ *
+ *  \sa SMB2SHC_Monitor_Start
+ */
+int32 __MAPILIB SMB2SHC_Monitor_Stop(void **monHdlP)
+{
+	MON_HANDLE *mon = (MON_HANDLE*)*monHdlP;
+
+	if (!mon)
+		return SMB_ERR_PARAM;
+
+	mon->stop = 1;
+	SMB2_OsThreadJoin(&mon->thread);
+	SMB2_OsMutexDestroy(&mon->lock);
+	free(mon);
+	*monHdlP = NULL;
+
+	return SMB2_SHC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Get statistics of the power-fail monitor.
+ *
+ *  The latency of a transition is measured from the start of the
+ *  previous status read (the last time the old state was seen) to the
+ *  call of the first callback, i.e. poll delay plus bus time. It is
+ *  bounded by the poll period in effect before the transition, which is
+ *  \a period_max while the shelf is healthy.
+ *
+ *  \param     monHdl    \IN   monitor handle
+ *  \param     stats     \OUT  statistics
+ *  \return    0 on success or error code
+ *
+ *  \sa SMB2SHC_Monitor_Start
+ */
+int32 __MAPILIB SMB2SHC_Monitor_GetStats(
+	void *monHdl,
+	struct shc_mon_stats *stats)
+{
+	MON_HANDLE *mon = (MON_HANDLE*)monHdl;
+
+	if (!mon)
+		return SMB_ERR_PARAM;
+
+	SMB2_OsMutexLock(&mon->lock);
+	*stats = mon->stats;
+	if (mon->latCnt)
+		stats->latAvg = (int32)(mon->latSum / mon->latCnt);
+	SMB2_OsMutexUnlock(&mon->lock);
+
+	return SMB2_SHC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Monitor thread
+ *
+ *  Polls at fixed absolute times. The first successful read is the
+ *  reference and causes no events.
+ *
+ *  \param     arg    \IN  monitor handle
+ */
+static void MonitorThread(void *arg)
+{
+	MON_HANDLE *mon = (MON_HANDLE*)arg;
+	struct shc_mon_state state, prev;
+	u_int32 wake, period, events;
+	int valid = 0;
+	int32 rem;
+
+	memset(&prev, 0, sizeof(prev));
+	period = mon->stats.periodMin;
+	wake = UOS_MsecTimerGet();
+
+	while (!mon->stop) {
+		rem = (int32)(wake - UOS_MsecTimerGet());
+		if (rem > 0) {
+			UOS_Delay(rem > MON_SLICE ? MON_SLICE : rem);
+			continue;
+		}
+
+		memset(&state, 0, sizeof(state));
+		state.err = SHC_MonStatusRead(mon->shcHdl, &state);
+
+		events = 0;
+		if (valid)
+			events = MonitorDiff(&state, &prev);
+
+		if (events)
+			MonitorDeliver(mon, events, &state, &prev);
+
+		/* adapt poll rate */
+		if (events || MonitorAlert(&state))
+			period = mon->stats.periodMin;
+		else if (period < mon->stats.periodMax)
+			period = (period * 2 > mon->stats.periodMax) ?
+				mon->stats.periodMax : period * 2;
+
+		SMB2_OsMutexLock(&mon->lock);
+		mon->stats.pollCnt++;
+		if (state.err)
+			mon->stats.errCnt++;
+		mon->stats.period = period;
+		SMB2_OsMutexUnlock(&mon->lock);
+
+		/* keep the last valid state as reference for a failed read */
+		if (!state.err) {
+			prev = state;
+			valid = 1;
+		}
+		else if (valid) {
+			prev.err = state.err;
+		}
+
+		wake += period;
+		if ((int32)(wake - UOS_MsecTimerGet()) <= 0)
+			wake = UOS_MsecTimerGet() + period;
+	}
+}
+
+/****************************************************************************/
+/** Compare two monitor states
+ *
+ *  \param     state    \IN  new state
+ *  \param     prev     \IN  previous state
+ *  \return    SMB2_SHC_MON_EV_xxx events
+ */
+static u_int32 MonitorDiff(struct shc_mon_state *state,
+						   struct shc_mon_state *prev)
+{
+	u_int32 events = 0;
+	int i;
+
+	if (MON_CHANGED(state->err, prev->err))
+		events |= SMB2_SHC_MON_EV_ERR;
+
+	/* a failed read carries no unit state */
+	if (state->err)
+		return events;
+
+	for (i = 0; i < SMB2_SHC_PSU_NUM; i++) {
+		if (MON_CHANGED(state->psu[i].isEPwrPresent, prev->psu[i].isEPwrPresent))
+			events |= SMB2_SHC_MON_EV_PSU_EPWR;
+		if (MON_CHANGED(state->psu[i].intFailure, prev->psu[i].intFailure))
+			events |= SMB2_SHC_MON_EV_PSU_FAIL;
+		if (MON_CHANGED(state->psu[i].isPresent, prev->psu[i].isPresent))
+			events |= SMB2_SHC_MON_EV_PSU_PRESENT;
+	}
+
+	for (i = 0; i < SMB2_SHC_UPS_NUM; i++) {
+		if (MON_CHANGED(state->ups[i].provPWR, prev->ups[i].provPWR))
+			events |= SMB2_SHC_MON_EV_UPS_PWR;
+		if (MON_CHANGED(state->ups[i].intFailure, prev->ups[i].intFailure))
+			events |= SMB2_SHC_MON_EV_UPS_FAIL;
+		if (MON_CHANGED(state->ups[i].isPresent, prev->ups[i].isPresent))
+			events |= SMB2_SHC_MON_EV_UPS_PRESENT;
+	}
+
+	for (i = 0; i < SMB2_SHC_FAN_NUM; i++) {
+		if (MON_CHANGED(state->fan[i].state, prev->fan[i].state))
+			events |= SMB2_SHC_MON_EV_FAN_FAIL;
+		if (MON_CHANGED(state->fan[i].isPresent, prev->fan[i].isPresent))
+			events |= SMB2_SHC_MON_EV_FAN_PRESENT;
+	}
+
+	return events;
+}
+
+/****************************************************************************/
+/** Check if the shelf needs the fastest poll rate
+ *
+ *  \param     state    \IN  actual state
+ *  \return    1 if a read failed, a present PSU has no external power,
+ *             a UPS provides power or a unit fails, 0 otherwise
+ */
+static int MonitorAlert(struct shc_mon_state *state)
+{
+	int i;
+
+	if (state->err)
+		return 1;
+
+	for (i = 0; i < SMB2_SHC_PSU_NUM; i++)
+		if (state->psu[i].isPresent &&
+			(!state->psu[i].isEPwrPresent || state->psu[i].intFailure))
+			return 1;
+
+	for (i = 0; i < SMB2_SHC_UPS_NUM; i++)
+		if (state->ups[i].isPresent &&
+			(state->ups[i].provPWR || state->ups[i].intFailure))
+			return 1;
+
+	for (i = 0; i < SMB2_SHC_FAN_NUM; i++)
+		if (state->fan[i].isPresent && state->fan[i].state != SHC_FAN_OK)
+			return 1;
+
+	return 0;
+}
+
+/****************************************************************************/
+/** Call the callbacks registered for the events
+ *
+ *  \param     mon       \IN  monitor handle
+ *  \param     events    \IN  SMB2_SHC_MON_EV_xxx events
+ *  \param     state     \IN  new state
+ *  \param     prev      \IN  previous state
+ */
+static void MonitorDeliver(MON_HANDLE *mon, u_int32 events,
+						   struct shc_mon_state *state,
+						   struct shc_mon_state *prev)
+{
+	MON_CB_ENTRY cb[SMB2_SHC_MON_CB_MAX];
+	u_int32 cbNum, i;
+	int32 lat;
+
+	/* call the callbacks without holding the lock */
+	SMB2_OsMutexLock(&mon->lock);
+	cbNum = mon->cbNum;
+	memcpy(cb, mon->cb, sizeof(cb));
+
+	/* worst case: transition right after the previous read */
+	lat = (int32)(UOS_MsecTimerGet() - prev->tstamp);
+	if (mon->latCnt == 0 || lat < mon->stats.latMin)
+		mon->stats.latMin = lat;
+	if (mon->latCnt == 0 || lat > mon->stats.latMax)
+		mon->stats.latMax = lat;
+	mon->latSum += lat;
+	mon->latCnt++;
+	mon->stats.evCnt++;
+	SMB2_OsMutexUnlock(&mon->lock);
+
+	for (i = 0; i < cbNum; i++)
+		if (cb[i].events & events)
+			cb[i].callback(cb[i].cbArg, cb[i].events & events, state, prev);
+}
@@ -0,0 +1,282 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************/
+/*!
+ *        \file  smb2_shc_tref.c
+ *
+ *      \author  quoc.bui@men.de
+ *
+ *       \brief  SHC temperature override refresher
+ *
+ *               A background thread polls the application for the ambient
+ *               temperature and keeps the temperature override of the SHC
+ *               alive. All wake-up times are absolute times from
+ *               UOS_MsecTimerGet(), so the time spent for the callback and
+ *               the SMBus access does not accumulate.
+ *
+ *    \switches  WINNT
+ *
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2014-2019, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+ /*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <MEN/men_typs.h>
+#include <MEN/usr_oss.h>
+#include <MEN/smb2_shc.h>
+#include <MEN/smb2_api.h>
+#include "smb2_shc_int.h"
+
+/*-----------------------------------------+
+|  DEFINES                                 |
++-----------------------------------------*/
+#define TREF_SLICE				100		/* max. sleep time before checking
+										   for stop request [ms] */
+#define TREF_RETRY				500		/* retry time after failed write [ms] */
+
+/*-----------------------------------------+
+|  TYPEDEFS                                |
++-----------------------------------------*/
+/** refresher handle */
+typedef struct
+{
+	void			*shcHdl;	/**< SHC handle */
+	SMB2_OS_THREAD	thread;		/**< refresher thread */
+	SMB2_OS_MUTEX	lock;		/**< protects stats and latSum */
+	volatile int	stop;		/**< stop request for the thread */
+	SMB2SHC_TEMP_CB	callback;	/**< temperature callback */
+	void			*cbArg;		/**< argument for callback */
+	double			latSum;		/**< sum of latency values [ms] */
+	struct shc_temp_refresh_stats stats;	/**< statistics */
+}TREF_HANDLE;
+
+/*-----------------------------------------+
+|  PROTOTYPES                              |
++-----------------------------------------*/
+static void RefreshThread(void *arg);
+
+/****************************************************************************/
+/** Handle based variant of SMB2SHC_TempRefresh_Start().
+ *
+ *  \param     shcHdl    \IN  SHC handle from SMB2SHC_Open
+ *
+ *  \sa SMB2SHC_TempRefresh_Start, SMB2SHC_Open
+ */
+int32 __MAPILIB SMB2SHC_H_TempRefresh_Start(
+	void *shcHdl,
+	u_int32 period,
+	u_int32 lead,
+	SMB2SHC_TEMP_CB callback,
+	void *cb_arg,
+	void **trefHdlP)
+{
+	TREF_HANDLE *tref;
+	int32 err;
+
+	*trefHdlP = NULL;
+
+	if (period == 0 || lead == 0 || lead >= SMB2_SHC_TEMP_OVR_TIME ||
+		!callback)
+		return SMB_ERR_PARAM;
+
+	tref = (TREF_HANDLE*)malloc(sizeof(TREF_HANDLE));
+	if (!tref)
+		return SMB_ERR_NO_MEM;
+
+	memset(tref, 0, sizeof(TREF_HANDLE));
+	tref->shcHdl = shcHdl;
+	tref->callback = callback;
+	tref->cbArg = cb_arg;
+	tref->stats.period = period;
+	tref->stats.lead = lead;
+
+	SMB2_OsMutexInit(&tref->lock);
+
+	err = SMB2_OsThreadCreate(&tref->thread, RefreshThread, tref, 0);
+	if (err) {
+		SMB2_OsMutexDestroy(&tref->lock);
+		free(tref);
+		return err;
+	}
+
+	*trefHdlP = tref;
+
+	return SMB2_SHC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Stop the temperature override refresher.
+ *
+ *  Waits for the refresher thread to terminate and frees the handle.
+ *  The last override is not revoked, it expires after
+ *  SMB2_SHC_TEMP_OVR_TIME.
+ *
+ *  \param     trefHdlP    \INOUT  refresher handle, set to NULL
+ *  \return    0 on success or error code
+ *
+ *  \sa SMB2SHC_TempRefresh_Start
+ */
+int32 __MAPILIB SMB2SHC_TempRefresh_Stop(void **trefHdlP)
+{
+	TREF_HANDLE *tref = (TREF_HANDLE*)*trefHdlP;
+
+	if (!tref)
+		return SMB_ERR_PARAM;
+
+	tref->stop = 1;
+	SMB2_OsThreadJoin(&tref->thread);
+	SMB2_OsMutexDestroy(&tref->lock);
+	free(tref);
+	*trefHdlP = NULL;
+
+	return SMB2_SHC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Get statistics of the temperature override refresher.
+ *
+ *  The latency is the delay between the scheduled time of a write and
+ *  its completion. A missed deadline is an override that expired before
+ *  it was refreshed.
+ *
+ *  \param     trefHdl    \IN   refresher handle
+ *  \param     stats      \OUT  statistics
+ *  \return    0 on success or error code
+ *
+ *  \sa SMB2SHC_TempRefresh_Start
+ */
+int32 __MAPILIB SMB2SHC_TempRefresh_GetStats(
+	void *trefHdl,
+	struct shc_temp_refresh_stats *stats)
+{
+	TREF_HANDLE *tref = (TREF_HANDLE*)trefHdl;
+
+	if (!tref)
+		return SMB_ERR_PARAM;
+
+	SMB2_OsMutexLock(&tref->lock);
+	*stats = tref->stats;
+	if (tref->stats.writeCnt)
+		stats->latAvg = (int32)(tref->latSum / tref->stats.writeCnt);
+	SMB2_OsMutexUnlock(&tref->lock);
+
+	return SMB2_SHC_ERR_NO;
+}
+
+/****************************************************************************/
+/** Refresher thread
+ *
+ *  Wakes up every period to poll the callback, and additionally at the
+ *  refresh deadline (last write + SMB2_SHC_TEMP_OVR_TIME - lead). The
+ *  temperature is written if it changed or the deadline is reached.
+ *  Sleeps are split into TREF_SLICE pieces to notice a stop request.
+ *
+ *  \param     arg    \IN  refresher handle
+ */
+static void RefreshThread(void *arg)
+{
+	TREF_HANDLE *tref = (TREF_HANDLE*)arg;
+	u_int32 poll, due = 0, expire = 0, wake, now, start;
+	u_int16 tempK;
+	int written = 0, missed = 0, dueArmed = 0, isDue;
+	int32 rem, lat, err;
+
+	poll = UOS_MsecTimerGet();
+
+	while (!tref->stop) {
+		wake = poll;
+		if (dueArmed && (int32)(due - poll) < 0)
+			wake = due;
+
+		rem = (int32)(wake - UOS_MsecTimerGet());
+		if (rem > 0) {
+			UOS_Delay(rem > TREF_SLICE ? TREF_SLICE : rem);
+			continue;
+		}
+
+		now = UOS_MsecTimerGet();
+		if ((int32)(now - poll) >= 0) {
+			poll += tref->stats.period;
+			if ((int32)(poll - now) <= 0)
+				poll = now + tref->stats.period;
+		}
+
+		/* override expired without refresh */
+		if (written && !missed && (int32)(now - expire) >= 0) {
+			SMB2_OsMutexLock(&tref->lock);
+			tref->stats.missCnt++;
+			SMB2_OsMutexUnlock(&tref->lock);
+			missed = 1;
+		}
+
+		/* deadline reached: further attempts at the poll times */
+		if (dueArmed && (int32)(now - due) >= 0)
+			dueArmed = 0;
+
+		/* no valid temperature: let the override expire */
+		if (tref->callback(tref->cbArg, &tempK)) {
+			SMB2_OsMutexLock(&tref->lock);
+			tref->stats.cbErrCnt++;
+			SMB2_OsMutexUnlock(&tref->lock);
+			continue;
+		}
+
+		isDue = written && (int32)(now - due) >= 0;
+		if (written && !isDue && tempK == tref->stats.tempK) {
+			SMB2_OsMutexLock(&tref->lock);
+			tref->stats.skipCnt++;
+			SMB2_OsMutexUnlock(&tref->lock);
+			continue;
+		}
+
+		start = UOS_MsecTimerGet();
+		err = SMB2SHC_H_SetTemperature(tref->shcHdl, tempK);
+		now = UOS_MsecTimerGet();
+
+		SMB2_OsMutexLock(&tref->lock);
+		if (err) {
+			tref->stats.errCnt++;
+			tref->stats.lastErr = err;
+		}
+		else {
+			lat = (int32)(now - wake);
+			if (tref->stats.writeCnt == 0 || lat < tref->stats.latMin)
+				tref->stats.latMin = lat;
+			if (tref->stats.writeCnt == 0 || lat > tref->stats.latMax)
+				tref->stats.latMax = lat;
+			tref->latSum += lat;
+			tref->stats.writeCnt++;
+			tref->stats.tempK = tempK;
+		}
+		SMB2_OsMutexUnlock(&tref->lock);
+
+		if (err) {
+			/* retry soon */
+			poll = now + TREF_RETRY;
+		}
+		else {
+			written = 1;
+			missed = 0;
+			/* the SHC may have started the override before completion */
+			expire = start + SMB2_SHC_TEMP_OVR_TIME;
+			due = expire - tref->stats.lead;
+			dueArmed = 1;
+		}
+	}
+}